@@ -55,6 +55,105 @@ extern "C"
     bool vfs_exists(const char *path);
     bool vfs_is_directory(const char *path);
 
+    /**
+     * Rename or move a file or directory within one filesystem.
+     * @param from  Existing virtual path.
+     * @param to    New virtual path; an existing file is replaced, an existing directory is not.
+     * @return ESP_OK, ESP_ERR_NOT_FOUND if `from` does not exist, ESP_FAIL otherwise.
+     */
+    esp_err_t vfs_rename(const char *from, const char *to);
+
+    /**
+     * Remove a file, or a directory together with everything below it.
+     * @return ESP_OK, ESP_ERR_NOT_FOUND if nothing exists at `path`, ESP_FAIL if an entry could not be removed.
+     */
+    esp_err_t vfs_remove_recursive(const char *path);
+
+    /* --- Integrity --- */
+
+#define VFS_SHA256_LEN 32
+/** Suggested read buffer size for vfs_hash_file(). */
+#define VFS_HASH_BUF_SIZE 4096
+
+    /** Digests of a file's contents, as computed by vfs_hash_file(). */
+    typedef struct
+    {
+        uint8_t sha256[VFS_SHA256_LEN]; /**< SHA-256 of the contents. */
+        uint32_t crc32;                 /**< CRC-32 (IEEE 802.3, as in gzip and zip). */
+        uint64_t size;                  /**< Bytes hashed. */
+    } vfs_hash_t;
+
+    /**
+     * Compute the SHA-256 and CRC-32 of a file in one pass.
+     * @param path     Virtual file path.
+     * @param buf      Read buffer, reused for every block; the caller may keep it between calls.
+     * @param buf_len  Size of buf; VFS_HASH_BUF_SIZE or more keeps the per-read overhead low.
+     * @param out      Receives the digests and the size.
+     * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NOT_FOUND if the file cannot be opened, ESP_FAIL on a read error.
+     */
+    esp_err_t vfs_hash_file(const char *path, void *buf, size_t buf_len, vfs_hash_t *out);
+
+    /**
+     * Format the SHA-256 of a vfs_hash_t as lowercase hex.
+     * @param hash  Digests from vfs_hash_file().
+     * @param out   Receives 64 hex digits and a terminator.
+     */
+    void vfs_hash_sha256_hex(const vfs_hash_t *hash, char out[2 * VFS_SHA256_LEN + 1]);
+
+    /* --- Byte accounting (exported as the cos_fs_*_bytes_total metrics) --- */
+
+    /**
+     * Count bytes read with stdio from a path returned by vfs_resolve_path().
+     * vfs_read_file() counts its own reads.
+     * @param bytes  Number of bytes read.
+     */
+    void vfs_count_read(size_t bytes);
+
+    /**
+     * Count bytes written with stdio to a path returned by vfs_resolve_path().
+     * vfs_write_file() counts its own writes.
+     * @param bytes  Number of bytes written.
+     */
+    void vfs_count_written(size_t bytes);
+
+    /* --- Streaming directory iteration (constant memory, no entry limit) --- */
+
+    /** Opaque directory iterator. */
+    typedef struct vfs_dir vfs_dir_t;
+
+    /**
+     * Open a directory for iteration.
+     * @param path  Virtual directory path (not "/").
+     * @param out   Receives the iterator; release it with vfs_dir_close().
+     * @return ESP_OK, ESP_ERR_NOT_FOUND if the directory cannot be opened, ESP_ERR_NO_MEM.
+     */
+    esp_err_t vfs_dir_open(const char *path, vfs_dir_t **out);
+
+    /**
+     * Read the next entry, skipping "." and "..".
+     * @return ESP_OK, or ESP_ERR_NOT_FOUND when the directory is exhausted.
+     */
+    esp_err_t vfs_dir_next(vfs_dir_t *dir, vfs_dir_entry_t *entry);
+
+    /**
+     * Like vfs_dir_next() but without stat(): only name and is_dir are filled in,
+     * size and mtime are 0. Much cheaper on FAT, where every stat() searches the
+     * directory again; complete the entries you keep with vfs_dir_stat().
+     */
+    esp_err_t vfs_dir_next_name(vfs_dir_t *dir, vfs_dir_entry_t *entry);
+
+    /**
+     * Fill in is_dir, size and mtime for an entry of this directory by name.
+     * @return ESP_OK, or ESP_ERR_NOT_FOUND if the entry is gone.
+     */
+    esp_err_t vfs_dir_stat(vfs_dir_t *dir, vfs_dir_entry_t *entry);
+
+    /** Restart iteration at the first entry. */
+    void vfs_dir_rewind(vfs_dir_t *dir);
+
+    /** Close an iterator from vfs_dir_open(). NULL is ignored. */
+    void vfs_dir_close(vfs_dir_t *dir);
+
 #ifdef __cplusplus
 }
 #endif
@@ -3,17 +3,34 @@
 #include "sdcard.h"
 
 #include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "mbedtls/sha256.h"
+#include "metrics.h"
 
 #include <dirent.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/unistd.h>
 
 static const char *const TAG = "vfs";
 
+static metric_t *s_bytes_read = NULL;
+static metric_t *s_bytes_written = NULL;
+
+static bool sample_flash_used(int64_t *value)
+{
+    *value = (int64_t)flash_get_used_bytes();
+    return true;
+}
+
 esp_err_t filesystem_init(void)
 {
+    s_bytes_read = metrics_counter("cos_fs_read_bytes_total", "Bytes read from flash and SD card files");
+    s_bytes_written = metrics_counter("cos_fs_written_bytes_total", "Bytes written to flash and SD card files");
+    metrics_gauge_sampled("cos_fs_flash_used_bytes", "Used space on the flash filesystem", sample_flash_used);
+
     esp_err_t ret = flash_init();
     if (ret != ESP_OK)
     {
@@ -29,8 +46,58 @@ esp_err_t filesystem_init(void)
     return ESP_OK;
 }
 
+void vfs_count_read(size_t bytes)
+{
+    metrics_counter_add(s_bytes_read, (uint32_t)bytes);
+}
+
+void vfs_count_written(size_t bytes)
+{
+    metrics_counter_add(s_bytes_written, (uint32_t)bytes);
+}
+
 /* ---- File operations ---- */
 
+/* stat() one entry of a directory for is_dir, size and mtime */
+static esp_err_t stat_entry(const char *dir_real_path, vfs_dir_entry_t *out)
+{
+    char entry_path[VFS_PATH_MAX];
+    size_t rp_len = strlen(dir_real_path);
+    const char *sep = (rp_len > 0 && dir_real_path[rp_len - 1] == '/') ? "" : "/";
+    int written = snprintf(entry_path, sizeof(entry_path), "%s%s%s", dir_real_path, sep, out->name);
+    if (written < 0 || (size_t)written >= sizeof(entry_path))
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    struct stat st;
+    if (stat(entry_path, &st) != 0)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    out->is_dir = S_ISDIR(st.st_mode);
+    out->size = (size_t)st.st_size;
+    out->mtime = st.st_mtime;
+    return ESP_OK;
+}
+
+/* Populate an entry from a readdir() result, without size and mtime */
+static void fill_name(const struct dirent *entry, vfs_dir_entry_t *out)
+{
+    strncpy(out->name, entry->d_name, VFS_NAME_MAX - 1);
+    out->name[VFS_NAME_MAX - 1] = '\0';
+    out->is_dir = (entry->d_type == DT_DIR);
+    out->size = 0;
+    out->mtime = 0;
+}
+
+/* Populate an entry from a readdir() result, stat()ing it for size and mtime */
+static void fill_entry(const char *dir_real_path, const struct dirent *entry, vfs_dir_entry_t *out)
+{
+    fill_name(entry, out);
+    stat_entry(dir_real_path, out);
+}
+
 esp_err_t vfs_list_dir(const char *path, vfs_dir_entry_t *entries, size_t max_entries, size_t *count)
 {
     if (path == NULL || entries == NULL || count == NULL)
@@ -86,37 +153,7 @@ esp_err_t vfs_list_dir(const char *path, vfs_dir_entry_t *entries, size_t max_en
             continue;
         }
 
-        strncpy(entries[*count].name, entry->d_name, VFS_NAME_MAX - 1);
-        entries[*count].name[VFS_NAME_MAX - 1] = '\0';
-
-        char entry_path[VFS_PATH_MAX];
-        size_t rp_len = strlen(real_path);
-        const char *sep = (rp_len > 0 && real_path[rp_len - 1] == '/') ? "" : "/";
-        int written = snprintf(entry_path, sizeof(entry_path), "%s%s%s", real_path, sep, entry->d_name);
-
-        struct stat st;
-        if (written < 0 || (size_t)written >= sizeof(entry_path))
-        {
-            entries[*count].is_dir = (entry->d_type == DT_DIR);
-            entries[*count].size = 0;
-            entries[*count].mtime = 0;
-            (*count)++;
-            continue;
-        }
-
-        if (stat(entry_path, &st) == 0)
-        {
-            entries[*count].is_dir = S_ISDIR(st.st_mode);
-            entries[*count].size = (size_t)st.st_size;
-            entries[*count].mtime = st.st_mtime;
-        }
-        else
-        {
-            entries[*count].is_dir = (entry->d_type == DT_DIR);
-            entries[*count].size = 0;
-            entries[*count].mtime = 0;
-        }
-
+        fill_entry(real_path, entry, &entries[*count]);
         (*count)++;
     }
 
@@ -149,6 +186,7 @@ esp_err_t vfs_read_file(const char *path, char *buf, size_t buf_size, size_t *by
 
     *bytes_read = fread(buf, 1, buf_size, f);
     fclose(f);
+    vfs_count_read(*bytes_read);
     return ESP_OK;
 }
 
@@ -175,6 +213,7 @@ esp_err_t vfs_write_file(const char *path, const char *data, size_t len)
     if (len > 0)
     {
         size_t written = fwrite(data, 1, len, f);
+        vfs_count_written(written);
         if (written != len)
         {
             fclose(f);
@@ -186,6 +225,66 @@ esp_err_t vfs_write_file(const char *path, const char *data, size_t len)
     return ESP_OK;
 }
 
+esp_err_t vfs_hash_file(const char *path, void *buf, size_t buf_len, vfs_hash_t *out)
+{
+    if (path == NULL || buf == NULL || buf_len == 0 || out == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char real_path[VFS_PATH_MAX];
+    esp_err_t err = vfs_resolve_path(path, real_path, sizeof(real_path));
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    FILE *f = fopen(real_path, "rb");
+    if (f == NULL)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    /* Reads are already block-sized; stdio buffering would only add a copy */
+    setvbuf(f, NULL, _IONBF, 0);
+
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+    uint32_t crc = 0;
+    uint64_t size = 0;
+
+    size_t n;
+    while ((n = fread(buf, 1, buf_len, f)) > 0)
+    {
+        mbedtls_sha256_update(&sha, buf, n);
+        crc = esp_rom_crc32_le(crc, buf, n);
+        size += n;
+    }
+    err = ferror(f) ? ESP_FAIL : ESP_OK;
+    fclose(f);
+    vfs_count_read((size_t)size);
+
+    if (err == ESP_OK)
+    {
+        mbedtls_sha256_finish(&sha, out->sha256);
+        out->crc32 = crc;
+        out->size = size;
+    }
+    mbedtls_sha256_free(&sha);
+    return err;
+}
+
+void vfs_hash_sha256_hex(const vfs_hash_t *hash, char out[2 * VFS_SHA256_LEN + 1])
+{
+    static const char digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < VFS_SHA256_LEN; i++)
+    {
+        out[2 * i] = digits[hash->sha256[i] >> 4];
+        out[2 * i + 1] = digits[hash->sha256[i] & 0x0f];
+    }
+    out[2 * VFS_SHA256_LEN] = '\0';
+}
+
 esp_err_t vfs_mkdir(const char *path)
 {
     if (path == NULL)
@@ -249,6 +348,129 @@ esp_err_t vfs_remove(const char *path)
     return ESP_OK;
 }
 
+esp_err_t vfs_rename(const char *from, const char *to)
+{
+    if (from == NULL || to == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char real_from[VFS_PATH_MAX];
+    char real_to[VFS_PATH_MAX];
+    esp_err_t err = vfs_resolve_path(from, real_from, sizeof(real_from));
+    if (err == ESP_OK)
+    {
+        err = vfs_resolve_path(to, real_to, sizeof(real_to));
+    }
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    struct stat st;
+    if (stat(real_from, &st) != 0)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (rename(real_from, real_to) != 0)
+    {
+        ESP_LOGE(TAG, "rename failed: %s -> %s", real_from, real_to);
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+/*
+ * Depth-first removal on a real path, reusing one path buffer for the whole
+ * tree. Each directory is re-opened until it reads back empty, because not
+ * every filesystem keeps readdir() stable while entries are being unlinked.
+ */
+static esp_err_t remove_tree(char *path, size_t size)
+{
+    struct stat st;
+    if (stat(path, &st) != 0)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (!S_ISDIR(st.st_mode))
+    {
+        return unlink(path) == 0 ? ESP_OK : ESP_FAIL;
+    }
+
+    size_t len = strlen(path);
+    bool removed;
+    do
+    {
+        DIR *dir = opendir(path);
+        if (dir == NULL)
+        {
+            return ESP_FAIL;
+        }
+
+        removed = false;
+        esp_err_t err = ESP_OK;
+        struct dirent *entry;
+        while (err == ESP_OK && (entry = readdir(dir)) != NULL)
+        {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            {
+                continue;
+            }
+            int n = snprintf(path + len, size - len, "/%s", entry->d_name);
+            if (n < 0 || (size_t)n >= size - len)
+            {
+                err = ESP_ERR_INVALID_SIZE;
+            }
+            else
+            {
+                err = remove_tree(path, size);
+                removed = true;
+            }
+            path[len] = '\0';
+        }
+        closedir(dir);
+
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Failed to empty %s", path);
+            return ESP_FAIL;
+        }
+    } while (removed);
+
+    return rmdir(path) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t vfs_remove_recursive(const char *path)
+{
+    if (path == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char real_path[VFS_PATH_MAX];
+    esp_err_t err = vfs_resolve_path(path, real_path, sizeof(real_path));
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    /* Never wipe a mount point itself */
+    if (strcmp(real_path, FLASH_MOUNT_POINT) == 0 || strcmp(real_path, SDCARD_MOUNT_POINT) == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    err = remove_tree(real_path, sizeof(real_path));
+    if (err == ESP_FAIL)
+    {
+        ESP_LOGE(TAG, "recursive remove failed: %s", real_path);
+    }
+    return err;
+}
+
 bool vfs_exists(const char *path)
 {
     if (path == NULL)
@@ -304,3 +526,114 @@ bool vfs_is_directory(const char *path)
     }
     return S_ISDIR(st.st_mode);
 }
+
+struct vfs_dir
+{
+    DIR *dir;
+    char real_path[VFS_PATH_MAX];
+};
+
+esp_err_t vfs_dir_open(const char *path, vfs_dir_t **out)
+{
+    if (path == NULL || out == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out = NULL;
+
+    vfs_dir_t *d = calloc(1, sizeof(*d));
+    if (d == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t err = vfs_resolve_path(path, d->real_path, sizeof(d->real_path));
+    if (err != ESP_OK)
+    {
+        free(d);
+        return err;
+    }
+
+    d->dir = opendir(d->real_path);
+    if (d->dir == NULL)
+    {
+        free(d);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    *out = d;
+    return ESP_OK;
+}
+
+/* Next readdir() result, skipping "." and ".." */
+static struct dirent *read_entry(vfs_dir_t *dir)
+{
+    struct dirent *de;
+    while ((de = readdir(dir->dir)) != NULL)
+    {
+        if (strcmp(de->d_name, ".") != 0 && strcmp(de->d_name, "..") != 0)
+        {
+            return de;
+        }
+    }
+    return NULL;
+}
+
+esp_err_t vfs_dir_next(vfs_dir_t *dir, vfs_dir_entry_t *entry)
+{
+    if (dir == NULL || entry == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct dirent *de = read_entry(dir);
+    if (de == NULL)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    fill_entry(dir->real_path, de, entry);
+    return ESP_OK;
+}
+
+esp_err_t vfs_dir_next_name(vfs_dir_t *dir, vfs_dir_entry_t *entry)
+{
+    if (dir == NULL || entry == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct dirent *de = read_entry(dir);
+    if (de == NULL)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    fill_name(de, entry);
+    return ESP_OK;
+}
+
+esp_err_t vfs_dir_stat(vfs_dir_t *dir, vfs_dir_entry_t *entry)
+{
+    if (dir == NULL || entry == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return stat_entry(dir->real_path, entry);
+}
+
+void vfs_dir_rewind(vfs_dir_t *dir)
+{
+    if (dir != NULL)
+    {
+        rewinddir(dir->dir);
+    }
+}
+
+void vfs_dir_close(vfs_dir_t *dir)
+{
+    if (dir == NULL)
+    {
+        return;
+    }
+    closedir(dir->dir);
+    free(dir);
+}
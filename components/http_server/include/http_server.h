@@ -6,6 +6,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <time.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -20,10 +21,106 @@ extern "C"
 
     /**
      * @brief Get the httpd handle for endpoint registration by other components.
+     *
+     * With both listeners running this is the HTTPS one; see http_server_get_handles().
+     *
      * @return The handle, or NULL if the server is not running.
      */
     httpd_handle_t http_server_get_handle(void);
 
+    /**
+     * @brief Get every running listener (plain HTTP and/or HTTPS).
+     * @param out Receives up to max handles.
+     * @param max Capacity of out; 2 is enough.
+     * @return Number of handles written.
+     */
+    size_t http_server_get_handles(httpd_handle_t *out, size_t max);
+
+    /* --- HTTPS --- */
+
+    /** Which listeners http_server_init() starts. */
+    typedef enum
+    {
+        HTTP_TLS_OFF = 0, /**< Plain HTTP on port 80 only. */
+        HTTP_TLS_ON,      /**< HTTPS on port 443 only. */
+        HTTP_TLS_BOTH,    /**< Both, for migrating clients to HTTPS. */
+    } http_tls_mode_t;
+
+    /**
+     * @brief Select the listeners. Persists to NVS; applies at the next server start.
+     *
+     * HTTPS needs a PEM certificate and key at /flash/certs/server.crt and
+     * /flash/certs/server.key; without them only plain HTTP is started.
+     *
+     * @param mode Listeners to run.
+     * @return ESP_OK, ESP_ERR_INVALID_ARG, or an NVS error.
+     */
+    esp_err_t http_server_set_tls_mode(http_tls_mode_t mode);
+
+    /**
+     * @brief Get the configured listener mode.
+     * @return The mode last set, or loaded from NVS at server start.
+     */
+    http_tls_mode_t http_server_get_tls_mode(void);
+
+    /* --- API routing --- */
+
+/** Method bit for http_route_t.methods, e.g. HTTP_ROUTE_METHOD(HTTP_GET) | HTTP_ROUTE_METHOD(HTTP_HEAD). */
+#define HTTP_ROUTE_METHOD(m) (1u << (m))
+
+/** Route flag: run http_auth_check() before the handler. */
+#define HTTP_ROUTE_AUTH (1u << 0)
+
+/** Route flag: hand the request to the async worker pool before calling the handler. */
+#define HTTP_ROUTE_ASYNC (1u << 1)
+
+/** Maximum number of path parameters in one route. */
+#define HTTP_ROUTE_MAX_PARAMS 4
+
+    /**
+     * @brief An endpoint served by the API router.
+     *
+     * All routes live behind a single wildcard URI handler under /api, so they do not count
+     * against the httpd handler limit. Path segments are literals, "{name}" (one
+     * non-empty segment) or, as the last segment only, "{name...}" (the rest of
+     * the path). Literal segments take precedence over parameters.
+     */
+    typedef struct
+    {
+        const char *path;         /**< Pattern starting with "/api/", e.g. "/api/uploads/{id}". */
+        uint32_t methods;         /**< Bitmask of HTTP_ROUTE_METHOD() values. */
+        uint32_t flags;           /**< HTTP_ROUTE_AUTH, HTTP_ROUTE_ASYNC. */
+        httpd_uri_func_t handler; /**< Called once the path, method and flags have been checked. */
+    } http_route_t;
+
+    /**
+     * @brief Add a route to the API router. Call during initialization, before requests arrive.
+     *
+     * The route is copied. Unmatched paths get a 404, and a path that matches with
+     * the wrong method gets a 405 with an Allow header.
+     *
+     * @param route  Route to add.
+     * @return ESP_OK, ESP_ERR_INVALID_ARG for a malformed pattern, ESP_ERR_INVALID_STATE if
+     *         a method is already taken for that pattern or a parameter name conflicts,
+     *         ESP_ERR_NO_MEM if out of memory.
+     */
+    esp_err_t http_server_register_route(const http_route_t *route);
+
+    /**
+     * @brief Copy a path parameter of the current request, percent-decoded.
+     *
+     * Works from the httpd task and from async workers alike.
+     *
+     * @param req   Request being handled by a route.
+     * @param name  Parameter name without braces or dots.
+     * @param buf   Output buffer.
+     * @param len   Size of the output buffer.
+     * @return ESP_OK, ESP_ERR_NOT_FOUND if the route has no such parameter,
+     *         ESP_ERR_INVALID_SIZE if the value does not fit,
+     *         ESP_ERR_INVALID_ARG for a malformed escape or an embedded NUL.
+     */
+    esp_err_t http_server_route_param(httpd_req_t *req, const char *name, char *buf, size_t len);
+
     /* --- Pure utility functions (testable on host) --- */
 
     /**
@@ -38,6 +135,20 @@ extern "C"
      */
     esp_err_t http_sanitize_upload_path(const char *raw, char *out_path, size_t len);
 
+    /**
+     * @brief Percent-decode a URL path.
+     *
+     * Rejects malformed escapes, and %00 and %2F, which would end the string
+     * or add a path separator that is not in the URL.
+     *
+     * @param in   Encoded path, without the query string.
+     * @param out  Output buffer for the decoded path.
+     * @param len  Size of the output buffer.
+     * @return ESP_OK, ESP_ERR_INVALID_ARG if rejected, or ESP_ERR_INVALID_SIZE
+     *         if the result does not fit.
+     */
+    esp_err_t http_path_decode(const char *in, char *out, size_t len);
+
     /**
      * @brief Get the MIME type for a file path based on its extension.
      * @param path  File path or name.
@@ -45,6 +156,100 @@ extern "C"
      */
     const char *http_mime_type(const char *path);
 
+    /**
+     * @brief Whether a response of this type is worth gzip-compressing on the fly.
+     * @param type  MIME type as returned by http_mime_type().
+     * @return True for text, JSON, JavaScript, XML and SVG.
+     */
+    bool http_mime_is_compressible(const char *type);
+
+/** Buffer size for an IMF-fixdate HTTP date string, including the terminator. */
+#define HTTP_DATE_LEN 30
+
+/** Buffer size for an ETag produced by http_etag_format(), including quotes and terminator. */
+#define HTTP_ETAG_MAX 32
+
+    /**
+     * @brief Format a strong ETag from a file's size and modification time.
+     *
+     * @param size   File size in bytes.
+     * @param mtime  Last modification time (epoch seconds).
+     * @param out    Output buffer (HTTP_ETAG_MAX bytes recommended).
+     * @param len    Size of the output buffer.
+     */
+    void http_etag_format(size_t size, time_t mtime, char *out, size_t len);
+
+    /**
+     * @brief Format a timestamp as an IMF-fixdate HTTP date ("Sun, 06 Nov 1994 08:49:37 GMT").
+     *
+     * @param t    Epoch seconds (must not be negative).
+     * @param out  Output buffer of at least HTTP_DATE_LEN bytes.
+     * @param len  Size of the output buffer.
+     * @return ESP_OK on success, ESP_ERR_INVALID_ARG on bad input.
+     */
+    esp_err_t http_date_format(time_t t, char *out, size_t len);
+
+    /**
+     * @brief Parse an IMF-fixdate HTTP date. Obsolete RFC 850 and asctime forms are rejected.
+     *
+     * @param str  Date string.
+     * @param out  Parsed epoch seconds.
+     * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the string is not a valid IMF-fixdate.
+     */
+    esp_err_t http_date_parse(const char *str, time_t *out);
+
+    /**
+     * @brief Check an If-None-Match header value against an ETag (weak comparison, "*" matches anything).
+     *
+     * @param if_none_match  Header value, possibly a comma-separated list.
+     * @param etag           Current entity tag, including quotes.
+     * @return true if any listed tag matches.
+     */
+    bool http_etag_matches(const char *if_none_match, const char *etag);
+
+    /**
+     * @brief Evaluate conditional GET headers.
+     *
+     * If-None-Match takes precedence; If-Modified-Since is only consulted when
+     * If-None-Match is absent. Either header may be NULL or empty.
+     *
+     * @param if_none_match      If-None-Match header value.
+     * @param if_modified_since  If-Modified-Since header value.
+     * @param etag               Current entity tag.
+     * @param mtime              Current modification time (0 if unknown).
+     * @return true if a 304 Not Modified response should be sent.
+     */
+    bool http_is_not_modified(const char *if_none_match, const char *if_modified_since, const char *etag, time_t mtime);
+
+    /**
+     * @brief Evaluate an If-Range header.
+     *
+     * An entity tag (starting with '"' or "W/") must match strongly, so a weak
+     * tag never does; anything else is read as an HTTP-date that must equal
+     * the modification time.
+     *
+     * @param if_range  If-Range header value, or NULL if absent.
+     * @param etag      Current entity tag.
+     * @param mtime     Current modification time (0 if unknown).
+     * @return true if the Range header applies, false to send the full body.
+     */
+    bool http_if_range_matches(const char *if_range, const char *etag, time_t mtime);
+
+    /**
+     * @brief Parse a single-range "Range: bytes=..." header against a resource size.
+     *
+     * Supports "a-b", "a-" and suffix "-n" forms. The end position is clamped
+     * to the resource size.
+     *
+     * @param header  Range header value.
+     * @param size    Total resource size in bytes.
+     * @param start   First byte offset (inclusive) on success.
+     * @param end     Last byte offset (inclusive) on success.
+     * @return ESP_OK for a satisfiable range, ESP_ERR_INVALID_SIZE if unsatisfiable (send 416),
+     *         ESP_ERR_NOT_FOUND if the header is absent, malformed or multi-range (send the full body).
+     */
+    esp_err_t http_range_parse(const char *header, size_t size, size_t *start, size_t *end);
+
     /* --- Static file serving --- */
 
     /** @brief Enable or disable static file serving. Persists to NVS. */
@@ -65,6 +270,12 @@ extern "C"
     /** @brief Check if SPA fallback is enabled. */
     bool http_static_is_spa(void);
 
+    /** @brief Enable or disable HTML listings for directories without index.html. Persists to NVS. */
+    esp_err_t http_static_set_autoindex(bool enabled);
+
+    /** @brief Check if directory listings are enabled. */
+    bool http_static_is_autoindex(void);
+
     /* --- Authentication --- */
 
     /** @brief Set Basic auth credentials. Persists to NVS. */
@@ -74,11 +285,15 @@ extern "C"
     const char *http_auth_get_username(void);
 
     /**
-     * @brief Check Basic auth on a request.
+     * @brief Check a request's credentials.
      *
+     * A session token from POST /api/login ("Authorization: Bearer" or the
+     * cos_session cookie) is accepted first; Basic auth is the fallback.
      * Returns ESP_OK if authorized. On failure, sends a 401 response with
-     * WWW-Authenticate header and returns ESP_FAIL. Call this at the top
-     * of every protected endpoint handler.
+     * WWW-Authenticate header (or 429 with Retry-After while repeated failures
+     * are being throttled) and returns ESP_FAIL. Routes flagged with
+     * HTTP_ROUTE_AUTH get this check from the router; handlers registered
+     * directly with httpd must call it themselves.
      */
     esp_err_t http_auth_check(httpd_req_t *req);
 
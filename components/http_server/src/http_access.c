@@ -0,0 +1,349 @@
+#include "http_access.h"
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "metrics.h"
+
+#include <string.h>
+
+typedef struct
+{
+    bool active;
+    bool async;
+    int fd;
+    uint8_t method;
+    uint16_t status;
+    uint32_t bytes;
+    uint32_t uri_hash;
+    int64_t start_us;
+    http_access_route_t *route;
+} access_slot_t;
+
+static http_access_entry_t s_log[HTTP_ACCESS_LOG_SIZE];
+static size_t s_log_head;
+static size_t s_log_count;
+
+/* Entry 0 collects unmatched requests and routes past the table's end */
+static http_access_route_t s_routes[HTTP_ACCESS_ROUTES] = {{.name = "other"}};
+static size_t s_route_count = 1;
+
+static access_slot_t s_slots[HTTP_ACCESS_SLOTS];
+static SemaphoreHandle_t s_mutex = NULL;
+
+/* Registry-wide view of the same requests, for /api/metrics */
+static metric_t *s_requests[5];
+static metric_t *s_duration;
+static const uint32_t s_duration_bounds_us[] = {1000,   5000,    10000,   25000,   50000,   100000,
+                                                250000, 500000, 1000000, 2500000, 5000000, 10000000};
+
+static void lock(void)
+{
+    if (s_mutex)
+    {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+    }
+}
+
+static void unlock(void)
+{
+    if (s_mutex)
+    {
+        xSemaphoreGive(s_mutex);
+    }
+}
+
+void http_access_init(void)
+{
+    if (s_mutex == NULL)
+    {
+        s_mutex = xSemaphoreCreateMutex();
+    }
+
+    static const char *const names[] = {
+        "cos_http_requests_total{code=\"1xx\"}", "cos_http_requests_total{code=\"2xx\"}",
+        "cos_http_requests_total{code=\"3xx\"}", "cos_http_requests_total{code=\"4xx\"}",
+        "cos_http_requests_total{code=\"5xx\"}",
+    };
+    for (size_t i = 0; i < 5; i++)
+    {
+        s_requests[i] = metrics_counter(names[i], "HTTP requests by status class");
+    }
+    s_duration = metrics_histogram("cos_http_request_duration_us", "HTTP request handling time in microseconds",
+                                   s_duration_bounds_us,
+                                   sizeof(s_duration_bounds_us) / sizeof(s_duration_bounds_us[0]));
+}
+
+/* --- Histograms --- */
+
+static size_t bucket_index(uint32_t us)
+{
+    uint32_t v = us / HTTP_ACCESS_BUCKET0_US;
+    if (v == 0)
+    {
+        return 0;
+    }
+    size_t i = 32 - (size_t)__builtin_clz(v);
+    return i < HTTP_ACCESS_BUCKETS ? i : HTTP_ACCESS_BUCKETS - 1;
+}
+
+uint32_t http_access_bucket_bound(size_t i)
+{
+    return i + 1 < HTTP_ACCESS_BUCKETS ? (uint32_t)HTTP_ACCESS_BUCKET0_US << i : UINT32_MAX;
+}
+
+uint32_t http_access_percentile(const http_access_route_t *route, unsigned pct)
+{
+    if (route->count == 0)
+    {
+        return 0;
+    }
+
+    uint64_t target = ((uint64_t)route->count * pct + 99) / 100;
+    if (target == 0)
+    {
+        target = 1;
+    }
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < HTTP_ACCESS_BUCKETS; i++)
+    {
+        uint32_t n = route->buckets[i];
+        if (n == 0 || seen + n < target)
+        {
+            seen += n;
+            continue;
+        }
+        uint64_t lo = i == 0 ? 0 : (uint64_t)HTTP_ACCESS_BUCKET0_US << (i - 1);
+        uint64_t hi = i + 1 < HTTP_ACCESS_BUCKETS ? (uint64_t)HTTP_ACCESS_BUCKET0_US << i : route->max_us;
+        if (hi > route->max_us)
+        {
+            hi = route->max_us;
+        }
+        if (hi < lo)
+        {
+            return route->max_us;
+        }
+        return (uint32_t)(lo + (hi - lo) * (target - seen) / n);
+    }
+    return route->max_us;
+}
+
+uint32_t http_access_uri_hash(const char *uri)
+{
+    uint32_t h = 2166136261u;
+    while (*uri != '\0' && *uri != '?')
+    {
+        h ^= (uint8_t)*uri++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* --- Registry and ring --- */
+
+http_access_route_t *http_access_route(const char *name)
+{
+    http_access_route_t *route = &s_routes[0];
+    lock();
+    for (size_t i = 1; i < s_route_count; i++)
+    {
+        if (strcmp(s_routes[i].name, name) == 0)
+        {
+            route = &s_routes[i];
+            break;
+        }
+    }
+    if (route == &s_routes[0] && s_route_count < HTTP_ACCESS_ROUTES)
+    {
+        route = &s_routes[s_route_count++];
+        route->name = name;
+    }
+    unlock();
+    return route;
+}
+
+void http_access_record(http_access_route_t *route, const http_access_entry_t *entry)
+{
+    lock();
+    s_log[s_log_head] = *entry;
+    s_log[s_log_head].route = route->name;
+    s_log_head = (s_log_head + 1) % HTTP_ACCESS_LOG_SIZE;
+    if (s_log_count < HTTP_ACCESS_LOG_SIZE)
+    {
+        s_log_count++;
+    }
+
+    route->count++;
+    if (entry->status >= 100 && entry->status < 600)
+    {
+        route->status[entry->status / 100 - 1]++;
+    }
+    route->total_us += entry->duration_us;
+    if (entry->duration_us > route->max_us)
+    {
+        route->max_us = entry->duration_us;
+    }
+    route->buckets[bucket_index(entry->duration_us)]++;
+    unlock();
+
+    if (entry->status >= 100 && entry->status < 600)
+    {
+        metrics_counter_add(s_requests[entry->status / 100 - 1], 1);
+    }
+    metrics_histogram_observe(s_duration, entry->duration_us);
+}
+
+size_t http_access_log_read(http_access_entry_t *out, size_t max)
+{
+    lock();
+    size_t n = s_log_count < max ? s_log_count : max;
+    size_t start = (s_log_head + HTTP_ACCESS_LOG_SIZE - s_log_count) % HTTP_ACCESS_LOG_SIZE;
+    /* Keep the newest entries when the caller's buffer is smaller than the ring */
+    start = (start + s_log_count - n) % HTTP_ACCESS_LOG_SIZE;
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] = s_log[(start + i) % HTTP_ACCESS_LOG_SIZE];
+    }
+    unlock();
+    return n;
+}
+
+bool http_access_route_get(size_t i, http_access_route_t *out)
+{
+    lock();
+    bool ok = i < s_route_count;
+    if (ok)
+    {
+        *out = s_routes[i];
+    }
+    unlock();
+    return ok;
+}
+
+void http_access_reset(void)
+{
+    lock();
+    for (size_t i = 0; i < s_route_count; i++)
+    {
+        const char *name = s_routes[i].name;
+        memset(&s_routes[i], 0, sizeof(s_routes[i]));
+        s_routes[i].name = name;
+    }
+    s_log_head = 0;
+    s_log_count = 0;
+    unlock();
+}
+
+void http_access_reset_routes(void)
+{
+    lock();
+    memset(&s_routes[1], 0, sizeof(s_routes) - sizeof(s_routes[0]));
+    s_route_count = 1;
+    unlock();
+    http_access_reset();
+}
+
+/* --- Request lifecycle --- */
+
+/* Caller holds the lock */
+static access_slot_t *find_slot(int fd)
+{
+    for (size_t i = 0; i < HTTP_ACCESS_SLOTS; i++)
+    {
+        if (s_slots[i].active && s_slots[i].fd == fd)
+        {
+            return &s_slots[i];
+        }
+    }
+    return NULL;
+}
+
+void http_access_begin(httpd_req_t *req, http_access_route_t *route)
+{
+    int fd = httpd_req_to_sockfd(req);
+    lock();
+    access_slot_t *slot = find_slot(fd);
+    for (size_t i = 0; slot == NULL && i < HTTP_ACCESS_SLOTS; i++)
+    {
+        if (!s_slots[i].active)
+        {
+            slot = &s_slots[i];
+        }
+    }
+    if (slot != NULL)
+    {
+        *slot = (access_slot_t){
+            .active = true,
+            .fd = fd,
+            .method = (uint8_t)req->method,
+            .uri_hash = http_access_uri_hash(req->uri),
+            .start_us = esp_timer_get_time(),
+            .route = route != NULL ? route : &s_routes[0],
+        };
+    }
+    unlock();
+}
+
+void http_access_set_async(httpd_req_t *req, bool async)
+{
+    int fd = httpd_req_to_sockfd(req);
+    lock();
+    access_slot_t *slot = find_slot(fd);
+    if (slot != NULL)
+    {
+        slot->async = async;
+    }
+    unlock();
+}
+
+void http_access_end(httpd_req_t *req, bool worker)
+{
+    int fd = httpd_req_to_sockfd(req);
+    lock();
+    access_slot_t *slot = find_slot(fd);
+    if (slot == NULL || (slot->async && !worker))
+    {
+        unlock();
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    http_access_entry_t entry = {
+        .uri_hash = slot->uri_hash,
+        .end_ms = (uint32_t)(now / 1000),
+        .duration_us = (uint32_t)(now - slot->start_us),
+        .bytes = slot->bytes,
+        /* httpd sends 200 unless a handler set something else */
+        .status = slot->status != 0 ? slot->status : 200,
+        .method = slot->method,
+    };
+    http_access_route_t *route = slot->route;
+    slot->active = false;
+    unlock();
+
+    http_access_record(route, &entry);
+}
+
+void http_access_note_status(httpd_req_t *req, unsigned status)
+{
+    int fd = httpd_req_to_sockfd(req);
+    lock();
+    access_slot_t *slot = find_slot(fd);
+    if (slot != NULL)
+    {
+        slot->status = (uint16_t)status;
+    }
+    unlock();
+}
+
+void http_access_note_bytes(httpd_req_t *req, size_t bytes)
+{
+    int fd = httpd_req_to_sockfd(req);
+    lock();
+    access_slot_t *slot = find_slot(fd);
+    if (slot != NULL)
+    {
+        slot->bytes += (uint32_t)bytes;
+    }
+    unlock();
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Access log and per-route latency histograms. Every finished request is
+ * appended to a fixed ring and folded into its route's histogram; nothing is
+ * allocated per request. Histogram bucket 0 counts durations below
+ * HTTP_ACCESS_BUCKET0_US and bucket i the range [BUCKET0 << (i - 1), BUCKET0 << i);
+ * the last bucket also takes everything longer.
+ */
+
+#ifndef HTTP_ACCESS_LOG_SIZE
+#define HTTP_ACCESS_LOG_SIZE 32
+#endif
+
+/* Routes with their own histogram; later ones share the "other" entry */
+#ifndef HTTP_ACCESS_ROUTES
+#define HTTP_ACCESS_ROUTES 24
+#endif
+
+/* In-flight requests tracked at once (one per socket) */
+#ifndef HTTP_ACCESS_SLOTS
+#define HTTP_ACCESS_SLOTS 8
+#endif
+
+#define HTTP_ACCESS_BUCKETS 20
+#define HTTP_ACCESS_BUCKET0_US 128
+
+typedef struct
+{
+    const char *route; /* name of the route's stats entry */
+    uint32_t uri_hash; /* FNV-1a of the path, query excluded */
+    uint32_t end_ms;   /* uptime when the request finished */
+    uint32_t duration_us;
+    uint32_t bytes; /* response body bytes */
+    uint16_t status;
+    uint8_t method;
+} http_access_entry_t;
+
+typedef struct
+{
+    const char *name;
+    uint32_t count;
+    uint32_t status[5]; /* 1xx..5xx */
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t buckets[HTTP_ACCESS_BUCKETS];
+} http_access_route_t;
+
+void http_access_init(void);
+
+/* Stats entry for a route; name must outlive the server. Never NULL. */
+http_access_route_t *http_access_route(const char *name);
+
+/* Fold one finished request into the ring and its route (thread-safe) */
+void http_access_record(http_access_route_t *route, const http_access_entry_t *entry);
+
+/* Copy the ring, oldest first; returns the number of entries */
+size_t http_access_log_read(http_access_entry_t *out, size_t max);
+
+/* Snapshot of stats entry i; false past the last one */
+bool http_access_route_get(size_t i, http_access_route_t *out);
+
+/* Zero every counter and empty the ring */
+void http_access_reset(void);
+
+/* Also forget the registered routes (host tests, when the router is rebuilt) */
+void http_access_reset_routes(void);
+
+/* Percentile estimate (pct 1..100), interpolated within its bucket and capped at max_us */
+uint32_t http_access_percentile(const http_access_route_t *route, unsigned pct);
+
+/* Upper bound of histogram bucket i in microseconds (UINT32_MAX for the last one) */
+uint32_t http_access_bucket_bound(size_t i);
+
+uint32_t http_access_uri_hash(const char *uri);
+
+/* --- Request lifecycle (keyed by socket, so async copies of a request share the slot) --- */
+
+void http_access_begin(httpd_req_t *req, http_access_route_t *route);
+
+/* Mark the request as handed to (or, with false, taken back from) an async worker */
+void http_access_set_async(httpd_req_t *req, bool async);
+
+/* Record the request. From the handler's own task this is a no-op once it went async. */
+void http_access_end(httpd_req_t *req, bool worker);
+
+/* Called from the httpd_resp_* wrappers */
+void http_access_note_status(httpd_req_t *req, unsigned status);
+void http_access_note_bytes(httpd_req_t *req, size_t bytes);
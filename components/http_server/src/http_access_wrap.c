@@ -0,0 +1,91 @@
+#include "http_access.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * esp_http_server has no accessor for the status or byte count of a response,
+ * so the component links with --wrap for the calls below (see CMakeLists.txt)
+ * and notes them against the request's access-log slot on the way through.
+ * --wrap rewrites the references in every object of the link, so this also
+ * sees esp_http_server's own error replies (URI matching, header parsing).
+ * Those can come before a slot exists for the socket and are then ignored.
+ * The static handler writes large bodies with httpd_send() and notes them
+ * itself.
+ */
+
+esp_err_t __real_httpd_resp_set_status(httpd_req_t *r, const char *status);
+esp_err_t __real_httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len);
+esp_err_t __real_httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len);
+esp_err_t __real_httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg);
+
+esp_err_t __wrap_httpd_resp_set_status(httpd_req_t *r, const char *status)
+{
+    http_access_note_status(r, (unsigned)atoi(status));
+    return __real_httpd_resp_set_status(r, status);
+}
+
+esp_err_t __wrap_httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    size_t len = buf_len == HTTPD_RESP_USE_STRLEN ? (buf != NULL ? strlen(buf) : 0) : (size_t)buf_len;
+    http_access_note_bytes(r, len);
+    return __real_httpd_resp_send(r, buf, buf_len);
+}
+
+esp_err_t __wrap_httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    size_t len = buf_len == HTTPD_RESP_USE_STRLEN ? (buf != NULL ? strlen(buf) : 0) : (size_t)buf_len;
+    http_access_note_bytes(r, len);
+    return __real_httpd_resp_send_chunk(r, buf, buf_len);
+}
+
+esp_err_t __wrap_httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg)
+{
+    unsigned status;
+    switch (error)
+    {
+    case HTTPD_400_BAD_REQUEST:
+        status = 400;
+        break;
+    case HTTPD_401_UNAUTHORIZED:
+        status = 401;
+        break;
+    case HTTPD_403_FORBIDDEN:
+        status = 403;
+        break;
+    case HTTPD_404_NOT_FOUND:
+        status = 404;
+        break;
+    case HTTPD_405_METHOD_NOT_ALLOWED:
+        status = 405;
+        break;
+    case HTTPD_408_REQ_TIMEOUT:
+        status = 408;
+        break;
+    case HTTPD_411_LENGTH_REQUIRED:
+        status = 411;
+        break;
+    case HTTPD_414_URI_TOO_LONG:
+        status = 414;
+        break;
+    case HTTPD_431_REQ_HDR_FIELDS_TOO_LARGE:
+        status = 431;
+        break;
+    case HTTPD_501_METHOD_NOT_IMPLEMENTED:
+        status = 501;
+        break;
+    case HTTPD_505_VERSION_NOT_SUPPORTED:
+        status = 505;
+        break;
+    case HTTPD_500_INTERNAL_SERVER_ERROR:
+    default:
+        status = 500;
+        break;
+    }
+    http_access_note_status(req, status);
+    if (msg != NULL)
+    {
+        http_access_note_bytes(req, strlen(msg));
+    }
+    return __real_httpd_resp_send_err(req, error, msg);
+}
@@ -1,7 +1,12 @@
 #include "filesystem.h"
+#include "http_access.h"
+#include "http_dir_list.h"
+#include "http_json.h"
 #include "http_server.h"
+#include "metrics.h"
 
 #include "esp_log.h"
+#include "esp_timer.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -9,109 +14,377 @@
 
 static const char *const TAG = "http_api";
 
-static size_t json_escape(const char *src, char *dst, size_t dst_len)
+/* Entries per page unless ?limit= says otherwise, and the most a page may hold */
+#ifndef HTTP_FILES_LIMIT_DEFAULT
+#define HTTP_FILES_LIMIT_DEFAULT 100
+#endif
+
+#ifndef HTTP_FILES_LIMIT_MAX
+#define HTTP_FILES_LIMIT_MAX 200
+#endif
+
+/* The virtual root holds at most flash and sdcard */
+#define FILES_ROOT_ENTRIES 2
+
+typedef struct
 {
-    size_t j = 0;
-    for (size_t i = 0; src[i] != '\0' && j < dst_len - 1; i++)
+    const char *path;
+    vfs_dir_t *dir; /* NULL for the virtual root */
+    const char *glob;
+    http_dir_sort_t sort;
+    bool have_floor;
+    vfs_dir_entry_t floor; /* last entry of the previous pass; only later ones are offered */
+    size_t total;
+} files_scan_t;
+
+static void scan_offer(files_scan_t *s, http_dir_topk_t *topk, vfs_dir_entry_t *e, bool count)
+{
+    if (s->glob[0] != '\0' && !http_dir_glob_match(s->glob, e->name))
     {
-        char c = src[i];
-        if (c == '"' || c == '\\')
-        {
-            if (j + 2 >= dst_len)
-            {
-                break;
-            }
-            dst[j++] = '\\';
-        }
-        dst[j++] = c;
+        return;
+    }
+    /* Only size and mtime ordering needs a stat() per entry; the page is completed later */
+    if (s->dir != NULL && s->sort.key != HTTP_DIR_SORT_NAME && vfs_dir_stat(s->dir, e) != ESP_OK)
+    {
+        return;
+    }
+    if (count)
+    {
+        s->total++;
+    }
+    if (!s->have_floor || http_dir_compare(&s->sort, e, &s->floor) > 0)
+    {
+        http_dir_topk_offer(topk, e);
     }
-    dst[j] = '\0';
-    return j;
 }
 
-static esp_err_t handler_files(httpd_req_t *req)
+/* One pass over the directory: keep the first topk->cap matching entries after the floor */
+static void scan_pass(files_scan_t *s, http_dir_topk_t *topk, bool count)
 {
-    if (http_auth_check(req) != ESP_OK)
+    vfs_dir_entry_t e;
+    if (s->dir == NULL)
     {
-        return ESP_OK;
+        vfs_dir_entry_t root[FILES_ROOT_ENTRIES];
+        size_t n = 0;
+        vfs_list_dir(s->path, root, FILES_ROOT_ENTRIES, &n);
+        for (size_t i = 0; i < n; i++)
+        {
+            scan_offer(s, topk, &root[i], count);
+        }
+    }
+    else
+    {
+        vfs_dir_rewind(s->dir);
+        while (vfs_dir_next_name(s->dir, &e) == ESP_OK)
+        {
+            scan_offer(s, topk, &e, count);
+        }
     }
+    http_dir_topk_finish(topk);
+}
 
+/*
+ * GET /api/files?path=/sdcard/log[&offset=N][&limit=N][&sort=name|size|mtime][&order=asc|desc][&glob=*.csv]
+ *
+ * Answers one page of the directory as a JSON array and the number of matching
+ * entries in X-Total-Count. Entries are ranked while the directory streams past
+ * into a bounded heap, so memory does not grow with the directory. Skipping
+ * `offset` entries takes one more pass per HTTP_FILES_LIMIT_MAX entries
+ * skipped (the heap is that large whenever there is an offset, since with
+ * sort=size|mtime every pass stats every entry), each pass continuing after
+ * the last entry of the one before; the order is total (ties are broken by
+ * name), so no entry is seen twice.
+ */
+static esp_err_t handler_files(httpd_req_t *req)
+{
     char query[256] = {0};
     char path[VFS_PATH_MAX] = "/flash";
+    char glob[VFS_NAME_MAX] = {0};
+    char sort_key[8] = {0};
+    char order[8] = {0};
+    char value[12] = {0};
+    size_t offset = 0;
+    size_t limit = HTTP_FILES_LIMIT_DEFAULT;
 
+    files_scan_t s = {0};
     if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK)
     {
         httpd_query_key_value(query, "path", path, sizeof(path));
+        httpd_query_key_value(query, "glob", glob, sizeof(glob));
+        httpd_query_key_value(query, "sort", sort_key, sizeof(sort_key));
+        httpd_query_key_value(query, "order", order, sizeof(order));
+        if (httpd_query_key_value(query, "offset", value, sizeof(value)) == ESP_OK)
+        {
+            offset = strtoul(value, NULL, 10);
+        }
+        if (httpd_query_key_value(query, "limit", value, sizeof(value)) == ESP_OK)
+        {
+            limit = strtoul(value, NULL, 10);
+        }
+    }
+    if (!http_dir_sort_parse(sort_key, order, &s.sort))
+    {
+        return http_json_send_error(req, "400 Bad Request", "sort must be name, size or mtime; order asc or desc");
+    }
+    if (limit == 0 || limit > HTTP_FILES_LIMIT_MAX)
+    {
+        limit = HTTP_FILES_LIMIT_MAX;
     }
 
-    vfs_dir_entry_t *entries = malloc(VFS_ENTRIES_MAX * sizeof(vfs_dir_entry_t));
-    if (entries == NULL)
+    s.path = path;
+    s.glob = glob;
+    if (strcmp(path, "/") != 0)
     {
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
-        return ESP_OK;
+        esp_err_t err = vfs_dir_open(path, &s.dir);
+        if (err != ESP_OK)
+        {
+            return http_json_send_error(req, "400 Bad Request", esp_err_to_name(err));
+        }
     }
 
-    size_t count = 0;
-    esp_err_t err = vfs_list_dir(path, entries, VFS_ENTRIES_MAX, &count);
-    if (err != ESP_OK)
+    size_t cap = offset > 0 ? HTTP_FILES_LIMIT_MAX : limit;
+    vfs_dir_entry_t *items = malloc(cap * sizeof(vfs_dir_entry_t));
+    if (items == NULL && cap > limit)
+    {
+        cap = limit;
+        items = malloc(cap * sizeof(vfs_dir_entry_t));
+    }
+    if (items == NULL)
+    {
+        vfs_dir_close(s.dir);
+        return http_json_send_error(req, "500 Internal Server Error", "Out of memory");
+    }
+
+    /* Skip passes of up to `cap` entries first, so the last pass is the page */
+    http_dir_topk_t topk;
+    size_t skip = offset;
+    bool first = true;
+    for (;;)
     {
-        free(entries);
-        httpd_resp_set_type(req, "application/json");
-        httpd_resp_set_status(req, "400 Bad Request");
-        char errbuf[64];
-        snprintf(errbuf, sizeof(errbuf), "{\"error\":\"%s\"}", esp_err_to_name(err));
-        return httpd_resp_send(req, errbuf, HTTPD_RESP_USE_STRLEN);
+        size_t want = skip == 0 ? limit : (skip < cap ? skip : cap);
+        http_dir_topk_init(&topk, items, want, &s.sort);
+        scan_pass(&s, &topk, first);
+        first = false;
+
+        if (skip == 0)
+        {
+            break;
+        }
+        if (topk.count < want || skip >= s.total)
+        {
+            topk.count = 0;
+            break;
+        }
+        skip -= want;
+        s.floor = items[want - 1];
+        s.have_floor = true;
     }
 
+    if (s.dir != NULL)
+    {
+        for (size_t i = 0; i < topk.count && s.sort.key == HTTP_DIR_SORT_NAME; i++)
+        {
+            vfs_dir_stat(s.dir, &items[i]);
+        }
+        vfs_dir_close(s.dir);
+    }
+
+    char total[12];
+    snprintf(total, sizeof(total), "%u", (unsigned)s.total);
+    httpd_resp_set_hdr(req, "X-Total-Count", total);
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr_chunk(req, "[");
 
-    for (size_t i = 0; i < count; i++)
+    http_stream_t out;
+    http_json_t j;
+    http_stream_init(&out, req);
+    http_stream_gzip(&out);
+    http_json_init(&j, &out);
+    http_json_array_begin(&j);
+    for (size_t i = 0; i < topk.count; i++)
     {
-        char escaped_name[128];
-        json_escape(entries[i].name, escaped_name, sizeof(escaped_name));
-        char item[256];
-        snprintf(item, sizeof(item), "%s{\"name\":\"%s\",\"size\":%u,\"is_dir\":%s}", (i > 0) ? "," : "", escaped_name,
-                 (unsigned)entries[i].size, entries[i].is_dir ? "true" : "false");
-        httpd_resp_sendstr_chunk(req, item);
+        http_json_object_begin(&j);
+        http_json_kv_string(&j, "name", items[i].name);
+        http_json_kv_uint(&j, "size", items[i].size);
+        http_json_kv_bool(&j, "is_dir", items[i].is_dir);
+        http_json_kv_int(&j, "mtime", (int64_t)items[i].mtime);
+        http_json_object_end(&j);
     }
+    http_json_array_end(&j);
 
-    free(entries);
-    httpd_resp_sendstr_chunk(req, "]");
-    httpd_resp_sendstr_chunk(req, NULL);
-    return ESP_OK;
+    free(items);
+    return http_stream_finish(&out);
 }
 
-static esp_err_t handler_heap(httpd_req_t *req)
+/*
+ * GET /api/files/hash?path=/sdcard/big.bin -- SHA-256 and CRC-32 of a file
+ * as it is on the filesystem, so an upload can be checked without
+ * downloading it again. Hashing runs at flash or card read speed, reported
+ * as "bytes_per_sec".
+ */
+static esp_err_t handler_file_hash(httpd_req_t *req)
 {
-    if (http_auth_check(req) != ESP_OK)
+    char query[256] = {0};
+    char raw_path[VFS_PATH_MAX] = {0};
+    char path[VFS_PATH_MAX];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+        httpd_query_key_value(query, "path", raw_path, sizeof(raw_path)) != ESP_OK)
     {
-        return ESP_OK;
+        return http_json_send_error(req, "400 Bad Request", "Missing path parameter");
     }
+    if (http_sanitize_upload_path(raw_path, path, sizeof(path)) != ESP_OK)
+    {
+        return http_json_send_error(req, "400 Bad Request", "Invalid path");
+    }
+    if (vfs_is_directory(path))
+    {
+        return http_json_send_error(req, "400 Bad Request", "Path is a directory");
+    }
+
+    void *buf = malloc(VFS_HASH_BUF_SIZE);
+    if (buf == NULL)
+    {
+        return http_json_send_error(req, "500 Internal Server Error", "Out of memory");
+    }
+    vfs_hash_t hash;
+    int64_t start = esp_timer_get_time();
+    esp_err_t err = vfs_hash_file(path, buf, VFS_HASH_BUF_SIZE, &hash);
+    int64_t elapsed_us = esp_timer_get_time() - start;
+    free(buf);
+    if (err == ESP_ERR_NOT_FOUND)
+    {
+        return http_json_send_error(req, "404 Not Found", "File not found");
+    }
+    if (err != ESP_OK)
+    {
+        return http_json_send_error(req, "500 Internal Server Error", "Read failed");
+    }
+
+    char sha256[2 * VFS_SHA256_LEN + 1];
+    char crc32[9];
+    vfs_hash_sha256_hex(&hash, sha256);
+    snprintf(crc32, sizeof(crc32), "%08x", (unsigned)hash.crc32);
+
+    httpd_resp_set_type(req, "application/json");
+    http_stream_t out;
+    http_json_t j;
+    http_stream_init(&out, req);
+    http_json_init(&j, &out);
+    http_json_object_begin(&j);
+    http_json_kv_string(&j, "path", path);
+    http_json_kv_uint(&j, "size", hash.size);
+    http_json_kv_string(&j, "sha256", sha256);
+    http_json_kv_string(&j, "crc32", crc32);
+    http_json_kv_uint(&j, "elapsed_us", (uint64_t)elapsed_us);
+    http_json_kv_uint(&j, "bytes_per_sec", elapsed_us > 0 ? hash.size * 1000000u / (uint64_t)elapsed_us : 0);
+    http_json_object_end(&j);
+    return http_stream_finish(&out);
+}
 
+static esp_err_t handler_heap(httpd_req_t *req)
+{
     char buf[16];
     snprintf(buf, sizeof(buf), "%u", (unsigned)esp_get_free_heap_size());
     httpd_resp_set_type(req, "text/plain");
     return httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
 }
 
-void http_api_register(httpd_handle_t server)
+static esp_err_t write_stream(void *ctx, const char *data, size_t len)
 {
-    const httpd_uri_t files_uri = {
-        .uri = "/api/files",
-        .method = HTTP_GET,
-        .handler = handler_files,
-        .user_ctx = NULL,
-    };
-    httpd_register_uri_handler(server, &files_uri);
+    return http_stream_write(ctx, data, len);
+}
 
-    const httpd_uri_t heap_uri = {
-        .uri = "/api/heap",
-        .method = HTTP_GET,
-        .handler = handler_heap,
-        .user_ctx = NULL,
-    };
-    httpd_register_uri_handler(server, &heap_uri);
+/* GET /api/metrics[?prefix=cos_http] -- Prometheus text exposition format */
+static esp_err_t handler_metrics(httpd_req_t *req)
+{
+    char query[64] = {0};
+    char prefix[48] = {0};
+
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK)
+    {
+        httpd_query_key_value(query, "prefix", prefix, sizeof(prefix));
+    }
+
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
 
+    http_stream_t out;
+    http_stream_init(&out, req);
+    http_stream_gzip(&out);
+    metrics_export(prefix, write_stream, &out);
+    return http_stream_finish(&out);
+}
+
+static esp_err_t handler_server_stats(httpd_req_t *req)
+{
+    static const char *const classes[] = {"1xx", "2xx", "3xx", "4xx", "5xx"};
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+
+    http_stream_t out;
+    http_json_t j;
+    http_stream_init(&out, req);
+    http_json_init(&j, &out);
+    http_json_object_begin(&j);
+
+    /* Upper bounds of the histogram buckets; the last bucket is open-ended */
+    http_json_key(&j, "bucket_le_us");
+    http_json_array_begin(&j);
+    for (size_t i = 0; i + 1 < HTTP_ACCESS_BUCKETS; i++)
+    {
+        http_json_uint(&j, http_access_bucket_bound(i));
+    }
+    http_json_array_end(&j);
+
+    http_json_key(&j, "routes");
+    http_json_array_begin(&j);
+    http_access_route_t r;
+    for (size_t i = 0; http_access_route_get(i, &r); i++)
+    {
+        http_json_object_begin(&j);
+        http_json_kv_string(&j, "route", r.name);
+        http_json_kv_uint(&j, "count", r.count);
+        http_json_kv_uint(&j, "mean_us", r.count > 0 ? (uint32_t)(r.total_us / r.count) : 0);
+        http_json_kv_uint(&j, "p50_us", http_access_percentile(&r, 50));
+        http_json_kv_uint(&j, "p95_us", http_access_percentile(&r, 95));
+        http_json_kv_uint(&j, "p99_us", http_access_percentile(&r, 99));
+        http_json_kv_uint(&j, "max_us", r.max_us);
+
+        http_json_key(&j, "status");
+        http_json_object_begin(&j);
+        for (size_t c = 0; c < 5; c++)
+        {
+            http_json_kv_uint(&j, classes[c], r.status[c]);
+        }
+        http_json_object_end(&j);
+
+        http_json_key(&j, "buckets");
+        http_json_array_begin(&j);
+        for (size_t b = 0; b < HTTP_ACCESS_BUCKETS; b++)
+        {
+            http_json_uint(&j, r.buckets[b]);
+        }
+        http_json_array_end(&j);
+        http_json_object_end(&j);
+    }
+    http_json_array_end(&j);
+
+    http_json_object_end(&j);
+    return http_stream_finish(&out);
+}
+
+void http_api_register(void)
+{
+    static const http_route_t routes[] = {
+        {"/api/files", HTTP_ROUTE_METHOD(HTTP_GET), HTTP_ROUTE_AUTH | HTTP_ROUTE_ASYNC, handler_files},
+        {"/api/files/hash", HTTP_ROUTE_METHOD(HTTP_GET), HTTP_ROUTE_AUTH | HTTP_ROUTE_ASYNC, handler_file_hash},
+        {"/api/heap", HTTP_ROUTE_METHOD(HTTP_GET), HTTP_ROUTE_AUTH, handler_heap},
+        {"/api/metrics", HTTP_ROUTE_METHOD(HTTP_GET), HTTP_ROUTE_AUTH, handler_metrics},
+        {"/api/server/stats", HTTP_ROUTE_METHOD(HTTP_GET), HTTP_ROUTE_AUTH, handler_server_stats},
+    };
+    for (size_t i = 0; i < sizeof(routes) / sizeof(routes[0]); i++)
+    {
+        http_server_register_route(&routes[i]);
+    }
     ESP_LOGI(TAG, "API endpoints registered");
 }
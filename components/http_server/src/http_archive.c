@@ -0,0 +1,680 @@
+#include "filesystem.h"
+#include "http_deflate.h"
+#include "http_inflate.h"
+#include "http_json.h"
+#include "http_server.h"
+#include "http_stream.h"
+#include "http_tar.h"
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const TAG = "http_archive";
+
+/*
+ * GET /api/archive?path=/flash/data[&gzip=1]
+ *
+ * Streams the directory tree as a ustar archive (optionally gzipped) over a
+ * chunked response. Memory is fixed: one read buffer, the path buffers and
+ * one directory iterator per level of nesting.
+ */
+
+#define ARCHIVE_BUF_SIZE 4096
+#define ARCHIVE_MAX_DEPTH 8
+#define ARCHIVE_NAME_MAX (VFS_PATH_MAX + 32)
+
+typedef struct
+{
+    http_stream_t out;
+    http_deflate_t *gz;
+    esp_err_t err;
+    uint8_t *buf;
+    char vpath[VFS_PATH_MAX];
+    char name[ARCHIVE_NAME_MAX];
+    unsigned files;
+    unsigned skipped;
+} archive_t;
+
+static esp_err_t chunk_sink(void *ctx, const uint8_t *data, size_t len)
+{
+    archive_t *a = ctx;
+    return http_stream_write(&a->out, (const char *)data, len);
+}
+
+static void emit(archive_t *a, const uint8_t *data, size_t len)
+{
+    if (a->err != ESP_OK || len == 0)
+    {
+        return;
+    }
+    a->err = a->gz ? http_gzip_write(a->gz, data, len) : chunk_sink(a, data, len);
+}
+
+static void emit_zeros(archive_t *a, size_t len)
+{
+    memset(a->buf, 0, len < ARCHIVE_BUF_SIZE ? len : ARCHIVE_BUF_SIZE);
+    while (len > 0 && a->err == ESP_OK)
+    {
+        size_t n = len < ARCHIVE_BUF_SIZE ? len : ARCHIVE_BUF_SIZE;
+        emit(a, a->buf, n);
+        len -= n;
+    }
+}
+
+static bool emit_header(archive_t *a, uint64_t size, time_t mtime, bool is_dir)
+{
+    uint8_t block[HTTP_TAR_BLOCK];
+    if (http_tar_header(block, a->name, size, mtime, is_dir) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Skipping %s: name too long for ustar", a->vpath);
+        a->skipped++;
+        return false;
+    }
+    emit(a, block, sizeof(block));
+    return true;
+}
+
+static void emit_file(archive_t *a, const vfs_dir_entry_t *entry)
+{
+    char real_path[VFS_PATH_MAX];
+    FILE *f = NULL;
+    if (vfs_resolve_path(a->vpath, real_path, sizeof(real_path)) == ESP_OK)
+    {
+        f = fopen(real_path, "rb");
+    }
+    if (f == NULL)
+    {
+        ESP_LOGW(TAG, "Skipping unreadable %s", a->vpath);
+        a->skipped++;
+        return;
+    }
+
+    if (emit_header(a, entry->size, entry->mtime, false))
+    {
+        /* The header already promised entry->size bytes; hold to it even if the file changes */
+        size_t remaining = entry->size;
+        while (remaining > 0 && a->err == ESP_OK)
+        {
+            size_t want = remaining < ARCHIVE_BUF_SIZE ? remaining : ARCHIVE_BUF_SIZE;
+            size_t n = fread(a->buf, 1, want, f);
+            if (n == 0)
+            {
+                break;
+            }
+            vfs_count_read(n);
+            emit(a, a->buf, n);
+            remaining -= n;
+        }
+        emit_zeros(a, remaining + http_tar_padding(entry->size));
+        a->files++;
+    }
+    fclose(f);
+}
+
+/* Append "/component" to a buffer in place; returns the old length or -1 if it does not fit */
+static int path_push(char *buf, size_t size, const char *component)
+{
+    size_t len = strlen(buf);
+    int n = snprintf(buf + len, size - len, "/%s", component);
+    if (n < 0 || (size_t)n >= size - len)
+    {
+        buf[len] = '\0';
+        return -1;
+    }
+    return (int)len;
+}
+
+static void archive_dir(archive_t *a, int depth)
+{
+    vfs_dir_t *dir = NULL;
+    if (vfs_dir_open(a->vpath, &dir) != ESP_OK)
+    {
+        a->skipped++;
+        return;
+    }
+
+    vfs_dir_entry_t entry;
+    while (a->err == ESP_OK && vfs_dir_next(dir, &entry) == ESP_OK)
+    {
+        int vlen = path_push(a->vpath, sizeof(a->vpath), entry.name);
+        int nlen = (vlen >= 0) ? path_push(a->name, sizeof(a->name), entry.name) : -1;
+        if (vlen < 0 || nlen < 0)
+        {
+            if (vlen >= 0)
+            {
+                a->vpath[vlen] = '\0';
+            }
+            a->skipped++;
+            continue;
+        }
+
+        if (!entry.is_dir)
+        {
+            emit_file(a, &entry);
+        }
+        else if (emit_header(a, 0, entry.mtime, true))
+        {
+            if (depth < ARCHIVE_MAX_DEPTH)
+            {
+                archive_dir(a, depth + 1);
+            }
+            else
+            {
+                ESP_LOGW(TAG, "Not descending into %s: too deep", a->vpath);
+                a->skipped++;
+            }
+        }
+
+        a->vpath[vlen] = '\0';
+        a->name[nlen] = '\0';
+    }
+    vfs_dir_close(dir);
+}
+
+static esp_err_t handler_archive(httpd_req_t *req)
+{
+    char query[256] = {0};
+    char raw_path[VFS_PATH_MAX] = {0};
+    char gzip_param[8] = {0};
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK)
+    {
+        httpd_query_key_value(query, "path", raw_path, sizeof(raw_path));
+        httpd_query_key_value(query, "gzip", gzip_param, sizeof(gzip_param));
+    }
+
+    archive_t *a = calloc(1, sizeof(archive_t));
+    if (a == NULL)
+    {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+        return ESP_OK;
+    }
+    http_stream_init(&a->out, req);
+
+    if (http_sanitize_upload_path(raw_path, a->vpath, sizeof(a->vpath)) != ESP_OK || !vfs_is_directory(a->vpath))
+    {
+        free(a);
+        return http_json_send_error(req, "400 Bad Request", "Invalid directory");
+    }
+
+    bool gzip = (strcmp(gzip_param, "1") == 0 || strcmp(gzip_param, "true") == 0);
+    a->buf = malloc(ARCHIVE_BUF_SIZE);
+    a->gz = gzip ? malloc(sizeof(http_deflate_t)) : NULL;
+    if (a->buf == NULL || (gzip && a->gz == NULL))
+    {
+        free(a->gz);
+        free(a->buf);
+        free(a);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+        return ESP_OK;
+    }
+
+    /* Entries are stored under the directory's own name, like `tar -C parent dir` */
+    const char *base = strrchr(a->vpath, '/');
+    strncpy(a->name, base + 1, sizeof(a->name) - 1);
+
+    char disposition[VFS_NAME_MAX + 48];
+    snprintf(disposition, sizeof(disposition), "attachment; filename=\"%s.tar%s\"", a->name, gzip ? ".gz" : "");
+    httpd_resp_set_type(req, gzip ? "application/gzip" : "application/x-tar");
+    httpd_resp_set_hdr(req, "Content-Disposition", disposition);
+
+    if (gzip)
+    {
+        a->err = http_gzip_init(a->gz, chunk_sink, a);
+    }
+    if (emit_header(a, 0, 0, true))
+    {
+        archive_dir(a, 1);
+    }
+
+    /* End of archive: two zero blocks */
+    emit_zeros(a, 2 * HTTP_TAR_BLOCK);
+    if (gzip && a->err == ESP_OK)
+    {
+        a->err = http_gzip_finish(a->gz);
+    }
+
+    esp_err_t err = a->err;
+    if (err == ESP_OK)
+    {
+        err = http_stream_finish(&a->out);
+        ESP_LOGI(TAG, "Archived %s: %u files, %u skipped", a->vpath, a->files, a->skipped);
+    }
+    else
+    {
+        ESP_LOGW(TAG, "Archive of %s aborted: %s", a->vpath, esp_err_to_name(err));
+    }
+
+    free(a->gz);
+    free(a->buf);
+    free(a);
+    return err;
+}
+
+/*
+ * POST /api/archive?dest=/flash/public[&atomic=1]
+ *
+ * Extracts a tar stream, gzipped or not (told apart by the gzip magic), while
+ * it is being received. The receive buffer is the only data buffer: file
+ * contents go from it, or from the inflate window, straight into unbuffered
+ * files. With atomic=1 the tree is built in "<dest>.staging" and only swapped
+ * in for the old one once the whole archive has been extracted.
+ */
+
+#define EXTRACT_STAGING_SUFFIX ".staging"
+#define EXTRACT_OLD_SUFFIX ".old"
+
+typedef struct
+{
+    httpd_req_t *req;
+    uint8_t *buf;
+    size_t pending;
+    size_t remaining;
+    bool recv_failed;
+    esp_err_t tar_err;
+    const char *status;
+    const char *error;
+    http_tar_reader_t tar;
+    FILE *file;
+    char base[VFS_PATH_MAX];
+    char vpath[VFS_PATH_MAX];
+    char last_dir[VFS_PATH_MAX];
+    unsigned files;
+    unsigned dirs;
+    unsigned skipped;
+    uint64_t bytes;
+} extract_t;
+
+static SemaphoreHandle_t s_extract_mutex = NULL;
+
+/* Remember the first failure for the response; the tar reader or inflater then unwinds with ESP_FAIL */
+static esp_err_t extract_fail(extract_t *x, const char *status, const char *msg)
+{
+    if (x->error == NULL)
+    {
+        x->status = status;
+        x->error = msg;
+    }
+    return ESP_FAIL;
+}
+
+/* Receive until at least `want` bytes are buffered or the body ends */
+static esp_err_t body_fill(extract_t *x, size_t want)
+{
+    while (x->pending < want && x->remaining > 0)
+    {
+        size_t space = ARCHIVE_BUF_SIZE - x->pending;
+        int n = httpd_req_recv(x->req, (char *)x->buf + x->pending, x->remaining < space ? x->remaining : space);
+        if (n == HTTPD_SOCK_ERR_TIMEOUT)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            x->recv_failed = true;
+            return ESP_FAIL;
+        }
+        x->pending += (size_t)n;
+        x->remaining -= (size_t)n;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t body_source(void *ctx, const uint8_t **data, size_t *len)
+{
+    extract_t *x = ctx;
+    esp_err_t err = body_fill(x, 1);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    *data = x->buf;
+    *len = x->pending;
+    x->pending = 0;
+    return ESP_OK;
+}
+
+static esp_err_t tar_sink(void *ctx, const uint8_t *data, size_t len)
+{
+    extract_t *x = ctx;
+    esp_err_t err = http_tar_reader_write(&x->tar, data, len);
+    if (err != ESP_OK && x->error == NULL)
+    {
+        x->tar_err = err;
+    }
+    return err;
+}
+
+/* mkdir -p for a virtual path; the last directory made or seen is cached */
+static bool make_dirs(extract_t *x, const char *dir)
+{
+    if (strcmp(dir, x->last_dir) == 0)
+    {
+        return true;
+    }
+
+    char path[VFS_PATH_MAX];
+    strncpy(path, dir, sizeof(path) - 1);
+    path[sizeof(path) - 1] = '\0';
+
+    /* Skip the mount point component */
+    char *p = strchr(path + 1, '/');
+    while (p != NULL)
+    {
+        *p = '\0';
+        if (!vfs_is_directory(path) && vfs_mkdir(path) != ESP_OK)
+        {
+            return false;
+        }
+        *p = '/';
+        p = strchr(p + 1, '/');
+    }
+    if (!vfs_is_directory(path) && vfs_mkdir(path) != ESP_OK)
+    {
+        return false;
+    }
+
+    strncpy(x->last_dir, path, sizeof(x->last_dir) - 1);
+    return true;
+}
+
+static esp_err_t extract_entry(void *ctx, const http_tar_entry_t *entry)
+{
+    extract_t *x = ctx;
+
+    /* "./" names the extraction root itself */
+    if (entry->type == HTTP_TAR_TYPE_DIR && entry->name[0] == '\0')
+    {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    char joined[VFS_PATH_MAX];
+    int n = snprintf(joined, sizeof(joined), "%s/%s", x->base, entry->name);
+    if (entry->type == HTTP_TAR_TYPE_OTHER || entry->name[0] == '\0' || n < 0 || (size_t)n >= sizeof(joined) ||
+        http_sanitize_upload_path(joined, x->vpath, sizeof(x->vpath)) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Skipping tar entry '%s'", entry->name);
+        x->skipped++;
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (entry->type == HTTP_TAR_TYPE_DIR)
+    {
+        if (!make_dirs(x, x->vpath))
+        {
+            return extract_fail(x, "500 Internal Server Error", "Failed to create directory");
+        }
+        x->dirs++;
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    char *slash = strrchr(x->vpath, '/');
+    *slash = '\0';
+    bool parent_ok = make_dirs(x, x->vpath);
+    *slash = '/';
+
+    char real_path[VFS_PATH_MAX];
+    if (!parent_ok || vfs_resolve_path(x->vpath, real_path, sizeof(real_path)) != ESP_OK)
+    {
+        return extract_fail(x, "500 Internal Server Error", "Failed to create directory");
+    }
+
+    x->file = fopen(real_path, "wb");
+    if (x->file == NULL)
+    {
+        return extract_fail(x, "500 Internal Server Error", "Failed to open file");
+    }
+    setvbuf(x->file, NULL, _IONBF, 0);
+    return ESP_OK;
+}
+
+static esp_err_t extract_data(void *ctx, const uint8_t *data, size_t len)
+{
+    extract_t *x = ctx;
+    if (fwrite(data, 1, len, x->file) != len)
+    {
+        return extract_fail(x, "500 Internal Server Error", "Write failed");
+    }
+    vfs_count_written(len);
+    x->bytes += len;
+    return ESP_OK;
+}
+
+static esp_err_t extract_end(void *ctx)
+{
+    extract_t *x = ctx;
+    int rc = fclose(x->file);
+    x->file = NULL;
+    if (rc != 0)
+    {
+        return extract_fail(x, "500 Internal Server Error", "Write failed");
+    }
+    x->files++;
+    return ESP_OK;
+}
+
+static esp_err_t extract_stream(extract_t *x)
+{
+    /* Two bytes are enough to tell gzip from tar */
+    esp_err_t err = body_fill(x, 2);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    if (x->pending >= 2 && x->buf[0] == 0x1f && x->buf[1] == 0x8b)
+    {
+        http_inflate_t *gz = malloc(sizeof(http_inflate_t));
+        if (gz == NULL)
+        {
+            return extract_fail(x, "500 Internal Server Error", "Out of memory");
+        }
+        err = http_gunzip(gz, body_source, tar_sink, x);
+        free(gz);
+        return err;
+    }
+
+    for (;;)
+    {
+        const uint8_t *data;
+        size_t len;
+        err = body_source(x, &data, &len);
+        if (err != ESP_OK || len == 0)
+        {
+            return err;
+        }
+        err = tar_sink(x, data, len);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+    }
+}
+
+/* Replace dest with the staging tree; dest is moved aside first so it can be put back */
+static esp_err_t swap_in(const char *staging, const char *dest)
+{
+    char old[VFS_PATH_MAX];
+    snprintf(old, sizeof(old), "%s" EXTRACT_OLD_SUFFIX, dest);
+    if (vfs_exists(old))
+    {
+        vfs_remove_recursive(old);
+    }
+
+    bool had_dest = vfs_exists(dest);
+    if (had_dest && vfs_rename(dest, old) != ESP_OK)
+    {
+        return ESP_FAIL;
+    }
+    if (vfs_rename(staging, dest) != ESP_OK)
+    {
+        if (had_dest)
+        {
+            vfs_rename(old, dest);
+        }
+        return ESP_FAIL;
+    }
+    if (had_dest && vfs_remove_recursive(old) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Could not remove previous tree %s", old);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t handler_extract(httpd_req_t *req)
+{
+    char query[256] = {0};
+    char raw_dest[VFS_PATH_MAX] = {0};
+    char atomic_param[8] = {0};
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK)
+    {
+        httpd_query_key_value(query, "dest", raw_dest, sizeof(raw_dest));
+        httpd_query_key_value(query, "atomic", atomic_param, sizeof(atomic_param));
+    }
+    bool atomic = (strcmp(atomic_param, "1") == 0 || strcmp(atomic_param, "true") == 0);
+
+    char dest[VFS_PATH_MAX];
+    if (http_sanitize_upload_path(raw_dest, dest, sizeof(dest)) != ESP_OK)
+    {
+        return http_json_send_error(req, "400 Bad Request", "Invalid destination");
+    }
+    if (vfs_exists(dest) && !vfs_is_directory(dest))
+    {
+        return http_json_send_error(req, "400 Bad Request", "Destination is a file");
+    }
+    /* A mount point cannot be renamed, and the staging name must fit */
+    if (atomic && (strchr(dest + 1, '/') == NULL || strlen(dest) + sizeof(EXTRACT_STAGING_SUFFIX) > VFS_PATH_MAX))
+    {
+        return http_json_send_error(req, "400 Bad Request", "Destination not usable for atomic extraction");
+    }
+    if (req->content_len == 0)
+    {
+        return http_json_send_error(req, "400 Bad Request", "Empty body");
+    }
+
+    if (xSemaphoreTake(s_extract_mutex, 0) != pdTRUE)
+    {
+        return http_json_send_error(req, "423 Locked", "Extraction busy");
+    }
+
+    extract_t *x = calloc(1, sizeof(extract_t));
+    uint8_t *buf = malloc(ARCHIVE_BUF_SIZE);
+    if (x == NULL || buf == NULL)
+    {
+        free(buf);
+        free(x);
+        xSemaphoreGive(s_extract_mutex);
+        return http_json_send_error(req, "500 Internal Server Error", "Out of memory");
+    }
+    x->req = req;
+    x->buf = buf;
+    x->remaining = req->content_len;
+
+    if (atomic)
+    {
+        snprintf(x->base, sizeof(x->base), "%s" EXTRACT_STAGING_SUFFIX, dest);
+        if (vfs_exists(x->base))
+        {
+            vfs_remove_recursive(x->base);
+        }
+    }
+    else
+    {
+        strncpy(x->base, dest, sizeof(x->base) - 1);
+    }
+
+    const http_tar_callbacks_t cb = {
+        .on_entry = extract_entry,
+        .on_data = extract_data,
+        .on_end = extract_end,
+        .ctx = x,
+    };
+    http_tar_reader_init(&x->tar, &cb);
+
+    esp_err_t err = ESP_OK;
+    if (!make_dirs(x, x->base))
+    {
+        err = extract_fail(x, "500 Internal Server Error", "Failed to create directory");
+    }
+    if (err == ESP_OK)
+    {
+        err = extract_stream(x);
+    }
+    if (err == ESP_OK && http_tar_reader_finish(&x->tar) != ESP_OK)
+    {
+        err = extract_fail(x, "400 Bad Request", "Truncated archive");
+    }
+    if (x->file != NULL)
+    {
+        fclose(x->file);
+    }
+
+    if (err == ESP_OK && atomic && swap_in(x->base, dest) != ESP_OK)
+    {
+        err = extract_fail(x, "500 Internal Server Error", "Failed to replace destination");
+    }
+    if (err != ESP_OK && atomic)
+    {
+        vfs_remove_recursive(x->base);
+    }
+
+    esp_err_t ret = ESP_OK;
+    if (x->recv_failed)
+    {
+        ESP_LOGW(TAG, "Extraction into %s aborted: connection lost", dest);
+        ret = ESP_FAIL;
+    }
+    else if (err != ESP_OK)
+    {
+        if (x->error == NULL)
+        {
+            extract_fail(x, "400 Bad Request", x->tar_err != ESP_OK ? "Corrupt tar archive" : "Corrupt gzip stream");
+        }
+        ESP_LOGW(TAG, "Extraction into %s failed: %s (%s)", dest, x->error, esp_err_to_name(err));
+        ret = http_json_send_error(req, x->status, x->error);
+    }
+    else
+    {
+        ESP_LOGI(TAG, "Extracted %u files, %u dirs (%llu bytes) into %s%s", x->files, x->dirs,
+                 (unsigned long long)x->bytes, dest, atomic ? " atomically" : "");
+        httpd_resp_set_type(req, "application/json");
+        http_stream_t out;
+        http_json_t j;
+        http_stream_init(&out, req);
+        http_json_init(&j, &out);
+        http_json_object_begin(&j);
+        http_json_kv_string(&j, "status", "ok");
+        http_json_kv_uint(&j, "files", x->files);
+        http_json_kv_uint(&j, "dirs", x->dirs);
+        http_json_kv_uint(&j, "skipped", x->skipped);
+        http_json_kv_uint(&j, "bytes", x->bytes);
+        http_json_object_end(&j);
+        ret = http_stream_finish(&out);
+    }
+
+    free(x->buf);
+    free(x);
+    xSemaphoreGive(s_extract_mutex);
+    return ret;
+}
+
+void http_archive_register(void)
+{
+    if (s_extract_mutex == NULL)
+    {
+        s_extract_mutex = xSemaphoreCreateMutex();
+    }
+
+    static const http_route_t routes[] = {
+        {"/api/archive", HTTP_ROUTE_METHOD(HTTP_GET), HTTP_ROUTE_AUTH | HTTP_ROUTE_ASYNC, handler_archive},
+        {"/api/archive", HTTP_ROUTE_METHOD(HTTP_POST), HTTP_ROUTE_AUTH | HTTP_ROUTE_ASYNC, handler_extract},
+    };
+    for (size_t i = 0; i < sizeof(routes) / sizeof(routes[0]); i++)
+    {
+        http_server_register_route(&routes[i]);
+    }
+}
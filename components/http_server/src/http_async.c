@@ -0,0 +1,131 @@
+#include "http_async.h"
+#include "http_access.h"
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include <stdio.h>
+
+static const char *const TAG = "http_async";
+
+typedef struct
+{
+    httpd_req_t *req;
+    httpd_uri_func_t handler;
+} async_job_t;
+
+static QueueHandle_t s_queue = NULL;
+static SemaphoreHandle_t s_idle = NULL;
+static TaskHandle_t s_workers[HTTP_ASYNC_WORKERS];
+
+static void worker_task(void *arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        async_job_t job;
+        if (xQueueReceive(s_queue, &job, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+
+        job.handler(job.req);
+        http_access_end(job.req, true);
+        if (httpd_req_async_handler_complete(job.req) != ESP_OK)
+        {
+            ESP_LOGW(TAG, "Failed to complete async request");
+        }
+        xSemaphoreGive(s_idle);
+    }
+}
+
+esp_err_t http_async_init(void)
+{
+    if (s_queue != NULL)
+    {
+        return ESP_OK;
+    }
+
+    s_queue = xQueueCreate(HTTP_ASYNC_WORKERS, sizeof(async_job_t));
+    s_idle = xSemaphoreCreateCounting(HTTP_ASYNC_WORKERS, HTTP_ASYNC_WORKERS);
+    if (s_queue == NULL || s_idle == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to create worker queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i < HTTP_ASYNC_WORKERS; i++)
+    {
+        char name[16];
+        snprintf(name, sizeof(name), "httpd_wrk%d", i);
+        if (xTaskCreate(worker_task, name, HTTP_ASYNC_WORKER_STACK, NULL, HTTP_ASYNC_WORKER_PRIO, &s_workers[i]) !=
+            pdPASS)
+        {
+            ESP_LOGE(TAG, "Failed to create worker %d", i);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    ESP_LOGI(TAG, "%d workers started (stack %d)", HTTP_ASYNC_WORKERS, HTTP_ASYNC_WORKER_STACK);
+    return ESP_OK;
+}
+
+bool http_async_is_worker(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < HTTP_ASYNC_WORKERS; i++)
+    {
+        if (s_workers[i] != NULL && s_workers[i] == self)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void send_busy(httpd_req_t *req)
+{
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    httpd_resp_set_hdr(req, "Retry-After", HTTP_ASYNC_RETRY_AFTER);
+    httpd_resp_set_type(req, "text/plain");
+    httpd_resp_send(req, "Server busy", HTTPD_RESP_USE_STRLEN);
+}
+
+bool http_async_defer(httpd_req_t *req, httpd_uri_func_t handler)
+{
+    if (s_queue == NULL || http_async_is_worker())
+    {
+        return false;
+    }
+
+    if (xSemaphoreTake(s_idle, 0) != pdTRUE)
+    {
+        ESP_LOGW(TAG, "All workers busy, rejecting %s", req->uri);
+        send_busy(req);
+        return true;
+    }
+
+    async_job_t job = {.req = NULL, .handler = handler};
+    if (httpd_req_async_handler_begin(req, &job.req) != ESP_OK)
+    {
+        xSemaphoreGive(s_idle);
+        send_busy(req);
+        return true;
+    }
+
+    /* From here the worker closes the access-log record; marked before it can start */
+    http_access_set_async(req, true);
+
+    /* Queue depth equals the idle-worker count, so this cannot block */
+    if (xQueueSend(s_queue, &job, 0) != pdTRUE)
+    {
+        http_access_set_async(req, false);
+        httpd_req_async_handler_complete(job.req);
+        xSemaphoreGive(s_idle);
+        send_busy(req);
+    }
+    return true;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#include <stdbool.h>
+
+/* Number of worker tasks serving long-running requests off the httpd task */
+#ifndef HTTP_ASYNC_WORKERS
+#define HTTP_ASYNC_WORKERS 2
+#endif
+
+/* Stack size of each worker task in bytes */
+#ifndef HTTP_ASYNC_WORKER_STACK
+#define HTTP_ASYNC_WORKER_STACK 6144
+#endif
+
+#ifndef HTTP_ASYNC_WORKER_PRIO
+#define HTTP_ASYNC_WORKER_PRIO 5
+#endif
+
+/* Seconds a client is asked to wait when every worker is busy */
+#define HTTP_ASYNC_RETRY_AFTER "2"
+
+esp_err_t http_async_init(void);
+
+/* True when called from one of the worker tasks */
+bool http_async_is_worker(void);
+
+/*
+ * Hand a request to the worker pool. Returns true if the caller must return
+ * immediately: either the request was queued (handler will be re-invoked on a
+ * worker) or the pool was saturated and a 503 has been sent. Returns false on a
+ * worker thread, or if the pool is not running, so the caller handles inline.
+ */
+bool http_async_defer(httpd_req_t *req, httpd_uri_func_t handler);
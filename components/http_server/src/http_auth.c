@@ -1,9 +1,15 @@
 #include "http_auth.h"
 
 #include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "lwip/sockets.h"
 #include "mbedtls/base64.h"
 #include "nvs.h"
 
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -16,9 +22,68 @@ static const char *const TAG = "http_auth";
 #define DEFAULT_USER "cos"
 #define DEFAULT_PASS "cos12345"
 
+#if HTTP_AUTH_SESSIONS < 1 || HTTP_AUTH_SESSIONS > 16
+#error "HTTP_AUTH_SESSIONS must be 1..16 (the slot is one hex digit of the token)"
+#endif
+
+#define FAIL_INTERVAL_US ((int64_t)HTTP_AUTH_FAIL_INTERVAL_MS * 1000)
+
+/* "user:pass" as sent in a Basic header */
+#define BASIC_MAX (HTTP_AUTH_MAX_USER + HTTP_AUTH_MAX_PASS)
+
+typedef struct
+{
+    bool used;
+    int64_t expires_us;
+    char token[HTTP_AUTH_TOKEN_LEN];
+} session_t;
+
+typedef struct
+{
+    uint8_t addr[16]; /* IPv6, or IPv4-mapped */
+    int64_t tat_us;
+} fail_peer_t;
+
 static char s_username[HTTP_AUTH_MAX_USER] = DEFAULT_USER;
 static char s_password[HTTP_AUTH_MAX_PASS] = DEFAULT_PASS;
 
+/*
+ * Sessions are indexed by the token's first hex digit, so validation is one
+ * slot lookup plus a constant-time compare of the whole token.
+ */
+static session_t s_sessions[HTTP_AUTH_SESSIONS];
+
+/*
+ * Failure limiter (GCRA): each failed attempt pushes the client address's
+ * theoretical arrival time one interval forward; once it runs more than a
+ * burst ahead of the clock, Basic attempts from that address are refused
+ * before any decoding. Keying by address keeps one guessing client from
+ * locking everybody else out of Basic auth and /api/login. Valid sessions
+ * bypass it.
+ */
+static fail_peer_t s_fail_peers[HTTP_AUTH_FAIL_PEERS];
+
+/* Requests are checked on both httpd tasks and the async workers */
+static SemaphoreHandle_t s_mutex = NULL;
+
+static const char s_hex[] = "0123456789abcdef";
+
+static void lock(void)
+{
+    if (s_mutex)
+    {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+    }
+}
+
+static void unlock(void)
+{
+    if (s_mutex)
+    {
+        xSemaphoreGive(s_mutex);
+    }
+}
+
 static esp_err_t load_credentials(void)
 {
     nvs_handle_t handle;
@@ -48,7 +113,15 @@ static esp_err_t load_credentials(void)
 
 esp_err_t http_auth_init(void)
 {
+    if (s_mutex == NULL)
+    {
+        s_mutex = xSemaphoreCreateMutex();
+    }
     load_credentials();
+    http_auth_session_clear();
+    lock();
+    memset(s_fail_peers, 0, sizeof(s_fail_peers));
+    unlock();
     ESP_LOGI(TAG, "Auth initialized (user=%s)", s_username);
     return ESP_OK;
 }
@@ -73,6 +146,9 @@ esp_err_t http_auth_set_credentials(const char *username, const char *password)
     strncpy(s_password, password, sizeof(s_password) - 1);
     s_password[sizeof(s_password) - 1] = '\0';
 
+    /* Sessions were issued for the old credentials */
+    http_auth_session_clear();
+
     nvs_handle_t handle;
     esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
     if (err != ESP_OK)
@@ -93,51 +169,265 @@ const char *http_auth_get_username(void)
     return s_username;
 }
 
-esp_err_t http_auth_check(httpd_req_t *req)
+/* --- Sessions --- */
+
+static bool ct_equal(const void *a, const void *b, size_t len)
 {
-    char auth_hdr[256] = {0};
-    esp_err_t err = httpd_req_get_hdr_value_str(req, "Authorization", auth_hdr, sizeof(auth_hdr));
-    if (err != ESP_OK)
+    const volatile uint8_t *pa = a;
+    const volatile uint8_t *pb = b;
+    uint8_t diff = 0;
+    for (size_t i = 0; i < len; i++)
     {
-        goto unauthorized;
+        diff |= pa[i] ^ pb[i];
     }
+    return diff == 0;
+}
 
-    if (strncmp(auth_hdr, "Basic ", 6) != 0)
+/* Caller holds the lock */
+static session_t *session_lookup(const char *token)
+{
+    if (token == NULL || strnlen(token, HTTP_AUTH_TOKEN_LEN + 1) != HTTP_AUTH_TOKEN_LEN)
     {
-        goto unauthorized;
+        return NULL;
+    }
+    const char *digit = strchr(s_hex, token[0]);
+    if (token[0] == '\0' || digit == NULL || digit - s_hex >= HTTP_AUTH_SESSIONS)
+    {
+        return NULL;
     }
 
-    const char *b64 = auth_hdr + 6;
-    uint8_t decoded[128];
-    size_t decoded_len = 0;
-    int ret = mbedtls_base64_decode(decoded, sizeof(decoded) - 1, &decoded_len, (const uint8_t *)b64, strlen(b64));
-    if (ret != 0)
+    session_t *s = &s_sessions[digit - s_hex];
+    if (!s->used)
     {
-        goto unauthorized;
+        return NULL;
     }
-    decoded[decoded_len] = '\0';
+    if (s->expires_us <= esp_timer_get_time())
+    {
+        memset(s, 0, sizeof(*s));
+        return NULL;
+    }
+    return ct_equal(s->token, token, HTTP_AUTH_TOKEN_LEN) ? s : NULL;
+}
 
-    char *colon = strchr((char *)decoded, ':');
-    if (colon == NULL)
+esp_err_t http_auth_session_create(char *buf, size_t len)
+{
+    if (len < HTTP_AUTH_TOKEN_LEN + 1)
     {
-        goto unauthorized;
+        return ESP_ERR_INVALID_SIZE;
     }
-    *colon = '\0';
 
-    const char *req_user = (const char *)decoded;
-    const char *req_pass = colon + 1;
+    uint8_t rnd[(HTTP_AUTH_TOKEN_LEN - 1) / 2];
+    esp_fill_random(rnd, sizeof(rnd));
+
+    /* First free or expired slot, otherwise the one closest to expiry */
+    lock();
+    int64_t now = esp_timer_get_time();
+    size_t slot = 0;
+    for (size_t i = 0; i < HTTP_AUTH_SESSIONS; i++)
+    {
+        if (!s_sessions[i].used || s_sessions[i].expires_us <= now)
+        {
+            slot = i;
+            break;
+        }
+        if (s_sessions[i].expires_us < s_sessions[slot].expires_us)
+        {
+            slot = i;
+        }
+    }
 
-    if (strcmp(req_user, s_username) != 0 || strcmp(req_pass, s_password) != 0)
+    buf[0] = s_hex[slot];
+    for (size_t i = 0; i < sizeof(rnd); i++)
     {
-        goto unauthorized;
+        buf[1 + 2 * i] = s_hex[rnd[i] >> 4];
+        buf[2 + 2 * i] = s_hex[rnd[i] & 0x0F];
     }
+    buf[HTTP_AUTH_TOKEN_LEN] = '\0';
 
+    session_t *s = &s_sessions[slot];
+    memcpy(s->token, buf, HTTP_AUTH_TOKEN_LEN);
+    s->expires_us = now + (int64_t)HTTP_AUTH_SESSION_TTL_S * 1000000;
+    s->used = true;
+    unlock();
     return ESP_OK;
+}
+
+bool http_auth_session_valid(const char *token)
+{
+    lock();
+    bool valid = session_lookup(token) != NULL;
+    unlock();
+    return valid;
+}
+
+void http_auth_session_revoke(const char *token)
+{
+    lock();
+    session_t *s = session_lookup(token);
+    if (s != NULL)
+    {
+        memset(s, 0, sizeof(*s));
+    }
+    unlock();
+}
+
+void http_auth_session_clear(void)
+{
+    lock();
+    memset(s_sessions, 0, sizeof(s_sessions));
+    unlock();
+}
+
+/* --- Request checks --- */
+
+static bool token_from(httpd_req_t *req, const char *auth_hdr, char *buf, size_t len)
+{
+    if (auth_hdr != NULL)
+    {
+        if (strncmp(auth_hdr, "Bearer ", 7) != 0 || strlen(auth_hdr + 7) >= len)
+        {
+            return false;
+        }
+        strcpy(buf, auth_hdr + 7);
+        return true;
+    }
+    size_t n = len;
+    return httpd_req_get_cookie_val(req, HTTP_AUTH_COOKIE, buf, &n) == ESP_OK;
+}
+
+bool http_auth_request_token(httpd_req_t *req, char *buf, size_t len)
+{
+    char auth_hdr[256];
+    bool has_hdr = httpd_req_get_hdr_value_str(req, "Authorization", auth_hdr, sizeof(auth_hdr)) == ESP_OK;
+    return token_from(req, has_hdr ? auth_hdr : NULL, buf, len);
+}
+
+static bool basic_matches(const char *b64)
+{
+    uint8_t decoded[BASIC_MAX + 1] = {0};
+    size_t decoded_len = 0;
+    if (mbedtls_base64_decode(decoded, sizeof(decoded) - 1, &decoded_len, (const uint8_t *)b64, strlen(b64)) != 0)
+    {
+        return false;
+    }
+    memset(decoded + decoded_len, 0, sizeof(decoded) - decoded_len);
+
+    /* Compare the whole zero-padded buffer so timing does not depend on where it differs */
+    char expected[BASIC_MAX + 1] = {0};
+    snprintf(expected, sizeof(expected), "%s:%s", s_username, s_password);
+    return ct_equal(decoded, expected, sizeof(expected));
+}
+
+/* All clients whose address cannot be read share the all-zero key */
+static void peer_addr(httpd_req_t *req, uint8_t addr[16])
+{
+    memset(addr, 0, 16);
+    struct sockaddr_storage ss;
+    socklen_t len = sizeof(ss);
+    if (getpeername(httpd_req_to_sockfd(req), (struct sockaddr *)&ss, &len) != 0)
+    {
+        return;
+    }
+    if (ss.ss_family == AF_INET6)
+    {
+        memcpy(addr, &((struct sockaddr_in6 *)&ss)->sin6_addr, 16);
+    }
+    else if (ss.ss_family == AF_INET)
+    {
+        addr[10] = 0xFF;
+        addr[11] = 0xFF;
+        memcpy(addr + 12, &((struct sockaddr_in *)&ss)->sin_addr, 4);
+    }
+}
+
+/* Caller holds the lock. With create, an unknown address takes the entry with the
+   oldest arrival time, which is an idle one whenever any is idle. */
+static fail_peer_t *fail_peer(const uint8_t addr[16], bool create)
+{
+    fail_peer_t *oldest = &s_fail_peers[0];
+    for (size_t i = 0; i < HTTP_AUTH_FAIL_PEERS; i++)
+    {
+        if (memcmp(s_fail_peers[i].addr, addr, 16) == 0 && s_fail_peers[i].tat_us != 0)
+        {
+            return &s_fail_peers[i];
+        }
+        if (s_fail_peers[i].tat_us < oldest->tat_us)
+        {
+            oldest = &s_fail_peers[i];
+        }
+    }
+    if (!create)
+    {
+        return NULL;
+    }
+    memcpy(oldest->addr, addr, 16);
+    oldest->tat_us = 0;
+    return oldest;
+}
+
+static esp_err_t check_basic(httpd_req_t *req, const char *auth_hdr)
+{
+    uint8_t addr[16];
+    peer_addr(req, addr);
+
+    lock();
+    int64_t now = esp_timer_get_time();
+    fail_peer_t *peer = fail_peer(addr, false);
+    int64_t wait_us = peer != NULL ? peer->tat_us - now - (HTTP_AUTH_FAIL_BURST - 1) * FAIL_INTERVAL_US : 0;
+    unlock();
+    if (wait_us > 0)
+    {
+        char retry[16];
+        snprintf(retry, sizeof(retry), "%d", (int)((wait_us + 999999) / 1000000));
+        httpd_resp_set_status(req, "429 Too Many Requests");
+        httpd_resp_set_hdr(req, "Retry-After", retry);
+        httpd_resp_set_type(req, "text/plain");
+        httpd_resp_send(req, "Too many failed attempts", HTTPD_RESP_USE_STRLEN);
+        return ESP_FAIL;
+    }
+
+    if (auth_hdr != NULL && strncmp(auth_hdr, "Basic ", 6) == 0 && basic_matches(auth_hdr + 6))
+    {
+        return ESP_OK;
+    }
+
+    /* A bare request is the browser asking for the challenge, not a guess */
+    if (auth_hdr != NULL)
+    {
+        lock();
+        peer = fail_peer(addr, true);
+        peer->tat_us = (peer->tat_us > now ? peer->tat_us : now) + FAIL_INTERVAL_US;
+        bool throttled = peer->tat_us - now > (HTTP_AUTH_FAIL_BURST - 1) * FAIL_INTERVAL_US;
+        unlock();
+        if (throttled)
+        {
+            ESP_LOGW(TAG, "Repeated auth failures from one client; throttling it");
+        }
+    }
 
-unauthorized:
     httpd_resp_set_status(req, "401 Unauthorized");
     httpd_resp_set_hdr(req, "WWW-Authenticate", "Basic realm=\"COS\"");
     httpd_resp_set_type(req, "text/plain");
     httpd_resp_send(req, "Unauthorized", HTTPD_RESP_USE_STRLEN);
     return ESP_FAIL;
 }
+
+esp_err_t http_auth_check_basic(httpd_req_t *req)
+{
+    char auth_hdr[256];
+    bool has_hdr = httpd_req_get_hdr_value_str(req, "Authorization", auth_hdr, sizeof(auth_hdr)) == ESP_OK;
+    return check_basic(req, has_hdr ? auth_hdr : NULL);
+}
+
+esp_err_t http_auth_check(httpd_req_t *req)
+{
+    char auth_hdr[256];
+    bool has_hdr = httpd_req_get_hdr_value_str(req, "Authorization", auth_hdr, sizeof(auth_hdr)) == ESP_OK;
+
+    char token[HTTP_AUTH_TOKEN_LEN + 1];
+    if (token_from(req, has_hdr ? auth_hdr : NULL, token, sizeof(token)) && http_auth_session_valid(token))
+    {
+        return ESP_OK;
+    }
+    return check_basic(req, has_hdr ? auth_hdr : NULL);
+}
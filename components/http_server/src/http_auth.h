@@ -3,10 +3,55 @@
 #include "esp_err.h"
 #include "esp_http_server.h"
 
+#include <stdbool.h>
+#include <stddef.h>
+
 #define HTTP_AUTH_MAX_USER 32
 #define HTTP_AUTH_MAX_PASS 64
 
+/* Concurrent login sessions; the oldest is evicted when the table is full (at most 16) */
+#ifndef HTTP_AUTH_SESSIONS
+#define HTTP_AUTH_SESSIONS 8
+#endif
+
+#ifndef HTTP_AUTH_SESSION_TTL_S
+#define HTTP_AUTH_SESSION_TTL_S 3600
+#endif
+
+/* Failed attempts allowed back to back per client address, then one per interval; further attempts get 429 */
+#ifndef HTTP_AUTH_FAIL_BURST
+#define HTTP_AUTH_FAIL_BURST 5
+#endif
+
+#ifndef HTTP_AUTH_FAIL_INTERVAL_MS
+#define HTTP_AUTH_FAIL_INTERVAL_MS 2000
+#endif
+
+/* Client addresses the failure limiter tracks at once; the least indebted is reused */
+#ifndef HTTP_AUTH_FAIL_PEERS
+#define HTTP_AUTH_FAIL_PEERS 8
+#endif
+
+/* Slot digit plus 128 random bits in hex */
+#define HTTP_AUTH_TOKEN_LEN 33
+
+#define HTTP_AUTH_COOKIE "cos_session"
+
 esp_err_t http_auth_init(void);
 esp_err_t http_auth_set_credentials(const char *username, const char *password);
 const char *http_auth_get_username(void);
+
+/* Session token, Basic fallback; sends 401 or 429 itself on failure */
 esp_err_t http_auth_check(httpd_req_t *req);
+
+/* Basic credentials only (used by the login endpoint); sends 401 or 429 itself on failure */
+esp_err_t http_auth_check_basic(httpd_req_t *req);
+
+/* Issue a session token into buf (HTTP_AUTH_TOKEN_LEN + 1 bytes) */
+esp_err_t http_auth_session_create(char *buf, size_t len);
+bool http_auth_session_valid(const char *token);
+void http_auth_session_revoke(const char *token);
+void http_auth_session_clear(void);
+
+/* Token presented as "Authorization: Bearer" or in the session cookie */
+bool http_auth_request_token(httpd_req_t *req, char *buf, size_t len);
@@ -0,0 +1,140 @@
+#include "http_autoindex.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static void write_html(http_stream_t *out, const char *s)
+{
+    const char *run = s;
+    for (; *s != '\0'; s++)
+    {
+        const char *esc = NULL;
+        switch (*s)
+        {
+        case '&':
+            esc = "&amp;";
+            break;
+        case '<':
+            esc = "&lt;";
+            break;
+        case '>':
+            esc = "&gt;";
+            break;
+        case '"':
+            esc = "&quot;";
+            break;
+        case '\'':
+            esc = "&#39;";
+            break;
+        default:
+            continue;
+        }
+        http_stream_write(out, run, (size_t)(s - run));
+        http_stream_puts(out, esc);
+        run = s + 1;
+    }
+    http_stream_write(out, run, (size_t)(s - run));
+}
+
+static bool is_unreserved(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '.' ||
+           c == '_' || c == '~';
+}
+
+static void write_url(http_stream_t *out, const char *s)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    for (; *s != '\0'; s++)
+    {
+        if (is_unreserved(*s))
+        {
+            http_stream_write(out, s, 1);
+        }
+        else
+        {
+            unsigned char c = (unsigned char)*s;
+            char enc[3] = {'%', hex[c >> 4], hex[c & 0x0F]};
+            http_stream_write(out, enc, sizeof(enc));
+        }
+    }
+}
+
+void http_autoindex_begin(http_stream_t *out, const char *path)
+{
+    http_stream_puts(out, "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\">"
+                          "<meta name=\"viewport\" content=\"width=device-width\"><title>Index of ");
+    write_html(out, path);
+    http_stream_puts(out, "</title><style>body{font-family:monospace}th,td{padding:0 1.5em 0 0;text-align:left}"
+                          "td.s{text-align:right}</style></head>\n<body><h1>Index of ");
+    write_html(out, path);
+    http_stream_puts(out, "</h1>\n<table>\n<tr><th>Name</th><th>Size</th><th>Modified (UTC)</th></tr>\n");
+    if (strcmp(path, "/") != 0)
+    {
+        http_stream_puts(out, "<tr><td><a href=\"../\">../</a></td><td></td><td></td></tr>\n");
+    }
+}
+
+void http_autoindex_entry(http_stream_t *out, const vfs_dir_entry_t *entry)
+{
+    const char *slash = entry->is_dir ? "/" : "";
+
+    http_stream_puts(out, "<tr><td><a href=\"");
+    write_url(out, entry->name);
+    http_stream_puts(out, slash);
+    http_stream_puts(out, "\">");
+    write_html(out, entry->name);
+    http_stream_puts(out, slash);
+    http_stream_puts(out, "</a></td><td class=\"s\">");
+    if (entry->is_dir)
+    {
+        http_stream_puts(out, "-");
+    }
+    else
+    {
+        http_stream_printf(out, "%u", (unsigned)entry->size);
+    }
+    http_stream_puts(out, "</td><td>");
+
+    struct tm tm;
+    if (entry->mtime > 0 && gmtime_r(&entry->mtime, &tm) != NULL)
+    {
+        char date[20];
+        strftime(date, sizeof(date), "%Y-%m-%d %H:%M", &tm);
+        http_stream_puts(out, date);
+    }
+    http_stream_puts(out, "</td></tr>\n");
+}
+
+esp_err_t http_autoindex_end(http_stream_t *out)
+{
+    return http_stream_puts(out, "</table>\n</body></html>\n");
+}
+
+static uint32_t fnv1a(uint32_t hash, const void *data, size_t len)
+{
+    const unsigned char *p = data;
+    for (size_t i = 0; i < len; i++)
+    {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint32_t http_autoindex_hash(uint32_t hash, const vfs_dir_entry_t *entry)
+{
+    /* The terminator is folded in too, so "ab"+"c" and "a"+"bc" differ */
+    hash = fnv1a(hash, entry->name, strlen(entry->name) + 1);
+    uint64_t size = entry->size;
+    int64_t mtime = (int64_t)entry->mtime;
+    uint8_t is_dir = entry->is_dir;
+    hash = fnv1a(hash, &size, sizeof(size));
+    hash = fnv1a(hash, &mtime, sizeof(mtime));
+    return fnv1a(hash, &is_dir, sizeof(is_dir));
+}
+
+void http_autoindex_etag(time_t dir_mtime, uint32_t entries_hash, char *out, size_t len)
+{
+    snprintf(out, len, "W/\"%lx-%08lx\"", (unsigned long)dir_mtime, (unsigned long)entries_hash);
+}
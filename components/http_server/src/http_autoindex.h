@@ -0,0 +1,31 @@
+#pragma once
+
+#include "filesystem.h"
+#include "http_stream.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * HTML directory listing for static serving, written row by row while the
+ * directory is iterated, so nothing but the current entry is held in memory.
+ * Names are HTML-escaped for display and percent-encoded in links; links are
+ * relative, so the page must be served at a URL ending in '/'.
+ */
+
+/* Seed for http_autoindex_hash() */
+#define HTTP_AUTOINDEX_HASH_INIT 2166136261u
+
+/* Page header and table head; `path` is the URL path shown in the title */
+void http_autoindex_begin(http_stream_t *out, const char *path);
+
+void http_autoindex_entry(http_stream_t *out, const vfs_dir_entry_t *entry);
+
+esp_err_t http_autoindex_end(http_stream_t *out);
+
+/* Fold an entry (name, type, size and mtime, as shown on the page) into a running FNV-1a hash of the listing */
+uint32_t http_autoindex_hash(uint32_t hash, const vfs_dir_entry_t *entry);
+
+/* Weak ETag from the directory mtime and the hash of its entries */
+void http_autoindex_etag(time_t dir_mtime, uint32_t entries_hash, char *out, size_t len);
@@ -0,0 +1,32 @@
+#include "http_bundle.h"
+
+#include <string.h>
+
+const http_bundle_asset_t *http_bundle_find(const char *path)
+{
+    if (path == NULL)
+    {
+        return NULL;
+    }
+
+    size_t lo = 0;
+    size_t hi = g_http_bundle_count;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(path, g_http_bundle_assets[mid].path);
+        if (cmp == 0)
+        {
+            return &g_http_bundle_assets[mid];
+        }
+        if (cmp < 0)
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1;
+        }
+    }
+    return NULL;
+}
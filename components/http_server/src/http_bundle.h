@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* One gzipped asset compiled into flash by scripts/gen_web_bundle.py */
+typedef struct
+{
+    const char *path;
+    const char *mime;
+    const char *etag;
+    const uint8_t *data;
+    size_t len;
+} http_bundle_asset_t;
+
+/* Generated table, sorted by path */
+extern const http_bundle_asset_t g_http_bundle_assets[];
+extern const size_t g_http_bundle_count;
+
+const http_bundle_asset_t *http_bundle_find(const char *path);
@@ -0,0 +1,219 @@
+#include "http_server.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char *const DAY_NAMES[] = {"Thu", "Fri", "Sat", "Sun", "Mon", "Tue", "Wed"};
+static const char *const MONTH_NAMES[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                          "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+/* Days since 1970-01-01 for a proleptic Gregorian date (Howard Hinnant's algorithm). */
+static int64_t days_from_civil(int64_t y, unsigned m, unsigned d)
+{
+    y -= (m <= 2) ? 1 : 0;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t)doe - 719468;
+}
+
+static void civil_from_days(int64_t z, int64_t *y, unsigned *m, unsigned *d)
+{
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = (unsigned)(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    *d = doy - (153 * mp + 2) / 5 + 1;
+    *m = mp < 10 ? mp + 3 : mp - 9;
+    *y = (int64_t)yoe + era * 400 + (*m <= 2 ? 1 : 0);
+}
+
+void http_etag_format(size_t size, time_t mtime, char *out, size_t len)
+{
+    if (out == NULL || len == 0)
+    {
+        return;
+    }
+    snprintf(out, len, "\"%lx-%llx\"", (unsigned long)size, (unsigned long long)mtime);
+}
+
+esp_err_t http_date_format(time_t t, char *out, size_t len)
+{
+    if (out == NULL || len < HTTP_DATE_LEN || t < 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t secs = (int64_t)t;
+    int64_t days = secs / 86400;
+    int64_t rem = secs % 86400;
+
+    int64_t year;
+    unsigned month;
+    unsigned day;
+    civil_from_days(days, &year, &month, &day);
+
+    snprintf(out, len, "%s, %02u %s %04lld %02d:%02d:%02d GMT", DAY_NAMES[days % 7], day, MONTH_NAMES[month - 1],
+             (long long)year, (int)(rem / 3600), (int)((rem % 3600) / 60), (int)(rem % 60));
+    return ESP_OK;
+}
+
+static bool parse_uint(const char *s, size_t n, unsigned *out)
+{
+    unsigned v = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (s[i] < '0' || s[i] > '9')
+        {
+            return false;
+        }
+        v = v * 10 + (unsigned)(s[i] - '0');
+    }
+    *out = v;
+    return true;
+}
+
+esp_err_t http_date_parse(const char *str, time_t *out)
+{
+    /* Only IMF-fixdate is accepted: "Sun, 06 Nov 1994 08:49:37 GMT" */
+    if (str == NULL || out == NULL || strlen(str) != HTTP_DATE_LEN - 1)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (str[3] != ',' || str[4] != ' ' || str[7] != ' ' || str[11] != ' ' || str[16] != ' ' || str[19] != ':' ||
+        str[22] != ':' || str[25] != ' ' || strcmp(str + 26, "GMT") != 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    unsigned month = 0;
+    for (unsigned i = 0; i < 12; i++)
+    {
+        if (strncmp(str + 8, MONTH_NAMES[i], 3) == 0)
+        {
+            month = i + 1;
+            break;
+        }
+    }
+
+    unsigned day;
+    unsigned year;
+    unsigned hour;
+    unsigned min;
+    unsigned sec;
+    if (month == 0 || !parse_uint(str + 5, 2, &day) || !parse_uint(str + 12, 4, &year) ||
+        !parse_uint(str + 17, 2, &hour) || !parse_uint(str + 20, 2, &min) || !parse_uint(str + 23, 2, &sec))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (day < 1 || day > 31 || year < 1970 || hour > 23 || min > 59 || sec > 60)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t days = days_from_civil(year, month, day);
+    *out = (time_t)(days * 86400 + hour * 3600 + min * 60 + sec);
+    return ESP_OK;
+}
+
+static bool etag_equal(const char *a, size_t a_len, const char *etag)
+{
+    /* Weak comparison (RFC 9110 13.1.2): ignore the W/ prefix on either side */
+    if (a_len >= 2 && a[0] == 'W' && a[1] == '/')
+    {
+        a += 2;
+        a_len -= 2;
+    }
+    if (etag[0] == 'W' && etag[1] == '/')
+    {
+        etag += 2;
+    }
+    return strlen(etag) == a_len && strncmp(a, etag, a_len) == 0;
+}
+
+bool http_etag_matches(const char *if_none_match, const char *etag)
+{
+    if (if_none_match == NULL || etag == NULL || etag[0] == '\0')
+    {
+        return false;
+    }
+
+    const char *p = if_none_match;
+    while (*p != '\0')
+    {
+        while (*p == ' ' || *p == '\t' || *p == ',')
+        {
+            p++;
+        }
+        if (*p == '\0')
+        {
+            break;
+        }
+        if (*p == '*')
+        {
+            return true;
+        }
+
+        const char *start = p;
+        if (p[0] == 'W' && p[1] == '/')
+        {
+            p += 2;
+        }
+        if (*p == '"')
+        {
+            const char *close = strchr(p + 1, '"');
+            p = close ? close + 1 : p + strlen(p);
+        }
+        else
+        {
+            while (*p != '\0' && *p != ',')
+            {
+                p++;
+            }
+        }
+
+        if (etag_equal(start, (size_t)(p - start), etag))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool http_if_range_matches(const char *if_range, const char *etag, time_t mtime)
+{
+    if (if_range == NULL)
+    {
+        return true;
+    }
+    /* Dates can start with 'W' too (Wed), so a weak tag is recognised by "W/" */
+    if (if_range[0] == '"' || strncmp(if_range, "W/", 2) == 0)
+    {
+        /* Strong comparison: weak validators never satisfy If-Range */
+        return if_range[0] == '"' && strcmp(if_range, etag) == 0;
+    }
+    time_t since;
+    return mtime > 0 && http_date_parse(if_range, &since) == ESP_OK && since == mtime;
+}
+
+bool http_is_not_modified(const char *if_none_match, const char *if_modified_since, const char *etag, time_t mtime)
+{
+    /* If-None-Match takes precedence over If-Modified-Since when present */
+    if (if_none_match != NULL && if_none_match[0] != '\0')
+    {
+        return http_etag_matches(if_none_match, etag);
+    }
+
+    if (if_modified_since != NULL && if_modified_since[0] != '\0' && mtime > 0)
+    {
+        time_t since;
+        if (http_date_parse(if_modified_since, &since) == ESP_OK)
+        {
+            return mtime <= since;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,269 @@
+#include "http_deflate.h"
+
+#include <string.h>
+
+#define MIN_MATCH 3
+#define MAX_MATCH 258
+#define HASH_SIZE (1 << HTTP_DEFLATE_HASH_BITS)
+#define END_OF_BLOCK 256
+
+static const uint16_t s_len_base[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                        31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t s_len_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                        2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t s_dist_base[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                         33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                         1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t s_dist_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                         6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+/* Nibble-wise table keeps the CRC at 64 bytes of rodata */
+static const uint32_t s_crc_nibble[16] = {
+    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+    0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+};
+
+uint32_t http_crc32(uint32_t crc, const uint8_t *data, size_t len)
+{
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ s_crc_nibble[crc & 0x0f];
+        crc = (crc >> 4) ^ s_crc_nibble[crc & 0x0f];
+    }
+    return ~crc;
+}
+
+static void out_flush(http_deflate_t *z)
+{
+    if (z->out_len > 0 && z->err == ESP_OK)
+    {
+        z->err = z->sink(z->sink_ctx, z->out, z->out_len);
+    }
+    z->out_len = 0;
+}
+
+static void out_byte(http_deflate_t *z, uint8_t b)
+{
+    if (z->out_len == HTTP_DEFLATE_OUT_SIZE)
+    {
+        out_flush(z);
+    }
+    z->out[z->out_len++] = b;
+}
+
+/* Append bits LSB-first, as deflate packs everything except Huffman codes */
+static void put_bits(http_deflate_t *z, uint32_t value, unsigned count)
+{
+    z->bit_buf |= value << z->bit_count;
+    z->bit_count += count;
+    while (z->bit_count >= 8)
+    {
+        out_byte(z, (uint8_t)z->bit_buf);
+        z->bit_buf >>= 8;
+        z->bit_count -= 8;
+    }
+}
+
+/* Huffman codes are defined MSB-first, so reverse them before packing */
+static void put_code(http_deflate_t *z, uint32_t code, unsigned len)
+{
+    uint32_t rev = 0;
+    for (unsigned i = 0; i < len; i++)
+    {
+        rev = (rev << 1) | ((code >> i) & 1);
+    }
+    put_bits(z, rev, len);
+}
+
+/* Fixed literal/length code from RFC 1951 section 3.2.6 */
+static void put_litlen(http_deflate_t *z, unsigned sym)
+{
+    if (sym < 144)
+    {
+        put_code(z, 0x30 + sym, 8);
+    }
+    else if (sym < 256)
+    {
+        put_code(z, 0x190 + (sym - 144), 9);
+    }
+    else if (sym < 280)
+    {
+        put_code(z, sym - 256, 7);
+    }
+    else
+    {
+        put_code(z, 0xc0 + (sym - 280), 8);
+    }
+}
+
+static void put_match(http_deflate_t *z, unsigned len, unsigned dist)
+{
+    unsigned li = 28;
+    while (s_len_base[li] > len)
+    {
+        li--;
+    }
+    put_litlen(z, 257 + li);
+    put_bits(z, len - s_len_base[li], s_len_extra[li]);
+
+    unsigned di = 29;
+    while (s_dist_base[di] > dist)
+    {
+        di--;
+    }
+    put_code(z, di, 5);
+    put_bits(z, dist - s_dist_base[di], s_dist_extra[di]);
+}
+
+static unsigned hash3(const uint8_t *p)
+{
+    uint32_t v = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+    return (v * 2654435761u) >> (32 - HTTP_DEFLATE_HASH_BITS);
+}
+
+/* Encode window bytes while at least `keep` bytes of lookahead remain */
+static void compress_window(http_deflate_t *z, size_t keep)
+{
+    while (z->win_len - z->pos > keep)
+    {
+        size_t p = z->pos;
+        size_t avail = z->win_len - p;
+        unsigned best = 0;
+        size_t dist = 0;
+
+        if (avail >= MIN_MATCH)
+        {
+            unsigned h = hash3(z->win + p);
+            size_t cand = z->head[h];
+            z->head[h] = (uint16_t)(p + 1);
+            if (cand > 0 && p - (cand - 1) <= HTTP_DEFLATE_WINDOW)
+            {
+                cand--;
+                size_t limit = avail < MAX_MATCH ? avail : MAX_MATCH;
+                unsigned n = 0;
+                while (n < limit && z->win[cand + n] == z->win[p + n])
+                {
+                    n++;
+                }
+                if (n >= MIN_MATCH)
+                {
+                    best = n;
+                    dist = p - cand;
+                }
+            }
+        }
+
+        if (best > 0)
+        {
+            put_match(z, best, (unsigned)dist);
+            for (size_t i = p + 1; i < p + best && i + MIN_MATCH <= z->win_len; i++)
+            {
+                z->head[hash3(z->win + i)] = (uint16_t)(i + 1);
+            }
+            z->pos += best;
+        }
+        else
+        {
+            put_litlen(z, z->win[p]);
+            z->pos++;
+        }
+    }
+}
+
+/* Drop the older half of the window once the encoder has moved past it */
+static void slide_window(http_deflate_t *z)
+{
+    memmove(z->win, z->win + HTTP_DEFLATE_WINDOW, z->win_len - HTTP_DEFLATE_WINDOW);
+    z->win_len -= HTTP_DEFLATE_WINDOW;
+    z->pos -= HTTP_DEFLATE_WINDOW;
+    for (size_t i = 0; i < HASH_SIZE; i++)
+    {
+        z->head[i] = (z->head[i] > HTTP_DEFLATE_WINDOW) ? (uint16_t)(z->head[i] - HTTP_DEFLATE_WINDOW) : 0;
+    }
+}
+
+esp_err_t http_gzip_init(http_deflate_t *z, http_deflate_sink_t sink, void *ctx)
+{
+    if (z == NULL || sink == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(z->head, 0, sizeof(z->head));
+    z->sink = sink;
+    z->sink_ctx = ctx;
+    z->err = ESP_OK;
+    z->crc = 0;
+    z->total_in = 0;
+    z->bit_buf = 0;
+    z->bit_count = 0;
+    z->win_len = 0;
+    z->pos = 0;
+    z->out_len = 0;
+
+    /* ID1 ID2 CM=deflate FLG=0 MTIME=0 XFL=0 OS=unknown */
+    static const uint8_t header[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff};
+    for (size_t i = 0; i < sizeof(header); i++)
+    {
+        out_byte(z, header[i]);
+    }
+
+    /* One open-ended fixed-Huffman block: BFINAL=0, BTYPE=01 */
+    put_bits(z, 0, 1);
+    put_bits(z, 1, 2);
+    out_flush(z);
+    return z->err;
+}
+
+esp_err_t http_gzip_write(http_deflate_t *z, const uint8_t *data, size_t len)
+{
+    z->crc = http_crc32(z->crc, data, len);
+    z->total_in += (uint32_t)len;
+
+    while (len > 0 && z->err == ESP_OK)
+    {
+        if (z->win_len == sizeof(z->win))
+        {
+            /* Keep a full match of lookahead so matches can span input calls */
+            compress_window(z, MAX_MATCH);
+            slide_window(z);
+        }
+        size_t n = sizeof(z->win) - z->win_len;
+        if (n > len)
+        {
+            n = len;
+        }
+        memcpy(z->win + z->win_len, data, n);
+        z->win_len += n;
+        data += n;
+        len -= n;
+    }
+    return z->err;
+}
+
+esp_err_t http_gzip_finish(http_deflate_t *z)
+{
+    compress_window(z, 0);
+    put_litlen(z, END_OF_BLOCK);
+
+    /* Empty final fixed block, then byte-align */
+    put_bits(z, 1, 1);
+    put_bits(z, 1, 2);
+    put_litlen(z, END_OF_BLOCK);
+    if (z->bit_count > 0)
+    {
+        put_bits(z, 0, 8 - z->bit_count);
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        out_byte(z, (uint8_t)(z->crc >> (8 * i)));
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        out_byte(z, (uint8_t)(z->total_in >> (8 * i)));
+    }
+    out_flush(z);
+    return z->err;
+}
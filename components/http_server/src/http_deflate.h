@@ -0,0 +1,48 @@
+#pragma once
+
+#include "esp_err.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Small streaming gzip encoder: LZ77 over a 4 KB window with a single-probe
+ * hash, emitted as fixed-Huffman deflate blocks. Trades ratio for a ~11 KB
+ * footprint, which is what fits next to the HTTP server on a no-PSRAM ESP32.
+ */
+
+#define HTTP_DEFLATE_WINDOW 4096
+#define HTTP_DEFLATE_HASH_BITS 10
+#define HTTP_DEFLATE_OUT_SIZE 512
+
+typedef esp_err_t (*http_deflate_sink_t)(void *ctx, const uint8_t *data, size_t len);
+
+typedef struct
+{
+    http_deflate_sink_t sink;
+    void *sink_ctx;
+    esp_err_t err;
+    uint32_t crc;
+    uint32_t total_in;
+    uint32_t bit_buf;
+    unsigned bit_count;
+    size_t win_len;
+    size_t pos;
+    size_t out_len;
+    uint16_t head[1 << HTTP_DEFLATE_HASH_BITS];
+    uint8_t win[2 * HTTP_DEFLATE_WINDOW];
+    uint8_t out[HTTP_DEFLATE_OUT_SIZE];
+} http_deflate_t;
+
+/* Start a gzip member; the 10-byte header goes to the sink immediately */
+esp_err_t http_gzip_init(http_deflate_t *z, http_deflate_sink_t sink, void *ctx);
+
+/* Compress more input. Output reaches the sink in HTTP_DEFLATE_OUT_SIZE pieces. */
+esp_err_t http_gzip_write(http_deflate_t *z, const uint8_t *data, size_t len);
+
+/* Flush remaining input, close the deflate stream and write the gzip trailer */
+esp_err_t http_gzip_finish(http_deflate_t *z);
+
+/* Standard CRC-32 (as used by gzip and zip); pass 0 to start */
+uint32_t http_crc32(uint32_t crc, const uint8_t *data, size_t len);
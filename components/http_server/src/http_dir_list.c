@@ -0,0 +1,260 @@
+#include "http_dir_list.h"
+
+#include <string.h>
+
+/* Match `c` against the class starting at p ('['). Sets *end past the closing ']'.
+   Returns -1 if the class is unterminated, in which case '[' is an ordinary character. */
+static int match_class(const char *p, char c, const char **end)
+{
+    const char *q = p + 1;
+    bool negate = false;
+    bool matched = false;
+
+    if (*q == '!' || *q == '^')
+    {
+        negate = true;
+        q++;
+    }
+    /* A ']' right after the opening bracket is a member, not the end */
+    bool first = true;
+    while (*q != '\0' && (*q != ']' || first))
+    {
+        first = false;
+        char lo = *q;
+        if (lo == '\\' && q[1] != '\0')
+        {
+            lo = *++q;
+        }
+        char hi = lo;
+        if (q[1] == '-' && q[2] != '\0' && q[2] != ']')
+        {
+            q += 2;
+            hi = *q;
+            if (hi == '\\' && q[1] != '\0')
+            {
+                hi = *++q;
+            }
+        }
+        if ((unsigned char)c >= (unsigned char)lo && (unsigned char)c <= (unsigned char)hi)
+        {
+            matched = true;
+        }
+        q++;
+    }
+    if (*q != ']')
+    {
+        return -1;
+    }
+    *end = q + 1;
+    return matched != negate;
+}
+
+bool http_dir_glob_match(const char *pattern, const char *name)
+{
+    const char *p = pattern;
+    const char *n = name;
+    /* Where to resume after the most recent '*' when a later part fails: linear backtracking */
+    const char *star_p = NULL;
+    const char *star_n = NULL;
+
+    while (*n != '\0')
+    {
+        if (*p == '*')
+        {
+            while (*p == '*')
+            {
+                p++;
+            }
+            star_p = p;
+            star_n = n;
+            continue;
+        }
+
+        const char *next = p + 1;
+        bool ok;
+        if (*p == '?')
+        {
+            ok = true;
+        }
+        else if (*p == '[')
+        {
+            int m = match_class(p, *n, &next);
+            ok = m < 0 ? *n == '[' : m == 1;
+        }
+        else if (*p == '\\' && p[1] != '\0')
+        {
+            ok = p[1] == *n;
+            next = p + 2;
+        }
+        else
+        {
+            ok = *p != '\0' && *p == *n;
+        }
+
+        if (ok)
+        {
+            p = next;
+            n++;
+        }
+        else if (star_p != NULL)
+        {
+            p = star_p;
+            n = ++star_n;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (*p == '*')
+    {
+        p++;
+    }
+    return *p == '\0';
+}
+
+bool http_dir_sort_parse(const char *sort, const char *order, http_dir_sort_t *out)
+{
+    out->key = HTTP_DIR_SORT_NAME;
+    out->desc = false;
+
+    if (sort != NULL && sort[0] != '\0')
+    {
+        if (strcmp(sort, "name") == 0)
+        {
+            out->key = HTTP_DIR_SORT_NAME;
+        }
+        else if (strcmp(sort, "size") == 0)
+        {
+            out->key = HTTP_DIR_SORT_SIZE;
+        }
+        else if (strcmp(sort, "mtime") == 0)
+        {
+            out->key = HTTP_DIR_SORT_MTIME;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    if (order != NULL && order[0] != '\0')
+    {
+        if (strcmp(order, "desc") == 0)
+        {
+            out->desc = true;
+        }
+        else if (strcmp(order, "asc") != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int http_dir_compare(const http_dir_sort_t *sort, const vfs_dir_entry_t *a, const vfs_dir_entry_t *b)
+{
+    int c = 0;
+    switch (sort->key)
+    {
+    case HTTP_DIR_SORT_SIZE:
+        c = (a->size > b->size) - (a->size < b->size);
+        break;
+    case HTTP_DIR_SORT_MTIME:
+        c = (a->mtime > b->mtime) - (a->mtime < b->mtime);
+        break;
+    case HTTP_DIR_SORT_NAME:
+    default:
+        break;
+    }
+    if (c == 0)
+    {
+        c = strcmp(a->name, b->name);
+    }
+    return sort->desc ? -c : c;
+}
+
+void http_dir_topk_init(http_dir_topk_t *t, vfs_dir_entry_t *items, size_t cap, const http_dir_sort_t *sort)
+{
+    t->items = items;
+    t->cap = cap;
+    t->count = 0;
+    t->sort = *sort;
+}
+
+static void swap_entries(vfs_dir_entry_t *a, vfs_dir_entry_t *b)
+{
+    vfs_dir_entry_t tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+/* Max-heap on the listing order: items[0] is the entry that sorts last */
+static void sift_down(http_dir_topk_t *t, size_t i, size_t count)
+{
+    for (;;)
+    {
+        size_t largest = i;
+        size_t l = 2 * i + 1;
+        size_t r = l + 1;
+        if (l < count && http_dir_compare(&t->sort, &t->items[l], &t->items[largest]) > 0)
+        {
+            largest = l;
+        }
+        if (r < count && http_dir_compare(&t->sort, &t->items[r], &t->items[largest]) > 0)
+        {
+            largest = r;
+        }
+        if (largest == i)
+        {
+            return;
+        }
+        swap_entries(&t->items[i], &t->items[largest]);
+        i = largest;
+    }
+}
+
+static void sift_up(http_dir_topk_t *t, size_t i)
+{
+    while (i > 0)
+    {
+        size_t parent = (i - 1) / 2;
+        if (http_dir_compare(&t->sort, &t->items[i], &t->items[parent]) <= 0)
+        {
+            return;
+        }
+        swap_entries(&t->items[i], &t->items[parent]);
+        i = parent;
+    }
+}
+
+void http_dir_topk_offer(http_dir_topk_t *t, const vfs_dir_entry_t *entry)
+{
+    if (t->cap == 0)
+    {
+        return;
+    }
+    if (t->count < t->cap)
+    {
+        t->items[t->count] = *entry;
+        sift_up(t, t->count);
+        t->count++;
+        return;
+    }
+    if (http_dir_compare(&t->sort, entry, &t->items[0]) < 0)
+    {
+        t->items[0] = *entry;
+        sift_down(t, 0, t->count);
+    }
+}
+
+void http_dir_topk_finish(http_dir_topk_t *t)
+{
+    /* Heapsort: repeatedly move the last-sorting entry to the end */
+    for (size_t n = t->count; n > 1; n--)
+    {
+        swap_entries(&t->items[0], &t->items[n - 1]);
+        sift_down(t, 0, n - 1);
+    }
+}
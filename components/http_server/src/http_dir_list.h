@@ -0,0 +1,48 @@
+#pragma once
+
+#include "filesystem.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum
+{
+    HTTP_DIR_SORT_NAME,
+    HTTP_DIR_SORT_SIZE,
+    HTTP_DIR_SORT_MTIME,
+} http_dir_sort_key_t;
+
+typedef struct
+{
+    http_dir_sort_key_t key;
+    bool desc;
+} http_dir_sort_t;
+
+/* Shell-style match of a whole name: '*' (any run), '?' (one character) and
+   "[abc]", "[a-z]", "[!x]" classes; '\' escapes the next character. Case-sensitive. */
+bool http_dir_glob_match(const char *pattern, const char *name);
+
+/* Parse sort=name|size|mtime and order=asc|desc (either may be NULL or empty for the
+   default, name ascending). Returns false on an unknown value. */
+bool http_dir_sort_parse(const char *sort, const char *order, http_dir_sort_t *out);
+
+/* Total order for listing: by the sort key, ties broken by name, all reversed for desc */
+int http_dir_compare(const http_dir_sort_t *sort, const vfs_dir_entry_t *a, const vfs_dir_entry_t *b);
+
+/* Keeps the first `cap` entries (in sort order) of everything offered, in caller-owned
+   storage, so a directory of any size is ranked in O(cap) memory. */
+typedef struct
+{
+    vfs_dir_entry_t *items;
+    size_t cap;
+    size_t count;
+    http_dir_sort_t sort;
+} http_dir_topk_t;
+
+void http_dir_topk_init(http_dir_topk_t *t, vfs_dir_entry_t *items, size_t cap, const http_dir_sort_t *sort);
+
+/* Offer an entry; it is kept if fewer than cap entries are held or it sorts before the last one */
+void http_dir_topk_offer(http_dir_topk_t *t, const vfs_dir_entry_t *entry);
+
+/* Sort the kept entries into listing order in place; offering again afterwards is not allowed */
+void http_dir_topk_finish(http_dir_topk_t *t);
@@ -0,0 +1,355 @@
+#include "http_async.h"
+#include "http_json.h"
+#include "http_server.h"
+#include "http_stream.h"
+#include "shell.h"
+
+#include "esp_console.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const TAG = "http_exec";
+
+/*
+ * POST /api/exec[?stop_on_error=1] -- run shell commands and stream their output.
+ *
+ * The body is one command line, or several separated by newlines (batch mode,
+ * one request for many commands). Blank lines and lines starting with '#' are
+ * skipped. A single command answers with its stdout as text/plain. In batch
+ * mode each command is echoed as "$ <command>" before its output and followed
+ * by "[exit <code>]"; with stop_on_error=1 the batch ends at the first
+ * command that fails.
+ *
+ * Output goes out while the command runs: stdout is redirected for the
+ * worker task only (newlib keeps a stdout per task, and text_console only
+ * replaced the global default), so the LCD and the UART console never see it.
+ * A response that is complete before anything was sent carries an
+ * X-Exit-Code header; an unknown single command gets 404.
+ *
+ * Commands go through shell_run_command(), which they share with the UART
+ * shell, and run on a task of their own: they expect the shell task's stack,
+ * and the capture adds a stdio FILE on top, more than an async worker has.
+ */
+
+#ifndef HTTP_EXEC_BODY_MAX
+#define HTTP_EXEC_BODY_MAX 1024
+#endif
+
+#ifndef HTTP_EXEC_MAX_COMMANDS
+#define HTTP_EXEC_MAX_COMMANDS 16
+#endif
+
+/* esp_console's default max_cmdline_length */
+#define HTTP_EXEC_LINE_MAX 256
+
+/* Output is held for at most this long before it is pushed to the client */
+#define HTTP_EXEC_FLUSH_US (100 * 1000)
+
+/* How long a command waits for one typed on the console to finish */
+#ifndef HTTP_EXEC_CONSOLE_WAIT_MS
+#define HTTP_EXEC_CONSOLE_WAIT_MS 2000
+#endif
+
+/* The shell input task's 8 KiB plus the capture's FILE and cookie calls */
+#ifndef HTTP_EXEC_STACK
+#define HTTP_EXEC_STACK 9216
+#endif
+
+typedef struct
+{
+    http_stream_t out;
+    int64_t last_flush_us;
+    bool sending; /* inside a send; anything logged meanwhile also lands here */
+} exec_output_t;
+
+typedef struct
+{
+    httpd_req_t *req;
+    char **cmds;
+    size_t count;
+    bool stop_on_error;
+    esp_err_t err;
+} exec_job_t;
+
+/* One exec at a time; it owns the static buffers below */
+static SemaphoreHandle_t s_lock = NULL;
+static SemaphoreHandle_t s_done = NULL;
+
+static ssize_t output_write(void *cookie, const char *buf, size_t size)
+{
+    exec_output_t *o = cookie;
+    /*
+     * A failing send makes esp_http_server log a warning, which goes to this
+     * task's stdout and so back here before the error is stored; passing it on
+     * would send, fail and log again until the stack runs out. Output written
+     * during a send, or after one has failed, is dropped.
+     */
+    if (o->sending || o->out.err != ESP_OK)
+    {
+        return (ssize_t)size;
+    }
+
+    o->sending = true;
+    http_stream_write(&o->out, buf, size);
+    int64_t now = esp_timer_get_time();
+    if (now - o->last_flush_us >= HTTP_EXEC_FLUSH_US)
+    {
+        o->last_flush_us = now;
+        http_stream_flush(&o->out);
+    }
+    o->sending = false;
+    /* A client that went away must not make the command itself fail */
+    return (ssize_t)size;
+}
+
+/* Run one command with this task's stdout pointed at the response */
+static esp_err_t run_captured(exec_output_t *o, const char *cmdline, int *ret)
+{
+    cookie_io_functions_t fns = {.write = output_write};
+    FILE *capture = fopencookie(o, "w", fns);
+    if (capture == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    setvbuf(capture, NULL, _IOLBF, 0);
+
+    /* `stdout` is this task's _REENT->_stdout; other tasks keep theirs */
+    FILE *prev = stdout;
+    stdout = capture;
+    esp_err_t err = shell_run_command(cmdline, ret, HTTP_EXEC_CONSOLE_WAIT_MS);
+    fflush(capture);
+    stdout = prev;
+    fclose(capture);
+    return err;
+}
+
+static int receive_body(httpd_req_t *req, char *buf, size_t size)
+{
+    if (req->content_len >= size)
+    {
+        return -1;
+    }
+    size_t got = 0;
+    while (got < req->content_len)
+    {
+        int n = httpd_req_recv(req, buf + got, req->content_len - got);
+        if (n == HTTPD_SOCK_ERR_TIMEOUT)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return -1;
+        }
+        got += (size_t)n;
+    }
+    buf[got] = '\0';
+    return (int)got;
+}
+
+/* Next command line in the body, or NULL at the end; trims whitespace */
+static char *next_command(char **cursor)
+{
+    while (**cursor != '\0')
+    {
+        char *line = *cursor;
+        char *end = strchr(line, '\n');
+        *cursor = end != NULL ? end + 1 : line + strlen(line);
+        if (end != NULL)
+        {
+            *end = '\0';
+        }
+
+        while (*line == ' ' || *line == '\t')
+        {
+            line++;
+        }
+        size_t len = strlen(line);
+        while (len > 0 && (line[len - 1] == '\r' || line[len - 1] == ' ' || line[len - 1] == '\t'))
+        {
+            line[--len] = '\0';
+        }
+        if (len > 0 && line[0] != '#')
+        {
+            return line;
+        }
+    }
+    return NULL;
+}
+
+/* Split the body into commands in place; returns the count, or SIZE_MAX if there are too many */
+static size_t split_commands(char *body, char **cmds)
+{
+    size_t n = 0;
+    char *cursor = body;
+    char *cmd;
+    while ((cmd = next_command(&cursor)) != NULL)
+    {
+        if (n == HTTP_EXEC_MAX_COMMANDS)
+        {
+            return SIZE_MAX;
+        }
+        cmds[n++] = cmd;
+    }
+    return n;
+}
+
+static esp_err_t run_batch(httpd_req_t *req, char **cmds, size_t count, bool stop_on_error)
+{
+    static exec_output_t o;
+    http_stream_init(&o.out, req);
+    o.last_flush_us = esp_timer_get_time();
+    o.sending = false;
+    httpd_resp_set_type(req, "text/plain");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+
+    bool batch = count > 1;
+    for (size_t i = 0; i < count && o.out.err == ESP_OK; i++)
+    {
+        const char *cmd = cmds[i];
+        if (strlen(cmd) >= HTTP_EXEC_LINE_MAX)
+        {
+            if (!batch)
+            {
+                return http_json_send_error(req, "400 Bad Request", "Command line too long");
+            }
+            http_stream_printf(&o.out, "$ %.32s...\nCommand line too long\n[exit 1]\n", cmd);
+            if (stop_on_error)
+            {
+                break;
+            }
+            continue;
+        }
+
+        if (batch)
+        {
+            http_stream_printf(&o.out, "$ %s\n", cmd);
+        }
+
+        int ret = 0;
+        esp_err_t err = run_captured(&o, cmd, &ret);
+        ESP_LOGI(TAG, "'%s' -> %s (%d)", cmd, esp_err_to_name(err), ret);
+        if (err != ESP_OK)
+        {
+            ret = 1;
+        }
+
+        if (!batch)
+        {
+            /* Nothing sent yet: the status line can still tell the result */
+            if (!o.out.started)
+            {
+                if (err == ESP_ERR_NOT_FOUND)
+                {
+                    return http_json_send_error(req, "404 Not Found", "Unknown command");
+                }
+                if (err == ESP_ERR_TIMEOUT || err == ESP_ERR_INVALID_STATE)
+                {
+                    httpd_resp_set_hdr(req, "Retry-After", "1");
+                    return http_json_send_error(req, "503 Service Unavailable", "Console busy");
+                }
+                char code[12];
+                snprintf(code, sizeof(code), "%d", ret);
+                httpd_resp_set_hdr(req, "X-Exit-Code", code);
+            }
+            break;
+        }
+
+        if (err == ESP_ERR_NOT_FOUND)
+        {
+            http_stream_puts(&o.out, "Unknown command\n");
+        }
+        else if (err != ESP_OK)
+        {
+            http_stream_printf(&o.out, "Error: %s\n", esp_err_to_name(err));
+        }
+        http_stream_printf(&o.out, "[exit %d]\n", ret);
+        http_stream_flush(&o.out);
+        o.last_flush_us = esp_timer_get_time();
+        if (ret != 0 && stop_on_error)
+        {
+            break;
+        }
+    }
+    return http_stream_finish(&o.out);
+}
+
+static void exec_task(void *arg)
+{
+    exec_job_t *job = arg;
+    job->err = run_batch(job->req, job->cmds, job->count, job->stop_on_error);
+    xSemaphoreGive(s_done);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t handler_exec(httpd_req_t *req)
+{
+    static char body[HTTP_EXEC_BODY_MAX];
+    static char *cmds[HTTP_EXEC_MAX_COMMANDS];
+
+    if (xSemaphoreTake(s_lock, 0) != pdTRUE)
+    {
+        httpd_resp_set_hdr(req, "Retry-After", "1");
+        return http_json_send_error(req, "409 Conflict", "Another command is running");
+    }
+
+    esp_err_t err;
+    if (receive_body(req, body, sizeof(body)) < 0)
+    {
+        err = http_json_send_error(req, "400 Bad Request", "Body missing or too large");
+    }
+    else
+    {
+        size_t count = split_commands(body, cmds);
+        if (count == 0 || count == SIZE_MAX)
+        {
+            err = http_json_send_error(req, "400 Bad Request", count == 0 ? "No command" : "Too many commands");
+        }
+        else
+        {
+            char query[48] = {0};
+            char value[8] = {0};
+            if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK)
+            {
+                httpd_query_key_value(query, "stop_on_error", value, sizeof(value));
+            }
+            exec_job_t job = {req, cmds, count, strcmp(value, "1") == 0 || strcmp(value, "true") == 0, ESP_OK};
+            if (xTaskCreate(exec_task, "http_exec", HTTP_EXEC_STACK, &job, HTTP_ASYNC_WORKER_PRIO, NULL) != pdPASS)
+            {
+                err = http_json_send_error(req, "503 Service Unavailable", "Out of memory");
+            }
+            else
+            {
+                xSemaphoreTake(s_done, portMAX_DELAY);
+                err = job.err;
+            }
+        }
+    }
+
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+void http_exec_register(void)
+{
+    static const http_route_t route = {"/api/exec", HTTP_ROUTE_METHOD(HTTP_POST), HTTP_ROUTE_AUTH | HTTP_ROUTE_ASYNC,
+                                       handler_exec};
+
+    s_lock = xSemaphoreCreateMutex();
+    s_done = xSemaphoreCreateBinary();
+    if (s_lock == NULL || s_done == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to create semaphores");
+        return;
+    }
+    http_server_register_route(&route);
+    ESP_LOGI(TAG, "Exec endpoint registered");
+}
@@ -0,0 +1,238 @@
+#include "http_file_cache.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static http_file_cache_entry_t s_entries[HTTP_FILE_CACHE_SLOTS];
+static http_file_cache_stats_t s_stats;
+static uint32_t s_clock;
+static SemaphoreHandle_t s_mutex = NULL;
+
+static uint32_t fnv1a(const char *s)
+{
+    uint32_t h = 2166136261u;
+    while (*s != '\0')
+    {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void lock(void)
+{
+    if (s_mutex)
+    {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+    }
+}
+
+static void unlock(void)
+{
+    if (s_mutex)
+    {
+        xSemaphoreGive(s_mutex);
+    }
+}
+
+static void free_entry(http_file_cache_entry_t *e)
+{
+    s_stats.bytes -= e->size;
+    s_stats.entries--;
+    free(e->path);
+    free(e->data);
+    memset(e, 0, sizeof(*e));
+}
+
+/* Drop an entry now, or once its last reader releases it */
+static void retire_entry(http_file_cache_entry_t *e)
+{
+    if (e->refs == 0)
+    {
+        free_entry(e);
+    }
+    else
+    {
+        e->stale = true;
+    }
+}
+
+static http_file_cache_entry_t *find_entry(const char *path, uint32_t hash)
+{
+    for (size_t i = 0; i < HTTP_FILE_CACHE_SLOTS; i++)
+    {
+        http_file_cache_entry_t *e = &s_entries[i];
+        if (e->used && !e->stale && e->hash == hash && strcmp(e->path, path) == 0)
+        {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static http_file_cache_entry_t *lru_victim(void)
+{
+    http_file_cache_entry_t *victim = NULL;
+    for (size_t i = 0; i < HTTP_FILE_CACHE_SLOTS; i++)
+    {
+        http_file_cache_entry_t *e = &s_entries[i];
+        if (e->used && !e->stale && e->refs == 0 && (victim == NULL || e->last_used < victim->last_used))
+        {
+            victim = e;
+        }
+    }
+    return victim;
+}
+
+static http_file_cache_entry_t *free_slot(void)
+{
+    for (size_t i = 0; i < HTTP_FILE_CACHE_SLOTS; i++)
+    {
+        if (!s_entries[i].used)
+        {
+            return &s_entries[i];
+        }
+    }
+    return NULL;
+}
+
+void http_file_cache_init(void)
+{
+    if (s_mutex == NULL)
+    {
+        s_mutex = xSemaphoreCreateMutex();
+    }
+}
+
+const http_file_cache_entry_t *http_file_cache_acquire(const char *path, size_t size, time_t mtime)
+{
+    if (path == NULL)
+    {
+        return NULL;
+    }
+
+    uint32_t hash = fnv1a(path);
+    lock();
+    http_file_cache_entry_t *e = find_entry(path, hash);
+    if (e != NULL && (e->size != size || e->mtime != mtime))
+    {
+        retire_entry(e);
+        e = NULL;
+    }
+    if (e != NULL)
+    {
+        e->refs++;
+        e->last_used = ++s_clock;
+        s_stats.hits++;
+    }
+    else
+    {
+        s_stats.misses++;
+    }
+    unlock();
+    return e;
+}
+
+void http_file_cache_release(const http_file_cache_entry_t *entry)
+{
+    if (entry == NULL)
+    {
+        return;
+    }
+
+    lock();
+    http_file_cache_entry_t *e = &s_entries[entry - s_entries];
+    if (e->refs > 0)
+    {
+        e->refs--;
+    }
+    if (e->stale && e->refs == 0)
+    {
+        free_entry(e);
+    }
+    unlock();
+}
+
+const http_file_cache_entry_t *http_file_cache_put(const char *path, size_t size, time_t mtime, uint8_t *data)
+{
+    if (path == NULL || data == NULL || size > HTTP_FILE_CACHE_MAX_FILE || size > HTTP_FILE_CACHE_MAX_BYTES)
+    {
+        return NULL;
+    }
+
+    char *path_copy = strdup(path);
+    if (path_copy == NULL)
+    {
+        return NULL;
+    }
+
+    uint32_t hash = fnv1a(path);
+    lock();
+
+    http_file_cache_entry_t *existing = find_entry(path, hash);
+    if (existing != NULL)
+    {
+        retire_entry(existing);
+    }
+
+    http_file_cache_entry_t *slot = free_slot();
+    while (slot == NULL || s_stats.bytes + size > HTTP_FILE_CACHE_MAX_BYTES)
+    {
+        http_file_cache_entry_t *victim = lru_victim();
+        if (victim == NULL)
+        {
+            /* Everything left is pinned by in-flight responses */
+            unlock();
+            free(path_copy);
+            return NULL;
+        }
+        free_entry(victim);
+        s_stats.evictions++;
+        if (slot == NULL)
+        {
+            slot = free_slot();
+        }
+    }
+
+    slot->path = path_copy;
+    slot->data = data;
+    slot->size = size;
+    slot->mtime = mtime;
+    slot->hash = hash;
+    slot->last_used = ++s_clock;
+    slot->refs = 1;
+    slot->used = true;
+    slot->stale = false;
+    s_stats.bytes += size;
+    s_stats.entries++;
+
+    unlock();
+    return slot;
+}
+
+void http_file_cache_flush(void)
+{
+    lock();
+    for (size_t i = 0; i < HTTP_FILE_CACHE_SLOTS; i++)
+    {
+        if (s_entries[i].used && !s_entries[i].stale)
+        {
+            retire_entry(&s_entries[i]);
+        }
+    }
+    unlock();
+}
+
+void http_file_cache_get_stats(http_file_cache_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+    lock();
+    *stats = s_stats;
+    unlock();
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "esp_err.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/* Total bytes of file data the cache may hold */
+#ifndef HTTP_FILE_CACHE_MAX_BYTES
+#define HTTP_FILE_CACHE_MAX_BYTES (32 * 1024)
+#endif
+
+/* Files larger than this are always streamed from the filesystem */
+#ifndef HTTP_FILE_CACHE_MAX_FILE
+#define HTTP_FILE_CACHE_MAX_FILE (8 * 1024)
+#endif
+
+#ifndef HTTP_FILE_CACHE_SLOTS
+#define HTTP_FILE_CACHE_SLOTS 16
+#endif
+
+typedef struct
+{
+    char *path;
+    uint8_t *data;
+    size_t size;
+    time_t mtime;
+    uint32_t hash;
+    uint32_t last_used;
+    uint16_t refs;
+    bool used;
+    bool stale;
+} http_file_cache_entry_t;
+
+typedef struct
+{
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t entries;
+    size_t bytes;
+} http_file_cache_stats_t;
+
+void http_file_cache_init(void);
+
+/* Look up a path; the entry is only returned if size and mtime still match. A returned
+   entry is pinned and must be released with http_file_cache_release(). */
+const http_file_cache_entry_t *http_file_cache_acquire(const char *path, size_t size, time_t mtime);
+
+void http_file_cache_release(const http_file_cache_entry_t *entry);
+
+/* Insert a file's contents, evicting least-recently-used entries as needed. On success the
+   cache takes ownership of data and the returned entry is pinned; on NULL the caller keeps it. */
+const http_file_cache_entry_t *http_file_cache_put(const char *path, size_t size, time_t mtime, uint8_t *data);
+
+void http_file_cache_flush(void);
+void http_file_cache_get_stats(http_file_cache_stats_t *stats);
@@ -0,0 +1,235 @@
+#include "filesystem.h"
+#include "http_file_writer.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const TAG = "http_writer";
+
+#define WRITER_PRIO 5
+
+/* Control blocks carry no buffer; len selects the action */
+#define CTRL_STOP 0
+#define CTRL_BARRIER 1
+
+typedef struct
+{
+    uint8_t *buf;
+    size_t len;
+} writer_block_t;
+
+struct http_file_writer
+{
+    FILE *file;
+    const char *label;
+    QueueHandle_t free_q;
+    QueueHandle_t full_q;
+    SemaphoreHandle_t done;
+    uint8_t *pool;
+    uint8_t *cur;
+    size_t cur_len;
+    size_t total;
+    int64_t started_us;
+    volatile bool failed;
+};
+
+static void writer_task(void *arg)
+{
+    http_file_writer_t *w = arg;
+    for (;;)
+    {
+        writer_block_t block;
+        if (xQueueReceive(w->full_q, &block, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+        if (block.buf == NULL)
+        {
+            if (block.len == CTRL_BARRIER)
+            {
+                xSemaphoreGive(w->done);
+                continue;
+            }
+            break;
+        }
+        if (!w->failed && (w->file == NULL || fwrite(block.buf, 1, block.len, w->file) != block.len))
+        {
+            w->failed = true;
+        }
+        else if (!w->failed)
+        {
+            vfs_count_written(block.len);
+        }
+        xQueueSend(w->free_q, &block.buf, portMAX_DELAY);
+    }
+    xSemaphoreGive(w->done);
+    vTaskDelete(NULL);
+}
+
+static void writer_free(http_file_writer_t *w)
+{
+    if (w->free_q)
+    {
+        vQueueDelete(w->free_q);
+    }
+    if (w->full_q)
+    {
+        vQueueDelete(w->full_q);
+    }
+    if (w->done)
+    {
+        vSemaphoreDelete(w->done);
+    }
+    free(w->pool);
+    free(w);
+}
+
+http_file_writer_t *http_file_writer_open(FILE *f, const char *label)
+{
+    http_file_writer_t *w = calloc(1, sizeof(*w));
+    if (w == NULL)
+    {
+        return NULL;
+    }
+    w->file = f;
+    w->label = label ? label : "";
+    w->pool = malloc((size_t)HTTP_WRITER_BUFFERS * HTTP_WRITER_BUF_SIZE);
+    w->free_q = xQueueCreate(HTTP_WRITER_BUFFERS, sizeof(uint8_t *));
+    /* One extra slot for a control block */
+    w->full_q = xQueueCreate(HTTP_WRITER_BUFFERS + 1, sizeof(writer_block_t));
+    w->done = xSemaphoreCreateBinary();
+    if (w->pool == NULL || w->free_q == NULL || w->full_q == NULL || w->done == NULL)
+    {
+        writer_free(w);
+        return NULL;
+    }
+
+    for (int i = 0; i < HTTP_WRITER_BUFFERS; i++)
+    {
+        uint8_t *buf = w->pool + (size_t)i * HTTP_WRITER_BUF_SIZE;
+        xQueueSend(w->free_q, &buf, 0);
+    }
+
+    if (xTaskCreate(writer_task, "httpd_fwrite", HTTP_WRITER_STACK, w, WRITER_PRIO, NULL) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to start writer task");
+        writer_free(w);
+        return NULL;
+    }
+
+    w->started_us = esp_timer_get_time();
+    return w;
+}
+
+uint8_t *http_file_writer_acquire(http_file_writer_t *w)
+{
+    uint8_t *buf = NULL;
+    xQueueReceive(w->free_q, &buf, portMAX_DELAY);
+    return buf;
+}
+
+esp_err_t http_file_writer_submit(http_file_writer_t *w, uint8_t *buf, size_t len)
+{
+    if (w->failed)
+    {
+        xQueueSend(w->free_q, &buf, portMAX_DELAY);
+        return ESP_FAIL;
+    }
+    writer_block_t block = {.buf = buf, .len = len};
+    xQueueSend(w->full_q, &block, portMAX_DELAY);
+    w->total += len;
+    return ESP_OK;
+}
+
+esp_err_t http_file_writer_write(http_file_writer_t *w, const uint8_t *data, size_t len)
+{
+    while (len > 0)
+    {
+        if (w->cur == NULL)
+        {
+            w->cur = http_file_writer_acquire(w);
+            w->cur_len = 0;
+        }
+        size_t n = HTTP_WRITER_BUF_SIZE - w->cur_len;
+        if (n > len)
+        {
+            n = len;
+        }
+        memcpy(w->cur + w->cur_len, data, n);
+        w->cur_len += n;
+        data += n;
+        len -= n;
+
+        if (w->cur_len == HTTP_WRITER_BUF_SIZE)
+        {
+            uint8_t *full = w->cur;
+            w->cur = NULL;
+            if (http_file_writer_submit(w, full, HTTP_WRITER_BUF_SIZE) != ESP_OK)
+            {
+                return ESP_FAIL;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+static void submit_partial(http_file_writer_t *w)
+{
+    if (w->cur != NULL)
+    {
+        http_file_writer_submit(w, w->cur, w->cur_len);
+    }
+    w->cur = NULL;
+    w->cur_len = 0;
+}
+
+esp_err_t http_file_writer_flush(http_file_writer_t *w)
+{
+    submit_partial(w);
+
+    writer_block_t barrier = {.buf = NULL, .len = CTRL_BARRIER};
+    xQueueSend(w->full_q, &barrier, portMAX_DELAY);
+    xSemaphoreTake(w->done, portMAX_DELAY);
+
+    esp_err_t err = w->failed ? ESP_FAIL : ESP_OK;
+    w->failed = false;
+    return err;
+}
+
+void http_file_writer_set_file(http_file_writer_t *w, FILE *f)
+{
+    w->file = f;
+}
+
+esp_err_t http_file_writer_close(http_file_writer_t *w)
+{
+    if (w == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    submit_partial(w);
+
+    writer_block_t stop = {.buf = NULL, .len = CTRL_STOP};
+    xQueueSend(w->full_q, &stop, portMAX_DELAY);
+    xSemaphoreTake(w->done, portMAX_DELAY);
+
+    esp_err_t err = w->failed ? ESP_FAIL : ESP_OK;
+    int64_t elapsed_us = esp_timer_get_time() - w->started_us;
+    if (err == ESP_OK && elapsed_us > 0)
+    {
+        ESP_LOGI(TAG, "%s: %u bytes in %u ms (%u KB/s)", w->label, (unsigned)w->total,
+                 (unsigned)(elapsed_us / 1000), (unsigned)((uint64_t)w->total * 1000000 / 1024 / elapsed_us));
+    }
+
+    writer_free(w);
+    return err;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "esp_err.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* Buffers per upload; receiving fills one while the writer task drains the others */
+#ifndef HTTP_WRITER_BUFFERS
+#define HTTP_WRITER_BUFFERS 3
+#endif
+
+#ifndef HTTP_WRITER_BUF_SIZE
+#define HTTP_WRITER_BUF_SIZE 4096
+#endif
+
+#ifndef HTTP_WRITER_STACK
+#define HTTP_WRITER_STACK 3072
+#endif
+
+/*
+ * Pipelined file writer: filled buffers are handed to a dedicated task that
+ * fwrite()s them, so network receive overlaps flash/SD latency. When all
+ * buffers are queued for writing, acquiring the next one blocks (backpressure).
+ */
+typedef struct http_file_writer http_file_writer_t;
+
+/* Start a writer for an open file (may be NULL until set_file). The caller keeps ownership of the FILE. */
+http_file_writer_t *http_file_writer_open(FILE *f, const char *label);
+
+/* Block until a free buffer of HTTP_WRITER_BUF_SIZE bytes is available */
+uint8_t *http_file_writer_acquire(http_file_writer_t *w);
+
+/* Queue len bytes of a buffer from http_file_writer_acquire() for writing */
+esp_err_t http_file_writer_submit(http_file_writer_t *w, uint8_t *buf, size_t len);
+
+/* Copy arbitrary-sized data in, submitting buffers as they fill */
+esp_err_t http_file_writer_write(http_file_writer_t *w, const uint8_t *data, size_t len);
+
+/*
+ * Submit the partially filled buffer and wait until everything queued so far
+ * has been written. Returns and clears the write error state, so one writer
+ * (and its buffers) can be reused for several files in turn.
+ */
+esp_err_t http_file_writer_flush(http_file_writer_t *w);
+
+/* Point subsequent writes at another file; only valid right after a flush */
+void http_file_writer_set_file(http_file_writer_t *w, FILE *f);
+
+/*
+ * Flush the partially filled buffer, wait for all writes, stop the task and
+ * free the writer. Returns the first write error, if any.
+ */
+esp_err_t http_file_writer_close(http_file_writer_t *w);
@@ -0,0 +1,505 @@
+#include "http_inflate.h"
+#include "http_deflate.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+/*
+ * Structure follows zlib's puff.c: canonical Huffman tables given as
+ * per-length counts plus symbols sorted by code, decoded bit by bit. Errors
+ * are sticky in z->err; once set, bit reads return zeros and every loop
+ * below stops at its next check.
+ */
+
+#define MAX_BITS 15
+#define MAX_LCODES 286
+#define MAX_DCODES 30
+#define FIXED_LCODES 288
+
+#define GZIP_FHCRC 0x02
+#define GZIP_FEXTRA 0x04
+#define GZIP_FNAME 0x08
+#define GZIP_FCOMMENT 0x10
+#define GZIP_FRESERVED 0xe0
+
+static const uint16_t LEN_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83,
+                                      99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LEN_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5,
+                                      5, 0};
+static const uint16_t DIST_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+                                       1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11,
+                                       12, 12, 13, 13};
+
+static void fail(http_inflate_t *z, esp_err_t err)
+{
+    if (z->err == ESP_OK)
+    {
+        z->err = err;
+    }
+}
+
+static bool refill(http_inflate_t *z)
+{
+    if (z->err != ESP_OK)
+    {
+        return false;
+    }
+    esp_err_t err = z->source(z->ctx, &z->in, &z->in_len);
+    if (err != ESP_OK)
+    {
+        fail(z, err);
+        return false;
+    }
+    if (z->in_len == 0)
+    {
+        fail(z, ESP_ERR_INVALID_SIZE);
+        return false;
+    }
+    return true;
+}
+
+static uint32_t bits(http_inflate_t *z, unsigned need)
+{
+    while (z->bit_count < need)
+    {
+        if (z->in_len == 0 && !refill(z))
+        {
+            return 0;
+        }
+        z->bit_buf |= (uint32_t)*z->in++ << z->bit_count;
+        z->in_len--;
+        z->bit_count += 8;
+    }
+    uint32_t val = z->bit_buf & ((1UL << need) - 1);
+    z->bit_buf >>= need;
+    z->bit_count -= need;
+    return val;
+}
+
+/* Drop the rest of the current byte; what remains in bit_buf is then always empty */
+static void align_to_byte(http_inflate_t *z)
+{
+    z->bit_buf = 0;
+    z->bit_count = 0;
+}
+
+static void flush_window(http_inflate_t *z)
+{
+    if (z->pos > z->flushed && z->err == ESP_OK)
+    {
+        size_t n = z->pos - z->flushed;
+        z->crc = http_crc32(z->crc, z->window + z->flushed, n);
+        esp_err_t err = z->sink(z->ctx, z->window + z->flushed, n);
+        if (err != ESP_OK)
+        {
+            fail(z, err);
+        }
+    }
+    z->flushed = z->pos;
+    if (z->pos == HTTP_INFLATE_WINDOW)
+    {
+        z->pos = 0;
+        z->flushed = 0;
+    }
+}
+
+static inline void put_byte(http_inflate_t *z, uint8_t b)
+{
+    z->window[z->pos++] = b;
+    z->total_out++;
+    if (z->pos == HTTP_INFLATE_WINDOW)
+    {
+        flush_window(z);
+    }
+}
+
+/* Returns 0 for a complete code, >0 for an incomplete one, <0 if over-subscribed */
+static int build(http_inflate_huffman_t *h, const uint8_t *length, int n)
+{
+    memset(h->count, 0, sizeof(h->count));
+    for (int sym = 0; sym < n; sym++)
+    {
+        h->count[length[sym]]++;
+    }
+    if (h->count[0] == n)
+    {
+        return 0;
+    }
+
+    int left = 1;
+    for (int len = 1; len <= MAX_BITS; len++)
+    {
+        left <<= 1;
+        left -= h->count[len];
+        if (left < 0)
+        {
+            return left;
+        }
+    }
+
+    int16_t offs[MAX_BITS + 1];
+    offs[1] = 0;
+    for (int len = 1; len < MAX_BITS; len++)
+    {
+        offs[len + 1] = (int16_t)(offs[len] + h->count[len]);
+    }
+    for (int sym = 0; sym < n; sym++)
+    {
+        if (length[sym] != 0)
+        {
+            h->symbol[offs[length[sym]]++] = (int16_t)sym;
+        }
+    }
+    return left;
+}
+
+static int decode(http_inflate_t *z, const http_inflate_huffman_t *h)
+{
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (int len = 1; len <= MAX_BITS; len++)
+    {
+        code |= (int)bits(z, 1);
+        int count = h->count[len];
+        if (code - count < first)
+        {
+            return h->symbol[index + (code - first)];
+        }
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+static void stored(http_inflate_t *z)
+{
+    align_to_byte(z);
+    uint32_t len = bits(z, 16);
+    uint32_t nlen = bits(z, 16);
+    if (z->err != ESP_OK)
+    {
+        return;
+    }
+    if (len != (~nlen & 0xffff))
+    {
+        fail(z, ESP_ERR_INVALID_RESPONSE);
+        return;
+    }
+
+    /* bit_buf is empty here, so the payload can be taken straight from the input */
+    while (len > 0)
+    {
+        if (z->in_len == 0 && !refill(z))
+        {
+            return;
+        }
+        size_t n = z->in_len < len ? z->in_len : len;
+        size_t room = HTTP_INFLATE_WINDOW - z->pos;
+        if (n > room)
+        {
+            n = room;
+        }
+        memcpy(z->window + z->pos, z->in, n);
+        z->pos += n;
+        z->total_out += (uint32_t)n;
+        z->in += n;
+        z->in_len -= n;
+        len -= (uint32_t)n;
+        if (z->pos == HTTP_INFLATE_WINDOW)
+        {
+            flush_window(z);
+            if (z->err != ESP_OK)
+            {
+                return;
+            }
+        }
+    }
+}
+
+static void codes(http_inflate_t *z)
+{
+    while (z->err == ESP_OK)
+    {
+        int sym = decode(z, &z->lencode);
+        if (z->err != ESP_OK)
+        {
+            return;
+        }
+        if (sym < 0)
+        {
+            fail(z, ESP_ERR_INVALID_RESPONSE);
+            return;
+        }
+        if (sym < 256)
+        {
+            put_byte(z, (uint8_t)sym);
+            continue;
+        }
+        if (sym == 256)
+        {
+            return;
+        }
+
+        sym -= 257;
+        if (sym >= 29)
+        {
+            fail(z, ESP_ERR_INVALID_RESPONSE);
+            return;
+        }
+        uint32_t len = LEN_BASE[sym] + bits(z, LEN_EXTRA[sym]);
+
+        int dsym = decode(z, &z->distcode);
+        if (z->err != ESP_OK)
+        {
+            return;
+        }
+        if (dsym < 0 || dsym >= MAX_DCODES)
+        {
+            fail(z, ESP_ERR_INVALID_RESPONSE);
+            return;
+        }
+        uint32_t dist = DIST_BASE[dsym] + bits(z, DIST_EXTRA[dsym]);
+        if (dist > z->total_out)
+        {
+            fail(z, ESP_ERR_INVALID_RESPONSE);
+            return;
+        }
+
+        size_t from = (z->pos + HTTP_INFLATE_WINDOW - dist) % HTTP_INFLATE_WINDOW;
+        while (len-- > 0)
+        {
+            put_byte(z, z->window[from]);
+            from = (from + 1) % HTTP_INFLATE_WINDOW;
+        }
+    }
+}
+
+static void fixed(http_inflate_t *z)
+{
+    uint8_t lengths[FIXED_LCODES];
+    int sym = 0;
+    for (; sym < 144; sym++)
+    {
+        lengths[sym] = 8;
+    }
+    for (; sym < 256; sym++)
+    {
+        lengths[sym] = 9;
+    }
+    for (; sym < 280; sym++)
+    {
+        lengths[sym] = 7;
+    }
+    for (; sym < FIXED_LCODES; sym++)
+    {
+        lengths[sym] = 8;
+    }
+    build(&z->lencode, lengths, FIXED_LCODES);
+
+    memset(lengths, 5, MAX_DCODES);
+    build(&z->distcode, lengths, MAX_DCODES);
+
+    codes(z);
+}
+
+static void dynamic(http_inflate_t *z)
+{
+    static const uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+    uint8_t lengths[MAX_LCODES + MAX_DCODES];
+
+    int nlen = (int)bits(z, 5) + 257;
+    int ndist = (int)bits(z, 5) + 1;
+    int ncode = (int)bits(z, 4) + 4;
+    if (z->err != ESP_OK)
+    {
+        return;
+    }
+    if (nlen > MAX_LCODES || ndist > MAX_DCODES)
+    {
+        fail(z, ESP_ERR_INVALID_RESPONSE);
+        return;
+    }
+
+    memset(lengths, 0, 19);
+    for (int i = 0; i < ncode; i++)
+    {
+        lengths[order[i]] = (uint8_t)bits(z, 3);
+    }
+    if (z->err != ESP_OK || build(&z->lencode, lengths, 19) != 0)
+    {
+        fail(z, ESP_ERR_INVALID_RESPONSE);
+        return;
+    }
+
+    int index = 0;
+    while (index < nlen + ndist && z->err == ESP_OK)
+    {
+        int sym = decode(z, &z->lencode);
+        if (sym < 0)
+        {
+            fail(z, ESP_ERR_INVALID_RESPONSE);
+            return;
+        }
+        if (sym < 16)
+        {
+            lengths[index++] = (uint8_t)sym;
+            continue;
+        }
+
+        uint8_t len = 0;
+        int repeat;
+        if (sym == 16)
+        {
+            if (index == 0)
+            {
+                fail(z, ESP_ERR_INVALID_RESPONSE);
+                return;
+            }
+            len = lengths[index - 1];
+            repeat = 3 + (int)bits(z, 2);
+        }
+        else if (sym == 17)
+        {
+            repeat = 3 + (int)bits(z, 3);
+        }
+        else
+        {
+            repeat = 11 + (int)bits(z, 7);
+        }
+        if (index + repeat > nlen + ndist)
+        {
+            fail(z, ESP_ERR_INVALID_RESPONSE);
+            return;
+        }
+        memset(lengths + index, len, (size_t)repeat);
+        index += repeat;
+    }
+    if (z->err != ESP_OK)
+    {
+        return;
+    }
+
+    /* An incomplete code is only allowed when it holds a single symbol */
+    int err = build(&z->lencode, lengths, nlen);
+    if (lengths[256] == 0 || (err != 0 && (err < 0 || nlen != z->lencode.count[0] + z->lencode.count[1])))
+    {
+        fail(z, ESP_ERR_INVALID_RESPONSE);
+        return;
+    }
+    err = build(&z->distcode, lengths + nlen, ndist);
+    if (err != 0 && (err < 0 || ndist != z->distcode.count[0] + z->distcode.count[1]))
+    {
+        fail(z, ESP_ERR_INVALID_RESPONSE);
+        return;
+    }
+
+    codes(z);
+}
+
+static void skip_zero_terminated(http_inflate_t *z)
+{
+    while (z->err == ESP_OK && bits(z, 8) != 0)
+    {
+    }
+}
+
+static void gzip_header(http_inflate_t *z)
+{
+    uint32_t id1 = bits(z, 8);
+    uint32_t id2 = bits(z, 8);
+    uint32_t method = bits(z, 8);
+    uint32_t flags = bits(z, 8);
+    bits(z, 16); /* mtime */
+    bits(z, 16);
+    bits(z, 16); /* xfl, os */
+    if (z->err != ESP_OK)
+    {
+        return;
+    }
+    if (id1 != 0x1f || id2 != 0x8b || method != 8 || (flags & GZIP_FRESERVED) != 0)
+    {
+        fail(z, ESP_ERR_INVALID_RESPONSE);
+        return;
+    }
+
+    if (flags & GZIP_FEXTRA)
+    {
+        uint32_t xlen = bits(z, 16);
+        while (xlen-- > 0 && z->err == ESP_OK)
+        {
+            bits(z, 8);
+        }
+    }
+    if (flags & GZIP_FNAME)
+    {
+        skip_zero_terminated(z);
+    }
+    if (flags & GZIP_FCOMMENT)
+    {
+        skip_zero_terminated(z);
+    }
+    if (flags & GZIP_FHCRC)
+    {
+        bits(z, 16);
+    }
+}
+
+esp_err_t http_gunzip(http_inflate_t *z, http_inflate_source_t source, http_inflate_sink_t sink, void *ctx)
+{
+    if (z == NULL || source == NULL || sink == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    z->source = source;
+    z->sink = sink;
+    z->ctx = ctx;
+    z->err = ESP_OK;
+    z->in = NULL;
+    z->in_len = 0;
+    z->bit_buf = 0;
+    z->bit_count = 0;
+    z->crc = 0;
+    z->total_out = 0;
+    z->pos = 0;
+    z->flushed = 0;
+
+    gzip_header(z);
+
+    bool last = false;
+    while (!last && z->err == ESP_OK)
+    {
+        last = bits(z, 1) != 0;
+        switch (bits(z, 2))
+        {
+        case 0:
+            stored(z);
+            break;
+        case 1:
+            fixed(z);
+            break;
+        case 2:
+            dynamic(z);
+            break;
+        default:
+            fail(z, ESP_ERR_INVALID_RESPONSE);
+            break;
+        }
+    }
+    flush_window(z);
+
+    align_to_byte(z);
+    uint32_t crc = bits(z, 16);
+    crc |= bits(z, 16) << 16;
+    uint32_t isize = bits(z, 16);
+    isize |= bits(z, 16) << 16;
+    if (z->err == ESP_OK && (crc != z->crc || isize != z->total_out))
+    {
+        fail(z, ESP_ERR_INVALID_CRC);
+    }
+    return z->err;
+}
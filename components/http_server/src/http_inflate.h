@@ -0,0 +1,56 @@
+#pragma once
+
+#include "esp_err.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Streaming gzip decoder (RFC 1951/1952). Input is pulled from a source
+ * callback without copying; output is pushed to a sink each time the history
+ * window fills. Huffman codes are decoded canonically one bit at a time, so
+ * the code tables stay around a kilobyte and the 32 KB window - which any
+ * deflate stream may reference - is the only large part of the state.
+ */
+
+#define HTTP_INFLATE_WINDOW 32768
+
+/*
+ * Provide the next piece of compressed input: point *data at it and set *len.
+ * *len == 0 means end of input.
+ */
+typedef esp_err_t (*http_inflate_source_t)(void *ctx, const uint8_t **data, size_t *len);
+typedef esp_err_t (*http_inflate_sink_t)(void *ctx, const uint8_t *data, size_t len);
+
+typedef struct
+{
+    int16_t count[16];
+    int16_t symbol[288];
+} http_inflate_huffman_t;
+
+typedef struct
+{
+    http_inflate_source_t source;
+    http_inflate_sink_t sink;
+    void *ctx;
+    esp_err_t err;
+    const uint8_t *in;
+    size_t in_len;
+    uint32_t bit_buf;
+    unsigned bit_count;
+    uint32_t crc;
+    uint32_t total_out;
+    size_t pos;
+    size_t flushed;
+    http_inflate_huffman_t lencode;
+    http_inflate_huffman_t distcode;
+    uint8_t window[HTTP_INFLATE_WINDOW];
+} http_inflate_t;
+
+/*
+ * Decode one gzip member. Returns ESP_OK once the trailer has been verified,
+ * ESP_ERR_INVALID_RESPONSE for malformed data, ESP_ERR_INVALID_CRC for a
+ * checksum or length mismatch, ESP_ERR_INVALID_SIZE if the input ends early,
+ * or the first error returned by the source or sink.
+ */
+esp_err_t http_gunzip(http_inflate_t *z, http_inflate_source_t source, http_inflate_sink_t sink, void *ctx);
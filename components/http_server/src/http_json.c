@@ -0,0 +1,233 @@
+#include "http_json.h"
+
+#include <string.h>
+
+void http_json_init(http_json_t *j, http_stream_t *out)
+{
+    j->out = out;
+    j->depth = 0;
+    j->after_key = false;
+    j->has_items = 0;
+}
+
+/* Comma before the second and later values at the current level */
+static void before_value(http_json_t *j)
+{
+    if (j->after_key)
+    {
+        j->after_key = false;
+        return;
+    }
+    uint16_t bit = (uint16_t)(1u << j->depth);
+    if (j->has_items & bit)
+    {
+        http_stream_write(j->out, ",", 1);
+    }
+    j->has_items |= bit;
+}
+
+static void open_container(http_json_t *j, char c)
+{
+    before_value(j);
+    http_stream_write(j->out, &c, 1);
+    if (j->depth + 1 >= HTTP_JSON_MAX_DEPTH)
+    {
+        j->out->err = ESP_ERR_INVALID_STATE;
+        return;
+    }
+    j->depth++;
+    j->has_items &= (uint16_t)~(1u << j->depth);
+}
+
+static void close_container(http_json_t *j, char c)
+{
+    if (j->depth > 0)
+    {
+        j->depth--;
+    }
+    j->after_key = false;
+    http_stream_write(j->out, &c, 1);
+}
+
+void http_json_object_begin(http_json_t *j)
+{
+    open_container(j, '{');
+}
+
+void http_json_object_end(http_json_t *j)
+{
+    close_container(j, '}');
+}
+
+void http_json_array_begin(http_json_t *j)
+{
+    open_container(j, '[');
+}
+
+void http_json_array_end(http_json_t *j)
+{
+    close_container(j, ']');
+}
+
+esp_err_t http_json_write_escaped(http_stream_t *out, const char *s)
+{
+    static const char HEX[] = "0123456789abcdef";
+
+    http_stream_write(out, "\"", 1);
+    const char *run = s;
+    for (const char *p = s; *p != '\0'; p++)
+    {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+
+        /* Copy the plain run in one go, then the escape */
+        http_stream_write(out, run, (size_t)(p - run));
+        run = p + 1;
+
+        char esc[6] = {'\\', 0};
+        size_t n = 2;
+        switch (c)
+        {
+        case '"':
+            esc[1] = '"';
+            break;
+        case '\\':
+            esc[1] = '\\';
+            break;
+        case '\b':
+            esc[1] = 'b';
+            break;
+        case '\f':
+            esc[1] = 'f';
+            break;
+        case '\n':
+            esc[1] = 'n';
+            break;
+        case '\r':
+            esc[1] = 'r';
+            break;
+        case '\t':
+            esc[1] = 't';
+            break;
+        default:
+            memcpy(esc + 1, "u00", 3);
+            esc[4] = HEX[c >> 4];
+            esc[5] = HEX[c & 0x0f];
+            n = 6;
+            break;
+        }
+        http_stream_write(out, esc, n);
+    }
+    http_stream_write(out, run, strlen(run));
+    return http_stream_write(out, "\"", 1);
+}
+
+void http_json_key(http_json_t *j, const char *key)
+{
+    before_value(j);
+    http_json_write_escaped(j->out, key);
+    http_stream_write(j->out, ":", 1);
+    j->after_key = true;
+}
+
+void http_json_string(http_json_t *j, const char *value)
+{
+    before_value(j);
+    if (value == NULL)
+    {
+        http_stream_write(j->out, "null", 4);
+        return;
+    }
+    http_json_write_escaped(j->out, value);
+}
+
+/* Digits are produced back to front; cheaper than a printf per number */
+static void write_number(http_stream_t *out, uint64_t value, bool negative)
+{
+    char tmp[21];
+    char *p = tmp + sizeof(tmp);
+    do
+    {
+        *--p = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    if (negative)
+    {
+        *--p = '-';
+    }
+    http_stream_write(out, p, (size_t)(tmp + sizeof(tmp) - p));
+}
+
+void http_json_uint(http_json_t *j, uint64_t value)
+{
+    before_value(j);
+    write_number(j->out, value, false);
+}
+
+void http_json_int(http_json_t *j, int64_t value)
+{
+    before_value(j);
+    uint64_t magnitude = (value < 0) ? (uint64_t)0 - (uint64_t)value : (uint64_t)value;
+    write_number(j->out, magnitude, value < 0);
+}
+
+void http_json_bool(http_json_t *j, bool value)
+{
+    before_value(j);
+    if (value)
+    {
+        http_stream_write(j->out, "true", 4);
+    }
+    else
+    {
+        http_stream_write(j->out, "false", 5);
+    }
+}
+
+void http_json_null(http_json_t *j)
+{
+    before_value(j);
+    http_stream_write(j->out, "null", 4);
+}
+
+void http_json_kv_string(http_json_t *j, const char *key, const char *value)
+{
+    http_json_key(j, key);
+    http_json_string(j, value);
+}
+
+void http_json_kv_uint(http_json_t *j, const char *key, uint64_t value)
+{
+    http_json_key(j, key);
+    http_json_uint(j, value);
+}
+
+void http_json_kv_int(http_json_t *j, const char *key, int64_t value)
+{
+    http_json_key(j, key);
+    http_json_int(j, value);
+}
+
+void http_json_kv_bool(http_json_t *j, const char *key, bool value)
+{
+    http_json_key(j, key);
+    http_json_bool(j, value);
+}
+
+esp_err_t http_json_send_error(httpd_req_t *req, const char *status, const char *msg)
+{
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_status(req, status);
+
+    http_stream_t out;
+    http_json_t j;
+    http_stream_init(&out, req);
+    http_json_init(&j, &out);
+    http_json_object_begin(&j);
+    http_json_kv_string(&j, "error", msg);
+    http_json_object_end(&j);
+    return http_stream_finish(&out);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "http_stream.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Streaming JSON writer on top of http_stream. Commas and key separators are
+ * inserted automatically; strings are escaped per RFC 8259 (quotes,
+ * backslashes and all control characters). Nothing is validated beyond
+ * nesting depth: callers are expected to emit keys only inside objects.
+ */
+
+#define HTTP_JSON_MAX_DEPTH 16
+
+typedef struct
+{
+    http_stream_t *out;
+    uint8_t depth;
+    bool after_key;
+    uint16_t has_items; /* bit per nesting level: a value was already written there */
+} http_json_t;
+
+void http_json_init(http_json_t *j, http_stream_t *out);
+
+void http_json_object_begin(http_json_t *j);
+void http_json_object_end(http_json_t *j);
+void http_json_array_begin(http_json_t *j);
+void http_json_array_end(http_json_t *j);
+
+void http_json_key(http_json_t *j, const char *key);
+void http_json_string(http_json_t *j, const char *value);
+void http_json_uint(http_json_t *j, uint64_t value);
+void http_json_int(http_json_t *j, int64_t value);
+void http_json_bool(http_json_t *j, bool value);
+void http_json_null(http_json_t *j);
+
+/* key + value shorthands for object members */
+void http_json_kv_string(http_json_t *j, const char *key, const char *value);
+void http_json_kv_uint(http_json_t *j, const char *key, uint64_t value);
+void http_json_kv_int(http_json_t *j, const char *key, int64_t value);
+void http_json_kv_bool(http_json_t *j, const char *key, bool value);
+
+/* Write `s` as a quoted JSON string straight into a stream */
+esp_err_t http_json_write_escaped(http_stream_t *out, const char *s);
+
+/* Send {"error":"msg"} with the given status line */
+esp_err_t http_json_send_error(httpd_req_t *req, const char *status, const char *msg);
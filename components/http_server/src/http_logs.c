@@ -0,0 +1,296 @@
+#include "http_access.h"
+#include "http_server.h"
+#include "http_stream.h"
+#include "metrics.h"
+#include "text_console.h"
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include <stdlib.h>
+
+static const char *const TAG = "http_logs";
+
+/*
+ * GET /api/logs/stream[?replay=N] -- console and ESP_LOG output as Server-Sent
+ * Events, one event per line with the line number as its id:
+ *
+ *   id: 1234
+ *   data: I (5678) wifi: Got IP: 192.168.1.20
+ *
+ * The stream starts N lines back in the console history (default
+ * HTTP_LOGS_REPLAY), or right after Last-Event-ID when a client reconnects.
+ * Lines come from the bounded history in text_console, which writers never
+ * wait on; a client that falls behind it gets "event: dropped" with the
+ * number of lines it missed instead of holding up logging.
+ *
+ * Streams never return to the httpd task: the handler takes the request
+ * async and one small task serves every open stream, so long-lived clients
+ * do not occupy the request worker pool.
+ */
+
+#ifndef HTTP_LOGS_MAX_CLIENTS
+#define HTTP_LOGS_MAX_CLIENTS 2
+#endif
+
+/* Lines replayed to a new client unless ?replay= says otherwise */
+#ifndef HTTP_LOGS_REPLAY
+#define HTTP_LOGS_REPLAY 50
+#endif
+
+#define HTTP_LOGS_POLL_MS 200
+#define HTTP_LOGS_KEEPALIVE_MS 15000
+/* Lines sent to one client per pass, so one busy stream cannot starve the others */
+#define HTTP_LOGS_BURST 64
+#define HTTP_LOGS_LINE_MAX 200
+#define HTTP_LOGS_TASK_STACK 3072
+#define HTTP_LOGS_TASK_PRIO 2
+
+typedef struct
+{
+    httpd_req_t *req; /* async copy; NULL when the slot is free */
+    text_console_log_cursor_t cursor;
+    uint32_t idle_ms;
+    bool fresh;
+    bool busy;    /* the stream task is writing to it, without the lock */
+    bool closing; /* http_logs_stop() came while busy; the stream task closes it and gives s_closed */
+} log_client_t;
+
+static log_client_t s_clients[HTTP_LOGS_MAX_CLIENTS];
+/* Guards slot ownership only; sends happen outside it so a stalled client holds up nobody */
+static SemaphoreHandle_t s_lock = NULL;
+/* Given once per slot the stream task closes on behalf of http_logs_stop() */
+static SemaphoreHandle_t s_closed = NULL;
+static TaskHandle_t s_task = NULL;
+static metric_t *s_dropped = NULL;
+
+static void close_client(log_client_t *c)
+{
+    http_access_end(c->req, true);
+    if (httpd_req_async_handler_complete(c->req) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Failed to complete stream");
+    }
+    c->req = NULL;
+}
+
+/* Send whatever is new for one client; false once its connection has failed */
+static bool pump(log_client_t *c)
+{
+    static http_stream_t out;
+    static char line[HTTP_LOGS_LINE_MAX];
+
+    http_stream_init(&out, c->req);
+    if (c->fresh)
+    {
+        c->fresh = false;
+        httpd_resp_set_type(c->req, "text/event-stream");
+        httpd_resp_set_hdr(c->req, "Cache-Control", "no-store");
+        http_stream_puts(&out, "retry: 2000\n\n");
+    }
+
+    int lines = 0;
+    size_t len = 0;
+    uint32_t dropped = 0;
+    while (out.err == ESP_OK && lines < HTTP_LOGS_BURST &&
+           text_console_log_next(&c->cursor, line, sizeof(line), &len, &dropped))
+    {
+        if (dropped > 0)
+        {
+            http_stream_printf(&out, "event: dropped\ndata: %lu\n\n", (unsigned long)dropped);
+            metrics_counter_add(s_dropped, dropped);
+            dropped = 0;
+        }
+        http_stream_printf(&out, "id: %lu\ndata: ", (unsigned long)(c->cursor.seq - 1));
+        http_stream_write(&out, line, len);
+        http_stream_puts(&out, "\n\n");
+        lines++;
+    }
+
+    if (lines > 0)
+    {
+        c->idle_ms = 0;
+    }
+    else if ((c->idle_ms += HTTP_LOGS_POLL_MS) >= HTTP_LOGS_KEEPALIVE_MS)
+    {
+        /* A comment line keeps proxies from timing out and detects closed clients */
+        http_stream_puts(&out, ": keepalive\n\n");
+        c->idle_ms = 0;
+    }
+    return http_stream_flush(&out) == ESP_OK;
+}
+
+static void stream_task(void *arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(HTTP_LOGS_POLL_MS));
+
+        for (size_t i = 0; i < HTTP_LOGS_MAX_CLIENTS; i++)
+        {
+            log_client_t *c = &s_clients[i];
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            bool open = c->req != NULL;
+            c->busy = open;
+            xSemaphoreGive(s_lock);
+            if (!open)
+            {
+                continue;
+            }
+
+            bool ok = pump(c);
+
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            c->busy = false;
+            bool stopped = c->closing;
+            if (!ok || stopped)
+            {
+                if (!ok)
+                {
+                    ESP_LOGI(TAG, "Log stream closed");
+                }
+                c->closing = false;
+                close_client(c);
+            }
+            xSemaphoreGive(s_lock);
+            if (stopped)
+            {
+                xSemaphoreGive(s_closed);
+            }
+        }
+    }
+}
+
+static bool sample_clients(int64_t *value)
+{
+    int64_t n = 0;
+    for (size_t i = 0; i < HTTP_LOGS_MAX_CLIENTS; i++)
+    {
+        n += s_clients[i].req != NULL;
+    }
+    *value = n;
+    return true;
+}
+
+static esp_err_t handler_stream(httpd_req_t *req)
+{
+    char query[32] = {0};
+    char value[12] = {0};
+    uint32_t head = text_console_log_head();
+    uint32_t replay = HTTP_LOGS_REPLAY;
+
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "replay", value, sizeof(value)) == ESP_OK)
+    {
+        replay = (uint32_t)strtoul(value, NULL, 10);
+    }
+    uint32_t start = head - (replay < head ? replay : head);
+
+    /* A reconnecting EventSource picks up after the last line it saw */
+    if (httpd_req_get_hdr_value_str(req, "Last-Event-ID", value, sizeof(value)) == ESP_OK)
+    {
+        start = (uint32_t)strtoul(value, NULL, 10) + 1;
+    }
+
+    /* The lock is only held to look at or claim a slot */
+    log_client_t *slot = NULL;
+    if (xSemaphoreTake(s_lock, pdMS_TO_TICKS(100)) == pdTRUE)
+    {
+        for (size_t i = 0; slot == NULL && i < HTTP_LOGS_MAX_CLIENTS; i++)
+        {
+            if (s_clients[i].req == NULL)
+            {
+                slot = &s_clients[i];
+            }
+        }
+        if (slot != NULL && httpd_req_async_handler_begin(req, &slot->req) != ESP_OK)
+        {
+            slot->req = NULL;
+            slot = NULL;
+        }
+        if (slot != NULL)
+        {
+            http_access_set_async(req, true);
+            text_console_log_seek(start, &slot->cursor);
+            slot->idle_ms = 0;
+            slot->fresh = true;
+        }
+        xSemaphoreGive(s_lock);
+    }
+
+    if (slot == NULL)
+    {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "5");
+        return httpd_resp_send(req, "Too many log streams", HTTPD_RESP_USE_STRLEN);
+    }
+
+    if (s_task == NULL && xTaskCreate(stream_task, "http_logs", HTTP_LOGS_TASK_STACK, NULL, HTTP_LOGS_TASK_PRIO,
+                                      &s_task) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create stream task");
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        close_client(slot);
+        xSemaphoreGive(s_lock);
+        return ESP_OK;
+    }
+    ESP_LOGI(TAG, "Log stream opened (from line %lu)", (unsigned long)start);
+    xTaskNotifyGive(s_task);
+    return ESP_OK;
+}
+
+/*
+ * Close every stream before the server goes away. A slot the stream task is
+ * sending on is left for it to close; this waits until it has, since the
+ * request it holds belongs to the server about to be freed. The wait is
+ * bounded by the socket send timeout of that one send.
+ */
+void http_logs_stop(void)
+{
+    if (s_lock == NULL)
+    {
+        return;
+    }
+    int pending = 0;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (size_t i = 0; i < HTTP_LOGS_MAX_CLIENTS; i++)
+    {
+        if (s_clients[i].req != NULL && s_clients[i].busy)
+        {
+            s_clients[i].closing = true;
+            pending++;
+        }
+        else if (s_clients[i].req != NULL)
+        {
+            close_client(&s_clients[i]);
+        }
+    }
+    xSemaphoreGive(s_lock);
+
+    for (; pending > 0; pending--)
+    {
+        xSemaphoreTake(s_closed, portMAX_DELAY);
+    }
+}
+
+void http_logs_register(void)
+{
+    static const http_route_t route = {"/api/logs/stream", HTTP_ROUTE_METHOD(HTTP_GET), HTTP_ROUTE_AUTH,
+                                       handler_stream};
+
+    s_closed = xSemaphoreCreateCounting(HTTP_LOGS_MAX_CLIENTS, 0);
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL || s_closed == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to create mutex");
+        return;
+    }
+    s_dropped = metrics_counter("cos_log_stream_dropped_lines_total", "Log lines skipped for slow stream clients");
+    metrics_gauge_sampled("cos_log_stream_clients", "Open log streams", sample_clients);
+
+    http_server_register_route(&route);
+    ESP_LOGI(TAG, "Log stream endpoint registered");
+}
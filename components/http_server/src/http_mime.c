@@ -37,6 +37,18 @@ const char *http_mime_type(const char *path)
     {
         return "application/json";
     }
+    if (ends_with(path, ".txt") || ends_with(path, ".log"))
+    {
+        return "text/plain";
+    }
+    if (ends_with(path, ".csv"))
+    {
+        return "text/csv";
+    }
+    if (ends_with(path, ".xml"))
+    {
+        return "application/xml";
+    }
     if (ends_with(path, ".png"))
     {
         return "image/png";
@@ -67,3 +79,15 @@ const char *http_mime_type(const char *path)
     }
     return "application/octet-stream";
 }
+
+bool http_mime_is_compressible(const char *type)
+{
+    if (type == NULL)
+    {
+        return false;
+    }
+    /* Images and fonts in use here are already compressed */
+    return strncmp(type, "text/", 5) == 0 || strcmp(type, "application/json") == 0 ||
+           strcmp(type, "application/javascript") == 0 || strcmp(type, "application/xml") == 0 ||
+           strcmp(type, "image/svg+xml") == 0;
+}
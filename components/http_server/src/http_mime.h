@@ -1,3 +1,8 @@
 #pragma once
 
+#include <stdbool.h>
+
 const char *http_mime_type(const char *path);
+
+/* True for text types that are worth gzip-compressing on the fly */
+bool http_mime_is_compressible(const char *type);
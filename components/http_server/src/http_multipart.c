@@ -1,11 +1,35 @@
 #include "http_multipart.h"
 
-#include <ctype.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+/*
+ * Streaming multipart/form-data parser.
+ *
+ * The body is read into a fixed window. Part data is handed to the callbacks
+ * straight out of the window; only the undecided tail (shorter than the
+ * boundary marker, or an incomplete part header) is carried to the front
+ * before the next recv. Boundary search is Boyer-Moore-Horspool over raw
+ * bytes, so file contents may contain NULs and part size is unbounded.
+ */
+
 #define READ_BUF_SIZE 2048
-#define ACCUM_BUF_SIZE (READ_BUF_SIZE * 4)
+#define PART_HEADER_MAX 1024
+#define WINDOW_SIZE (READ_BUF_SIZE + PART_HEADER_MAX)
+
+/* RFC 2046: boundary is 1..70 characters */
+#define BOUNDARY_MAX 70
+#define MARKER_MAX (BOUNDARY_MAX + 4)
+
+#define FIELD_VALUE_MAX 512
+
+typedef struct
+{
+    uint8_t bytes[MARKER_MAX];
+    size_t len;
+    uint8_t skip[256];
+} marker_t;
 
 static char *extract_boundary(httpd_req_t *req, char *buf, size_t buf_len)
 {
@@ -40,8 +64,7 @@ static char *extract_boundary(httpd_req_t *req, char *buf, size_t buf_len)
     return b;
 }
 
-static void parse_part_headers(const char *headers, size_t hdr_len, char *name, size_t name_len, char *filename,
-                               size_t filename_len)
+static void parse_part_headers(const char *headers, char *name, size_t name_len, char *filename, size_t filename_len)
 {
     name[0] = '\0';
     filename[0] = '\0';
@@ -86,223 +109,258 @@ static void parse_part_headers(const char *headers, size_t hdr_len, char *name,
     }
 }
 
+static void marker_init(marker_t *m, const char *boundary)
+{
+    m->len = (size_t)snprintf((char *)m->bytes, sizeof(m->bytes), "\r\n--%s", boundary);
+
+    for (size_t i = 0; i < 256; i++)
+    {
+        m->skip[i] = (uint8_t)m->len;
+    }
+    for (size_t i = 0; i + 1 < m->len; i++)
+    {
+        m->skip[m->bytes[i]] = (uint8_t)(m->len - 1 - i);
+    }
+}
+
+/* Horspool search; returns the offset of the first match or len if none */
+static size_t marker_find(const marker_t *m, const uint8_t *data, size_t len)
+{
+    if (len < m->len)
+    {
+        return len;
+    }
+
+    const size_t last = m->len - 1;
+    const uint8_t tail = m->bytes[last];
+    size_t i = 0;
+    while (i + last < len)
+    {
+        uint8_t c = data[i + last];
+        if (c == tail && memcmp(data + i, m->bytes, last) == 0)
+        {
+            return i;
+        }
+        i += m->skip[c];
+    }
+    return len;
+}
+
+static size_t find_header_end(const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i + 3 < len; i++)
+    {
+        if (data[i] == '\r' && data[i + 1] == '\n' && data[i + 2] == '\r' && data[i + 3] == '\n')
+        {
+            return i;
+        }
+    }
+    return len;
+}
+
+typedef struct
+{
+    multipart_field_cb on_field;
+    multipart_file_cb on_file;
+    void *ctx;
+    char field_name[64];
+    char file_name[128];
+    bool is_file;
+    bool is_first_chunk;
+    char field_value[FIELD_VALUE_MAX];
+    size_t field_value_len;
+} part_t;
+
+static bool emit_data(part_t *p, const uint8_t *data, size_t len, bool is_final)
+{
+    if (p->is_file)
+    {
+        if (p->on_file == NULL)
+        {
+            return true;
+        }
+        if (len == 0 && !is_final)
+        {
+            return true;
+        }
+        bool ok = p->on_file(p->field_name, p->file_name, data, len, p->is_first_chunk, is_final, p->ctx);
+        p->is_first_chunk = false;
+        return ok;
+    }
+
+    size_t copy = len;
+    if (p->field_value_len + copy >= sizeof(p->field_value))
+    {
+        copy = sizeof(p->field_value) - p->field_value_len - 1;
+    }
+    memcpy(p->field_value + p->field_value_len, data, copy);
+    p->field_value_len += copy;
+    p->field_value[p->field_value_len] = '\0';
+
+    if (is_final && p->on_field)
+    {
+        p->on_field(p->field_name, p->field_value, p->ctx);
+    }
+    return true;
+}
+
 esp_err_t http_multipart_parse(httpd_req_t *req, multipart_field_cb on_field, multipart_file_cb on_file, void *ctx)
 {
     char ct_buf[256];
     char *boundary = extract_boundary(req, ct_buf, sizeof(ct_buf));
-    if (!boundary)
+    if (!boundary || boundary[0] == '\0' || strlen(boundary) > BOUNDARY_MAX)
     {
         return ESP_ERR_INVALID_ARG;
     }
 
-    char boundary_marker[128];
-    snprintf(boundary_marker, sizeof(boundary_marker), "\r\n--%s", boundary);
-    size_t bm_len = strlen(boundary_marker);
+    marker_t marker;
+    marker_init(&marker, boundary);
 
-    char first_boundary[128];
-    snprintf(first_boundary, sizeof(first_boundary), "--%s\r\n", boundary);
-    size_t fb_len = strlen(first_boundary);
-
-    char *buf = malloc(READ_BUF_SIZE + 1);
-    if (!buf)
+    uint8_t *win = malloc(WINDOW_SIZE + 1);
+    if (!win)
     {
         return ESP_ERR_NO_MEM;
     }
 
-    char *accum = malloc(ACCUM_BUF_SIZE);
-    if (!accum)
-    {
-        free(buf);
-        return ESP_ERR_NO_MEM;
-    }
-    size_t accum_len = 0;
+    part_t part = {.on_field = on_field, .on_file = on_file, .ctx = ctx};
 
     enum
     {
         PREAMBLE,
         HEADER,
         BODY,
-        AFTER_BOUNDARY
+        AFTER_BOUNDARY,
+        DONE
     } state = PREAMBLE;
 
-    char field_name[64] = {0};
-    char file_name[128] = {0};
-    bool is_file = false;
-    bool is_first_chunk = true;
-    char field_value[512] = {0};
-    size_t field_value_len = 0;
+    /*
+     * Prime the window with CRLF so the opening "--boundary" matches the same
+     * "\r\n--boundary" marker as every later delimiter.
+     */
+    win[0] = '\r';
+    win[1] = '\n';
+    size_t head = 0;
+    size_t tail = 2;
 
-    int remaining = req->content_len;
+    size_t remaining = req->content_len;
     esp_err_t result = ESP_OK;
 
-    while (1)
+    while (state != DONE)
     {
         bool progress = true;
-        while (progress)
+        while (progress && state != DONE)
         {
             progress = false;
+            const uint8_t *data = win + head;
+            size_t avail = tail - head;
 
-            if (state == PREAMBLE)
-            {
-                char *pos = (accum_len >= fb_len) ? strstr(accum, first_boundary) : NULL;
-                if (pos)
-                {
-                    size_t skip = (size_t)(pos - accum) + fb_len;
-                    memmove(accum, accum + skip, accum_len - skip);
-                    accum_len -= skip;
-                    state = HEADER;
-                    progress = true;
-                }
-            }
-
-            if (state == HEADER)
+            if (state == PREAMBLE || state == BODY)
             {
-                char *pos = (accum_len >= 4) ? strstr(accum, "\r\n\r\n") : NULL;
-                if (pos)
+                size_t pos = marker_find(&marker, data, avail);
+                if (pos < avail)
                 {
-                    *pos = '\0';
-                    parse_part_headers(accum, (size_t)(pos - accum), field_name, sizeof(field_name), file_name,
-                                       sizeof(file_name));
-                    is_file = (file_name[0] != '\0');
-                    is_first_chunk = true;
-                    field_value_len = 0;
-
-                    size_t skip = (size_t)(pos - accum) + 4;
-                    memmove(accum, accum + skip, accum_len - skip);
-                    accum_len -= skip;
-                    state = BODY;
+                    if (state == BODY && !emit_data(&part, data, pos, true))
+                    {
+                        result = ESP_ERR_INVALID_STATE;
+                        goto cleanup;
+                    }
+                    head += pos + marker.len;
+                    state = AFTER_BOUNDARY;
                     progress = true;
                 }
-            }
-
-            if (state == BODY)
-            {
-                char *pos = (accum_len >= bm_len) ? strstr(accum, boundary_marker) : NULL;
-
-                if (pos)
+                else if (avail >= marker.len)
                 {
-                    size_t data_len = (size_t)(pos - accum);
-                    if (is_file && on_file)
-                    {
-                        if (!on_file(field_name, file_name, (const uint8_t *)accum, data_len, is_first_chunk, true,
-                                     ctx))
-                        {
-                            result = ESP_ERR_INVALID_STATE;
-                            goto cleanup;
-                        }
-                    }
-                    else if (!is_file && on_field)
+                    /* Everything except a possible partial marker is part data */
+                    size_t safe = avail - (marker.len - 1);
+                    if (state == BODY && !emit_data(&part, data, safe, false))
                     {
-                        size_t copy = data_len;
-                        if (field_value_len + copy >= sizeof(field_value))
-                        {
-                            copy = sizeof(field_value) - field_value_len - 1;
-                        }
-                        memcpy(field_value + field_value_len, accum, copy);
-                        field_value_len += copy;
-                        field_value[field_value_len] = '\0';
-                        on_field(field_name, field_value, ctx);
+                        result = ESP_ERR_INVALID_STATE;
+                        goto cleanup;
                     }
-
-                    size_t skip = data_len + bm_len;
-                    memmove(accum, accum + skip, accum_len - skip);
-                    accum_len -= skip;
-                    state = AFTER_BOUNDARY;
-                    progress = true;
+                    head += safe;
                 }
-                else if (accum_len > bm_len)
+            }
+            else if (state == AFTER_BOUNDARY)
+            {
+                if (avail >= 2)
                 {
-                    size_t safe = accum_len - bm_len;
-                    if (is_file && on_file)
+                    if (data[0] == '-' && data[1] == '-')
                     {
-                        if (!on_file(field_name, file_name, (const uint8_t *)accum, safe, is_first_chunk, false, ctx))
-                        {
-                            result = ESP_ERR_INVALID_STATE;
-                            goto cleanup;
-                        }
-                        is_first_chunk = false;
+                        state = DONE;
                     }
-                    else if (!is_file)
+                    else
                     {
-                        size_t copy = safe;
-                        if (field_value_len + copy >= sizeof(field_value))
-                        {
-                            copy = sizeof(field_value) - field_value_len - 1;
-                        }
-                        memcpy(field_value + field_value_len, accum, copy);
-                        field_value_len += copy;
+                        /* skip \r\n after boundary */
+                        head += 2;
+                        state = HEADER;
+                        progress = true;
                     }
-                    memmove(accum, accum + safe, accum_len - safe);
-                    accum_len -= safe;
                 }
             }
-
-            if (state == AFTER_BOUNDARY)
+            else if (state == HEADER)
             {
-                if (accum_len >= 2)
+                size_t pos = find_header_end(data, avail);
+                if (pos > PART_HEADER_MAX || (pos == avail && avail >= PART_HEADER_MAX))
                 {
-                    if (accum[0] == '-' && accum[1] == '-')
-                    {
-                        goto cleanup;
-                    }
-                    /* skip \r\n after boundary */
-                    memmove(accum, accum + 2, accum_len - 2);
-                    accum_len -= 2;
-                    state = HEADER;
+                    result = ESP_ERR_INVALID_SIZE;
+                    goto cleanup;
+                }
+                if (pos < avail)
+                {
+                    win[head + pos] = '\0';
+                    parse_part_headers((const char *)data, part.field_name, sizeof(part.field_name), part.file_name,
+                                       sizeof(part.file_name));
+                    part.is_file = (part.file_name[0] != '\0');
+                    part.is_first_chunk = true;
+                    part.field_value_len = 0;
+                    part.field_value[0] = '\0';
+
+                    head += pos + 4;
+                    state = BODY;
                     progress = true;
                 }
             }
         }
 
-        if (remaining <= 0)
+        if (state == DONE || remaining == 0)
         {
             break;
         }
 
-        int to_read = remaining < READ_BUF_SIZE ? remaining : READ_BUF_SIZE;
-        int recvd = httpd_req_recv(req, buf, to_read);
+        /* Carry the undecided tail to the front; bounded by the marker or header size */
+        if (head > 0)
+        {
+            memmove(win, win + head, tail - head);
+            tail -= head;
+            head = 0;
+        }
+
+        size_t space = WINDOW_SIZE - tail;
+        size_t to_read = remaining < space ? remaining : space;
+        int recvd = httpd_req_recv(req, (char *)win + tail, to_read);
         if (recvd <= 0)
         {
             if (recvd == HTTPD_SOCK_ERR_TIMEOUT)
             {
                 continue;
             }
-            break;
-        }
-        remaining -= recvd;
-
-        if (accum_len + (size_t)recvd >= ACCUM_BUF_SIZE)
-        {
-            result = ESP_ERR_NO_MEM;
+            result = ESP_FAIL;
             goto cleanup;
         }
-        memcpy(accum + accum_len, buf, (size_t)recvd);
-        accum_len += (size_t)recvd;
-        accum[accum_len] = '\0';
+        remaining -= (size_t)recvd;
+        tail += (size_t)recvd;
     }
 
-    if (state == BODY && accum_len > 0)
+    /* Body ended without a closing delimiter: flush what is left of the part */
+    if (state == BODY)
     {
-        if (is_file && on_file)
-        {
-            on_file(field_name, file_name, (const uint8_t *)accum, accum_len, is_first_chunk, true, ctx);
-        }
-        else if (!is_file && on_field)
+        if (!emit_data(&part, win + head, tail - head, true))
         {
-            size_t copy = accum_len;
-            if (field_value_len + copy >= sizeof(field_value))
-            {
-                copy = sizeof(field_value) - field_value_len - 1;
-            }
-            memcpy(field_value + field_value_len, accum, copy);
-            field_value_len += copy;
-            field_value[field_value_len] = '\0';
-            on_field(field_name, field_value, ctx);
+            result = ESP_ERR_INVALID_STATE;
         }
     }
 
 cleanup:
-    free(buf);
-    free(accum);
+    free(win);
     return result;
 }
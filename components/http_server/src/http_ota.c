@@ -0,0 +1,165 @@
+#include "http_json.h"
+#include "http_server.h"
+#include "http_stream.h"
+#include "ota.h"
+
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const TAG = "http_ota";
+
+/*
+ * POST /api/ota[?reboot=0] -- install a firmware image (the app .bin).
+ *
+ * The body is written to the inactive OTA partition as it arrives, one
+ * receive buffer at a time, and hashed on the way; an X-Content-SHA256 header
+ * (hex, as for PUT /api/files) is checked before the image is selected for
+ * boot. The device restarts shortly after answering unless reboot=0. The new
+ * image must confirm itself on its first boot, otherwise the bootloader
+ * returns to the current one.
+ */
+
+/* Receive buffer; a few TCP segments per flash write */
+#ifndef HTTP_OTA_CHUNK
+#define HTTP_OTA_CHUNK 4096
+#endif
+
+/* Time for the response to reach the client before restarting */
+#define HTTP_OTA_RESTART_DELAY_MS 1000
+
+static const char *receive_image(httpd_req_t *req, ota_update_t *update, char *buf)
+{
+    size_t remaining = req->content_len;
+    while (remaining > 0)
+    {
+        int recvd = httpd_req_recv(req, buf, remaining < HTTP_OTA_CHUNK ? remaining : HTTP_OTA_CHUNK);
+        if (recvd <= 0)
+        {
+            if (recvd == HTTPD_SOCK_ERR_TIMEOUT)
+            {
+                continue;
+            }
+            return "Receive failed";
+        }
+        esp_err_t err = ota_write(update, buf, (size_t)recvd);
+        if (err != ESP_OK)
+        {
+            return err == ESP_ERR_OTA_VALIDATE_FAILED ? "Not a firmware image" : "Flash write failed";
+        }
+        remaining -= (size_t)recvd;
+    }
+    return NULL;
+}
+
+static esp_err_t handler_ota(httpd_req_t *req)
+{
+    if (req->content_len == 0)
+    {
+        return http_json_send_error(req, "411 Length Required", "Image body required");
+    }
+
+    char value[2 * OTA_SHA256_LEN + 2];
+    uint8_t expected[OTA_SHA256_LEN];
+    bool verify = false;
+    if (httpd_req_get_hdr_value_str(req, "X-Content-SHA256", value, sizeof(value)) == ESP_OK)
+    {
+        if (ota_parse_sha256(value, expected) != ESP_OK)
+        {
+            return http_json_send_error(req, "400 Bad Request", "Malformed X-Content-SHA256");
+        }
+        verify = true;
+    }
+
+    char query[32] = {0};
+    bool reboot = true;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "reboot", value, sizeof(value)) == ESP_OK)
+    {
+        reboot = strcmp(value, "0") != 0 && strcmp(value, "false") != 0;
+    }
+
+    char *buf = malloc(HTTP_OTA_CHUNK);
+    if (buf == NULL)
+    {
+        return http_json_send_error(req, "500 Internal Server Error", "Out of memory");
+    }
+
+    ota_update_t *update = NULL;
+    esp_err_t err = ota_begin(req->content_len, &update);
+    if (err != ESP_OK)
+    {
+        free(buf);
+        if (err == ESP_ERR_INVALID_STATE)
+        {
+            return http_json_send_error(req, "409 Conflict", "Another update is running");
+        }
+        if (err == ESP_ERR_INVALID_SIZE)
+        {
+            return http_json_send_error(req, "413 Payload Too Large", "Image larger than the OTA partition");
+        }
+        return http_json_send_error(req, "500 Internal Server Error", esp_err_to_name(err));
+    }
+
+    ESP_LOGI(TAG, "Receiving %u byte image", (unsigned)req->content_len);
+    const char *error = receive_image(req, update, buf);
+    free(buf);
+    if (error != NULL)
+    {
+        ota_abort(update);
+        ESP_LOGW(TAG, "Update aborted: %s", error);
+        return http_json_send_error(req, "400 Bad Request", error);
+    }
+
+    uint8_t actual[OTA_SHA256_LEN];
+    err = ota_finish(update, verify ? expected : NULL, actual);
+    if (err == ESP_ERR_INVALID_CRC)
+    {
+        return http_json_send_error(req, "400 Bad Request", "Digest mismatch");
+    }
+    if (err == ESP_ERR_OTA_VALIDATE_FAILED)
+    {
+        return http_json_send_error(req, "400 Bad Request", "Image failed validation");
+    }
+    if (err != ESP_OK)
+    {
+        return http_json_send_error(req, "500 Internal Server Error", esp_err_to_name(err));
+    }
+
+    char hex[2 * OTA_SHA256_LEN + 1];
+    for (size_t i = 0; i < OTA_SHA256_LEN; i++)
+    {
+        snprintf(hex + 2 * i, 3, "%02x", actual[i]);
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    http_stream_t out;
+    http_json_t j;
+    http_stream_init(&out, req);
+    http_json_init(&j, &out);
+    http_json_object_begin(&j);
+    http_json_kv_string(&j, "status", "ok");
+    http_json_kv_uint(&j, "size", req->content_len);
+    http_json_kv_string(&j, "sha256", hex);
+    http_json_kv_bool(&j, "reboot", reboot);
+    http_json_object_end(&j);
+    err = http_stream_finish(&out);
+
+    if (reboot)
+    {
+        ota_restart_later(HTTP_OTA_RESTART_DELAY_MS);
+    }
+    return err;
+}
+
+void http_ota_register(void)
+{
+    /* Flash writes block for seconds; keep them off the httpd task */
+    static const http_route_t route = {"/api/ota", HTTP_ROUTE_METHOD(HTTP_POST), HTTP_ROUTE_AUTH | HTTP_ROUTE_ASYNC,
+                                       handler_ota};
+    http_server_register_route(&route);
+    ESP_LOGI(TAG, "OTA endpoint registered");
+}
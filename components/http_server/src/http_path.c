@@ -53,3 +53,56 @@ esp_err_t http_sanitize_upload_path(const char *raw, char *out_path, size_t len)
 
     return ESP_OK;
 }
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+esp_err_t http_path_decode(const char *in, char *out, size_t len)
+{
+    if (in == NULL || out == NULL || len == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t o = 0;
+    for (size_t i = 0; in[i] != '\0'; i++)
+    {
+        char c = in[i];
+        if (c == '%')
+        {
+            int h = hex_value(in[i + 1]);
+            int l = h < 0 ? -1 : hex_value(in[i + 2]);
+            if (h < 0 || l < 0)
+            {
+                return ESP_ERR_INVALID_ARG;
+            }
+            c = (char)(h << 4 | l);
+            if (c == '\0' || c == '/')
+            {
+                return ESP_ERR_INVALID_ARG;
+            }
+            i += 2;
+        }
+        if (o + 1 >= len)
+        {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        out[o++] = c;
+    }
+    out[o] = '\0';
+    return ESP_OK;
+}
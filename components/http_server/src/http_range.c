@@ -0,0 +1,101 @@
+#include "http_server.h"
+
+#include <stdint.h>
+#include <string.h>
+
+static const char *skip_ws(const char *p)
+{
+    while (*p == ' ' || *p == '\t')
+    {
+        p++;
+    }
+    return p;
+}
+
+/* Parse a run of decimal digits. Returns the number of digits consumed, 0 on none or overflow. */
+static size_t parse_pos(const char *p, uint64_t *out)
+{
+    uint64_t v = 0;
+    size_t n = 0;
+    while (p[n] >= '0' && p[n] <= '9')
+    {
+        if (v > (UINT64_MAX - 9) / 10)
+        {
+            return 0;
+        }
+        v = v * 10 + (uint64_t)(p[n] - '0');
+        n++;
+    }
+    *out = v;
+    return n;
+}
+
+esp_err_t http_range_parse(const char *header, size_t size, size_t *start, size_t *end)
+{
+    if (header == NULL || start == NULL || end == NULL)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const char *p = skip_ws(header);
+    if (strncmp(p, "bytes=", 6) != 0)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    p = skip_ws(p + 6);
+
+    uint64_t first = 0;
+    uint64_t last = 0;
+    bool has_first = false;
+    bool has_last = false;
+
+    size_t n = parse_pos(p, &first);
+    if (n > 0)
+    {
+        has_first = true;
+        p += n;
+    }
+    if (*p != '-')
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    p++;
+    n = parse_pos(p, &last);
+    if (n > 0)
+    {
+        has_last = true;
+        p += n;
+    }
+    p = skip_ws(p);
+
+    /* Multi-range requests are served as a plain 200 */
+    if (*p != '\0' || (!has_first && !has_last))
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (!has_first)
+    {
+        /* Suffix range: last N bytes */
+        if (last == 0 || size == 0)
+        {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        *start = (last >= size) ? 0 : size - (size_t)last;
+        *end = size - 1;
+        return ESP_OK;
+    }
+
+    if (has_last && last < first)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (first >= size)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    *start = (size_t)first;
+    *end = (!has_last || last >= size) ? size - 1 : (size_t)last;
+    return ESP_OK;
+}
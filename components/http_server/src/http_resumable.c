@@ -0,0 +1,639 @@
+#include "filesystem.h"
+#include "http_json.h"
+#include "http_server.h"
+#include "http_upload.h"
+#include "http_upload_session.h"
+
+#include "esp_log.h"
+#include "esp_random.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+static const char *const TAG = "http_resumable";
+
+/*
+ * Resumable uploads (a subset of the tus.io core protocol):
+ *   POST   /api/uploads?path=...   Upload-Length: N   -> 201, Location: /api/uploads/<id>
+ *   HEAD   /api/uploads/<id>                          -> Upload-Offset, Upload-Length
+ *   PATCH  /api/uploads/<id>       Upload-Offset: off -> appends the body, 204 + new Upload-Offset
+ *   DELETE /api/uploads/<id>                          -> abort
+ *
+ * Data goes to "<target>.<id>.part" on the target filesystem; the offset is
+ * that file's size, so whatever reached flash survives a reboot. The session
+ * record lives in /flash/.uploads/<id>. On the final byte the part file is
+ * renamed over the target.
+ */
+
+#define SESSION_DIR "/flash/.uploads"
+#define URI_PREFIX "/api/uploads/"
+#define PATCH_BUF_SIZE 4096
+#define META_BUF_SIZE 256
+
+/* fsync after this many bytes so a power cut loses at most this much progress */
+#ifndef HTTP_UPLOAD_SYNC_BYTES
+#define HTTP_UPLOAD_SYNC_BYTES (64 * 1024)
+#endif
+
+/* Open sessions; creating another is refused with 503 until one finishes or expires */
+#ifndef HTTP_UPLOAD_MAX_SESSIONS
+#define HTTP_UPLOAD_MAX_SESSIONS 16
+#endif
+
+/* Sessions that may receive a PATCH at the same time */
+#define MAX_ACTIVE 4
+
+static char s_active[MAX_ACTIVE][HTTP_UPLOAD_ID_LEN + 1];
+static SemaphoreHandle_t s_active_mutex = NULL;
+
+/* Expiry needs wall-clock time; until a GC pass has run with it, creating a session retries */
+static bool s_gc_clock_done = false;
+
+static bool session_claim(const char *id);
+static void session_release(const char *id);
+
+/* --- Session storage --- */
+
+static esp_err_t meta_real_path(const char *id, char *out, size_t len)
+{
+    char virt[VFS_PATH_MAX];
+    snprintf(virt, sizeof(virt), SESSION_DIR "/%s", id);
+    return vfs_resolve_path(virt, out, len);
+}
+
+static esp_err_t part_real_path(const http_upload_meta_t *meta, const char *id, char *out, size_t len)
+{
+    char real[VFS_PATH_MAX];
+    esp_err_t err = vfs_resolve_path(meta->path, real, sizeof(real));
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    int n = snprintf(out, len, "%s.%s.part", real, id);
+    return (n < 0 || (size_t)n >= len) ? ESP_ERR_INVALID_SIZE : ESP_OK;
+}
+
+static esp_err_t meta_load(const char *id, http_upload_meta_t *meta)
+{
+    char path[VFS_PATH_MAX];
+    if (meta_real_path(id, path, sizeof(path)) != ESP_OK)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    char buf[META_BUF_SIZE];
+    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    buf[n] = '\0';
+    return http_upload_meta_parse(buf, meta);
+}
+
+static esp_err_t meta_save(const char *id, const http_upload_meta_t *meta)
+{
+    char buf[META_BUF_SIZE];
+    int n = http_upload_meta_format(meta, buf, sizeof(buf));
+    if (n < 0)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    char path[VFS_PATH_MAX];
+    if (meta_real_path(id, path, sizeof(path)) != ESP_OK)
+    {
+        return ESP_FAIL;
+    }
+    FILE *f = fopen(path, "w");
+    if (f == NULL)
+    {
+        return ESP_FAIL;
+    }
+    bool ok = fwrite(buf, 1, (size_t)n, f) == (size_t)n;
+    ok = (fflush(f) == 0) && ok;
+    fsync(fileno(f));
+    ok = (fclose(f) == 0) && ok;
+    return ok ? ESP_OK : ESP_FAIL;
+}
+
+static void session_remove(const char *id, const http_upload_meta_t *meta, bool keep_part)
+{
+    char path[VFS_PATH_MAX + HTTP_UPLOAD_ID_LEN + 8];
+    if (!keep_part && meta != NULL && part_real_path(meta, id, path, sizeof(path)) == ESP_OK)
+    {
+        remove(path);
+    }
+    if (meta_real_path(id, path, sizeof(path)) == ESP_OK)
+    {
+        remove(path);
+    }
+}
+
+static bool part_size(const http_upload_meta_t *meta, const char *id, uint64_t *size)
+{
+    char path[VFS_PATH_MAX + HTTP_UPLOAD_ID_LEN + 8];
+    struct stat st;
+    if (part_real_path(meta, id, path, sizeof(path)) != ESP_OK || stat(path, &st) != 0)
+    {
+        return false;
+    }
+    *size = (uint64_t)st.st_size;
+    return true;
+}
+
+/*
+ * Drop expired sessions and sessions whose part file is gone. Without a
+ * valid clock only broken sessions go; sessions created before the clock was
+ * set get the current time as their creation time once it is. If `live` is
+ * non-NULL it receives the number of sessions left. Returns true if the pass
+ * ran with a valid clock.
+ *
+ * The directory is walked with an iterator so every record is seen however
+ * many there are. Removing the entry just returned is safe on FAT and
+ * LittleFS.
+ */
+static bool session_gc(size_t *live)
+{
+    int64_t now = (int64_t)time(NULL);
+    bool clock_valid = now >= HTTP_UPLOAD_CLOCK_VALID;
+    if (live != NULL)
+    {
+        *live = 0;
+    }
+
+    vfs_dir_t *dir = NULL;
+    if (vfs_dir_open(SESSION_DIR, &dir) != ESP_OK)
+    {
+        return clock_valid;
+    }
+
+    int removed = 0;
+    size_t kept = 0;
+    vfs_dir_entry_t entry;
+    while (vfs_dir_next_name(dir, &entry) == ESP_OK)
+    {
+        const char *id = entry.name;
+        if (entry.is_dir)
+        {
+            continue;
+        }
+        if (!http_upload_id_valid(id))
+        {
+            session_remove(id, NULL, true);
+            removed++;
+            continue;
+        }
+        /* A session receiving a PATCH is in use, not stale */
+        if (!session_claim(id))
+        {
+            kept++;
+            continue;
+        }
+
+        http_upload_meta_t meta;
+        uint64_t offset = 0;
+        if (meta_load(id, &meta) != ESP_OK)
+        {
+            session_remove(id, NULL, true);
+            removed++;
+        }
+        else if (http_upload_session_expired(meta.created, now, HTTP_UPLOAD_SESSION_TTL_S) ||
+                 !part_size(&meta, id, &offset))
+        {
+            session_remove(id, &meta, false);
+            removed++;
+        }
+        else
+        {
+            if (clock_valid && meta.created < HTTP_UPLOAD_CLOCK_VALID)
+            {
+                meta.created = now;
+                meta_save(id, &meta);
+            }
+            kept++;
+        }
+        session_release(id);
+    }
+    vfs_dir_close(dir);
+
+    if (removed > 0)
+    {
+        ESP_LOGI(TAG, "Removed %d stale upload session(s)", removed);
+    }
+    if (live != NULL)
+    {
+        *live = kept;
+    }
+    return clock_valid;
+}
+
+/* Number of session records, counted without opening them */
+static size_t session_count(void)
+{
+    vfs_dir_t *dir = NULL;
+    if (vfs_dir_open(SESSION_DIR, &dir) != ESP_OK)
+    {
+        return 0;
+    }
+    size_t count = 0;
+    vfs_dir_entry_t entry;
+    while (vfs_dir_next_name(dir, &entry) == ESP_OK)
+    {
+        if (!entry.is_dir)
+        {
+            count++;
+        }
+    }
+    vfs_dir_close(dir);
+    return count;
+}
+
+static bool session_claim(const char *id)
+{
+    bool claimed = false;
+    xSemaphoreTake(s_active_mutex, portMAX_DELAY);
+    int free_slot = -1;
+    for (int i = 0; i < MAX_ACTIVE; i++)
+    {
+        if (strcmp(s_active[i], id) == 0)
+        {
+            free_slot = -1;
+            break;
+        }
+        if (s_active[i][0] == '\0' && free_slot < 0)
+        {
+            free_slot = i;
+        }
+    }
+    if (free_slot >= 0)
+    {
+        strcpy(s_active[free_slot], id);
+        claimed = true;
+    }
+    xSemaphoreGive(s_active_mutex);
+    return claimed;
+}
+
+static void session_release(const char *id)
+{
+    xSemaphoreTake(s_active_mutex, portMAX_DELAY);
+    for (int i = 0; i < MAX_ACTIVE; i++)
+    {
+        if (strcmp(s_active[i], id) == 0)
+        {
+            s_active[i][0] = '\0';
+        }
+    }
+    xSemaphoreGive(s_active_mutex);
+}
+
+/* --- Request helpers --- */
+
+static bool uri_session_id(httpd_req_t *req, char *id, size_t len)
+{
+    return http_server_route_param(req, "id", id, len) == ESP_OK && http_upload_id_valid(id);
+}
+
+static bool header_u64(httpd_req_t *req, const char *field, uint64_t *out)
+{
+    char value[24];
+    if (httpd_req_get_hdr_value_str(req, field, value, sizeof(value)) != ESP_OK || value[0] == '\0')
+    {
+        return false;
+    }
+    char *end = NULL;
+    unsigned long long v = strtoull(value, &end, 10);
+    if (*end != '\0' || value[0] == '-')
+    {
+        return false;
+    }
+    *out = v;
+    return true;
+}
+
+static void set_offset_headers(httpd_req_t *req, char *offset_buf, size_t len, uint64_t offset)
+{
+    snprintf(offset_buf, len, "%" PRIu64, offset);
+    httpd_resp_set_hdr(req, "Upload-Offset", offset_buf);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+}
+
+/* Load the session named in the URI; sends the error response itself on failure */
+static bool load_session(httpd_req_t *req, char *id, http_upload_meta_t *meta, uint64_t *offset)
+{
+    if (!uri_session_id(req, id, HTTP_UPLOAD_ID_LEN + 1) || meta_load(id, meta) != ESP_OK)
+    {
+        http_json_send_error(req, "404 Not Found", "Unknown upload");
+        return false;
+    }
+    if (http_upload_session_expired(meta->created, (int64_t)time(NULL), HTTP_UPLOAD_SESSION_TTL_S) ||
+        !part_size(meta, id, offset))
+    {
+        session_remove(id, meta, false);
+        http_json_send_error(req, "410 Gone", "Upload expired");
+        return false;
+    }
+    return true;
+}
+
+/* Move the finished part file over the target */
+static esp_err_t session_finish(const char *id, const http_upload_meta_t *meta)
+{
+    char part[VFS_PATH_MAX + HTTP_UPLOAD_ID_LEN + 8];
+    char target[VFS_PATH_MAX];
+    if (part_real_path(meta, id, part, sizeof(part)) != ESP_OK ||
+        vfs_resolve_path(meta->path, target, sizeof(target)) != ESP_OK)
+    {
+        return ESP_FAIL;
+    }
+
+    /* FAT refuses to rename over an existing file */
+    if (rename(part, target) != 0 && (remove(target) != 0 || rename(part, target) != 0))
+    {
+        return ESP_FAIL;
+    }
+    session_remove(id, NULL, true);
+    ESP_LOGI(TAG, "Upload %s complete: %s (%" PRIu64 " bytes)", id, meta->path, meta->length);
+    return ESP_OK;
+}
+
+/* --- Handlers --- */
+
+static esp_err_t handler_create(httpd_req_t *req)
+{
+    /* The pass at registration usually runs before SNTP has set the clock */
+    if (!s_gc_clock_done && (int64_t)time(NULL) >= HTTP_UPLOAD_CLOCK_VALID)
+    {
+        s_gc_clock_done = session_gc(NULL);
+    }
+
+    /* Collect before refusing: the cap may be held by sessions that have expired */
+    size_t live = session_count();
+    if (live >= HTTP_UPLOAD_MAX_SESSIONS)
+    {
+        if (session_gc(&live))
+        {
+            s_gc_clock_done = true;
+        }
+    }
+    if (live >= HTTP_UPLOAD_MAX_SESSIONS)
+    {
+        httpd_resp_set_hdr(req, "Retry-After", "60");
+        return http_json_send_error(req, "503 Service Unavailable", "Too many upload sessions");
+    }
+
+    char query[256] = {0};
+    char raw_path[VFS_PATH_MAX] = {0};
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+        httpd_query_key_value(query, "path", raw_path, sizeof(raw_path)) != ESP_OK)
+    {
+        return http_json_send_error(req, "400 Bad Request", "Missing path parameter");
+    }
+
+    http_upload_meta_t meta = {0};
+    if (http_sanitize_upload_path(raw_path, meta.path, sizeof(meta.path)) != ESP_OK)
+    {
+        return http_json_send_error(req, "400 Bad Request", "Invalid path");
+    }
+    if (!header_u64(req, "Upload-Length", &meta.length))
+    {
+        return http_json_send_error(req, "400 Bad Request", "Missing Upload-Length");
+    }
+    meta.created = (int64_t)time(NULL);
+
+    char id[HTTP_UPLOAD_ID_LEN + 1];
+    snprintf(id, sizeof(id), "%08" PRIx32 "%08" PRIx32, esp_random(), esp_random());
+
+    char part[VFS_PATH_MAX + HTTP_UPLOAD_ID_LEN + 8];
+    if (part_real_path(&meta, id, part, sizeof(part)) != ESP_OK)
+    {
+        return http_json_send_error(req, "400 Bad Request", "Path too long");
+    }
+
+    http_upload_ensure_parent_dir(meta.path);
+    FILE *f = fopen(part, "wb");
+    if (f == NULL)
+    {
+        return http_json_send_error(req, "500 Internal Server Error", "Failed to create file");
+    }
+    fclose(f);
+
+    if (meta_save(id, &meta) != ESP_OK)
+    {
+        remove(part);
+        return http_json_send_error(req, "500 Internal Server Error", "Failed to save session");
+    }
+
+    ESP_LOGI(TAG, "Upload %s created: %s (%" PRIu64 " bytes)", id, meta.path, meta.length);
+
+    char location[sizeof(URI_PREFIX) + HTTP_UPLOAD_ID_LEN];
+    snprintf(location, sizeof(location), URI_PREFIX "%s", id);
+    char offset_buf[24];
+    set_offset_headers(req, offset_buf, sizeof(offset_buf), 0);
+    httpd_resp_set_hdr(req, "Location", location);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_status(req, "201 Created");
+
+    http_stream_t out;
+    http_json_t j;
+    http_stream_init(&out, req);
+    http_json_init(&j, &out);
+    http_json_object_begin(&j);
+    http_json_kv_string(&j, "id", id);
+    http_json_kv_uint(&j, "offset", 0);
+    http_json_object_end(&j);
+    return http_stream_finish(&out);
+}
+
+static esp_err_t handler_head(httpd_req_t *req)
+{
+    char id[HTTP_UPLOAD_ID_LEN + 1];
+    http_upload_meta_t meta;
+    uint64_t offset = 0;
+    if (!load_session(req, id, &meta, &offset))
+    {
+        return ESP_OK;
+    }
+
+    char offset_buf[24];
+    char length_buf[24];
+    set_offset_headers(req, offset_buf, sizeof(offset_buf), offset);
+    snprintf(length_buf, sizeof(length_buf), "%" PRIu64, meta.length);
+    httpd_resp_set_hdr(req, "Upload-Length", length_buf);
+    return httpd_resp_send(req, NULL, 0);
+}
+
+/* Append the request body; returns NULL or an error message */
+static const char *patch_receive(httpd_req_t *req, FILE *f)
+{
+    char *buf = malloc(PATCH_BUF_SIZE);
+    if (buf == NULL)
+    {
+        return "Out of memory";
+    }
+
+    const char *error = NULL;
+    size_t remaining = req->content_len;
+    size_t unsynced = 0;
+    while (remaining > 0)
+    {
+        size_t want = remaining < PATCH_BUF_SIZE ? remaining : PATCH_BUF_SIZE;
+        int recvd = httpd_req_recv(req, buf, want);
+        if (recvd <= 0)
+        {
+            if (recvd == HTTPD_SOCK_ERR_TIMEOUT)
+            {
+                continue;
+            }
+            /* Keep what arrived; the client resumes from the new offset */
+            error = "Receive failed";
+            break;
+        }
+        if (fwrite(buf, 1, (size_t)recvd, f) != (size_t)recvd)
+        {
+            error = "Write failed";
+            break;
+        }
+        vfs_count_written((size_t)recvd);
+        remaining -= (size_t)recvd;
+        unsynced += (size_t)recvd;
+        if (unsynced >= HTTP_UPLOAD_SYNC_BYTES)
+        {
+            fflush(f);
+            fsync(fileno(f));
+            unsynced = 0;
+        }
+    }
+
+    free(buf);
+    return error;
+}
+
+static esp_err_t handler_patch(httpd_req_t *req)
+{
+    char id[HTTP_UPLOAD_ID_LEN + 1];
+    http_upload_meta_t meta;
+    uint64_t offset = 0;
+    if (!load_session(req, id, &meta, &offset))
+    {
+        return ESP_OK;
+    }
+
+    char offset_buf[24];
+    uint64_t client_offset = 0;
+    if (!header_u64(req, "Upload-Offset", &client_offset))
+    {
+        return http_json_send_error(req, "400 Bad Request", "Missing Upload-Offset");
+    }
+    if (client_offset != offset)
+    {
+        set_offset_headers(req, offset_buf, sizeof(offset_buf), offset);
+        return http_json_send_error(req, "409 Conflict", "Offset mismatch");
+    }
+    if (offset + req->content_len > meta.length)
+    {
+        return http_json_send_error(req, "413 Payload Too Large", "Exceeds Upload-Length");
+    }
+
+    if (!session_claim(id))
+    {
+        return http_json_send_error(req, "423 Locked", "Upload busy");
+    }
+
+    /* A PATCH that held the claim since load_session() may have moved the offset */
+    if (!part_size(&meta, id, &offset) || offset != client_offset)
+    {
+        session_release(id);
+        set_offset_headers(req, offset_buf, sizeof(offset_buf), offset);
+        return http_json_send_error(req, "409 Conflict", "Offset mismatch");
+    }
+
+    char part[VFS_PATH_MAX + HTTP_UPLOAD_ID_LEN + 8];
+    part_real_path(&meta, id, part, sizeof(part));
+    FILE *f = fopen(part, "ab");
+    if (f == NULL)
+    {
+        session_release(id);
+        return http_json_send_error(req, "500 Internal Server Error", "Failed to open file");
+    }
+
+    const char *error = patch_receive(req, f);
+    fflush(f);
+    fsync(fileno(f));
+    fclose(f);
+
+    part_size(&meta, id, &offset);
+    esp_err_t err = ESP_OK;
+    if (error == NULL && offset == meta.length)
+    {
+        err = session_finish(id, &meta);
+    }
+    session_release(id);
+
+    if (error != NULL)
+    {
+        set_offset_headers(req, offset_buf, sizeof(offset_buf), offset);
+        return http_json_send_error(req, "500 Internal Server Error", error);
+    }
+    if (err != ESP_OK)
+    {
+        return http_json_send_error(req, "500 Internal Server Error", "Rename failed");
+    }
+
+    set_offset_headers(req, offset_buf, sizeof(offset_buf), offset);
+    httpd_resp_set_status(req, "204 No Content");
+    return httpd_resp_send(req, NULL, 0);
+}
+
+static esp_err_t handler_delete(httpd_req_t *req)
+{
+    char id[HTTP_UPLOAD_ID_LEN + 1];
+    http_upload_meta_t meta;
+    if (!uri_session_id(req, id, sizeof(id)) || meta_load(id, &meta) != ESP_OK)
+    {
+        return http_json_send_error(req, "404 Not Found", "Unknown upload");
+    }
+    if (!session_claim(id))
+    {
+        return http_json_send_error(req, "423 Locked", "Upload busy");
+    }
+    session_remove(id, &meta, false);
+    session_release(id);
+
+    httpd_resp_set_status(req, "204 No Content");
+    return httpd_resp_send(req, NULL, 0);
+}
+
+void http_resumable_register(void)
+{
+    if (s_active_mutex == NULL)
+    {
+        s_active_mutex = xSemaphoreCreateMutex();
+    }
+
+    if (!vfs_is_directory(SESSION_DIR))
+    {
+        vfs_mkdir(SESSION_DIR);
+    }
+    s_gc_clock_done = session_gc(NULL);
+
+    static const http_route_t routes[] = {
+        {"/api/uploads", HTTP_ROUTE_METHOD(HTTP_POST), HTTP_ROUTE_AUTH, handler_create},
+        {URI_PREFIX "{id}", HTTP_ROUTE_METHOD(HTTP_HEAD), HTTP_ROUTE_AUTH, handler_head},
+        {URI_PREFIX "{id}", HTTP_ROUTE_METHOD(HTTP_PATCH), HTTP_ROUTE_AUTH | HTTP_ROUTE_ASYNC, handler_patch},
+        {URI_PREFIX "{id}", HTTP_ROUTE_METHOD(HTTP_DELETE), HTTP_ROUTE_AUTH, handler_delete},
+    };
+    for (size_t i = 0; i < sizeof(routes) / sizeof(routes[0]); i++)
+    {
+        http_server_register_route(&routes[i]);
+    }
+    ESP_LOGI(TAG, "Resumable upload endpoints registered");
+}
@@ -0,0 +1,473 @@
+#include "http_router.h"
+#include "http_access.h"
+#include "http_async.h"
+#include "http_auth.h"
+#include "http_json.h"
+
+#include "esp_log.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const TAG = "http_router";
+
+#define ROUTE_PREFIX "/api/"
+
+typedef struct route_entry
+{
+    struct route_entry *next;
+    http_route_t route;
+    http_access_route_t *stats;
+    char name[]; /* "GET, HEAD /api/heap" for the access log */
+} route_entry_t;
+
+typedef struct route_node
+{
+    struct route_node *next;     /* sibling in the parent's literal list */
+    struct route_node *children; /* literal segments */
+    struct route_node *param;    /* "{name}" */
+    struct route_node *rest;     /* "{name...}", always a leaf */
+    route_entry_t *routes;
+    size_t len;
+    char segment[]; /* literal text, or the parameter name */
+} route_node_t;
+
+static route_node_t *s_root = NULL;
+
+static const struct
+{
+    int method;
+    const char *name;
+} s_methods[] = {
+    {HTTP_GET, "GET"},     {HTTP_HEAD, "HEAD"},   {HTTP_POST, "POST"},
+    {HTTP_PUT, "PUT"},     {HTTP_PATCH, "PATCH"}, {HTTP_DELETE, "DELETE"},
+};
+
+/* --- Building --- */
+
+static route_node_t *node_new(const char *segment, size_t len)
+{
+    route_node_t *node = calloc(1, sizeof(route_node_t) + len + 1);
+    if (node != NULL)
+    {
+        memcpy(node->segment, segment, len);
+        node->segment[len] = '\0';
+        node->len = len;
+    }
+    return node;
+}
+
+static void node_free(route_node_t *node)
+{
+    while (node != NULL)
+    {
+        route_node_t *next = node->next;
+        node_free(node->children);
+        node_free(node->param);
+        node_free(node->rest);
+        route_entry_t *e = node->routes;
+        while (e != NULL)
+        {
+            route_entry_t *e_next = e->next;
+            free(e);
+            e = e_next;
+        }
+        free(node);
+        node = next;
+    }
+}
+
+static bool name_valid(const char *name, size_t len)
+{
+    if (len == 0)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        if (name[i] == '{' || name[i] == '}' || name[i] == '.')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Find or create the child of node for one pattern segment */
+static esp_err_t node_child(route_node_t *node, const char *seg, size_t len, bool last, route_node_t **out)
+{
+    route_node_t **slot = NULL;
+    const char *name = seg;
+    size_t name_len = len;
+
+    if (len >= 2 && seg[0] == '{' && seg[len - 1] == '}')
+    {
+        name = seg + 1;
+        name_len = len - 2;
+        slot = &node->param;
+        if (name_len > 3 && memcmp(name + name_len - 3, "...", 3) == 0)
+        {
+            if (!last)
+            {
+                return ESP_ERR_INVALID_ARG;
+            }
+            name_len -= 3;
+            slot = &node->rest;
+        }
+        if (!name_valid(name, name_len))
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (*slot != NULL)
+        {
+            /* One parameter per position: the name must agree with earlier routes */
+            if ((*slot)->len != name_len || memcmp((*slot)->segment, name, name_len) != 0)
+            {
+                return ESP_ERR_INVALID_STATE;
+            }
+            *out = *slot;
+            return ESP_OK;
+        }
+    }
+    else
+    {
+        if (memchr(seg, '{', len) != NULL || memchr(seg, '}', len) != NULL)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+        for (route_node_t *c = node->children; c != NULL; c = c->next)
+        {
+            if (c->len == len && memcmp(c->segment, seg, len) == 0)
+            {
+                *out = c;
+                return ESP_OK;
+            }
+        }
+    }
+
+    route_node_t *child = node_new(name, name_len);
+    if (child == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    if (slot != NULL)
+    {
+        *slot = child;
+    }
+    else
+    {
+        child->next = node->children;
+        node->children = child;
+    }
+    *out = child;
+    return ESP_OK;
+}
+
+esp_err_t http_server_register_route(const http_route_t *route)
+{
+    if (route == NULL || route->path == NULL || route->handler == NULL || route->methods == 0 ||
+        strncmp(route->path, ROUTE_PREFIX, strlen(ROUTE_PREFIX)) != 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (s_root == NULL)
+    {
+        s_root = node_new("", 0);
+        if (s_root == NULL)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    route_node_t *node = s_root;
+    size_t params = 0;
+    const char *p = route->path;
+    while (*p == '/')
+    {
+        const char *seg = p + 1;
+        size_t len = strcspn(seg, "/");
+        if (len == 0)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (seg[0] == '{' && ++params > HTTP_ROUTE_MAX_PARAMS)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+        esp_err_t err = node_child(node, seg, len, seg[len] == '\0', &node);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+        p = seg + len;
+    }
+
+    for (const route_entry_t *e = node->routes; e != NULL; e = e->next)
+    {
+        if ((e->route.methods & route->methods) != 0)
+        {
+            ESP_LOGE(TAG, "Duplicate route: %s", route->path);
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+
+    char methods[48];
+    http_router_allow_header(route->methods, methods, sizeof(methods));
+    size_t name_len = strlen(methods) + 1 + strlen(route->path);
+    route_entry_t *entry = malloc(sizeof(route_entry_t) + name_len + 1);
+    if (entry == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    snprintf(entry->name, name_len + 1, "%s %s", methods, route->path);
+    entry->route = *route;
+    entry->route.path = NULL; /* the caller's string is not kept */
+    entry->stats = http_access_route(entry->name);
+    entry->next = node->routes;
+    node->routes = entry;
+    return ESP_OK;
+}
+
+void http_router_reset(void)
+{
+    node_free(s_root);
+    s_root = NULL;
+    http_access_reset_routes();
+}
+
+/* --- Matching --- */
+
+/* p is at the '/' before the next segment, or at end */
+static const route_node_t *match_from(const route_node_t *node, const char *p, const char *end,
+                                      http_router_match_t *m)
+{
+    if (p == end)
+    {
+        return node->routes != NULL ? node : NULL;
+    }
+
+    const char *seg = p + 1;
+    const char *seg_end = seg;
+    while (seg_end < end && *seg_end != '/')
+    {
+        seg_end++;
+    }
+    size_t len = (size_t)(seg_end - seg);
+    if (len == 0)
+    {
+        return NULL;
+    }
+
+    for (const route_node_t *c = node->children; c != NULL; c = c->next)
+    {
+        if (c->len == len && memcmp(c->segment, seg, len) == 0)
+        {
+            const route_node_t *found = match_from(c, seg_end, end, m);
+            if (found != NULL)
+            {
+                return found;
+            }
+            break;
+        }
+    }
+
+    size_t saved = m->param_count;
+    if (node->param != NULL)
+    {
+        m->params[saved] = (http_router_param_t){node->param->segment, seg, len};
+        m->param_count = saved + 1;
+        const route_node_t *found = match_from(node->param, seg_end, end, m);
+        if (found != NULL)
+        {
+            return found;
+        }
+        m->param_count = saved;
+    }
+
+    if (node->rest != NULL && node->rest->routes != NULL)
+    {
+        m->params[saved] = (http_router_param_t){node->rest->segment, seg, (size_t)(end - seg)};
+        m->param_count = saved + 1;
+        return node->rest;
+    }
+    return NULL;
+}
+
+esp_err_t http_router_match(const char *uri, int method, http_router_match_t *m)
+{
+    memset(m, 0, sizeof(*m));
+    if (s_root == NULL || uri == NULL || uri[0] != '/')
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const char *end = uri + strcspn(uri, "?");
+    if (end - uri > 1 && end[-1] == '/')
+    {
+        end--;
+    }
+
+    const route_node_t *node = match_from(s_root, uri, end, m);
+    if (node == NULL)
+    {
+        m->param_count = 0;
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    for (const route_entry_t *e = node->routes; e != NULL; e = e->next)
+    {
+        m->allowed |= e->route.methods;
+        if (method >= 0 && method < 32 && (e->route.methods & HTTP_ROUTE_METHOD(method)) != 0)
+        {
+            m->route = &e->route;
+            m->stats = e->stats;
+        }
+    }
+    return m->route != NULL ? ESP_OK : ESP_ERR_NOT_SUPPORTED;
+}
+
+const char *http_router_method_name(int method)
+{
+    for (size_t i = 0; i < sizeof(s_methods) / sizeof(s_methods[0]); i++)
+    {
+        if (s_methods[i].method == method)
+        {
+            return s_methods[i].name;
+        }
+    }
+    return "?";
+}
+
+size_t http_router_allow_header(uint32_t methods, char *buf, size_t len)
+{
+    size_t pos = 0;
+    if (len > 0)
+    {
+        buf[0] = '\0';
+    }
+    for (size_t i = 0; i < sizeof(s_methods) / sizeof(s_methods[0]); i++)
+    {
+        if ((methods & HTTP_ROUTE_METHOD(s_methods[i].method)) == 0)
+        {
+            continue;
+        }
+        int n = snprintf(buf + pos, len - pos, "%s%s", pos > 0 ? ", " : "", s_methods[i].name);
+        if (n < 0 || (size_t)n >= len - pos)
+        {
+            break;
+        }
+        pos += (size_t)n;
+    }
+    return pos;
+}
+
+/* --- Parameters --- */
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static esp_err_t percent_decode(const char *in, size_t in_len, char *out, size_t out_len)
+{
+    size_t o = 0;
+    for (size_t i = 0; i < in_len; i++)
+    {
+        char c = in[i];
+        if (c == '%')
+        {
+            if (i + 2 >= in_len)
+            {
+                return ESP_ERR_INVALID_ARG;
+            }
+            int h = hex_value(in[i + 1]);
+            int l = hex_value(in[i + 2]);
+            if (h < 0 || l < 0 || (h | l) == 0)
+            {
+                return ESP_ERR_INVALID_ARG;
+            }
+            c = (char)(h << 4 | l);
+            i += 2;
+        }
+        if (o + 1 >= out_len)
+        {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        out[o++] = c;
+    }
+    if (out_len == 0)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    out[o] = '\0';
+    return ESP_OK;
+}
+
+esp_err_t http_server_route_param(httpd_req_t *req, const char *name, char *buf, size_t len)
+{
+    http_router_match_t m;
+    if (http_router_match(req->uri, req->method, &m) != ESP_OK)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    for (size_t i = 0; i < m.param_count; i++)
+    {
+        if (strcmp(m.params[i].name, name) == 0)
+        {
+            return percent_decode(m.params[i].value, m.params[i].len, buf, len);
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+/* --- Dispatch --- */
+
+esp_err_t http_router_handler(httpd_req_t *req)
+{
+    http_router_match_t m;
+    esp_err_t err = http_router_match(req->uri, req->method, &m);
+    http_access_begin(req, m.stats);
+
+    esp_err_t ret = ESP_OK;
+    if (err == ESP_ERR_NOT_FOUND)
+    {
+        ret = http_json_send_error(req, "404 Not Found", "Unknown endpoint");
+    }
+    else if (err != ESP_OK)
+    {
+        char allow[64];
+        http_router_allow_header(m.allowed, allow, sizeof(allow));
+        httpd_resp_set_hdr(req, "Allow", allow);
+        ret = http_json_send_error(req, "405 Method Not Allowed", "Method not allowed");
+    }
+    else if ((m.route->flags & HTTP_ROUTE_AUTH) && http_auth_check(req) != ESP_OK)
+    {
+        ret = ESP_OK;
+    }
+    else if ((m.route->flags & HTTP_ROUTE_ASYNC) && http_async_defer(req, m.route->handler))
+    {
+        ret = ESP_OK; /* the worker records it */
+    }
+    else
+    {
+        ret = m.route->handler(req);
+    }
+
+    http_access_end(req, false);
+    return ret;
+}
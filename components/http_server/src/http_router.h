@@ -0,0 +1,53 @@
+#pragma once
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include "http_access.h"
+#include "http_server.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * API router: one wildcard httpd handler for /api dispatching through a segment trie.
+ * Each node has literal children, at most one "{name}" child and at most one
+ * "{name...}" leaf; routes hang off the node their pattern ends at. Matching
+ * walks the request path once, trying literals before parameters and
+ * backtracking only when a literal branch dead-ends.
+ */
+
+#define HTTP_ROUTER_URI "/api/*"
+
+typedef struct
+{
+    const char *name;  /* points into the trie, NUL-terminated */
+    const char *value; /* points into the matched URI, not terminated */
+    size_t len;
+} http_router_param_t;
+
+typedef struct
+{
+    const http_route_t *route;  /* NULL unless the method matched */
+    http_access_route_t *stats; /* latency stats of that route */
+    uint32_t allowed;          /* methods registered for the matched path */
+    size_t param_count;
+    http_router_param_t params[HTTP_ROUTE_MAX_PARAMS];
+} http_router_match_t;
+
+/*
+ * Match a URI (query string ignored) against the trie. Returns ESP_OK with
+ * m->route set, ESP_ERR_NOT_SUPPORTED if the path matched but the method did
+ * not (m->allowed lists the methods that would), or ESP_ERR_NOT_FOUND.
+ */
+esp_err_t http_router_match(const char *uri, int method, http_router_match_t *m);
+
+const char *http_router_method_name(int method);
+
+/* Format a method mask as an Allow header value ("GET, HEAD"). Returns the length written. */
+size_t http_router_allow_header(uint32_t methods, char *buf, size_t len);
+
+/* httpd entry point registered for HTTP_ROUTER_URI; every request is timed into the access log */
+esp_err_t http_router_handler(httpd_req_t *req);
+
+/* Drop every route (host tests) */
+void http_router_reset(void);
@@ -1,58 +1,168 @@
 #include "http_server.h"
+#include "http_access.h"
+#include "http_async.h"
 #include "http_auth.h"
+#include "http_router.h"
+#include "http_tls.h"
 
 #include "esp_log.h"
 
 static const char *const TAG = "http_server";
 
+/* Plain HTTP on port 80; HTTPS on 443 (see http_tls.c) */
 static httpd_handle_t s_server = NULL;
+static httpd_handle_t s_tls_server = NULL;
+static bool s_routes_added = false;
+static http_access_route_t *s_static_stats = NULL;
 
 /* Forward declarations for sub-module registration */
 void http_static_init(void);
 esp_err_t http_static_handler(httpd_req_t *req, httpd_err_code_t err_code);
-void http_api_register(httpd_handle_t server);
-void http_upload_register(httpd_handle_t server);
+void http_api_register(void);
+void http_upload_register(void);
+void http_resumable_register(void);
+void http_archive_register(void);
+void http_session_register(void);
+void http_logs_register(void);
+void http_exec_register(void);
+void http_ota_register(void);
+void http_logs_stop(void);
 void http_server_register_commands(void);
 
+/* Static files arrive through the 404 handler; time them like routed requests */
+static esp_err_t static_entry(httpd_req_t *req, httpd_err_code_t err_code)
+{
+    http_access_begin(req, s_static_stats);
+    esp_err_t ret = http_static_handler(req, err_code);
+    http_access_end(req, false);
+    return ret;
+}
+
 httpd_handle_t http_server_get_handle(void)
 {
-    return s_server;
+    return s_tls_server != NULL ? s_tls_server : s_server;
+}
+
+size_t http_server_get_handles(httpd_handle_t *out, size_t max)
+{
+    size_t n = 0;
+    if (s_tls_server != NULL && n < max)
+    {
+        out[n++] = s_tls_server;
+    }
+    if (s_server != NULL && n < max)
+    {
+        out[n++] = s_server;
+    }
+    return n;
 }
 
 esp_err_t http_server_stop(void)
 {
+    if (s_server || s_tls_server)
+    {
+        http_logs_stop();
+    }
     if (s_server)
     {
         httpd_stop(s_server);
         s_server = NULL;
         ESP_LOGI(TAG, "HTTP server stopped");
     }
+    if (s_tls_server)
+    {
+        http_tls_stop(s_tls_server);
+        s_tls_server = NULL;
+        ESP_LOGI(TAG, "HTTPS server stopped");
+    }
     return ESP_OK;
 }
 
+/* Both listeners serve the same handlers */
+static void register_handlers(httpd_handle_t server)
+{
+    httpd_register_err_handler(server, HTTPD_404_NOT_FOUND, static_entry);
+
+    /* Every /api endpoint goes through the router; see http_server_register_route() */
+    const httpd_uri_t api_uri = {
+        .uri = HTTP_ROUTER_URI,
+        .method = HTTP_ANY,
+        .handler = http_router_handler,
+        .user_ctx = NULL,
+    };
+    httpd_register_uri_handler(server, &api_uri);
+}
+
 esp_err_t http_server_init(void)
 {
     http_auth_init();
     http_static_init();
+    http_access_init();
+    http_tls_init();
+
+    esp_err_t err = http_async_init();
+    if (err != ESP_OK)
+    {
+        return err;
+    }
 
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
-    config.max_uri_handlers = 16;
+    config.max_uri_handlers = 8; /* the API router and /ws, with room to spare */
     config.lru_purge_enable = true;
     config.stack_size = 8192;
+    config.uri_match_fn = httpd_uri_match_wildcard;
 
-    esp_err_t err = httpd_start(&s_server, &config);
-    if (err != ESP_OK)
+    http_tls_mode_t mode = http_server_get_tls_mode();
+    if (mode != HTTP_TLS_OFF)
     {
-        ESP_LOGE(TAG, "Failed to start HTTP server: %s", esp_err_to_name(err));
-        return err;
+        err = http_tls_start(&config, &s_tls_server);
+        if (err == ESP_OK)
+        {
+            register_handlers(s_tls_server);
+        }
+        else if (mode == HTTP_TLS_ON)
+        {
+            ESP_LOGW(TAG, "HTTPS unavailable, falling back to plain HTTP");
+        }
     }
 
-    httpd_register_err_handler(s_server, HTTPD_404_NOT_FOUND, http_static_handler);
+    if (s_tls_server == NULL || mode == HTTP_TLS_BOTH)
+    {
+        if (s_tls_server != NULL)
+        {
+            /* Leave socket room for the TLS listener; both share CONFIG_LWIP_MAX_SOCKETS */
+            config.max_open_sockets = 4;
+        }
+        err = httpd_start(&s_server, &config);
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Failed to start HTTP server: %s", esp_err_to_name(err));
+            if (s_tls_server == NULL)
+            {
+                return err;
+            }
+        }
+        else
+        {
+            register_handlers(s_server);
+            ESP_LOGI(TAG, "HTTP server started on port %d", config.server_port);
+        }
+    }
 
-    http_api_register(s_server);
-    http_upload_register(s_server);
+    /* Routes outlive a stop/start cycle; only add them once */
+    if (!s_routes_added)
+    {
+        s_static_stats = http_access_route("static");
+        http_api_register();
+        http_upload_register();
+        http_resumable_register();
+        http_archive_register();
+        http_session_register();
+        http_logs_register();
+        http_exec_register();
+        http_ota_register();
+        s_routes_added = true;
+    }
     http_server_register_commands();
-
-    ESP_LOGI(TAG, "HTTP server started on port %d", config.server_port);
     return ESP_OK;
 }
@@ -1,13 +1,64 @@
+#include "http_access.h"
+#include "http_auth.h"
+#include "http_file_cache.h"
+#include "http_router.h"
 #include "http_server.h"
+#include "http_tls.h"
 
 #include "esp_console.h"
 #include "esp_log.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 static const char *const TAG = "http_cmd";
 
+static int print_access_log(void)
+{
+    http_access_entry_t *entries = malloc(HTTP_ACCESS_LOG_SIZE * sizeof(http_access_entry_t));
+    if (entries == NULL)
+    {
+        printf("server: out of memory\n");
+        return 1;
+    }
+    size_t n = http_access_log_read(entries, HTTP_ACCESS_LOG_SIZE);
+    printf("%10s %-6s %6s %8s %10s %-8s %s\n", "End(ms)", "Method", "Status", "Bytes", "Time(us)", "URI hash", "Route");
+    for (size_t i = 0; i < n; i++)
+    {
+        const http_access_entry_t *e = &entries[i];
+        printf("%10u %-6s %6u %8u %10u %08x %s\n", (unsigned)e->end_ms, http_router_method_name(e->method),
+               (unsigned)e->status, (unsigned)e->bytes, (unsigned)e->duration_us, (unsigned)e->uri_hash,
+               e->route != NULL ? e->route : "-");
+    }
+    free(entries);
+
+    printf("\n%8s %8s %8s %8s %8s  %s\n", "Count", "p50(us)", "p95(us)", "p99(us)", "Max(us)", "Route");
+    http_access_route_t r;
+    for (size_t i = 0; http_access_route_get(i, &r); i++)
+    {
+        if (r.count == 0)
+        {
+            continue;
+        }
+        printf("%8u %8u %8u %8u %8u  %s\n", (unsigned)r.count, (unsigned)http_access_percentile(&r, 50),
+               (unsigned)http_access_percentile(&r, 95), (unsigned)http_access_percentile(&r, 99),
+               (unsigned)r.max_us, r.name);
+    }
+    return 0;
+}
+
+static const char *const s_tls_mode_names[] = {"off", "on", "both"};
+
+static void print_tls_status(void)
+{
+    httpd_handle_t handles[2];
+    size_t n = http_server_get_handles(handles, 2);
+    printf("HTTPS:       %s (%s)\n", s_tls_mode_names[http_server_get_tls_mode()],
+           http_tls_is_running() ? "listening on 443" : "not running");
+    printf("Listeners:   %u\n", (unsigned)n);
+}
+
 static int cmd_server(int argc, char **argv)
 {
     if (argc == 1)
@@ -16,7 +67,9 @@ static int cmd_server(int argc, char **argv)
         printf("Static:      %s\n", http_static_is_enabled() ? "on" : "off");
         printf("Static root: %s\n", http_static_get_root());
         printf("SPA:         %s\n", http_static_is_spa() ? "on" : "off");
+        printf("Autoindex:   %s\n", http_static_is_autoindex() ? "on" : "off");
         printf("Auth user:   %s\n", http_auth_get_username());
+        print_tls_status();
         return 0;
     }
 
@@ -54,6 +107,7 @@ static int cmd_server(int argc, char **argv)
             printf("Static:      %s\n", http_static_is_enabled() ? "on" : "off");
             printf("Static root: %s\n", http_static_get_root());
             printf("SPA:         %s\n", http_static_is_spa() ? "on" : "off");
+        printf("Autoindex:   %s\n", http_static_is_autoindex() ? "on" : "off");
             return 0;
         }
 
@@ -110,10 +164,76 @@ static int cmd_server(int argc, char **argv)
             return 1;
         }
 
-        printf("Usage: server static on|off|root <path>|spa on|off\n");
+        if (strcmp(argv[2], "autoindex") == 0)
+        {
+            if (argc < 4)
+            {
+                printf("Autoindex: %s\n", http_static_is_autoindex() ? "on" : "off");
+                return 0;
+            }
+            if (strcmp(argv[3], "on") == 0)
+            {
+                http_static_set_autoindex(true);
+                printf("Directory listings: on\n");
+                return 0;
+            }
+            if (strcmp(argv[3], "off") == 0)
+            {
+                http_static_set_autoindex(false);
+                printf("Directory listings: off\n");
+                return 0;
+            }
+            printf("Usage: server static autoindex on|off\n");
+            return 1;
+        }
+
+        printf("Usage: server static on|off|root <path>|spa on|off|autoindex on|off\n");
         return 1;
     }
 
+    /* server cache [flush] */
+    if (strcmp(argv[1], "cache") == 0)
+    {
+        if (argc >= 3 && strcmp(argv[2], "flush") == 0)
+        {
+            http_file_cache_flush();
+            printf("Static cache flushed\n");
+            return 0;
+        }
+        if (argc >= 3)
+        {
+            printf("Usage: server cache [flush]\n");
+            return 1;
+        }
+
+        http_file_cache_stats_t stats;
+        http_file_cache_get_stats(&stats);
+        printf("Entries:     %u\n", (unsigned)stats.entries);
+        printf("Bytes:       %u / %u\n", (unsigned)stats.bytes, (unsigned)HTTP_FILE_CACHE_MAX_BYTES);
+        printf("Max file:    %u\n", (unsigned)HTTP_FILE_CACHE_MAX_FILE);
+        printf("Hits:        %u\n", (unsigned)stats.hits);
+        printf("Misses:      %u\n", (unsigned)stats.misses);
+        printf("Evictions:   %u\n", (unsigned)stats.evictions);
+        return 0;
+    }
+
+    /* server log [clear] */
+    if (strcmp(argv[1], "log") == 0)
+    {
+        if (argc >= 3 && strcmp(argv[2], "clear") == 0)
+        {
+            http_access_reset();
+            printf("Access log cleared\n");
+            return 0;
+        }
+        if (argc >= 3)
+        {
+            printf("Usage: server log [clear]\n");
+            return 1;
+        }
+        return print_access_log();
+    }
+
     /* server auth ... */
     if (strcmp(argv[1], "auth") == 0)
     {
@@ -122,9 +242,15 @@ static int cmd_server(int argc, char **argv)
             printf("Auth user: %s\n", http_auth_get_username());
             return 0;
         }
+        if (argc == 3 && strcmp(argv[2], "logout") == 0)
+        {
+            http_auth_session_clear();
+            printf("All login sessions revoked\n");
+            return 0;
+        }
         if (argc < 4)
         {
-            printf("Usage: server auth <username> <password>\n");
+            printf("Usage: server auth <username> <password> | server auth logout\n");
             return 1;
         }
         esp_err_t err = http_auth_set_credentials(argv[2], argv[3]);
@@ -137,7 +263,33 @@ static int cmd_server(int argc, char **argv)
         return 0;
     }
 
-    printf("Usage: server [start|stop|static ...|auth ...]\n");
+    /* server tls ... */
+    if (strcmp(argv[1], "tls") == 0)
+    {
+        if (argc == 2)
+        {
+            print_tls_status();
+            return 0;
+        }
+        for (size_t i = 0; i < sizeof(s_tls_mode_names) / sizeof(s_tls_mode_names[0]); i++)
+        {
+            if (strcmp(argv[2], s_tls_mode_names[i]) == 0)
+            {
+                esp_err_t err = http_server_set_tls_mode((http_tls_mode_t)i);
+                if (err != ESP_OK)
+                {
+                    printf("server: could not save mode (%s)\n", esp_err_to_name(err));
+                    return 1;
+                }
+                printf("HTTPS mode %s; applies after 'server stop' and 'server start'\n", s_tls_mode_names[i]);
+                return 0;
+            }
+        }
+        printf("Usage: server tls off|on|both\n");
+        return 1;
+    }
+
+    printf("Usage: server [start|stop|static ...|cache [flush]|log [clear]|auth ...|tls off|on|both]\n");
     return 1;
 }
 
@@ -145,8 +297,8 @@ void http_server_register_commands(void)
 {
     const esp_console_cmd_t cmd = {
         .command = "server",
-        .help = "HTTP server management (start, stop, static, auth)",
-        .hint = "[start|stop|static|auth]",
+        .help = "HTTP server management (start, stop, static, cache, log, auth, tls)",
+        .hint = "[start|stop|static|cache|log|auth|tls]",
         .func = &cmd_server,
     };
     ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
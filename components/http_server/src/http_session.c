@@ -0,0 +1,75 @@
+#include "http_auth.h"
+#include "http_json.h"
+#include "http_server.h"
+
+#include "esp_log.h"
+
+#include <stdio.h>
+
+static const char *const TAG = "http_session";
+
+/*
+ * Optional login sessions so clients need not send Basic credentials on every
+ * request:
+ *   POST /api/login   (Basic credentials) -> {"token":...}, Set-Cookie: cos_session=...
+ *   POST /api/logout  (any credentials)   -> 204, revokes the presented token
+ * The token works as "Authorization: Bearer <token>" or through the cookie.
+ */
+
+static esp_err_t handler_login(httpd_req_t *req)
+{
+    if (http_auth_check_basic(req) != ESP_OK)
+    {
+        return ESP_OK;
+    }
+
+    char token[HTTP_AUTH_TOKEN_LEN + 1];
+    esp_err_t err = http_auth_session_create(token, sizeof(token));
+    if (err != ESP_OK)
+    {
+        return http_json_send_error(req, "500 Internal Server Error", esp_err_to_name(err));
+    }
+
+    char cookie[sizeof(HTTP_AUTH_COOKIE) + HTTP_AUTH_TOKEN_LEN + 64];
+    snprintf(cookie, sizeof(cookie), HTTP_AUTH_COOKIE "=%s; Path=/; Max-Age=%d; HttpOnly; SameSite=Strict", token,
+             HTTP_AUTH_SESSION_TTL_S);
+    httpd_resp_set_hdr(req, "Set-Cookie", cookie);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    httpd_resp_set_type(req, "application/json");
+
+    http_stream_t out;
+    http_json_t j;
+    http_stream_init(&out, req);
+    http_json_init(&j, &out);
+    http_json_object_begin(&j);
+    http_json_kv_string(&j, "token", token);
+    http_json_kv_uint(&j, "expires_in", HTTP_AUTH_SESSION_TTL_S);
+    http_json_object_end(&j);
+    return http_stream_finish(&out);
+}
+
+static esp_err_t handler_logout(httpd_req_t *req)
+{
+    char token[HTTP_AUTH_TOKEN_LEN + 1];
+    if (http_auth_request_token(req, token, sizeof(token)))
+    {
+        http_auth_session_revoke(token);
+    }
+
+    httpd_resp_set_hdr(req, "Set-Cookie", HTTP_AUTH_COOKIE "=; Path=/; Max-Age=0; HttpOnly; SameSite=Strict");
+    httpd_resp_set_status(req, "204 No Content");
+    return httpd_resp_send(req, NULL, 0);
+}
+
+void http_session_register(void)
+{
+    static const http_route_t routes[] = {
+        {"/api/login", HTTP_ROUTE_METHOD(HTTP_POST), 0, handler_login},
+        {"/api/logout", HTTP_ROUTE_METHOD(HTTP_POST), HTTP_ROUTE_AUTH, handler_logout},
+    };
+    for (size_t i = 0; i < sizeof(routes) / sizeof(routes[0]); i++)
+    {
+        http_server_register_route(&routes[i]);
+    }
+    ESP_LOGI(TAG, "Session endpoints registered");
+}
@@ -1,11 +1,18 @@
+#include "http_access.h"
+#include "http_async.h"
+#include "http_autoindex.h"
+#include "http_bundle.h"
+#include "http_file_cache.h"
 #include "http_mime.h"
 #include "http_server.h"
+#include "http_stream.h"
 
 #include "esp_log.h"
 #include "filesystem.h"
 #include "nvs.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 
@@ -15,15 +22,18 @@ static const char *const TAG = "http_static";
 #define NVS_KEY_ENABLED "static_on"
 #define NVS_KEY_ROOT "static_root"
 #define NVS_KEY_SPA "spa"
+#define NVS_KEY_AUTOINDEX "autoindex"
 
 #define STATIC_ROOT_MAX 64
 #define DEFAULT_ROOT "/flash/public"
 #define CHUNK_SIZE 1024
 #define LITTLEFS_BASE "/littlefs"
 #define REAL_PATH_MAX 192
+#define RESP_HEAD_MAX 512
 
 static bool s_enabled = false;
 static bool s_spa = false;
+static bool s_autoindex = false;
 static char s_root[STATIC_ROOT_MAX] = DEFAULT_ROOT;
 
 static void load_config(void)
@@ -55,6 +65,13 @@ static void load_config(void)
         s_spa = (val != 0);
     }
 
+    val = 0;
+    len = sizeof(val);
+    if (nvs_get_blob(h, NVS_KEY_AUTOINDEX, &val, &len) == ESP_OK)
+    {
+        s_autoindex = (val != 0);
+    }
+
     nvs_close(h);
 }
 
@@ -75,7 +92,9 @@ static esp_err_t save_uint8(const char *key, uint8_t val)
 void http_static_init(void)
 {
     load_config();
-    ESP_LOGI(TAG, "Static: %s, root=%s, spa=%s", s_enabled ? "on" : "off", s_root, s_spa ? "on" : "off");
+    http_file_cache_init();
+    ESP_LOGI(TAG, "Static: %s, root=%s, spa=%s, autoindex=%s", s_enabled ? "on" : "off", s_root,
+             s_spa ? "on" : "off", s_autoindex ? "on" : "off");
 }
 
 esp_err_t http_static_set_enabled(bool enabled)
@@ -126,42 +145,464 @@ bool http_static_is_spa(void)
     return s_spa;
 }
 
+esp_err_t http_static_set_autoindex(bool enabled)
+{
+    s_autoindex = enabled;
+    return save_uint8(NVS_KEY_AUTOINDEX, enabled ? 1 : 0);
+}
+
+bool http_static_is_autoindex(void)
+{
+    return s_autoindex;
+}
+
 static bool is_api_route(const char *uri)
 {
     return (strncmp(uri, "/api/", 5) == 0 || strncmp(uri, "/ws", 3) == 0);
 }
 
-static esp_err_t serve_file(httpd_req_t *req, const char *real_path)
+typedef struct
+{
+    const char *field;
+    const char *value;
+} resp_hdr_t;
+
+static esp_err_t send_all(httpd_req_t *req, const char *buf, size_t len)
+{
+    while (len > 0)
+    {
+        int sent = httpd_send(req, buf, len);
+        if (sent == HTTPD_SOCK_ERR_TIMEOUT)
+        {
+            continue;
+        }
+        if (sent <= 0)
+        {
+            return ESP_FAIL;
+        }
+        http_access_note_bytes(req, (size_t)sent);
+        buf += sent;
+        len -= (size_t)sent;
+    }
+    return ESP_OK;
+}
+
+/* esp_http_server can only stream bodies with chunked encoding, so the head is
+   written by hand to stream a body of known Content-Length. httpd_send() bypasses
+   the access-log wrappers, so the status and bytes are noted here. */
+static esp_err_t send_head(httpd_req_t *req, const char *status, const char *type, size_t length,
+                           const resp_hdr_t *hdrs, size_t hdr_count)
 {
+    char head[RESP_HEAD_MAX];
+    int len = snprintf(head, sizeof(head), "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %u\r\n", status, type,
+                       (unsigned)length);
+    for (size_t i = 0; i < hdr_count && len > 0 && (size_t)len < sizeof(head); i++)
+    {
+        if (hdrs[i].value != NULL && hdrs[i].value[0] != '\0')
+        {
+            len += snprintf(head + len, sizeof(head) - (size_t)len, "%s: %s\r\n", hdrs[i].field, hdrs[i].value);
+        }
+    }
+    if (len < 0 || (size_t)len + 2 >= sizeof(head))
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(head + len, "\r\n", 2);
+    http_access_note_status(req, (unsigned)atoi(status));
+    return send_all(req, head, (size_t)len + 2);
+}
+
+static bool if_range_allows(httpd_req_t *req, const char *etag, time_t mtime)
+{
+    char if_range[64];
+    bool present = httpd_req_get_hdr_value_str(req, "If-Range", if_range, sizeof(if_range)) == ESP_OK;
+    return http_if_range_matches(present ? if_range : NULL, etag, mtime);
+}
+
+static void set_headers(httpd_req_t *req, const resp_hdr_t *hdrs, size_t hdr_count)
+{
+    for (size_t i = 0; i < hdr_count; i++)
+    {
+        if (hdrs[i].value != NULL && hdrs[i].value[0] != '\0')
+        {
+            httpd_resp_set_hdr(req, hdrs[i].field, hdrs[i].value);
+        }
+    }
+}
+
+/* Small files are served from the RAM cache with a single httpd_resp_send() */
+static esp_err_t send_buffer(httpd_req_t *req, const char *status, const char *type, const char *data, size_t len,
+                             const resp_hdr_t *hdrs, size_t hdr_count)
+{
+    set_headers(req, hdrs, hdr_count);
+    httpd_resp_set_status(req, status);
+    httpd_resp_set_type(req, type);
+    return httpd_resp_send(req, data, (ssize_t)len);
+}
+
+static const http_file_cache_entry_t *cache_load(const char *real_path, const struct stat *st)
+{
+    size_t size = (size_t)st->st_size;
+    const http_file_cache_entry_t *entry = http_file_cache_acquire(real_path, size, st->st_mtime);
+    if (entry != NULL)
+    {
+        return entry;
+    }
+
+    uint8_t *data = malloc(size > 0 ? size : 1);
+    if (data == NULL)
+    {
+        return NULL;
+    }
+    FILE *f = fopen(real_path, "rb");
+    if (f == NULL)
+    {
+        free(data);
+        return NULL;
+    }
+    size_t n = fread(data, 1, size, f);
+    fclose(f);
+    vfs_count_read(n);
+
+    if (n == size)
+    {
+        entry = http_file_cache_put(real_path, size, st->st_mtime, data);
+    }
+    if (entry == NULL)
+    {
+        free(data);
+    }
+    return entry;
+}
+
+static esp_err_t static_async_handler(httpd_req_t *req);
+
+/*
+ * Text files are gzip-compressed on the fly for clients that accept it. The
+ * compressed length is not known up front, so the body goes out chunked
+ * through http_stream, from the RAM cache when the file is there.
+ */
+static esp_err_t serve_file_gzip(httpd_req_t *req, const char *real_path, const struct stat *st, const char *type,
+                                 const resp_hdr_t *hdrs, size_t hdr_count)
+{
+    /* Compressing costs CPU time; keep it off the httpd task */
+    if (http_async_defer(req, static_async_handler))
+    {
+        return ESP_OK;
+    }
+
+    size_t size = (size_t)st->st_size;
+    const http_file_cache_entry_t *entry = size <= HTTP_FILE_CACHE_MAX_FILE ? cache_load(real_path, st) : NULL;
+    FILE *f = NULL;
+    if (entry == NULL)
+    {
+        f = fopen(real_path, "rb");
+        if (f == NULL)
+        {
+            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Read failed");
+            return ESP_FAIL;
+        }
+    }
+
+    set_headers(req, hdrs, hdr_count);
+    httpd_resp_set_type(req, type);
+    http_stream_t out;
+    http_stream_init(&out, req);
+    http_stream_gzip(&out);
+
+    if (entry != NULL)
+    {
+        http_stream_write(&out, (const char *)entry->data, size);
+        http_file_cache_release(entry);
+    }
+    else
+    {
+        char chunk[CHUNK_SIZE];
+        size_t n;
+        while (out.err == ESP_OK && (n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+        {
+            vfs_count_read(n);
+            http_stream_write(&out, chunk, n);
+        }
+        fclose(f);
+    }
+    return http_stream_finish(&out);
+}
+
+static esp_err_t serve_file(httpd_req_t *req, const char *real_path, const struct stat *st)
+{
+    size_t size = (size_t)st->st_size;
+
+    const char *type = http_mime_type(real_path);
+    bool compressible = http_mime_is_compressible(type);
+    char range_hdr[64];
+    bool has_range = httpd_req_get_hdr_value_str(req, "Range", range_hdr, sizeof(range_hdr)) == ESP_OK;
+
+    /* Ranges address the identity body, so ranged requests are served plain. Bodies
+       that fit in one segment gain nothing from compression. */
+    bool gzip = compressible && !has_range && size > HTTP_STREAM_CHUNK && http_stream_accepts_gzip(req);
+
+    /* Each encoding needs its own strong validator */
+    char etag[HTTP_ETAG_MAX];
+    http_etag_format(size, st->st_mtime, etag, sizeof(etag));
+    size_t etag_len = strlen(etag);
+    if (gzip && etag_len >= 2)
+    {
+        strcpy(etag + etag_len - 1, "-gz\"");
+    }
+    const char *vary = compressible ? "Accept-Encoding" : NULL;
+
+    char last_modified[HTTP_DATE_LEN] = {0};
+    if (st->st_mtime > 0)
+    {
+        http_date_format(st->st_mtime, last_modified, sizeof(last_modified));
+    }
+
+    char if_none_match[128] = {0};
+    char if_modified_since[HTTP_DATE_LEN + 2] = {0};
+    httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match));
+    httpd_req_get_hdr_value_str(req, "If-Modified-Since", if_modified_since, sizeof(if_modified_since));
+
+    /* Revalidation costs one stat() and no reads */
+    if (http_is_not_modified(if_none_match, if_modified_since, etag, st->st_mtime))
+    {
+        httpd_resp_set_hdr(req, "Cache-Control", "max-age=600");
+        httpd_resp_set_hdr(req, "ETag", etag);
+        if (last_modified[0] != '\0')
+        {
+            httpd_resp_set_hdr(req, "Last-Modified", last_modified);
+        }
+        if (vary != NULL)
+        {
+            httpd_resp_set_hdr(req, "Vary", vary);
+        }
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    if (gzip)
+    {
+        /* http_stream adds Content-Encoding and Vary once compression starts */
+        const resp_hdr_t gz_hdrs[] = {
+            {"Cache-Control", "max-age=600"},
+            {"ETag", etag},
+            {"Last-Modified", last_modified},
+        };
+        return serve_file_gzip(req, real_path, st, type, gz_hdrs, sizeof(gz_hdrs) / sizeof(gz_hdrs[0]));
+    }
+
+    size_t start = 0;
+    size_t end = (size > 0) ? size - 1 : 0;
+    bool partial = false;
+    if (has_range && if_range_allows(req, etag, st->st_mtime))
+    {
+        esp_err_t rerr = http_range_parse(range_hdr, size, &start, &end);
+        if (rerr == ESP_ERR_INVALID_SIZE)
+        {
+            char unsatisfied[32];
+            snprintf(unsatisfied, sizeof(unsatisfied), "bytes */%u", (unsigned)size);
+            httpd_resp_set_hdr(req, "Content-Range", unsatisfied);
+            httpd_resp_set_status(req, "416 Range Not Satisfiable");
+            return httpd_resp_send(req, NULL, 0);
+        }
+        partial = (rerr == ESP_OK);
+    }
+
+    size_t remaining = (size > 0) ? end - start + 1 : 0;
+
+    char content_range[64] = {0};
+    if (partial)
+    {
+        snprintf(content_range, sizeof(content_range), "bytes %u-%u/%u", (unsigned)start, (unsigned)end,
+                 (unsigned)size);
+    }
+    const resp_hdr_t hdrs[] = {
+        {"Accept-Ranges", "bytes"},
+        {"Cache-Control", "max-age=600"},
+        {"ETag", etag},
+        {"Last-Modified", last_modified},
+        {"Content-Range", content_range},
+        {"Vary", vary},
+    };
+    const char *status = partial ? "206 Partial Content" : "200 OK";
+
+    if (size <= HTTP_FILE_CACHE_MAX_FILE)
+    {
+        const http_file_cache_entry_t *entry = cache_load(real_path, st);
+        if (entry != NULL)
+        {
+            esp_err_t err = send_buffer(req, status, type, (const char *)entry->data + start, remaining, hdrs,
+                                        sizeof(hdrs) / sizeof(hdrs[0]));
+            http_file_cache_release(entry);
+            return err;
+        }
+    }
+
+    /* Streaming from flash is slow; let a worker do it so the httpd task keeps accepting */
+    if (http_async_defer(req, static_async_handler))
+    {
+        return ESP_OK;
+    }
+
     FILE *f = fopen(real_path, "rb");
     if (!f)
     {
         httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Read failed");
         return ESP_FAIL;
     }
+    if (start > 0 && fseek(f, (long)start, SEEK_SET) != 0)
+    {
+        fclose(f);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Seek failed");
+        return ESP_FAIL;
+    }
 
-    httpd_resp_set_type(req, http_mime_type(real_path));
-    httpd_resp_set_hdr(req, "Cache-Control", "max-age=600");
+    esp_err_t err = send_head(req, status, type, remaining, hdrs, sizeof(hdrs) / sizeof(hdrs[0]));
 
     char chunk[CHUNK_SIZE];
-    size_t n;
-    do
+    while (err == ESP_OK && remaining > 0)
     {
-        n = fread(chunk, 1, sizeof(chunk), f);
-        if (n > 0)
+        size_t want = remaining < sizeof(chunk) ? remaining : sizeof(chunk);
+        size_t n = fread(chunk, 1, want, f);
+        if (n == 0)
         {
-            if (httpd_resp_send_chunk(req, chunk, n) != ESP_OK)
-            {
-                fclose(f);
-                httpd_resp_send_chunk(req, NULL, 0);
-                return ESP_FAIL;
-            }
+            err = ESP_FAIL;
+            break;
         }
-    } while (n > 0);
+        vfs_count_read(n);
+        err = send_all(req, chunk, n);
+        remaining -= n;
+    }
 
     fclose(f);
-    httpd_resp_send_chunk(req, NULL, 0);
-    return ESP_OK;
+    return err;
+}
+
+/*
+ * The listing is written while the directory is read, so the validator has to
+ * be known up front: a first pass hashes every entry as the page shows it
+ * (name, size, mtime), combined with the directory mtime. A log file growing
+ * in place changes it, so the revalidation browsers are told to do on every
+ * view only saves the page when nothing shown on it changed.
+ */
+static esp_err_t serve_autoindex(httpd_req_t *req, const char *uri_path, const char *virtual_path,
+                                 const struct stat *st)
+{
+    /* Listing a large SD directory is slow; keep it off the httpd task */
+    if (http_async_defer(req, static_async_handler))
+    {
+        return ESP_OK;
+    }
+
+    vfs_dir_t *dir = NULL;
+    if (vfs_dir_open(virtual_path, &dir) != ESP_OK)
+    {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Not found");
+        return ESP_OK;
+    }
+
+    vfs_dir_entry_t entry;
+    uint32_t hash = HTTP_AUTOINDEX_HASH_INIT;
+    while (vfs_dir_next(dir, &entry) == ESP_OK)
+    {
+        hash = http_autoindex_hash(hash, &entry);
+    }
+    char etag[HTTP_ETAG_MAX];
+    http_autoindex_etag(st->st_mtime, hash, etag, sizeof(etag));
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    httpd_resp_set_hdr(req, "ETag", etag);
+
+    char if_none_match[128];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) == ESP_OK &&
+        http_etag_matches(if_none_match, etag))
+    {
+        vfs_dir_close(dir);
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    httpd_resp_set_type(req, "text/html");
+    http_stream_t out;
+    http_stream_init(&out, req);
+    http_stream_gzip(&out);
+    http_autoindex_begin(&out, uri_path);
+    vfs_dir_rewind(dir);
+    while (out.err == ESP_OK && vfs_dir_next(dir, &entry) == ESP_OK)
+    {
+        http_autoindex_entry(&out, &entry);
+    }
+    vfs_dir_close(dir);
+    http_autoindex_end(&out);
+    return http_stream_finish(&out);
+}
+
+/* A directory is served as its index.html, else as a listing when autoindex is on.
+   uri_path is decoded, raw_uri as requested (for the redirect). Returns
+   ESP_ERR_NOT_FOUND when neither applies, so the caller falls back. */
+static esp_err_t serve_directory(httpd_req_t *req, const char *uri_path, const char *raw_uri,
+                                 const char *virtual_path, const char *real_path, const struct stat *st)
+{
+    char index_real[REAL_PATH_MAX];
+    size_t rp_len = strlen(real_path);
+    snprintf(index_real, sizeof(index_real), "%s%sindex.html", real_path,
+             (rp_len > 0 && real_path[rp_len - 1] == '/') ? "" : "/");
+
+    struct stat index_st;
+    bool has_index = stat(index_real, &index_st) == 0 && !S_ISDIR(index_st.st_mode);
+    if (!has_index && !s_autoindex)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    /* Relative links inside the page need the trailing slash */
+    size_t len = strlen(uri_path);
+    if (len == 0 || uri_path[len - 1] != '/')
+    {
+        char location[REAL_PATH_MAX];
+        snprintf(location, sizeof(location), "%s/", raw_uri);
+        httpd_resp_set_status(req, "301 Moved Permanently");
+        httpd_resp_set_hdr(req, "Location", location);
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    if (has_index)
+    {
+        return serve_file(req, index_real, &index_st);
+    }
+    return serve_autoindex(req, uri_path, virtual_path, st);
+}
+
+/* Embedded assets carry precomputed MIME, ETag and length and are sent straight from flash */
+static esp_err_t serve_bundle_asset(httpd_req_t *req, const http_bundle_asset_t *asset)
+{
+    httpd_resp_set_hdr(req, "Cache-Control", "max-age=600");
+    httpd_resp_set_hdr(req, "ETag", asset->etag);
+    httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+
+    char if_none_match[128];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) == ESP_OK &&
+        http_etag_matches(if_none_match, asset->etag))
+    {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    httpd_resp_set_type(req, asset->mime);
+    return httpd_resp_send(req, (const char *)asset->data, (ssize_t)asset->len);
+}
+
+/* A decoded "%2E%2E" must not climb out of the static root */
+static bool has_dot_dot_segment(const char *path)
+{
+    for (const char *p = strstr(path, ".."); p != NULL; p = strstr(p + 1, ".."))
+    {
+        if ((p == path || p[-1] == '/') && (p[2] == '\0' || p[2] == '/'))
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
 esp_err_t http_static_handler(httpd_req_t *req, httpd_err_code_t err_code)
@@ -182,19 +623,28 @@ esp_err_t http_static_handler(httpd_req_t *req, httpd_err_code_t err_code)
         return ESP_OK;
     }
 
-    /* Strip query string */
-    char clean_uri[128];
-    strncpy(clean_uri, uri, sizeof(clean_uri) - 1);
-    clean_uri[sizeof(clean_uri) - 1] = '\0';
-    char *q = strchr(clean_uri, '?');
+    /* Strip query string, then decode: listing links percent-encode names */
+    char raw_uri[128];
+    strncpy(raw_uri, uri, sizeof(raw_uri) - 1);
+    raw_uri[sizeof(raw_uri) - 1] = '\0';
+    char *q = strchr(raw_uri, '?');
     if (q)
     {
         *q = '\0';
     }
+    char clean_uri[128];
+    if (http_path_decode(raw_uri, clean_uri, sizeof(clean_uri)) != ESP_OK || has_dot_dot_segment(clean_uri))
+    {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Not found");
+        return ESP_OK;
+    }
 
-    if (strcmp(clean_uri, "/") == 0)
+    bool gzip_ok = http_stream_accepts_gzip(req);
+    const char *bundle_uri = strcmp(clean_uri, "/") == 0 ? "/index.html" : clean_uri;
+    const http_bundle_asset_t *asset = gzip_ok ? http_bundle_find(bundle_uri) : NULL;
+    if (asset != NULL)
     {
-        strncpy(clean_uri, "/index.html", sizeof(clean_uri) - 1);
+        return serve_bundle_asset(req, asset);
     }
 
     /* Resolve root + URI to real filesystem path */
@@ -211,7 +661,15 @@ esp_err_t http_static_handler(httpd_req_t *req, httpd_err_code_t err_code)
     struct stat st;
     if (stat(real_path, &st) == 0)
     {
-        return serve_file(req, real_path);
+        if (!S_ISDIR(st.st_mode))
+        {
+            return serve_file(req, real_path, &st);
+        }
+        esp_err_t err = serve_directory(req, clean_uri, raw_uri, virtual_path, real_path, &st);
+        if (err != ESP_ERR_NOT_FOUND)
+        {
+            return err;
+        }
     }
 
     /* SPA fallback: serve index.html for unmatched paths */
@@ -223,10 +681,22 @@ esp_err_t http_static_handler(httpd_req_t *req, httpd_err_code_t err_code)
         char index_real[REAL_PATH_MAX];
         if (vfs_resolve_path(index_virtual, index_real, sizeof(index_real)) == ESP_OK && stat(index_real, &st) == 0)
         {
-            return serve_file(req, index_real);
+            return serve_file(req, index_real, &st);
+        }
+
+        asset = gzip_ok ? http_bundle_find("/index.html") : NULL;
+        if (asset != NULL)
+        {
+            return serve_bundle_asset(req, asset);
         }
     }
 
     httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Not found");
     return ESP_OK;
 }
+
+/* Worker-side entry point: re-runs the lookup with the detached request */
+static esp_err_t static_async_handler(httpd_req_t *req)
+{
+    return http_static_handler(req, HTTPD_404_NOT_FOUND);
+}
@@ -0,0 +1,228 @@
+#include "http_stream.h"
+#include "http_deflate.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+/* The encoder emits 512-byte pieces; they are collected into full chunks here */
+struct http_stream_gzip
+{
+    http_deflate_t z;
+    size_t len;
+    char out[HTTP_STREAM_CHUNK];
+};
+
+void http_stream_init(http_stream_t *s, httpd_req_t *req)
+{
+    s->req = req;
+    s->sink = NULL;
+    s->sink_ctx = NULL;
+    s->err = ESP_OK;
+    s->started = false;
+    s->gzip_wanted = false;
+    s->gz = NULL;
+    s->len = 0;
+}
+
+void http_stream_init_sink(http_stream_t *s, http_stream_sink_t sink, void *ctx)
+{
+    http_stream_init(s, NULL);
+    s->sink = sink;
+    s->sink_ctx = ctx;
+}
+
+static esp_err_t emit_raw(http_stream_t *s, const char *data, size_t len)
+{
+    if (s->err != ESP_OK)
+    {
+        return s->err;
+    }
+    s->started = true;
+    s->err = s->sink ? s->sink(s->sink_ctx, data, len) : httpd_resp_send_chunk(s->req, data, len);
+    return s->err;
+}
+
+static esp_err_t gzip_sink(void *ctx, const uint8_t *data, size_t len)
+{
+    http_stream_t *s = ctx;
+    struct http_stream_gzip *gz = s->gz;
+    while (len > 0 && s->err == ESP_OK)
+    {
+        size_t n = HTTP_STREAM_CHUNK - gz->len;
+        if (n > len)
+        {
+            n = len;
+        }
+        memcpy(gz->out + gz->len, data, n);
+        gz->len += n;
+        data += n;
+        len -= n;
+
+        if (gz->len == HTTP_STREAM_CHUNK)
+        {
+            gz->len = 0;
+            emit_raw(s, gz->out, HTTP_STREAM_CHUNK);
+        }
+    }
+    return s->err;
+}
+
+/* Called with the first full chunk: from here on the body goes through the encoder */
+static void gzip_start(http_stream_t *s)
+{
+    s->gzip_wanted = false;
+    s->gz = malloc(sizeof(*s->gz));
+    if (s->gz == NULL)
+    {
+        return;
+    }
+    s->gz->len = 0;
+    if (s->req != NULL)
+    {
+        httpd_resp_set_hdr(s->req, "Content-Encoding", "gzip");
+        httpd_resp_set_hdr(s->req, "Vary", "Accept-Encoding");
+    }
+    s->started = true;
+    s->err = http_gzip_init(&s->gz->z, gzip_sink, s);
+}
+
+static esp_err_t emit(http_stream_t *s, const char *data, size_t len)
+{
+    if (s->err != ESP_OK)
+    {
+        return s->err;
+    }
+    if (s->gzip_wanted)
+    {
+        gzip_start(s);
+    }
+    if (s->gz == NULL)
+    {
+        return emit_raw(s, data, len);
+    }
+    if (s->err == ESP_OK)
+    {
+        s->err = http_gzip_write(&s->gz->z, (const uint8_t *)data, len);
+    }
+    return s->err;
+}
+
+bool http_stream_accepts_gzip(httpd_req_t *req)
+{
+    char accept[128];
+    if (httpd_req_get_hdr_value_str(req, "Accept-Encoding", accept, sizeof(accept)) != ESP_OK)
+    {
+        return false;
+    }
+
+    /* "gzip" (or "*") as one of the listed codings, unless its q-value is 0 */
+    char *save = NULL;
+    for (char *tok = strtok_r(accept, ",", &save); tok != NULL; tok = strtok_r(NULL, ",", &save))
+    {
+        tok += strspn(tok, " \t");
+        size_t n = strcspn(tok, " \t;");
+        if ((n == 4 && strncasecmp(tok, "gzip", 4) == 0) || (n == 1 && tok[0] == '*'))
+        {
+            const char *q = strstr(tok + n, "q=");
+            return q == NULL || strtod(q + 2, NULL) > 0.0;
+        }
+    }
+    return false;
+}
+
+void http_stream_gzip(http_stream_t *s)
+{
+    s->gzip_wanted = s->req == NULL || http_stream_accepts_gzip(s->req);
+}
+
+esp_err_t http_stream_write(http_stream_t *s, const char *data, size_t len)
+{
+    while (len > 0 && s->err == ESP_OK)
+    {
+        /* Large writes skip the copy once the buffer has been drained */
+        if (s->len == 0 && len >= HTTP_STREAM_CHUNK)
+        {
+            return emit(s, data, len);
+        }
+
+        size_t n = HTTP_STREAM_CHUNK - s->len;
+        if (n > len)
+        {
+            n = len;
+        }
+        memcpy(s->buf + s->len, data, n);
+        s->len += n;
+        data += n;
+        len -= n;
+
+        if (s->len == HTTP_STREAM_CHUNK)
+        {
+            emit(s, s->buf, s->len);
+            s->len = 0;
+        }
+    }
+    return s->err;
+}
+
+esp_err_t http_stream_puts(http_stream_t *s, const char *str)
+{
+    return http_stream_write(s, str, strlen(str));
+}
+
+esp_err_t http_stream_printf(http_stream_t *s, const char *fmt, ...)
+{
+    char tmp[128];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(tmp, sizeof(tmp), fmt, ap);
+    va_end(ap);
+    if (n < 0)
+    {
+        return s->err;
+    }
+    return http_stream_write(s, tmp, (size_t)n < sizeof(tmp) ? (size_t)n : sizeof(tmp) - 1);
+}
+
+esp_err_t http_stream_flush(http_stream_t *s)
+{
+    if (s->len > 0)
+    {
+        emit(s, s->buf, s->len);
+        s->len = 0;
+    }
+    return s->err;
+}
+
+esp_err_t http_stream_finish(http_stream_t *s)
+{
+    /* A body still in its first chunk is not worth compressing */
+    s->gzip_wanted = false;
+
+    /* Fits in one chunk: a plain response with Content-Length costs a single send */
+    if (s->err == ESP_OK && !s->started && s->sink == NULL)
+    {
+        s->started = true;
+        s->err = httpd_resp_send(s->req, s->buf, s->len);
+        s->len = 0;
+        return s->err;
+    }
+
+    http_stream_flush(s);
+    if (s->gz != NULL)
+    {
+        if (s->err == ESP_OK)
+        {
+            s->err = http_gzip_finish(&s->gz->z);
+        }
+        if (s->gz->len > 0)
+        {
+            emit_raw(s, s->gz->out, s->gz->len);
+        }
+        free(s->gz);
+        s->gz = NULL;
+    }
+    return emit_raw(s, NULL, 0);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Buffered response body. Writes are collected into one fixed chunk and only
+ * handed on when it is full, so a response goes out in MSS-sized pieces
+ * instead of one socket send per snprintf. Writes of a chunk or more go out
+ * directly whenever the buffer is empty. A body that never fills the chunk is
+ * sent in one piece with a Content-Length instead of chunked encoding.
+ *
+ * Optionally the body is gzip-compressed on the way out (http_stream_gzip()).
+ * Compression starts only once the body outgrows the first chunk: a body that
+ * fits goes out in one send either way, and skipping it saves the ~12 KB
+ * encoder allocation and the CPU time.
+ */
+
+#ifndef HTTP_STREAM_CHUNK
+#define HTTP_STREAM_CHUNK 1460
+#endif
+
+/* Receives each full chunk; a final call with len == 0 marks the end of the body */
+typedef esp_err_t (*http_stream_sink_t)(void *ctx, const char *data, size_t len);
+
+struct http_stream_gzip;
+
+typedef struct
+{
+    httpd_req_t *req;
+    http_stream_sink_t sink;
+    void *sink_ctx;
+    esp_err_t err;
+    bool started;
+    bool gzip_wanted;
+    struct http_stream_gzip *gz; /* encoder while compressing, else NULL */
+    size_t len;
+    char buf[HTTP_STREAM_CHUNK];
+} http_stream_t;
+
+/* Stream into the response of `req`; set status and type before the first flush */
+void http_stream_init(http_stream_t *s, httpd_req_t *req);
+
+/* Stream into an arbitrary sink instead of a response */
+void http_stream_init_sink(http_stream_t *s, http_stream_sink_t sink, void *ctx);
+
+/* True if the request's Accept-Encoding allows gzip */
+bool http_stream_accepts_gzip(httpd_req_t *req);
+
+/* Compress the body if it outgrows one chunk. For a response this applies only
+   when the client accepts gzip, and sets Content-Encoding and Vary when
+   compression starts. Call before the first write; falls back to plain output
+   if the encoder cannot be allocated. Not for streams that rely on
+   http_stream_flush() reaching the client (e.g. event streams). */
+void http_stream_gzip(http_stream_t *s);
+
+/* Errors are sticky: after the first failure every call returns it and writes nothing */
+esp_err_t http_stream_write(http_stream_t *s, const char *data, size_t len);
+esp_err_t http_stream_puts(http_stream_t *s, const char *str);
+
+/* Formatted output, at most 127 bytes per call */
+esp_err_t http_stream_printf(http_stream_t *s, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+/* Send whatever is buffered now, even if the chunk is not full */
+esp_err_t http_stream_flush(http_stream_t *s);
+
+/* Send the rest and end the body; also releases the gzip encoder, so call it on error paths too */
+esp_err_t http_stream_finish(http_stream_t *s);
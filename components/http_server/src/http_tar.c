@@ -0,0 +1,438 @@
+#include "http_tar.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NAME_LEN 100
+#define PREFIX_LEN 155
+
+/* Field offsets within a ustar header */
+#define OFF_NAME 0
+#define OFF_MODE 100
+#define OFF_UID 108
+#define OFF_GID 116
+#define OFF_SIZE 124
+#define OFF_MTIME 136
+#define OFF_CHKSUM 148
+#define OFF_TYPEFLAG 156
+#define OFF_MAGIC 257
+#define OFF_VERSION 263
+#define OFF_UNAME 265
+#define OFF_GNAME 297
+#define OFF_PREFIX 345
+
+/* Write `value` as zero-padded octal filling width-1 digits plus a NUL */
+static bool put_octal(uint8_t *field, size_t width, uint64_t value)
+{
+    char tmp[24];
+    int n = snprintf(tmp, sizeof(tmp), "%0*llo", (int)(width - 1), (unsigned long long)value);
+    if (n < 0 || (size_t)n != width - 1)
+    {
+        return false;
+    }
+    memcpy(field, tmp, width);
+    return true;
+}
+
+static esp_err_t put_name(uint8_t *block, const char *name, bool is_dir)
+{
+    char full[NAME_LEN + PREFIX_LEN + 2];
+    int n = snprintf(full, sizeof(full), "%s%s", name, is_dir ? "/" : "");
+    if (n <= 0 || (size_t)n >= sizeof(full))
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    size_t len = (size_t)n;
+
+    if (len <= NAME_LEN)
+    {
+        memcpy(block + OFF_NAME, full, len);
+        return ESP_OK;
+    }
+
+    /* Split at the last '/' that leaves both halves within their fields */
+    for (size_t i = len - 1; i > 0; i--)
+    {
+        if (full[i] != '/' || (is_dir && i == len - 1))
+        {
+            continue;
+        }
+        size_t tail = len - i - 1;
+        if (i > PREFIX_LEN)
+        {
+            continue;
+        }
+        if (tail == 0 || tail > NAME_LEN)
+        {
+            break;
+        }
+        memcpy(block + OFF_PREFIX, full, i);
+        memcpy(block + OFF_NAME, full + i + 1, tail);
+        return ESP_OK;
+    }
+    return ESP_ERR_INVALID_SIZE;
+}
+
+esp_err_t http_tar_header(uint8_t block[HTTP_TAR_BLOCK], const char *name, uint64_t size, time_t mtime, bool is_dir)
+{
+    if (block == NULL || name == NULL || name[0] == '\0')
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(block, 0, HTTP_TAR_BLOCK);
+    esp_err_t err = put_name(block, name, is_dir);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    if (!put_octal(block + OFF_MODE, 8, is_dir ? 0755 : 0644) || !put_octal(block + OFF_UID, 8, 0) ||
+        !put_octal(block + OFF_GID, 8, 0) || !put_octal(block + OFF_SIZE, 12, is_dir ? 0 : size) ||
+        !put_octal(block + OFF_MTIME, 12, mtime > 0 ? (uint64_t)mtime : 0))
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    block[OFF_TYPEFLAG] = is_dir ? '5' : '0';
+    memcpy(block + OFF_MAGIC, "ustar", 6);
+    memcpy(block + OFF_VERSION, "00", 2);
+    memcpy(block + OFF_UNAME, "root", 4);
+    memcpy(block + OFF_GNAME, "root", 4);
+
+    /* Checksum is computed with its own field read as spaces */
+    memset(block + OFF_CHKSUM, ' ', 8);
+    unsigned sum = 0;
+    for (size_t i = 0; i < HTTP_TAR_BLOCK; i++)
+    {
+        sum += block[i];
+    }
+    char chk[8];
+    snprintf(chk, sizeof(chk), "%06o", sum & 0777777);
+    memcpy(block + OFF_CHKSUM, chk, 7);
+    block[OFF_CHKSUM + 7] = ' ';
+    return ESP_OK;
+}
+
+size_t http_tar_padding(uint64_t size)
+{
+    return (size_t)((HTTP_TAR_BLOCK - (size % HTTP_TAR_BLOCK)) % HTTP_TAR_BLOCK);
+}
+
+enum
+{
+    READ_HEADER,
+    READ_DATA,
+    READ_META,
+    READ_PADDING,
+    READ_END,
+};
+
+/* Numeric field: octal text, or GNU base-256 when the top bit of the first byte is set */
+static uint64_t get_number(const uint8_t *field, size_t width)
+{
+    uint64_t value = 0;
+    if (field[0] & 0x80)
+    {
+        value = field[0] & 0x3f;
+        for (size_t i = 1; i < width; i++)
+        {
+            value = (value << 8) | field[i];
+        }
+        return value;
+    }
+
+    size_t i = 0;
+    while (i < width && field[i] == ' ')
+    {
+        i++;
+    }
+    for (; i < width && field[i] >= '0' && field[i] <= '7'; i++)
+    {
+        value = (value << 3) | (uint64_t)(field[i] - '0');
+    }
+    return value;
+}
+
+static bool header_checksum_ok(const uint8_t *block)
+{
+    uint64_t stored = get_number(block + OFF_CHKSUM, 8);
+    unsigned sum = 0;
+    int signed_sum = 0;
+    for (size_t i = 0; i < HTTP_TAR_BLOCK; i++)
+    {
+        uint8_t c = (i >= OFF_CHKSUM && i < OFF_CHKSUM + 8) ? ' ' : block[i];
+        sum += c;
+        signed_sum += (int8_t)c;
+    }
+    /* Some historic writers summed signed chars */
+    return stored == sum || stored == (uint64_t)(unsigned)signed_sum;
+}
+
+static bool is_zero_block(const uint8_t *block)
+{
+    for (size_t i = 0; i < HTTP_TAR_BLOCK; i++)
+    {
+        if (block[i] != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Copy a name, dropping leading "/" and "./" and trailing "/"; false if it does not fit */
+static bool set_name(char *dst, const char *src, size_t len)
+{
+    while (len > 0 && (src[0] == '/' || (src[0] == '.' && (len == 1 || src[1] == '/'))))
+    {
+        src++;
+        len--;
+    }
+    while (len > 0 && src[len - 1] == '/')
+    {
+        len--;
+    }
+    if (len >= HTTP_TAR_NAME_MAX)
+    {
+        dst[0] = '\0';
+        return false;
+    }
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+    return true;
+}
+
+static size_t field_len(const uint8_t *field, size_t width)
+{
+    const uint8_t *end = memchr(field, '\0', width);
+    return end ? (size_t)(end - field) : width;
+}
+
+/* Pick the "path" record out of a pax extended header ("<len> key=value\n" records) */
+static void parse_pax(http_tar_reader_t *r)
+{
+    size_t pos = 0;
+    while (pos < r->meta_len)
+    {
+        char *end;
+        unsigned long rec_len = strtoul(r->meta + pos, &end, 10);
+        if (rec_len == 0 || *end != ' ' || pos + rec_len > r->meta_len)
+        {
+            return;
+        }
+        const char *key = end + 1;
+        const char *rec_end = r->meta + pos + rec_len - 1; /* the '\n' */
+        if (rec_end > key + 5 && strncmp(key, "path=", 5) == 0)
+        {
+            const char *value = key + 5;
+            r->long_name_bad = !set_name(r->long_name, value, (size_t)(rec_end - value));
+        }
+        pos += rec_len;
+    }
+}
+
+static void finish_meta(http_tar_reader_t *r)
+{
+    r->meta[r->meta_len] = '\0';
+    if (r->meta_type == 'L')
+    {
+        /* A name cut short by HTTP_TAR_META_MAX is longer than HTTP_TAR_NAME_MAX anyway */
+        r->long_name_bad = !set_name(r->long_name, r->meta, strlen(r->meta));
+        return;
+    }
+    parse_pax(r);
+}
+
+static void enter_data(http_tar_reader_t *r, uint64_t size, int state)
+{
+    r->remaining = size;
+    r->padding = http_tar_padding(size);
+    r->state = state;
+}
+
+static esp_err_t end_entry(http_tar_reader_t *r)
+{
+    esp_err_t err = ESP_OK;
+    if (r->state == READ_META)
+    {
+        finish_meta(r);
+    }
+    else if (r->accepted && r->cb.on_end)
+    {
+        err = r->cb.on_end(r->cb.ctx);
+    }
+    r->accepted = false;
+    r->state = r->padding > 0 ? READ_PADDING : READ_HEADER;
+    return err;
+}
+
+static esp_err_t handle_header(http_tar_reader_t *r)
+{
+    const uint8_t *b = r->block;
+    if (is_zero_block(b))
+    {
+        r->state = READ_END;
+        return ESP_OK;
+    }
+    if (!header_checksum_ok(b))
+    {
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    uint64_t size = get_number(b + OFF_SIZE, 12);
+    char type = (char)b[OFF_TYPEFLAG];
+
+    if (type == 'L' || type == 'x')
+    {
+        r->meta_type = type;
+        r->meta_len = 0;
+        r->long_name[0] = '\0';
+        r->long_name_bad = false;
+        enter_data(r, size, READ_META);
+        return size == 0 ? end_entry(r) : ESP_OK;
+    }
+
+    http_tar_entry_t *e = &r->entry;
+    e->size = size;
+    e->mtime = (time_t)get_number(b + OFF_MTIME, 12);
+
+    bool name_ok;
+    if (r->meta_type != 0 && (r->long_name[0] != '\0' || r->long_name_bad))
+    {
+        memcpy(e->name, r->long_name, sizeof(e->name));
+        name_ok = !r->long_name_bad;
+    }
+    else
+    {
+        char full[PREFIX_LEN + 1 + NAME_LEN + 1];
+        size_t len = 0;
+        if (memcmp(b + OFF_MAGIC, "ustar", 5) == 0 && b[OFF_PREFIX] != '\0')
+        {
+            len = field_len(b + OFF_PREFIX, PREFIX_LEN);
+            memcpy(full, b + OFF_PREFIX, len);
+            full[len++] = '/';
+        }
+        size_t name_len = field_len(b + OFF_NAME, NAME_LEN);
+        memcpy(full + len, b + OFF_NAME, name_len);
+        len += name_len;
+        /* Pre-POSIX archives mark directories only with a trailing slash */
+        if (type == '\0' && len > 0 && full[len - 1] == '/')
+        {
+            type = '5';
+        }
+        name_ok = set_name(e->name, full, len);
+    }
+    r->meta_type = 0;
+    r->long_name[0] = '\0';
+    r->long_name_bad = false;
+
+    if (!name_ok)
+    {
+        e->type = HTTP_TAR_TYPE_OTHER;
+    }
+    else if (type == '0' || type == '\0' || type == '7')
+    {
+        e->type = HTTP_TAR_TYPE_FILE;
+    }
+    else if (type == '5')
+    {
+        e->type = HTTP_TAR_TYPE_DIR;
+    }
+    else
+    {
+        e->type = HTTP_TAR_TYPE_OTHER;
+    }
+
+    /* Global pax headers carry nothing we use */
+    esp_err_t err = ESP_OK;
+    if (type != 'g')
+    {
+        err = r->cb.on_entry(r->cb.ctx, e);
+    }
+    if (err != ESP_OK && err != ESP_ERR_NOT_SUPPORTED)
+    {
+        return err;
+    }
+    r->accepted = (err == ESP_OK && type != 'g');
+    enter_data(r, size, READ_DATA);
+    return size == 0 ? end_entry(r) : ESP_OK;
+}
+
+void http_tar_reader_init(http_tar_reader_t *r, const http_tar_callbacks_t *cb)
+{
+    memset(r, 0, sizeof(*r));
+    r->cb = *cb;
+    r->state = READ_HEADER;
+}
+
+esp_err_t http_tar_reader_write(http_tar_reader_t *r, const uint8_t *data, size_t len)
+{
+    while (len > 0 && r->state != READ_END)
+    {
+        size_t n;
+        esp_err_t err = ESP_OK;
+        switch (r->state)
+        {
+        case READ_HEADER:
+            n = HTTP_TAR_BLOCK - r->block_len;
+            n = n < len ? n : len;
+            memcpy(r->block + r->block_len, data, n);
+            r->block_len += n;
+            if (r->block_len == HTTP_TAR_BLOCK)
+            {
+                r->block_len = 0;
+                err = handle_header(r);
+            }
+            break;
+
+        case READ_DATA:
+        case READ_META:
+            n = r->remaining < len ? (size_t)r->remaining : len;
+            if (r->state == READ_META)
+            {
+                size_t room = HTTP_TAR_META_MAX - 1 - r->meta_len;
+                size_t copy = n < room ? n : room;
+                memcpy(r->meta + r->meta_len, data, copy);
+                r->meta_len += copy;
+            }
+            else if (r->accepted)
+            {
+                err = r->cb.on_data(r->cb.ctx, data, n);
+            }
+            r->remaining -= n;
+            if (err == ESP_OK && r->remaining == 0)
+            {
+                err = end_entry(r);
+            }
+            break;
+
+        default: /* READ_PADDING */
+            n = r->padding < len ? r->padding : len;
+            r->padding -= n;
+            if (r->padding == 0)
+            {
+                r->state = READ_HEADER;
+            }
+            break;
+        }
+
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+        data += n;
+        len -= n;
+    }
+    return ESP_OK;
+}
+
+esp_err_t http_tar_reader_finish(const http_tar_reader_t *r)
+{
+    if (r->state == READ_END || (r->state == READ_HEADER && r->block_len == 0))
+    {
+        return ESP_OK;
+    }
+    return ESP_ERR_INVALID_SIZE;
+}
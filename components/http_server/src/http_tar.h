@@ -0,0 +1,83 @@
+#pragma once
+
+#include "esp_err.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#define HTTP_TAR_BLOCK 512
+
+/*
+ * Build a POSIX ustar header block for a regular file or directory. Names
+ * longer than 100 bytes are split into the prefix field at a '/'.
+ * Returns ESP_ERR_INVALID_SIZE if the name cannot be represented.
+ */
+esp_err_t http_tar_header(uint8_t block[HTTP_TAR_BLOCK], const char *name, uint64_t size, time_t mtime, bool is_dir);
+
+/* Zero bytes needed after `size` bytes of file data to reach a block boundary */
+size_t http_tar_padding(uint64_t size);
+
+/* --- Streaming reader --- */
+
+#define HTTP_TAR_NAME_MAX 256
+#define HTTP_TAR_META_MAX (2 * HTTP_TAR_BLOCK)
+
+typedef enum
+{
+    HTTP_TAR_TYPE_FILE,
+    HTTP_TAR_TYPE_DIR,
+    HTTP_TAR_TYPE_OTHER, /* links, devices, or a name longer than HTTP_TAR_NAME_MAX */
+} http_tar_type_t;
+
+typedef struct
+{
+    char name[HTTP_TAR_NAME_MAX]; /* relative: leading "/" and "./" and any trailing "/" removed */
+    uint64_t size;
+    time_t mtime;
+    http_tar_type_t type;
+} http_tar_entry_t;
+
+/*
+ * on_entry returns ESP_OK to receive the entry's data, ESP_ERR_NOT_SUPPORTED
+ * to have it skipped, or any other error to abort. on_data and on_end are
+ * only called for accepted entries; on_end follows the last data byte.
+ */
+typedef struct
+{
+    esp_err_t (*on_entry)(void *ctx, const http_tar_entry_t *entry);
+    esp_err_t (*on_data)(void *ctx, const uint8_t *data, size_t len);
+    esp_err_t (*on_end)(void *ctx);
+    void *ctx;
+} http_tar_callbacks_t;
+
+typedef struct
+{
+    http_tar_callbacks_t cb;
+    int state;
+    bool accepted;
+    char meta_type;
+    size_t block_len;
+    size_t padding;
+    uint64_t remaining;
+    size_t meta_len;
+    http_tar_entry_t entry;
+    char long_name[HTTP_TAR_NAME_MAX];
+    bool long_name_bad;
+    uint8_t block[HTTP_TAR_BLOCK];
+    char meta[HTTP_TAR_META_MAX];
+} http_tar_reader_t;
+
+void http_tar_reader_init(http_tar_reader_t *r, const http_tar_callbacks_t *cb);
+
+/*
+ * Feed the next piece of the archive, in pieces of any size. GNU long names
+ * and pax "path" records are applied to the entry that follows them.
+ * Returns ESP_ERR_INVALID_CRC for a damaged header; data after the
+ * end-of-archive marker is ignored.
+ */
+esp_err_t http_tar_reader_write(http_tar_reader_t *r, const uint8_t *data, size_t len);
+
+/* Call at end of input: ESP_ERR_INVALID_SIZE if it stopped inside an entry */
+esp_err_t http_tar_reader_finish(const http_tar_reader_t *r);
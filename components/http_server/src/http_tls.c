@@ -0,0 +1,208 @@
+#include "http_tls.h"
+#include "http_server.h"
+#include "metrics.h"
+
+#include "esp_https_server.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_tls.h"
+#include "filesystem.h"
+#include "nvs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+static const char *const TAG = "http_tls";
+
+#define NVS_NAMESPACE "http_srv"
+#define NVS_KEY_TLS_MODE "tls_mode"
+
+#define HTTPS_PORT 443
+/* An RSA-2048 handshake runs on the httpd task and needs more stack than plain HTTP */
+#define HTTPS_STACK_SIZE 10240
+/* Each TLS session holds ~40 KiB of mbedTLS buffers; keep the count low without PSRAM */
+#define HTTPS_MAX_SOCKETS 3
+#define PEM_MAX (8 * 1024)
+
+/*
+ * Session tickets let a returning client skip the key exchange: the server
+ * hands out an encrypted ticket after the first handshake, and a client
+ * presenting it resumes with symmetric crypto only. Nothing is stored per
+ * client on the device, unlike a session cache. Handshake durations go into
+ * a histogram; full and resumed handshakes fall into clearly separate
+ * buckets (see `metrics cos_https`).
+ */
+
+static http_tls_mode_t s_mode = HTTP_TLS_OFF;
+static char *s_cert = NULL;
+static size_t s_cert_len = 0;
+static char *s_key = NULL;
+static size_t s_key_len = 0;
+static metric_t *s_handshake_ms = NULL;
+static metric_t *s_handshake_failures = NULL;
+
+static const uint32_t s_handshake_bounds[] = {10, 25, 50, 100, 250, 500, 1000, 2000, 4000, 8000};
+
+void http_tls_init(void)
+{
+    nvs_handle_t h;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &h) == ESP_OK)
+    {
+        uint8_t val = 0;
+        size_t len = sizeof(val);
+        if (nvs_get_blob(h, NVS_KEY_TLS_MODE, &val, &len) == ESP_OK && val <= HTTP_TLS_BOTH)
+        {
+            s_mode = (http_tls_mode_t)val;
+        }
+        nvs_close(h);
+    }
+
+    s_handshake_ms = metrics_histogram("cos_https_handshake_ms", "TLS handshake duration in milliseconds",
+                                       s_handshake_bounds, sizeof(s_handshake_bounds) / sizeof(s_handshake_bounds[0]));
+    s_handshake_failures = metrics_counter("cos_https_handshake_failures_total", "TLS handshakes that failed");
+}
+
+esp_err_t http_server_set_tls_mode(http_tls_mode_t mode)
+{
+    if (mode > HTTP_TLS_BOTH)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_mode = mode;
+
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &h);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    uint8_t val = (uint8_t)mode;
+    nvs_set_blob(h, NVS_KEY_TLS_MODE, &val, sizeof(val));
+    nvs_commit(h);
+    nvs_close(h);
+    return ESP_OK;
+}
+
+http_tls_mode_t http_server_get_tls_mode(void)
+{
+    return s_mode;
+}
+
+/* Read a PEM file; the length includes the terminator, as mbedTLS expects for PEM */
+static esp_err_t load_pem(const char *path, char **out, size_t *out_len)
+{
+    char real_path[VFS_PATH_MAX];
+    struct stat st;
+    if (vfs_resolve_path(path, real_path, sizeof(real_path)) != ESP_OK || stat(real_path, &st) != 0)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (st.st_size <= 0 || st.st_size > PEM_MAX)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    FILE *f = fopen(real_path, "rb");
+    if (f == NULL)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    char *buf = malloc((size_t)st.st_size + 1);
+    size_t n = buf != NULL ? fread(buf, 1, (size_t)st.st_size, f) : 0;
+    fclose(f);
+    if (buf == NULL || n != (size_t)st.st_size)
+    {
+        free(buf);
+        return buf == NULL ? ESP_ERR_NO_MEM : ESP_FAIL;
+    }
+    vfs_count_read(n);
+    buf[n] = '\0';
+    *out = buf;
+    *out_len = n + 1;
+    return ESP_OK;
+}
+
+static void free_pems(void)
+{
+    free(s_cert);
+    free(s_key);
+    s_cert = NULL;
+    s_key = NULL;
+}
+
+esp_err_t http_tls_start(const httpd_config_t *base, httpd_handle_t *out)
+{
+    /* esp-tls parses the PEMs for every new session, so they stay loaded while running */
+    esp_err_t err = load_pem(HTTP_TLS_CERT_PATH, &s_cert, &s_cert_len);
+    if (err == ESP_OK)
+    {
+        err = load_pem(HTTP_TLS_KEY_PATH, &s_key, &s_key_len);
+    }
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "No usable %s / %s (%s)", HTTP_TLS_CERT_PATH, HTTP_TLS_KEY_PATH, esp_err_to_name(err));
+        free_pems();
+        return err;
+    }
+
+    httpd_ssl_config_t conf = HTTPD_SSL_CONFIG_DEFAULT();
+    conf.httpd = *base;
+    conf.httpd.stack_size = HTTPS_STACK_SIZE;
+    conf.httpd.max_open_sockets = HTTPS_MAX_SOCKETS;
+    /* The control socket must not collide with the plain listener's */
+    conf.httpd.ctrl_port = base->ctrl_port + 1;
+    conf.transport_mode = HTTPD_SSL_TRANSPORT_SECURE;
+    conf.port_secure = HTTPS_PORT;
+    conf.servercert = (const uint8_t *)s_cert;
+    conf.servercert_len = s_cert_len;
+    conf.prvtkey_pem = (const uint8_t *)s_key;
+    conf.prvtkey_len = s_key_len;
+    conf.session_tickets = true;
+
+    err = httpd_ssl_start(out, &conf);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to start HTTPS server: %s", esp_err_to_name(err));
+        free_pems();
+        return err;
+    }
+    ESP_LOGI(TAG, "HTTPS server started on port %d (session tickets on)", HTTPS_PORT);
+    return ESP_OK;
+}
+
+void http_tls_stop(httpd_handle_t server)
+{
+    if (server != NULL)
+    {
+        httpd_ssl_stop(server);
+    }
+    free_pems();
+}
+
+bool http_tls_is_running(void)
+{
+    return s_cert != NULL;
+}
+
+/*
+ * esp_https_server runs the whole handshake inside this call from its open
+ * callback; the component links with --wrap for it (see CMakeLists.txt) to
+ * time it.
+ */
+int __real_esp_tls_server_session_create(esp_tls_cfg_server_t *cfg, int sockfd, esp_tls_t *tls);
+
+int __wrap_esp_tls_server_session_create(esp_tls_cfg_server_t *cfg, int sockfd, esp_tls_t *tls)
+{
+    int64_t start = esp_timer_get_time();
+    int ret = __real_esp_tls_server_session_create(cfg, sockfd, tls);
+    if (ret == 0)
+    {
+        metrics_histogram_observe(s_handshake_ms, (uint32_t)((esp_timer_get_time() - start) / 1000));
+    }
+    else
+    {
+        metrics_counter_add(s_handshake_failures, 1);
+    }
+    return ret;
+}
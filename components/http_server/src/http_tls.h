@@ -0,0 +1,22 @@
+#pragma once
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#include <stdbool.h>
+
+/* PEM certificate (chain) and private key for the HTTPS listener */
+#define HTTP_TLS_CERT_PATH "/flash/certs/server.crt"
+#define HTTP_TLS_KEY_PATH "/flash/certs/server.key"
+
+/* Load the listener mode from NVS and register the handshake metrics */
+void http_tls_init(void);
+
+/* Start the HTTPS listener with the handler settings of `base` (the plain HTTP config).
+   Returns ESP_ERR_NOT_FOUND when the certificate or key is missing. */
+esp_err_t http_tls_start(const httpd_config_t *base, httpd_handle_t *out);
+
+void http_tls_stop(httpd_handle_t server);
+
+/* True while the certificate and key are loaded, i.e. between start and stop */
+bool http_tls_is_running(void);
@@ -1,38 +1,178 @@
 #include "filesystem.h"
+#include "http_file_writer.h"
+#include "http_json.h"
 #include "http_multipart.h"
 #include "http_server.h"
+#include "http_upload.h"
 
 #include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "mbedtls/base64.h"
+#include "mbedtls/md5.h"
+#include "mbedtls/sha256.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 
 static const char *const TAG = "http_upload";
 
+#define PART_SUFFIX ".part"
+
+/* Per-request cap on file parts reported in the response */
+#ifndef HTTP_UPLOAD_MAX_FILES
+#define HTTP_UPLOAD_MAX_FILES 16
+#endif
+
 typedef struct
 {
-    char target_path[VFS_PATH_MAX];
-    bool has_path;
+    char path[VFS_PATH_MAX];
+    size_t bytes;
+    const char *error;
+    vfs_hash_t hash; /* of the data as received, reported back for verification */
+} upload_result_t;
+
+/*
+ * One multipart request may carry several file parts. Each goes to the
+ * "path" field that precedes it, or to "dir" + "/" + filename. Files are
+ * written one after another through a single writer and its buffer pool.
+ */
+typedef struct
+{
+    char next_path[VFS_PATH_MAX];
+    char dir[VFS_PATH_MAX];
+    const char *field_error;
     FILE *file;
-    char error[128];
+    http_file_writer_t *writer;
+    upload_result_t *current;
+    mbedtls_sha256_context sha256; /* of the current part */
+    upload_result_t results[HTTP_UPLOAD_MAX_FILES];
+    size_t result_count;
+    size_t dropped;
 } upload_ctx_t;
 
-static void upload_field_cb(const char *name, const char *value, void *ctx)
+/* Takes a virtual (/flash, /sdcard) path; vfs_mkdir() resolves it itself */
+void http_upload_ensure_parent_dir(const char *virtual_path)
 {
-    upload_ctx_t *uctx = (upload_ctx_t *)ctx;
-    if (strcmp(name, "path") == 0)
+    char parent[VFS_PATH_MAX];
+    strncpy(parent, virtual_path, sizeof(parent) - 1);
+    parent[sizeof(parent) - 1] = '\0';
+    char *last_slash = strrchr(parent, '/');
+    if (last_slash && last_slash != parent)
     {
-        char sanitized[VFS_PATH_MAX];
-        if (http_sanitize_upload_path(value, sanitized, sizeof(sanitized)) == ESP_OK)
+        *last_slash = '\0';
+        if (!vfs_is_directory(parent))
         {
-            strncpy(uctx->target_path, sanitized, sizeof(uctx->target_path) - 1);
-            uctx->has_path = true;
+            vfs_mkdir(parent);
         }
-        else
+    }
+}
+
+static void upload_field_cb(const char *name, const char *value, void *ctx)
+{
+    upload_ctx_t *uctx = (upload_ctx_t *)ctx;
+    bool is_path = (strcmp(name, "path") == 0);
+    if (!is_path && strcmp(name, "dir") != 0)
+    {
+        return;
+    }
+
+    char *dst = is_path ? uctx->next_path : uctx->dir;
+    dst[0] = '\0';
+    if (http_sanitize_upload_path(value, dst, VFS_PATH_MAX) != ESP_OK)
+    {
+        dst[0] = '\0';
+        uctx->field_error = "Invalid path";
+    }
+    else
+    {
+        uctx->field_error = NULL;
+    }
+}
+
+/* Pick the virtual target for the next file part; returns NULL or an error */
+static const char *upload_target(upload_ctx_t *uctx, const char *file_name, char *out, size_t len)
+{
+    if (uctx->field_error != NULL)
+    {
+        const char *err = uctx->field_error;
+        uctx->field_error = NULL;
+        return err;
+    }
+
+    if (uctx->next_path[0] != '\0')
+    {
+        /* An explicit path applies to exactly one file */
+        strncpy(out, uctx->next_path, len - 1);
+        out[len - 1] = '\0';
+        uctx->next_path[0] = '\0';
+        return NULL;
+    }
+
+    if (uctx->dir[0] == '\0')
+    {
+        return "Missing path field";
+    }
+    if (file_name[0] == '\0' || strchr(file_name, '/') != NULL || strchr(file_name, '\\') != NULL)
+    {
+        return "Invalid file name";
+    }
+
+    char joined[VFS_PATH_MAX * 2];
+    snprintf(joined, sizeof(joined), "%s/%s", uctx->dir, file_name);
+    if (http_sanitize_upload_path(joined, out, len) != ESP_OK)
+    {
+        return "Invalid path";
+    }
+    return NULL;
+}
+
+static const char *upload_open(upload_ctx_t *uctx, const char *virtual_path)
+{
+    char real_path[VFS_PATH_MAX];
+    if (vfs_resolve_path(virtual_path, real_path, sizeof(real_path)) != ESP_OK)
+    {
+        return "Path resolution failed";
+    }
+    http_upload_ensure_parent_dir(virtual_path);
+
+    uctx->file = fopen(real_path, "wb");
+    if (!uctx->file)
+    {
+        return "Failed to open file";
+    }
+    setvbuf(uctx->file, NULL, _IONBF, 0);
+
+    if (uctx->writer == NULL)
+    {
+        uctx->writer = http_file_writer_open(NULL, "upload");
+        if (uctx->writer == NULL)
         {
-            snprintf(uctx->error, sizeof(uctx->error), "Invalid path");
+            fclose(uctx->file);
+            uctx->file = NULL;
+            return "Out of memory";
         }
     }
+    http_file_writer_set_file(uctx->writer, uctx->file);
+    return NULL;
+}
+
+/* Finish the current file; every queued block must land before fclose */
+static void upload_close_current(upload_ctx_t *uctx)
+{
+    if (uctx->file == NULL)
+    {
+        return;
+    }
+    esp_err_t werr = http_file_writer_flush(uctx->writer);
+    http_file_writer_set_file(uctx->writer, NULL);
+    int cerr = fclose(uctx->file);
+    uctx->file = NULL;
+    if ((werr != ESP_OK || cerr != 0) && uctx->current->error == NULL)
+    {
+        uctx->current->error = "Write failed";
+    }
 }
 
 static bool upload_file_cb(const char *field_name, const char *file_name, const uint8_t *data, size_t len,
@@ -41,106 +181,440 @@ static bool upload_file_cb(const char *field_name, const char *file_name, const
     (void)field_name;
     upload_ctx_t *uctx = (upload_ctx_t *)ctx;
 
-    if (is_first && !uctx->has_path)
+    if (is_first)
     {
-        snprintf(uctx->error, sizeof(uctx->error), "Missing path field");
-        return false;
+        if (uctx->result_count == HTTP_UPLOAD_MAX_FILES)
+        {
+            /* Nowhere to report the outcome; skip the part */
+            uctx->dropped++;
+            uctx->current = NULL;
+            return true;
+        }
+        upload_result_t *res = &uctx->results[uctx->result_count++];
+        memset(res, 0, sizeof(*res));
+        uctx->current = res;
+
+        res->error = upload_target(uctx, file_name, res->path, sizeof(res->path));
+        if (res->error == NULL)
+        {
+            res->error = upload_open(uctx, res->path);
+        }
+        mbedtls_sha256_starts(&uctx->sha256, 0);
     }
 
-    if (is_first)
+    upload_result_t *res = uctx->current;
+    if (res == NULL)
     {
-        /* Resolve virtual path to real path */
-        char real_path[VFS_PATH_MAX];
-        if (vfs_resolve_path(uctx->target_path, real_path, sizeof(real_path)) != ESP_OK)
+        return true;
+    }
+
+    if (data && len > 0 && uctx->file && res->error == NULL)
+    {
+        mbedtls_sha256_update(&uctx->sha256, data, len);
+        res->hash.crc32 = esp_rom_crc32_le(res->hash.crc32, data, len);
+        if (http_file_writer_write(uctx->writer, data, len) != ESP_OK)
         {
-            snprintf(uctx->error, sizeof(uctx->error), "Path resolution failed");
-            return false;
+            res->error = "Write failed";
+        }
+        else
+        {
+            res->bytes += len;
         }
-        strncpy(uctx->target_path, real_path, sizeof(uctx->target_path) - 1);
+    }
 
-        /* Create parent directory */
-        char parent[VFS_PATH_MAX];
-        strncpy(parent, uctx->target_path, sizeof(parent) - 1);
-        parent[sizeof(parent) - 1] = '\0';
-        char *last_slash = strrchr(parent, '/');
-        if (last_slash && last_slash != parent)
+    if (is_final)
+    {
+        mbedtls_sha256_finish(&uctx->sha256, res->hash.sha256);
+        res->hash.size = res->bytes;
+        upload_close_current(uctx);
+        if (res->error == NULL)
         {
-            *last_slash = '\0';
-            vfs_mkdir(parent);
+            ESP_LOGI(TAG, "Upload complete: %s (%s, %u bytes)", res->path, file_name, (unsigned)res->bytes);
+        }
+        uctx->current = NULL;
+    }
+    return true;
+}
+
+/* "size", "sha256" and "crc32" of what was written, to compare with the source */
+static void json_kv_hash(http_json_t *j, const vfs_hash_t *hash)
+{
+    char sha256[2 * VFS_SHA256_LEN + 1];
+    char crc32[9];
+    vfs_hash_sha256_hex(hash, sha256);
+    snprintf(crc32, sizeof(crc32), "%08x", (unsigned)hash->crc32);
+    http_json_kv_uint(j, "size", hash->size);
+    http_json_kv_string(j, "sha256", sha256);
+    http_json_kv_string(j, "crc32", crc32);
+}
+
+static esp_err_t send_upload_results(httpd_req_t *req, const upload_ctx_t *uctx, esp_err_t parse_err)
+{
+    size_t failed = uctx->dropped;
+    for (size_t i = 0; i < uctx->result_count; i++)
+    {
+        failed += (uctx->results[i].error != NULL) ? 1 : 0;
+    }
+
+    const char *error = NULL;
+    if (parse_err != ESP_OK)
+    {
+        error = "Upload failed";
+        httpd_resp_set_status(req, "500 Internal Server Error");
+    }
+    else if (uctx->result_count == 0)
+    {
+        error = uctx->field_error ? uctx->field_error : "No file parts";
+        httpd_resp_set_status(req, "400 Bad Request");
+    }
+    else if (failed > 0)
+    {
+        error = "Some files failed";
+        httpd_resp_set_status(req, "400 Bad Request");
+    }
+
+    httpd_resp_set_type(req, "application/json");
+
+    http_stream_t out;
+    http_json_t j;
+    http_stream_init(&out, req);
+    http_json_init(&j, &out);
+    http_json_object_begin(&j);
+    if (error != NULL)
+    {
+        http_json_kv_string(&j, "error", error);
+    }
+    else
+    {
+        http_json_kv_string(&j, "status", "ok");
+    }
+
+    http_json_key(&j, "files");
+    http_json_array_begin(&j);
+    for (size_t i = 0; i < uctx->result_count; i++)
+    {
+        const upload_result_t *res = &uctx->results[i];
+        http_json_object_begin(&j);
+        http_json_kv_string(&j, "path", res->path);
+        if (res->error != NULL)
+        {
+            http_json_kv_string(&j, "error", res->error);
         }
+        else
+        {
+            json_kv_hash(&j, &res->hash);
+        }
+        http_json_object_end(&j);
+    }
+    http_json_array_end(&j);
+
+    http_json_kv_uint(&j, "skipped", uctx->dropped);
+    http_json_object_end(&j);
+    return http_stream_finish(&out);
+}
+
+static esp_err_t handler_upload(httpd_req_t *req)
+{
+    upload_ctx_t *uctx = calloc(1, sizeof(upload_ctx_t));
+    if (uctx == NULL)
+    {
+        return http_json_send_error(req, "500 Internal Server Error", "Out of memory");
+    }
+
+    mbedtls_sha256_init(&uctx->sha256);
+    esp_err_t ret = http_multipart_parse(req, upload_field_cb, upload_file_cb, uctx);
+    mbedtls_sha256_free(&uctx->sha256);
+
+    if (uctx->current != NULL)
+    {
+        /* Parse aborted mid-part */
+        upload_close_current(uctx);
+    }
+    if (uctx->writer)
+    {
+        http_file_writer_close(uctx->writer);
+        uctx->writer = NULL;
+    }
+
+    esp_err_t err = send_upload_results(req, uctx, ret);
+    free(uctx);
+    return err;
+}
+
+static int hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
 
-        uctx->file = fopen(uctx->target_path, "wb");
-        if (!uctx->file)
+static bool parse_hex(const char *hex, uint8_t *out, size_t len)
+{
+    if (strlen(hex) != len * 2)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        int hi = hex_nibble(hex[2 * i]);
+        int lo = hex_nibble(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0)
         {
-            snprintf(uctx->error, sizeof(uctx->error), "Failed to open file");
             return false;
         }
+        out[i] = (uint8_t)((hi << 4) | lo);
     }
+    return true;
+}
+
+/* SHA-256 and CRC-32 are always computed and returned; the headers add a check */
+typedef struct
+{
+    bool want_md5;
+    bool check_sha256;
+    uint8_t md5[16];
+    uint8_t sha256[32];
+    vfs_hash_t actual;
+    mbedtls_md5_context md5_ctx;
+    mbedtls_sha256_context sha256_ctx;
+} put_digest_t;
 
-    if (data && len > 0 && uctx->file)
+/* Content-MD5 is base64 (RFC 1864); X-Content-SHA256 is hex */
+static esp_err_t put_digest_init(httpd_req_t *req, put_digest_t *d)
+{
+    char value[96];
+    mbedtls_sha256_init(&d->sha256_ctx);
+    mbedtls_sha256_starts(&d->sha256_ctx, 0);
+    if (httpd_req_get_hdr_value_str(req, "Content-MD5", value, sizeof(value)) == ESP_OK)
     {
-        if (fwrite(data, 1, len, uctx->file) != len)
+        size_t olen = 0;
+        if (mbedtls_base64_decode(d->md5, sizeof(d->md5), &olen, (const uint8_t *)value, strlen(value)) != 0 ||
+            olen != sizeof(d->md5))
         {
-            snprintf(uctx->error, sizeof(uctx->error), "Write failed");
-            fclose(uctx->file);
-            uctx->file = NULL;
-            return false;
+            return ESP_ERR_INVALID_ARG;
         }
+        d->want_md5 = true;
+        mbedtls_md5_init(&d->md5_ctx);
+        mbedtls_md5_starts(&d->md5_ctx);
     }
+    if (httpd_req_get_hdr_value_str(req, "X-Content-SHA256", value, sizeof(value)) == ESP_OK)
+    {
+        if (!parse_hex(value, d->sha256, sizeof(d->sha256)))
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+        d->check_sha256 = true;
+    }
+    return ESP_OK;
+}
 
-    if (is_final && uctx->file)
+static void put_digest_update(put_digest_t *d, const uint8_t *data, size_t len)
+{
+    if (d->want_md5)
     {
-        fclose(uctx->file);
-        uctx->file = NULL;
-        ESP_LOGI(TAG, "Upload complete: %s (%s)", uctx->target_path, file_name);
+        mbedtls_md5_update(&d->md5_ctx, data, len);
     }
-    return true;
+    mbedtls_sha256_update(&d->sha256_ctx, data, len);
+    d->actual.crc32 = esp_rom_crc32_le(d->actual.crc32, data, len);
+    d->actual.size += len;
 }
 
-static esp_err_t handler_upload(httpd_req_t *req)
+static bool put_digest_verify(put_digest_t *d)
 {
-    if (http_auth_check(req) != ESP_OK)
+    bool ok = true;
+    if (d->want_md5)
+    {
+        uint8_t actual[16];
+        mbedtls_md5_finish(&d->md5_ctx, actual);
+        ok = ok && memcmp(actual, d->md5, sizeof(actual)) == 0;
+    }
+    mbedtls_sha256_finish(&d->sha256_ctx, d->actual.sha256);
+    if (d->check_sha256)
     {
-        return ESP_OK;
+        ok = ok && memcmp(d->actual.sha256, d->sha256, sizeof(d->sha256)) == 0;
     }
+    return ok;
+}
 
-    upload_ctx_t uctx = {0};
+static void put_digest_free(put_digest_t *d)
+{
+    if (d->want_md5)
+    {
+        mbedtls_md5_free(&d->md5_ctx);
+    }
+    mbedtls_sha256_free(&d->sha256_ctx);
+}
 
-    esp_err_t ret = http_multipart_parse(req, upload_field_cb, upload_file_cb, &uctx);
+/*
+ * Stream the request body into an open file; returns NULL or an error message.
+ * Data is received straight into writer buffers, so each block is written by
+ * the writer task while the next one is being received.
+ */
+static const char *put_receive(httpd_req_t *req, http_file_writer_t *w, put_digest_t *digest)
+{
+    size_t remaining = req->content_len;
+    uint8_t *buf = NULL;
+    size_t fill = 0;
 
-    if (uctx.file)
+    while (remaining > 0)
     {
-        fclose(uctx.file);
-        uctx.file = NULL;
+        if (buf == NULL)
+        {
+            buf = http_file_writer_acquire(w);
+            fill = 0;
+        }
+        size_t want = HTTP_WRITER_BUF_SIZE - fill;
+        if (want > remaining)
+        {
+            want = remaining;
+        }
+        int recvd = httpd_req_recv(req, (char *)buf + fill, want);
+        if (recvd <= 0)
+        {
+            if (recvd == HTTPD_SOCK_ERR_TIMEOUT)
+            {
+                continue;
+            }
+            http_file_writer_submit(w, buf, 0);
+            return "Receive failed";
+        }
+        put_digest_update(digest, buf + fill, (size_t)recvd);
+        fill += (size_t)recvd;
+        remaining -= (size_t)recvd;
+
+        /* Only full blocks hit the filesystem, except the final tail */
+        if (fill == HTTP_WRITER_BUF_SIZE || remaining == 0)
+        {
+            uint8_t *full = buf;
+            buf = NULL;
+            if (http_file_writer_submit(w, full, fill) != ESP_OK)
+            {
+                return "Write failed";
+            }
+        }
     }
+    return NULL;
+}
 
-    httpd_resp_set_type(req, "application/json");
+static esp_err_t handler_put(httpd_req_t *req)
+{
+    /* PUT /api/files/flash/a.txt or PUT /api/files?path=/flash/a.txt */
+    char query[256] = {0};
+    char raw_path[VFS_PATH_MAX] = "/";
+    if (http_server_route_param(req, "path", raw_path + 1, sizeof(raw_path) - 1) != ESP_OK &&
+        (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+         httpd_query_key_value(query, "path", raw_path, sizeof(raw_path)) != ESP_OK))
+    {
+        return http_json_send_error(req, "400 Bad Request", "Missing path parameter");
+    }
 
-    if (uctx.error[0] != '\0')
+    char sanitized[VFS_PATH_MAX];
+    char real_path[VFS_PATH_MAX];
+    if (http_sanitize_upload_path(raw_path, sanitized, sizeof(sanitized)) != ESP_OK ||
+        vfs_resolve_path(sanitized, real_path, sizeof(real_path)) != ESP_OK)
     {
-        httpd_resp_set_status(req, "400 Bad Request");
-        char resp[192];
-        snprintf(resp, sizeof(resp), "{\"error\":\"%s\"}", uctx.error);
-        return httpd_resp_send(req, resp, HTTPD_RESP_USE_STRLEN);
+        return http_json_send_error(req, "400 Bad Request", "Invalid path");
     }
 
-    if (ret != ESP_OK)
+    char part_path[VFS_PATH_MAX + sizeof(PART_SUFFIX)];
+    snprintf(part_path, sizeof(part_path), "%s" PART_SUFFIX, real_path);
+
+    put_digest_t digest = {0};
+    if (put_digest_init(req, &digest) != ESP_OK)
     {
-        httpd_resp_set_status(req, "500 Internal Server Error");
-        return httpd_resp_send(req, "{\"error\":\"Upload failed\"}", HTTPD_RESP_USE_STRLEN);
+        put_digest_free(&digest);
+        return http_json_send_error(req, "400 Bad Request", "Malformed digest header");
     }
 
-    return httpd_resp_send(req, "{\"status\":\"ok\"}", HTTPD_RESP_USE_STRLEN);
+    http_upload_ensure_parent_dir(sanitized);
+    FILE *f = fopen(part_path, "wb");
+    if (f == NULL)
+    {
+        put_digest_free(&digest);
+        return http_json_send_error(req, "500 Internal Server Error", "Failed to open file");
+    }
+    /* Writes are already block-sized; stdio buffering would only add a copy */
+    setvbuf(f, NULL, _IONBF, 0);
+
+    http_file_writer_t *writer = http_file_writer_open(f, real_path);
+    if (writer == NULL)
+    {
+        fclose(f);
+        remove(part_path);
+        put_digest_free(&digest);
+        return http_json_send_error(req, "500 Internal Server Error", "Out of memory");
+    }
+
+    const char *error = put_receive(req, writer, &digest);
+    if (http_file_writer_close(writer) != ESP_OK && error == NULL)
+    {
+        error = "Write failed";
+    }
+    if (fclose(f) != 0 && error == NULL)
+    {
+        error = "Write failed";
+    }
+
+    if (error == NULL && !put_digest_verify(&digest))
+    {
+        put_digest_free(&digest);
+        remove(part_path);
+        return http_json_send_error(req, "400 Bad Request", "Digest mismatch");
+    }
+    put_digest_free(&digest);
+
+    if (error != NULL)
+    {
+        remove(part_path);
+        return http_json_send_error(req, "500 Internal Server Error", error);
+    }
+
+    /* FAT refuses to rename over an existing file */
+    struct stat st;
+    bool existed = (stat(real_path, &st) == 0);
+    if (rename(part_path, real_path) != 0 && (!existed || remove(real_path) != 0 || rename(part_path, real_path) != 0))
+    {
+        remove(part_path);
+        return http_json_send_error(req, "500 Internal Server Error", "Rename failed");
+    }
+
+    ESP_LOGI(TAG, "PUT complete: %s (%u bytes)", real_path, (unsigned)req->content_len);
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_status(req, existed ? "200 OK" : "201 Created");
+
+    http_stream_t out;
+    http_json_t j;
+    http_stream_init(&out, req);
+    http_json_init(&j, &out);
+    http_json_object_begin(&j);
+    http_json_kv_string(&j, "status", "ok");
+    json_kv_hash(&j, &digest.actual);
+    http_json_object_end(&j);
+    return http_stream_finish(&out);
 }
 
-void http_upload_register(httpd_handle_t server)
+void http_upload_register(void)
 {
-    const httpd_uri_t uri = {
-        .uri = "/api/upload",
-        .method = HTTP_POST,
-        .handler = handler_upload,
-        .user_ctx = NULL,
+    /* Flash writes block for seconds; keep them off the httpd task */
+    static const http_route_t routes[] = {
+        {"/api/upload", HTTP_ROUTE_METHOD(HTTP_POST), HTTP_ROUTE_AUTH | HTTP_ROUTE_ASYNC, handler_upload},
+        {"/api/files", HTTP_ROUTE_METHOD(HTTP_PUT), HTTP_ROUTE_AUTH | HTTP_ROUTE_ASYNC, handler_put},
+        {"/api/files/{path...}", HTTP_ROUTE_METHOD(HTTP_PUT), HTTP_ROUTE_AUTH | HTTP_ROUTE_ASYNC, handler_put},
     };
-    httpd_register_uri_handler(server, &uri);
-    ESP_LOGI(TAG, "Upload endpoint registered");
+    for (size_t i = 0; i < sizeof(routes) / sizeof(routes[0]); i++)
+    {
+        http_server_register_route(&routes[i]);
+    }
+    ESP_LOGI(TAG, "Upload endpoints registered");
 }
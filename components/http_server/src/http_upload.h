@@ -0,0 +1,6 @@
+#pragma once
+
+/* Helpers shared by the upload endpoints */
+
+/* Create the parent directory of a virtual path if it does not exist yet */
+void http_upload_ensure_parent_dir(const char *virtual_path);
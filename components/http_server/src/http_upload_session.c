@@ -0,0 +1,115 @@
+#include "http_upload_session.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define META_MAGIC "cos-upload 1\n"
+
+int http_upload_meta_format(const http_upload_meta_t *meta, char *buf, size_t len)
+{
+    if (meta == NULL || buf == NULL || strchr(meta->path, '\n') != NULL)
+    {
+        return -1;
+    }
+    int n = snprintf(buf, len, META_MAGIC "path=%s\nlength=%llu\ncreated=%lld\n", meta->path,
+                     (unsigned long long)meta->length, (long long)meta->created);
+    if (n < 0 || (size_t)n >= len)
+    {
+        return -1;
+    }
+    return n;
+}
+
+static bool parse_u64(const char *s, size_t n, unsigned long long *out)
+{
+    if (n == 0 || n > 20)
+    {
+        return false;
+    }
+    unsigned long long v = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (s[i] < '0' || s[i] > '9')
+        {
+            return false;
+        }
+        v = v * 10 + (unsigned long long)(s[i] - '0');
+    }
+    *out = v;
+    return true;
+}
+
+esp_err_t http_upload_meta_parse(const char *buf, http_upload_meta_t *meta)
+{
+    if (buf == NULL || meta == NULL || strncmp(buf, META_MAGIC, strlen(META_MAGIC)) != 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(meta, 0, sizeof(*meta));
+    bool have_path = false;
+    bool have_length = false;
+    bool have_created = false;
+
+    const char *line = buf + strlen(META_MAGIC);
+    while (*line != '\0')
+    {
+        const char *eol = strchr(line, '\n');
+        size_t line_len = eol ? (size_t)(eol - line) : strlen(line);
+        const char *eq = memchr(line, '=', line_len);
+        if (eq != NULL)
+        {
+            size_t key_len = (size_t)(eq - line);
+            const char *val = eq + 1;
+            size_t val_len = line_len - key_len - 1;
+            unsigned long long num = 0;
+
+            if (key_len == 4 && strncmp(line, "path", 4) == 0 && val_len > 0 && val_len < sizeof(meta->path))
+            {
+                memcpy(meta->path, val, val_len);
+                meta->path[val_len] = '\0';
+                have_path = true;
+            }
+            else if (key_len == 6 && strncmp(line, "length", 6) == 0 && parse_u64(val, val_len, &num))
+            {
+                meta->length = num;
+                have_length = true;
+            }
+            else if (key_len == 7 && strncmp(line, "created", 7) == 0 && parse_u64(val, val_len, &num))
+            {
+                meta->created = (int64_t)num;
+                have_created = true;
+            }
+        }
+        line += line_len + (eol ? 1 : 0);
+    }
+
+    return (have_path && have_length && have_created) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+bool http_upload_id_valid(const char *id)
+{
+    if (id == NULL || strlen(id) != HTTP_UPLOAD_ID_LEN)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < HTTP_UPLOAD_ID_LEN; i++)
+    {
+        char c = id[i];
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f')))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool http_upload_session_expired(int64_t created, int64_t now, int64_t ttl)
+{
+    if (created < HTTP_UPLOAD_CLOCK_VALID || now < HTTP_UPLOAD_CLOCK_VALID)
+    {
+        return false;
+    }
+    return now - created > ttl;
+}
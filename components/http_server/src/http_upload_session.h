@@ -0,0 +1,42 @@
+#pragma once
+
+#include "esp_err.h"
+#include "filesystem.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Session id: lowercase hex */
+#define HTTP_UPLOAD_ID_LEN 16
+
+/* Unfinished sessions are discarded after this many seconds */
+#ifndef HTTP_UPLOAD_SESSION_TTL_S
+#define HTTP_UPLOAD_SESSION_TTL_S (24 * 60 * 60)
+#endif
+
+/* Timestamps before this are treated as "clock not set yet" (2023-11-14) */
+#define HTTP_UPLOAD_CLOCK_VALID 1700000000LL
+
+/* Persisted description of a resumable upload */
+typedef struct
+{
+    char path[VFS_PATH_MAX];
+    uint64_t length;
+    int64_t created;
+} http_upload_meta_t;
+
+/* Serialize to a small text record; returns the length or -1 if it does not fit */
+int http_upload_meta_format(const http_upload_meta_t *meta, char *buf, size_t len);
+
+/* Parse a record produced by http_upload_meta_format() */
+esp_err_t http_upload_meta_parse(const char *buf, http_upload_meta_t *meta);
+
+bool http_upload_id_valid(const char *id);
+
+/*
+ * True if a session created at `created` has outlived `ttl` at `now`. Never
+ * expires anything while either timestamp predates a synced clock, so a reboot
+ * without SNTP does not wipe resumable uploads.
+ */
+bool http_upload_session_expired(int64_t created, int64_t now, int64_t ttl);
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "esp_err.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Maximum number of registered metrics (counters, gauges and histograms together). */
+#ifndef METRICS_MAX
+#define METRICS_MAX 40
+#endif
+
+/** Maximum number of histograms; each carries its own per-core bucket table. */
+#ifndef METRICS_MAX_HISTOGRAMS
+#define METRICS_MAX_HISTOGRAMS 4
+#endif
+
+/** Maximum number of finite bucket bounds per histogram (+Inf is implicit). */
+#ifndef METRICS_HIST_BUCKETS
+#define METRICS_HIST_BUCKETS 12
+#endif
+
+    /** Opaque handle to a registered metric. Every update function ignores NULL. */
+    typedef struct metric metric_t;
+
+    /**
+     * @brief Sampler for a gauge that is read only when exported.
+     *
+     * @param value Receives the current value.
+     * @return false to leave the gauge out of this export (e.g. RSSI while disconnected).
+     */
+    typedef bool (*metrics_sample_fn_t)(int64_t *value);
+
+    /**
+     * @brief Output callback for metrics_export().
+     *
+     * @param ctx  Caller context passed through unchanged.
+     * @param data Text to append.
+     * @param len  Number of bytes in data.
+     * @return ESP_OK to continue; any error stops the export and is returned.
+     */
+    typedef esp_err_t (*metrics_write_fn_t)(void *ctx, const char *data, size_t len);
+
+    /**
+     * @brief Register the metrics shell command.
+     *
+     * Metrics may be registered before this is called.
+     */
+    esp_err_t metrics_init(void);
+
+    /**
+     * @brief Register (or look up) a monotonically increasing counter.
+     *
+     * Names follow Prometheus rules and may carry a label set, e.g.
+     * "cos_http_requests_total{code=\"2xx\"}"; metrics sharing the part
+     * before '{' are exported as one family. Registering an existing name
+     * returns the same handle, so components may re-run their init.
+     *
+     * @param name Metric name; must outlive the registry (normally a literal).
+     * @param help One-line description for the HELP comment.
+     * @return The handle, or NULL if the registry is full or the name is
+     *         already registered with another type.
+     */
+    metric_t *metrics_counter(const char *name, const char *help);
+
+    /**
+     * @brief Register (or look up) a gauge that is set explicitly.
+     *
+     * @param name Metric name, see metrics_counter().
+     * @param help One-line description.
+     * @return The handle, or NULL on failure.
+     */
+    metric_t *metrics_gauge(const char *name, const char *help);
+
+    /**
+     * @brief Register (or look up) a gauge whose value is sampled at export time.
+     *
+     * @param name   Metric name, see metrics_counter().
+     * @param help   One-line description.
+     * @param sample Called on every export; must not block for long.
+     * @return The handle, or NULL on failure.
+     */
+    metric_t *metrics_gauge_sampled(const char *name, const char *help, metrics_sample_fn_t sample);
+
+    /**
+     * @brief Register (or look up) a histogram with fixed bucket bounds.
+     *
+     * @param name     Metric family name without a _bucket suffix; may carry labels.
+     * @param help     One-line description.
+     * @param bounds   Ascending inclusive upper bounds; must outlive the registry.
+     * @param n_bounds Number of bounds, at most METRICS_HIST_BUCKETS.
+     * @return The handle, or NULL on failure.
+     */
+    metric_t *metrics_histogram(const char *name, const char *help, const uint32_t *bounds, size_t n_bounds);
+
+    /**
+     * @brief Add to a counter.
+     *
+     * Lock-free: each core accumulates into its own slot, with interrupts
+     * masked on that core only for the increment itself. Safe from ISRs.
+     *
+     * @param m Counter handle (NULL is ignored).
+     * @param n Amount to add.
+     */
+    void metrics_counter_add(metric_t *m, uint32_t n);
+
+    /**
+     * @brief Set a gauge.
+     *
+     * @param m     Gauge handle (NULL is ignored).
+     * @param value New value.
+     */
+    void metrics_gauge_set(metric_t *m, int32_t value);
+
+    /**
+     * @brief Record one observation in a histogram (lock-free, per core).
+     *
+     * @param m     Histogram handle (NULL is ignored).
+     * @param value Observed value, in the unit the bounds use.
+     */
+    void metrics_histogram_observe(metric_t *m, uint32_t value);
+
+    /**
+     * @brief Current value of a counter, summed over all cores.
+     *
+     * @param m Counter handle.
+     * @return The total, or 0 for NULL or a metric of another type.
+     */
+    uint64_t metrics_counter_value(const metric_t *m);
+
+    /**
+     * @brief Write every metric in Prometheus text exposition format (0.0.4).
+     *
+     * @param prefix Only export families whose name starts with this; NULL for all.
+     * @param write  Receives the text, one line or less per call.
+     * @param ctx    Passed to write.
+     * @return ESP_OK, or the first error returned by write.
+     */
+    esp_err_t metrics_export(const char *prefix, metrics_write_fn_t write, void *ctx);
+
+    /** @brief Forget every registration. Handles returned earlier become invalid. */
+    void metrics_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,378 @@
+#include "metrics.h"
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *const TAG = "metrics";
+
+void metrics_register_commands(void);
+
+/*
+ * Every update touches only the calling core's slot, with interrupts masked
+ * on that core for the few instructions of the increment, so the hot path
+ * takes no lock and never waits on the other core. Readers sum the slots.
+ * A 64-bit slot is two stores on the 32-bit cores, so it carries a sequence
+ * number that is odd while its core updates it; a reader on the other core
+ * retries until it sees the same even number before and after the value.
+ */
+
+#define CORES portNUM_PROCESSORS
+
+typedef struct
+{
+    volatile uint32_t seq;
+    volatile uint64_t value;
+} u64_slot_t;
+
+typedef enum
+{
+    METRIC_COUNTER,
+    METRIC_GAUGE,
+    METRIC_HISTOGRAM,
+} metric_type_t;
+
+typedef struct
+{
+    const uint32_t *bounds;
+    size_t n_bounds;
+    uint32_t counts[CORES][METRICS_HIST_BUCKETS + 1]; /* last one is +Inf */
+    u64_slot_t sum[CORES];
+} histogram_t;
+
+struct metric
+{
+    const char *name;
+    const char *help;
+    metric_type_t type;
+    metrics_sample_fn_t sample;
+    volatile int32_t gauge;
+    u64_slot_t counter[CORES];
+    histogram_t *hist;
+};
+
+static metric_t s_metrics[METRICS_MAX];
+static size_t s_count;
+static histogram_t s_hists[METRICS_MAX_HISTOGRAMS];
+static size_t s_hist_count;
+static portMUX_TYPE s_register_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Only the slot's own core, with interrupts masked */
+static void slot_add(u64_slot_t *s, uint32_t n)
+{
+    s->seq++;
+    s->value += n;
+    s->seq++;
+}
+
+static uint64_t slot_read(const u64_slot_t *s)
+{
+    uint32_t seq;
+    uint64_t value;
+    do
+    {
+        seq = s->seq;
+        value = s->value;
+    } while ((seq & 1) != 0 || s->seq != seq);
+    return value;
+}
+
+esp_err_t metrics_init(void)
+{
+    metrics_register_commands();
+    ESP_LOGI(TAG, "Metrics component initialized");
+    return ESP_OK;
+}
+
+/* --- Registration --- */
+
+static metric_t *find(const char *name)
+{
+    for (size_t i = 0; i < s_count; i++)
+    {
+        if (strcmp(s_metrics[i].name, name) == 0)
+        {
+            return &s_metrics[i];
+        }
+    }
+    return NULL;
+}
+
+static metric_t *add(const char *name, const char *help, metric_type_t type, const uint32_t *bounds, size_t n_bounds)
+{
+    if (name == NULL || name[0] == '\0' || (type == METRIC_HISTOGRAM && n_bounds > METRICS_HIST_BUCKETS))
+    {
+        return NULL;
+    }
+
+    portENTER_CRITICAL(&s_register_lock);
+    metric_t *m = find(name);
+    const char *why = NULL;
+    if (m != NULL)
+    {
+        if (m->type != type)
+        {
+            m = NULL;
+            why = "registered with another type";
+        }
+    }
+    else if (s_count == METRICS_MAX || (type == METRIC_HISTOGRAM && s_hist_count == METRICS_MAX_HISTOGRAMS))
+    {
+        why = "registry full";
+    }
+    else
+    {
+        m = &s_metrics[s_count];
+        memset(m, 0, sizeof(*m));
+        m->name = name;
+        m->help = help;
+        m->type = type;
+        if (type == METRIC_HISTOGRAM)
+        {
+            m->hist = &s_hists[s_hist_count++];
+            memset(m->hist, 0, sizeof(*m->hist));
+            m->hist->bounds = bounds;
+            m->hist->n_bounds = n_bounds;
+        }
+        /* Published last so a concurrent export never sees a half-filled entry */
+        s_count++;
+    }
+    portEXIT_CRITICAL(&s_register_lock);
+
+    if (why != NULL)
+    {
+        ESP_LOGW(TAG, "Cannot register %s: %s", name, why);
+    }
+    return m;
+}
+
+metric_t *metrics_counter(const char *name, const char *help)
+{
+    return add(name, help, METRIC_COUNTER, NULL, 0);
+}
+
+metric_t *metrics_gauge(const char *name, const char *help)
+{
+    return add(name, help, METRIC_GAUGE, NULL, 0);
+}
+
+metric_t *metrics_gauge_sampled(const char *name, const char *help, metrics_sample_fn_t sample)
+{
+    metric_t *m = add(name, help, METRIC_GAUGE, NULL, 0);
+    if (m != NULL)
+    {
+        m->sample = sample;
+    }
+    return m;
+}
+
+metric_t *metrics_histogram(const char *name, const char *help, const uint32_t *bounds, size_t n_bounds)
+{
+    return add(name, help, METRIC_HISTOGRAM, bounds, n_bounds);
+}
+
+void metrics_reset(void)
+{
+    portENTER_CRITICAL(&s_register_lock);
+    s_count = 0;
+    s_hist_count = 0;
+    portEXIT_CRITICAL(&s_register_lock);
+}
+
+/* --- Updates --- */
+
+void metrics_counter_add(metric_t *m, uint32_t n)
+{
+    if (m == NULL || m->type != METRIC_COUNTER)
+    {
+        return;
+    }
+    UBaseType_t state = portSET_INTERRUPT_MASK_FROM_ISR();
+    slot_add(&m->counter[xPortGetCoreID()], n);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(state);
+}
+
+void metrics_gauge_set(metric_t *m, int32_t value)
+{
+    if (m != NULL && m->type == METRIC_GAUGE)
+    {
+        m->gauge = value;
+    }
+}
+
+void metrics_histogram_observe(metric_t *m, uint32_t value)
+{
+    if (m == NULL || m->type != METRIC_HISTOGRAM)
+    {
+        return;
+    }
+    histogram_t *h = m->hist;
+    size_t i = 0;
+    while (i < h->n_bounds && value > h->bounds[i])
+    {
+        i++;
+    }
+    UBaseType_t state = portSET_INTERRUPT_MASK_FROM_ISR();
+    int core = xPortGetCoreID();
+    h->counts[core][i]++;
+    slot_add(&h->sum[core], value);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(state);
+}
+
+uint64_t metrics_counter_value(const metric_t *m)
+{
+    if (m == NULL || m->type != METRIC_COUNTER)
+    {
+        return 0;
+    }
+    uint64_t total = 0;
+    for (int c = 0; c < CORES; c++)
+    {
+        total += slot_read(&m->counter[c]);
+    }
+    return total;
+}
+
+/* --- Export --- */
+
+/* Length of the family name, i.e. everything before the label set */
+static size_t family_len(const char *name)
+{
+    const char *brace = strchr(name, '{');
+    return brace != NULL ? (size_t)(brace - name) : strlen(name);
+}
+
+static bool same_family(const metric_t *a, const metric_t *b)
+{
+    size_t n = family_len(a->name);
+    return n == family_len(b->name) && strncmp(a->name, b->name, n) == 0;
+}
+
+typedef struct
+{
+    metrics_write_fn_t write;
+    void *ctx;
+    esp_err_t err;
+} exporter_t;
+
+static void emit(exporter_t *x, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void emit(exporter_t *x, const char *fmt, ...)
+{
+    if (x->err != ESP_OK)
+    {
+        return;
+    }
+    char line[192];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    if (n < 0)
+    {
+        return;
+    }
+    x->err = x->write(x->ctx, line, (size_t)n < sizeof(line) ? (size_t)n : sizeof(line) - 1);
+}
+
+static void export_histogram(exporter_t *x, const metric_t *m)
+{
+    const histogram_t *h = m->hist;
+    int fam = (int)family_len(m->name);
+    /* "{a=\"b\"" without the closing brace, so le can be appended */
+    const char *labels = m->name + fam;
+    int labels_len = labels[0] == '{' ? (int)strlen(labels) - 1 : 0;
+    const char *sep = labels_len > 0 ? "," : "{";
+
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i <= h->n_bounds; i++)
+    {
+        for (int c = 0; c < CORES; c++)
+        {
+            cumulative += h->counts[c][i];
+        }
+        if (i < h->n_bounds)
+        {
+            emit(x, "%.*s_bucket%.*s%sle=\"%lu\"} %llu\n", fam, m->name, labels_len, labels, sep,
+                 (unsigned long)h->bounds[i], (unsigned long long)cumulative);
+        }
+        else
+        {
+            emit(x, "%.*s_bucket%.*s%sle=\"+Inf\"} %llu\n", fam, m->name, labels_len, labels, sep,
+                 (unsigned long long)cumulative);
+        }
+    }
+
+    uint64_t sum = 0;
+    for (int c = 0; c < CORES; c++)
+    {
+        sum += slot_read(&h->sum[c]);
+    }
+    emit(x, "%.*s_sum%s %llu\n", fam, m->name, labels, (unsigned long long)sum);
+    emit(x, "%.*s_count%s %llu\n", fam, m->name, labels, (unsigned long long)cumulative);
+}
+
+static void export_metric(exporter_t *x, const metric_t *m)
+{
+    switch (m->type)
+    {
+    case METRIC_COUNTER:
+        emit(x, "%s %llu\n", m->name, (unsigned long long)metrics_counter_value(m));
+        break;
+    case METRIC_GAUGE:
+    {
+        int64_t value = m->gauge;
+        if (m->sample == NULL || m->sample(&value))
+        {
+            emit(x, "%s %lld\n", m->name, (long long)value);
+        }
+        break;
+    }
+    case METRIC_HISTOGRAM:
+        export_histogram(x, m);
+        break;
+    }
+}
+
+esp_err_t metrics_export(const char *prefix, metrics_write_fn_t write, void *ctx)
+{
+    static const char *const type_names[] = {"counter", "gauge", "histogram"};
+    exporter_t x = {.write = write, .ctx = ctx, .err = ESP_OK};
+    size_t prefix_len = prefix != NULL ? strlen(prefix) : 0;
+    size_t count = s_count;
+
+    for (size_t i = 0; i < count && x.err == ESP_OK; i++)
+    {
+        const metric_t *m = &s_metrics[i];
+        if (prefix_len > 0 && strncmp(m->name, prefix, prefix_len) != 0)
+        {
+            continue;
+        }
+
+        /* A family is written in one go, at its first member */
+        bool seen = false;
+        for (size_t j = 0; j < i && !seen; j++)
+        {
+            seen = same_family(&s_metrics[j], m);
+        }
+        if (seen)
+        {
+            continue;
+        }
+
+        int fam = (int)family_len(m->name);
+        emit(&x, "# HELP %.*s %s\n", fam, m->name, m->help != NULL ? m->help : "");
+        emit(&x, "# TYPE %.*s %s\n", fam, m->name, type_names[m->type]);
+        for (size_t j = i; j < count; j++)
+        {
+            if (same_family(&s_metrics[j], m))
+            {
+                export_metric(&x, &s_metrics[j]);
+            }
+        }
+    }
+    return x.err;
+}
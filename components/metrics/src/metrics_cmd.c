@@ -0,0 +1,44 @@
+#include "metrics.h"
+
+#include "esp_console.h"
+#include "esp_log.h"
+
+#include <stdio.h>
+
+static const char *const TAG = "metrics_cmd";
+
+static esp_err_t write_stdout(void *ctx, const char *data, size_t len)
+{
+    (void)ctx;
+    return fwrite(data, 1, len, stdout) == len ? ESP_OK : ESP_FAIL;
+}
+
+static int cmd_metrics(int argc, char **argv)
+{
+    if (argc > 2)
+    {
+        printf("Usage: metrics [prefix]\n");
+        return 1;
+    }
+
+    esp_err_t err = metrics_export(argc == 2 ? argv[1] : NULL, write_stdout, NULL);
+    if (err != ESP_OK)
+    {
+        printf("metrics: failed (%s)\n", esp_err_to_name(err));
+        return 1;
+    }
+    return 0;
+}
+
+void metrics_register_commands(void)
+{
+    const esp_console_cmd_t metrics_cmd = {
+        .command = "metrics",
+        .help = "Print all metrics in Prometheus text format, optionally only names starting with a prefix",
+        .hint = "[prefix]",
+        .func = &cmd_metrics,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&metrics_cmd));
+
+    ESP_LOGI(TAG, "Metrics commands registered");
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "esp_err.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Length of a SHA-256 digest in bytes. */
+#define OTA_SHA256_LEN 32
+
+    /** An update in progress; obtained from ota_begin(). */
+    typedef struct ota_update ota_update_t;
+
+    /**
+     * @brief Log the running partition and register the `ota` shell command.
+     * @return ESP_OK.
+     */
+    esp_err_t ota_init(void);
+
+    /**
+     * @brief Confirm the running image after a successful start.
+     *
+     * A freshly installed image boots in a pending state; if the device resets
+     * before this is called, the bootloader returns to the previous image.
+     * Call once startup has completed. Does nothing for an already valid image.
+     *
+     * @return ESP_OK, or the error from esp_ota_mark_app_valid_cancel_rollback().
+     */
+    esp_err_t ota_mark_valid(void);
+
+    /**
+     * @brief Start writing a new image into the inactive OTA partition.
+     *
+     * Flash is erased sector by sector as data arrives, so starting is quick
+     * and the image never has to be buffered. Only one update runs at a time.
+     *
+     * @param image_size Size of the image if known (checked against the
+     *                   partition), 0 if not.
+     * @param out        Receives the update handle.
+     * @return ESP_OK, ESP_ERR_INVALID_STATE if an update is already running,
+     *         ESP_ERR_INVALID_SIZE if the image cannot fit, ESP_ERR_NOT_FOUND
+     *         without an OTA partition, or an esp_ota_begin() error.
+     */
+    esp_err_t ota_begin(size_t image_size, ota_update_t **out);
+
+    /**
+     * @brief Append image data of any length.
+     *
+     * @param update Handle from ota_begin().
+     * @param data   Next part of the image.
+     * @param len    Number of bytes in data.
+     * @return ESP_OK, ESP_ERR_OTA_VALIDATE_FAILED if the first bytes are not an
+     *         image header, or a flash error.
+     */
+    esp_err_t ota_write(ota_update_t *update, const void *data, size_t len);
+
+    /**
+     * @brief Finish the image and select it for the next boot.
+     *
+     * The update is released in every case; on failure the boot partition is
+     * left unchanged.
+     *
+     * @param update   Handle from ota_begin(); invalid afterwards.
+     * @param expected SHA-256 the image must have, or NULL to skip the check.
+     * @param actual   Receives the SHA-256 of the written data; may be NULL.
+     * @return ESP_OK, ESP_ERR_INVALID_CRC on a digest mismatch,
+     *         ESP_ERR_OTA_VALIDATE_FAILED if the image is not a valid app.
+     */
+    esp_err_t ota_finish(ota_update_t *update, const uint8_t *expected, uint8_t *actual);
+
+    /**
+     * @brief Discard an update started with ota_begin().
+     * @param update Handle from ota_begin(); NULL is ignored.
+     */
+    void ota_abort(ota_update_t *update);
+
+    /**
+     * @brief Bytes written so far.
+     * @param update Handle from ota_begin().
+     * @return Total length passed to ota_write().
+     */
+    size_t ota_written(const ota_update_t *update);
+
+    /**
+     * @brief Install an image file, e.g. from the SD card.
+     *
+     * @param path     Virtual path of the image.
+     * @param expected SHA-256 the file must have, or NULL.
+     * @param progress Called with the bytes written and the file size after
+     *                 each block; may be NULL.
+     * @return ESP_OK, ESP_ERR_NOT_FOUND if the file does not exist, or an
+     *         error from ota_begin(), ota_write() or ota_finish().
+     */
+    esp_err_t ota_install_file(const char *path, const uint8_t *expected, void (*progress)(size_t done, size_t total));
+
+    /**
+     * @brief Parse a 64-digit hex SHA-256.
+     * @param hex Digest as hex digits, either case.
+     * @param out Receives the digest.
+     * @return ESP_OK or ESP_ERR_INVALID_ARG.
+     */
+    esp_err_t ota_parse_sha256(const char *hex, uint8_t out[OTA_SHA256_LEN]);
+
+    /**
+     * @brief Restart into the selected image a little later, e.g. once a response has gone out.
+     * @param delay_ms Delay before esp_restart().
+     */
+    void ota_restart_later(uint32_t delay_ms);
+
+#ifdef __cplusplus
+}
+#endif
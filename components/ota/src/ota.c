@@ -0,0 +1,305 @@
+#include "ota.h"
+
+#include "esp_app_desc.h"
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "filesystem.h"
+#include "freertos/FreeRTOS.h"
+#include "mbedtls/sha256.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+static const char *const TAG = "ota";
+
+void ota_register_commands(void);
+
+/* Read size for ota_install_file(); one flash sector */
+#define OTA_FILE_BLOCK 4096
+
+struct ota_update
+{
+    esp_ota_handle_t handle;
+    const esp_partition_t *partition;
+    mbedtls_sha256_context sha;
+    size_t written;
+};
+
+static ota_update_t s_update;
+static bool s_busy = false;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *state_name(esp_ota_img_states_t state)
+{
+    switch (state)
+    {
+    case ESP_OTA_IMG_NEW:
+        return "new";
+    case ESP_OTA_IMG_PENDING_VERIFY:
+        return "pending verify";
+    case ESP_OTA_IMG_VALID:
+        return "valid";
+    case ESP_OTA_IMG_INVALID:
+        return "invalid";
+    case ESP_OTA_IMG_ABORTED:
+        return "aborted";
+    case ESP_OTA_IMG_UNDEFINED:
+    default:
+        return "undefined";
+    }
+}
+
+esp_err_t ota_init(void)
+{
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    esp_ota_img_states_t state = ESP_OTA_IMG_UNDEFINED;
+    esp_ota_get_state_partition(running, &state);
+    ESP_LOGI(TAG, "Running %s from %s (%s)", esp_app_get_description()->version, running->label, state_name(state));
+
+    ota_register_commands();
+    return ESP_OK;
+}
+
+esp_err_t ota_mark_valid(void)
+{
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    esp_ota_img_states_t state;
+    if (esp_ota_get_state_partition(running, &state) != ESP_OK || state != ESP_OTA_IMG_PENDING_VERIFY)
+    {
+        return ESP_OK;
+    }
+    esp_err_t err = esp_ota_mark_app_valid_cancel_rollback();
+    if (err == ESP_OK)
+    {
+        ESP_LOGI(TAG, "Image in %s confirmed, rollback cancelled", running->label);
+    }
+    return err;
+}
+
+/* Only one update may own s_update */
+static bool claim(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    bool was_busy = s_busy;
+    s_busy = true;
+    portEXIT_CRITICAL(&s_lock);
+    return !was_busy;
+}
+
+static void unclaim(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_busy = false;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+static void release(void)
+{
+    mbedtls_sha256_free(&s_update.sha);
+    unclaim();
+}
+
+esp_err_t ota_begin(size_t image_size, ota_update_t **out)
+{
+    if (!claim())
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const esp_partition_t *partition = esp_ota_get_next_update_partition(NULL);
+    if (partition == NULL || image_size > partition->size)
+    {
+        unclaim();
+        return partition == NULL ? ESP_ERR_NOT_FOUND : ESP_ERR_INVALID_SIZE;
+    }
+
+    memset(&s_update, 0, sizeof(s_update));
+    mbedtls_sha256_init(&s_update.sha);
+    mbedtls_sha256_starts(&s_update.sha, 0);
+    s_update.partition = partition;
+
+    /* Sequential mode erases each sector just before it is written, instead of
+       the whole partition (seconds) up front while the client waits */
+    esp_err_t err = esp_ota_begin(partition, OTA_WITH_SEQUENTIAL_WRITES, &s_update.handle);
+    if (err != ESP_OK)
+    {
+        release();
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Writing update to %s", partition->label);
+    *out = &s_update;
+    return ESP_OK;
+}
+
+esp_err_t ota_write(ota_update_t *update, const void *data, size_t len)
+{
+    esp_err_t err = esp_ota_write(update->handle, data, len);
+    if (err == ESP_OK)
+    {
+        mbedtls_sha256_update(&update->sha, data, len);
+        update->written += len;
+    }
+    return err;
+}
+
+size_t ota_written(const ota_update_t *update)
+{
+    return update->written;
+}
+
+esp_err_t ota_finish(ota_update_t *update, const uint8_t *expected, uint8_t *actual)
+{
+    uint8_t digest[OTA_SHA256_LEN];
+    mbedtls_sha256_finish(&update->sha, digest);
+    if (actual != NULL)
+    {
+        memcpy(actual, digest, sizeof(digest));
+    }
+
+    if (expected != NULL && memcmp(expected, digest, sizeof(digest)) != 0)
+    {
+        ESP_LOGW(TAG, "SHA-256 mismatch, update discarded");
+        esp_ota_abort(update->handle);
+        release();
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    /* Checks the image structure and its appended hash */
+    esp_err_t err = esp_ota_end(update->handle);
+    if (err == ESP_OK)
+    {
+        err = esp_ota_set_boot_partition(update->partition);
+    }
+    if (err == ESP_OK)
+    {
+        ESP_LOGI(TAG, "Update of %u bytes in %s will boot next", (unsigned)update->written, update->partition->label);
+    }
+    else
+    {
+        ESP_LOGE(TAG, "Update failed: %s", esp_err_to_name(err));
+    }
+    release();
+    return err;
+}
+
+void ota_abort(ota_update_t *update)
+{
+    if (update == NULL)
+    {
+        return;
+    }
+    esp_ota_abort(update->handle);
+    release();
+}
+
+esp_err_t ota_install_file(const char *path, const uint8_t *expected, void (*progress)(size_t done, size_t total))
+{
+    char real_path[VFS_PATH_MAX];
+    esp_err_t err = vfs_resolve_path(path, real_path, sizeof(real_path));
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    struct stat st;
+    if (stat(real_path, &st) != 0 || S_ISDIR(st.st_mode))
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    uint8_t *buf = malloc(OTA_FILE_BLOCK);
+    FILE *f = fopen(real_path, "rb");
+    if (buf == NULL || f == NULL)
+    {
+        free(buf);
+        if (f != NULL)
+        {
+            fclose(f);
+        }
+        return buf == NULL ? ESP_ERR_NO_MEM : ESP_FAIL;
+    }
+
+    ota_update_t *update = NULL;
+    err = ota_begin((size_t)st.st_size, &update);
+    size_t n;
+    while (err == ESP_OK && (n = fread(buf, 1, OTA_FILE_BLOCK, f)) > 0)
+    {
+        vfs_count_read(n);
+        err = ota_write(update, buf, n);
+        if (progress != NULL)
+        {
+            progress(update->written, (size_t)st.st_size);
+        }
+    }
+    if (err == ESP_OK && ferror(f))
+    {
+        err = ESP_FAIL;
+    }
+    fclose(f);
+    free(buf);
+
+    if (update == NULL)
+    {
+        return err;
+    }
+    if (err != ESP_OK)
+    {
+        ota_abort(update);
+        return err;
+    }
+    return ota_finish(update, expected, NULL);
+}
+
+esp_err_t ota_parse_sha256(const char *hex, uint8_t out[OTA_SHA256_LEN])
+{
+    if (hex == NULL || strlen(hex) != 2 * OTA_SHA256_LEN)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < 2 * OTA_SHA256_LEN; i++)
+    {
+        char c = hex[i];
+        uint8_t v;
+        if (c >= '0' && c <= '9')
+        {
+            v = (uint8_t)(c - '0');
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+            v = (uint8_t)(c - 'a' + 10);
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+            v = (uint8_t)(c - 'A' + 10);
+        }
+        else
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+        out[i / 2] = (uint8_t)((i % 2 == 0) ? v << 4 : (out[i / 2] | v));
+    }
+    return ESP_OK;
+}
+
+static void restart_cb(void *arg)
+{
+    (void)arg;
+    ESP_LOGI(TAG, "Restarting into the new image");
+    esp_restart();
+}
+
+void ota_restart_later(uint32_t delay_ms)
+{
+    static esp_timer_handle_t timer = NULL;
+    const esp_timer_create_args_t args = {.callback = restart_cb, .name = "ota_restart"};
+    if (timer == NULL && esp_timer_create(&args, &timer) != ESP_OK)
+    {
+        restart_cb(NULL);
+        return;
+    }
+    esp_timer_start_once(timer, (uint64_t)delay_ms * 1000);
+}
@@ -0,0 +1,98 @@
+#include "ota.h"
+
+#include "esp_app_desc.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char *const TAG = "ota_cmd";
+
+static unsigned s_last_percent;
+
+static void print_progress(size_t done, size_t total)
+{
+    unsigned percent = total > 0 ? (unsigned)((uint64_t)done * 100 / total) : 100;
+    if (percent / 10 != s_last_percent / 10 || done == total)
+    {
+        printf("\r%3u%% (%u / %u bytes)", percent, (unsigned)done, (unsigned)total);
+        fflush(stdout);
+        s_last_percent = percent;
+    }
+}
+
+static void print_status(void)
+{
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    const esp_partition_t *boot = esp_ota_get_boot_partition();
+    const esp_partition_t *next = esp_ota_get_next_update_partition(NULL);
+    esp_ota_img_states_t state = ESP_OTA_IMG_UNDEFINED;
+    esp_ota_get_state_partition(running, &state);
+
+    printf("Version:  %s\n", esp_app_get_description()->version);
+    printf("Running:  %s%s\n", running->label, state == ESP_OTA_IMG_PENDING_VERIFY ? " (pending verify)" : "");
+    printf("Boot:     %s\n", boot != NULL ? boot->label : "-");
+    printf("Next:     %s (%u KiB)\n", next != NULL ? next->label : "-", next != NULL ? (unsigned)(next->size / 1024) : 0);
+    printf("Rollback: %s\n", esp_ota_check_rollback_is_possible() ? "possible" : "no other image");
+}
+
+static int cmd_ota(int argc, char **argv)
+{
+    if (argc == 1)
+    {
+        print_status();
+        return 0;
+    }
+
+    /* ota install <path> [sha256] */
+    if (strcmp(argv[1], "install") == 0 && (argc == 3 || argc == 4))
+    {
+        uint8_t expected[OTA_SHA256_LEN];
+        if (argc == 4 && ota_parse_sha256(argv[3], expected) != ESP_OK)
+        {
+            printf("ota: sha256 must be 64 hex digits\n");
+            return 1;
+        }
+
+        s_last_percent = 0;
+        esp_err_t err = ota_install_file(argv[2], argc == 4 ? expected : NULL, print_progress);
+        printf("\n");
+        if (err != ESP_OK)
+        {
+            printf("ota: install failed (%s)\n", err == ESP_ERR_INVALID_CRC ? "SHA-256 mismatch" : esp_err_to_name(err));
+            return 1;
+        }
+        printf("Installed; run 'restart' to boot it\n");
+        return 0;
+    }
+
+    /* ota rollback */
+    if (strcmp(argv[1], "rollback") == 0 && argc == 2)
+    {
+        if (!esp_ota_check_rollback_is_possible())
+        {
+            printf("ota: no other image to roll back to\n");
+            return 1;
+        }
+        esp_err_t err = esp_ota_mark_app_invalid_rollback_and_reboot();
+        printf("ota: rollback failed (%s)\n", esp_err_to_name(err));
+        return 1;
+    }
+
+    printf("Usage: ota [install <path> [sha256] | rollback]\n");
+    return 1;
+}
+
+void ota_register_commands(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "ota",
+        .help = "Firmware update status, install an image file (e.g. from /sdcard), roll back",
+        .hint = "[install <path> [sha256]|rollback]",
+        .func = &cmd_ota,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+    ESP_LOGI(TAG, "Registered 'ota' command");
+}
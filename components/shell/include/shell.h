@@ -3,12 +3,16 @@
 #include "esp_err.h"
 
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
+/** Timeout for shell_run_command() that waits as long as another command runs. */
+#define SHELL_WAIT_FOREVER UINT32_MAX
+
     /**
      * Initialize the shell: register all commands and start the
      * shared input subsystem (UART + BT keyboard).
@@ -46,6 +50,16 @@ extern "C"
      */
     esp_err_t shell_resolve_relative(const char *input, char *abs_path, size_t len);
 
+    /**
+     * Run one command line through esp_console, one caller at a time.
+     * Commands keep argtable and other state in statics, so every caller
+     * (UART/BT line editor, HTTP exec) must go through here rather than
+     * calling esp_console_run() directly. Output goes to the calling task's stdout.
+     * Returns ESP_ERR_TIMEOUT if another command is still running after wait_ms,
+     * ESP_ERR_INVALID_STATE before shell_init(), otherwise esp_console_run()'s result.
+     */
+    esp_err_t shell_run_command(const char *cmdline, int *ret, uint32_t wait_ms);
+
 #ifdef __cplusplus
 }
 #endif
@@ -6,6 +6,8 @@
 
 #include "esp_console.h"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -18,6 +20,9 @@ static const char *const TAG = "shell";
 static char s_cwd[SHELL_CWD_MAX] = "/flash";
 static char s_prompt[SHELL_PROMPT_MAX] = "COS/flash> ";
 
+/* Serializes esp_console_run() between the input task and HTTP exec */
+static SemaphoreHandle_t s_run_lock = NULL;
+
 static void update_prompt(void)
 {
     if (strcmp(s_cwd, "/") == 0)
@@ -145,6 +150,22 @@ esp_err_t shell_resolve_relative(const char *input, char *abs_path, size_t len)
     return ESP_OK;
 }
 
+esp_err_t shell_run_command(const char *cmdline, int *ret, uint32_t wait_ms)
+{
+    if (s_run_lock == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    TickType_t ticks = wait_ms == SHELL_WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(wait_ms);
+    if (xSemaphoreTake(s_run_lock, ticks) != pdTRUE)
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = esp_console_run(cmdline, ret);
+    xSemaphoreGive(s_run_lock);
+    return err;
+}
+
 esp_err_t shell_init(void)
 {
     ESP_LOGI(TAG, "Initializing shell...");
@@ -157,6 +178,12 @@ esp_err_t shell_init(void)
         return err;
     }
 
+    s_run_lock = xSemaphoreCreateMutex();
+    if (s_run_lock == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
     shell_register_fs_commands();
     shell_register_sd_commands();
     shell_register_info_commands();
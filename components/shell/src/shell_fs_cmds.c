@@ -3,6 +3,7 @@
 
 #include "esp_console.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 #include <ctype.h>
 #include <stdio.h>
@@ -312,6 +313,58 @@ static int cmd_hexdump(int argc, char **argv)
     return 0;
 }
 
+/* ---- sha256 ---- */
+
+static int cmd_sha256(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printf("Usage: sha256 <path>\n");
+        return 1;
+    }
+
+    char abs_path[VFS_PATH_MAX];
+    esp_err_t err = shell_resolve_relative(argv[1], abs_path, sizeof(abs_path));
+    if (err != ESP_OK)
+    {
+        printf("sha256: invalid path\n");
+        return 1;
+    }
+    if (vfs_is_directory(abs_path))
+    {
+        printf("sha256: '%s' is a directory\n", abs_path);
+        return 1;
+    }
+
+    /* One block buffer serves the whole file */
+    void *buf = malloc(VFS_HASH_BUF_SIZE);
+    if (buf == NULL)
+    {
+        printf("sha256: out of memory\n");
+        return 1;
+    }
+    vfs_hash_t hash;
+    int64_t start = esp_timer_get_time();
+    err = vfs_hash_file(abs_path, buf, VFS_HASH_BUF_SIZE, &hash);
+    int64_t elapsed_us = esp_timer_get_time() - start;
+    free(buf);
+    if (err != ESP_OK)
+    {
+        printf("sha256: cannot read '%s'\n", abs_path);
+        return 1;
+    }
+
+    char hex[2 * VFS_SHA256_LEN + 1];
+    vfs_hash_sha256_hex(&hash, hex);
+    printf("%s  %s\n", hex, abs_path);
+
+    /* Bytes per microsecond is MB/s */
+    uint64_t rate_x100 = elapsed_us > 0 ? hash.size * 100 / (uint64_t)elapsed_us : 0;
+    printf("crc32 %08x, %llu bytes in %lld ms (%u.%02u MB/s)\n", (unsigned)hash.crc32, (unsigned long long)hash.size,
+           (long long)(elapsed_us / 1000), (unsigned)(rate_x100 / 100), (unsigned)(rate_x100 % 100));
+    return 0;
+}
+
 /* ---- Registration ---- */
 
 static void register_cmd(const char *name, const char *help, const char *hint, esp_console_cmd_func_t func)
@@ -344,6 +397,7 @@ void shell_register_fs_commands(void)
 
     register_cmd("touch", "Create an empty file", "<path>", &cmd_touch);
     register_cmd("hexdump", "Hex dump of a file", "<path>", &cmd_hexdump);
+    register_cmd("sha256", "SHA-256 and CRC-32 of a file, with read throughput", "<path>", &cmd_sha256);
 
     ESP_LOGI(TAG, "Filesystem commands registered");
 }
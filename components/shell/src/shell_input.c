@@ -154,7 +154,7 @@ static void execute_line(void)
         history_push(s_line);
 
         int ret = 0;
-        esp_err_t err = esp_console_run(s_line, &ret);
+        esp_err_t err = shell_run_command(s_line, &ret, SHELL_WAIT_FOREVER);
         if (err == ESP_ERR_NOT_FOUND)
         {
             printf("Unknown command: %s\n", s_line);
@@ -1,3 +1,4 @@
+#include "metrics.h"
 #include "system.h"
 #include "sdkconfig.h"
 
@@ -13,8 +14,38 @@ static const char *const TAG = "system";
 
 void system_register_commands(void);
 
+static bool sample_heap_free(int64_t *value)
+{
+    *value = esp_get_free_heap_size();
+    return true;
+}
+
+static bool sample_heap_min_free(int64_t *value)
+{
+    *value = esp_get_minimum_free_heap_size();
+    return true;
+}
+
+static bool sample_heap_max_alloc(int64_t *value)
+{
+    *value = (int64_t)heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT);
+    return true;
+}
+
+static bool sample_uptime(int64_t *value)
+{
+    *value = esp_timer_get_time() / 1000000;
+    return true;
+}
+
 esp_err_t system_init(void)
 {
+    metrics_gauge_sampled("cos_heap_free_bytes", "Free heap", sample_heap_free);
+    metrics_gauge_sampled("cos_heap_min_free_bytes", "Lowest free heap since boot", sample_heap_min_free);
+    metrics_gauge_sampled("cos_heap_largest_free_block_bytes", "Largest allocatable heap block",
+                          sample_heap_max_alloc);
+    metrics_gauge_sampled("cos_uptime_seconds", "Time since boot", sample_uptime);
+
     system_register_commands();
     ESP_LOGI(TAG, "System component initialized");
     return ESP_OK;
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "esp_err.h"
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -46,6 +48,46 @@ extern "C"
      */
     void text_console_resize(void);
 
+    /** Reader position in the console output history (see text_console_log_seek()). */
+    typedef struct
+    {
+        uint32_t seq; /**< Number of the next line to read. */
+        uint32_t pos; /**< Internal offset of that line. */
+    } text_console_log_cursor_t;
+
+    /**
+     * @brief Number the next line of console output will get.
+     *
+     * Everything written to stdout (including ESP_LOG output) is also kept,
+     * line by line, in a bounded history. Lines are numbered from 0 at boot;
+     * subtract N from this value and seek there to replay the last N lines.
+     */
+    uint32_t text_console_log_head(void);
+
+    /**
+     * @brief Position a cursor at line `seq`, clamped to the lines still held.
+     *
+     * @param seq    Line number, e.g. text_console_log_head() - N.
+     * @param cursor Cursor to set.
+     */
+    void text_console_log_seek(uint32_t seq, text_console_log_cursor_t *cursor);
+
+    /**
+     * @brief Read the next line of console output and advance the cursor.
+     *
+     * Never blocks the writers: a reader that falls behind loses the oldest
+     * lines instead and is told how many.
+     *
+     * @param cursor  Cursor from text_console_log_seek().
+     * @param line    Receives the line without newline, NUL-terminated, truncated to size - 1.
+     * @param size    Capacity of line.
+     * @param len     Receives the number of bytes copied.
+     * @param dropped Incremented by the number of lines skipped; may be NULL.
+     * @return false when there is no new line yet.
+     */
+    bool text_console_log_next(text_console_log_cursor_t *cursor, char *line, size_t size, size_t *len,
+                               uint32_t *dropped);
+
     /** Register the display_mode shell command. */
     void text_console_register_commands(void);
 
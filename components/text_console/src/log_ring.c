@@ -0,0 +1,132 @@
+#include "log_ring.h"
+
+#include <string.h>
+
+/* Offsets are free-running 32-bit counters, so the size must divide 2^32 */
+_Static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE must be a power of two");
+_Static_assert(LOG_RING_LINE_MAX < LOG_RING_SIZE, "a line must fit in the ring");
+
+static char byte_at(const log_ring_t *r, uint32_t pos)
+{
+    return r->buf[pos & (LOG_RING_SIZE - 1)];
+}
+
+/* Wrap-safe "a comes before b" for sequence numbers */
+static bool seq_before(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
+
+void log_ring_init(log_ring_t *r)
+{
+    memset(r, 0, sizeof(*r));
+}
+
+static void drop_oldest(log_ring_t *r)
+{
+    while (byte_at(r, r->tail) != '\n')
+    {
+        r->tail++;
+    }
+    r->tail++;
+    r->seq_tail++;
+}
+
+static void commit(log_ring_t *r, const char *line, size_t len)
+{
+    while ((r->head - r->tail) + len + 1 > LOG_RING_SIZE)
+    {
+        drop_oldest(r);
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        r->buf[(r->head + i) & (LOG_RING_SIZE - 1)] = line[i];
+    }
+    r->buf[(r->head + len) & (LOG_RING_SIZE - 1)] = '\n';
+    r->head += (uint32_t)len + 1;
+    r->seq_head++;
+}
+
+void log_ring_write(log_ring_t *r, const char *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        char ch = data[i];
+        if (ch == '\r')
+        {
+            continue;
+        }
+        if (ch == '\n')
+        {
+            commit(r, r->partial, r->partial_len);
+            r->partial_len = 0;
+            continue;
+        }
+        r->partial[r->partial_len++] = ch;
+        if (r->partial_len == LOG_RING_LINE_MAX)
+        {
+            commit(r, r->partial, r->partial_len);
+            r->partial_len = 0;
+        }
+    }
+}
+
+void log_ring_seek(const log_ring_t *r, uint32_t seq, log_ring_cursor_t *c)
+{
+    if (seq_before(seq, r->seq_tail))
+    {
+        seq = r->seq_tail;
+    }
+    else if (seq_before(r->seq_head, seq))
+    {
+        seq = r->seq_head;
+    }
+
+    c->seq = r->seq_tail;
+    c->pos = r->tail;
+    while (c->seq != seq)
+    {
+        while (byte_at(r, c->pos) != '\n')
+        {
+            c->pos++;
+        }
+        c->pos++;
+        c->seq++;
+    }
+}
+
+bool log_ring_next(const log_ring_t *r, log_ring_cursor_t *c, char *line, size_t size, size_t *len,
+                   uint32_t *dropped)
+{
+    if (seq_before(c->seq, r->seq_tail))
+    {
+        if (dropped != NULL)
+        {
+            *dropped += r->seq_tail - c->seq;
+        }
+        c->seq = r->seq_tail;
+        c->pos = r->tail;
+    }
+    if (c->seq == r->seq_head)
+    {
+        return false;
+    }
+
+    size_t n = 0;
+    uint32_t pos = c->pos;
+    for (char ch = byte_at(r, pos); ch != '\n'; ch = byte_at(r, ++pos))
+    {
+        if (n + 1 < size)
+        {
+            line[n++] = ch;
+        }
+    }
+    if (size > 0)
+    {
+        line[n] = '\0';
+    }
+    *len = n;
+    c->pos = pos + 1;
+    c->seq++;
+    return true;
+}
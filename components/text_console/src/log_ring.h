@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Bytes of console history kept for late readers */
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE 4096
+#endif
+
+/* Longer lines are split; also the size of the pending partial-line buffer */
+#ifndef LOG_RING_LINE_MAX
+#define LOG_RING_LINE_MAX 192
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Line-oriented history of console output. Output is collected into whole
+     * lines and appended to a byte ring; when the ring is full the oldest lines
+     * are dropped. Readers hold their own cursor and never block the writer: a
+     * reader that falls behind the ring skips ahead and is told how many lines
+     * it missed. Lines are numbered from 0 in write order (wrapping at 2^32).
+     * Not thread-safe; the owner serializes access.
+     */
+
+    /** Reader position: the next line to read and where it starts. */
+    typedef struct
+    {
+        uint32_t seq; /**< Number of the next line. */
+        uint32_t pos; /**< Absolute byte offset of that line (valid while it is retained). */
+    } log_ring_cursor_t;
+
+    /** Ring state. */
+    typedef struct
+    {
+        char buf[LOG_RING_SIZE];
+        uint32_t head;     /**< Absolute offset one past the newest byte. */
+        uint32_t tail;     /**< Absolute offset of the oldest retained line. */
+        uint32_t seq_head; /**< Number the next completed line will get. */
+        uint32_t seq_tail; /**< Number of the oldest retained line. */
+        char partial[LOG_RING_LINE_MAX];
+        size_t partial_len;
+    } log_ring_t;
+
+    /** @brief Empty the ring and restart numbering at 0. */
+    void log_ring_init(log_ring_t *r);
+
+    /**
+     * @brief Append raw output. Completed lines ('\n'-terminated, '\r' removed)
+     *        enter the ring; a trailing partial line waits for the rest.
+     */
+    void log_ring_write(log_ring_t *r, const char *data, size_t len);
+
+    /**
+     * @brief Position a cursor at line `seq`, clamped to the retained range.
+     *
+     * Seeking to seq_head gives a cursor that only sees future lines.
+     */
+    void log_ring_seek(const log_ring_t *r, uint32_t seq, log_ring_cursor_t *c);
+
+    /**
+     * @brief Read the line at the cursor and advance it.
+     *
+     * @param line    Receives the line without its newline, NUL-terminated and
+     *                truncated to size - 1.
+     * @param len     Receives the copied length.
+     * @param dropped Incremented by the number of lines lost because the cursor
+     *                fell behind the ring; may be NULL.
+     * @return false when the cursor is at the newest line.
+     */
+    bool log_ring_next(const log_ring_t *r, log_ring_cursor_t *c, char *line, size_t size, size_t *len,
+                       uint32_t *dropped);
+
+#ifdef __cplusplus
+}
+#endif
@@ -6,6 +6,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
+#include "metrics.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -28,6 +29,13 @@ static bool s_initialized = false;
 
 static FILE *s_original_stdout;
 
+static metric_t *s_frames;
+static metric_t *s_rows_drawn;
+static metric_t *s_bytes;
+
+/* Line history for log streaming (text_console_log.c) */
+extern "C" void text_console_log_append(const char *data, size_t len);
+
 /* ── Rendering ─────────────────────────────────────────────── */
 
 static void render_dirty(void)
@@ -40,6 +48,8 @@ static void render_dirty(void)
     char chars[TEXT_BUF_MAX_COLS];
     uint16_t fg[TEXT_BUF_MAX_COLS];
     uint64_t dirty = s_buf.dirty_rows;
+    metrics_counter_add(s_frames, 1);
+    metrics_counter_add(s_rows_drawn, (uint32_t)__builtin_popcountll(dirty));
 
     while (dirty)
     {
@@ -85,10 +95,13 @@ static ssize_t stdout_write_hook(void *cookie, const char *buf, size_t size)
     size_t written = fwrite(buf, 1, size, s_original_stdout);
     fflush(s_original_stdout);
 
+    text_console_log_append(buf, size);
+
     if (s_initialized && xSemaphoreTake(s_mutex, pdMS_TO_TICKS(50)) == pdTRUE)
     {
         text_buffer_write(&s_buf, buf, size);
         xSemaphoreGive(s_mutex);
+        metrics_counter_add(s_bytes, (uint32_t)size);
         xTaskNotifyGive(s_render_task);
     }
 
@@ -112,6 +125,10 @@ extern "C" esp_err_t text_console_init(void)
         return ESP_ERR_NO_MEM;
     }
 
+    s_frames = metrics_counter("cos_console_frames_total", "Text console render passes that drew rows");
+    s_rows_drawn = metrics_counter("cos_console_rows_drawn_total", "Text rows pushed to the display");
+    s_bytes = metrics_counter("cos_console_bytes_total", "Bytes written to the text console");
+
     display_set_text_font(FONT_ID);
 
     int cols = display_get_width() / FONT_WIDTH;
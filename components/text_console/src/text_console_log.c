@@ -0,0 +1,50 @@
+#include "log_ring.h"
+#include "text_console.h"
+
+#include "freertos/FreeRTOS.h"
+
+/*
+ * Console output history shared by the stdout hook (writer) and any number
+ * of readers such as the SSE log stream. The spinlock is only held to copy
+ * one write in or one line out, so logging never waits on a slow reader.
+ */
+
+static log_ring_t s_ring;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void text_console_log_append(const char *data, size_t len)
+{
+    portENTER_CRITICAL(&s_lock);
+    log_ring_write(&s_ring, data, len);
+    portEXIT_CRITICAL(&s_lock);
+}
+
+uint32_t text_console_log_head(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    uint32_t seq = s_ring.seq_head;
+    portEXIT_CRITICAL(&s_lock);
+    return seq;
+}
+
+void text_console_log_seek(uint32_t seq, text_console_log_cursor_t *cursor)
+{
+    log_ring_cursor_t c;
+    portENTER_CRITICAL(&s_lock);
+    log_ring_seek(&s_ring, seq, &c);
+    portEXIT_CRITICAL(&s_lock);
+    cursor->seq = c.seq;
+    cursor->pos = c.pos;
+}
+
+bool text_console_log_next(text_console_log_cursor_t *cursor, char *line, size_t size, size_t *len,
+                           uint32_t *dropped)
+{
+    log_ring_cursor_t c = {.seq = cursor->seq, .pos = cursor->pos};
+    portENTER_CRITICAL(&s_lock);
+    bool ok = log_ring_next(&s_ring, &c, line, size, len, dropped);
+    portEXIT_CRITICAL(&s_lock);
+    cursor->seq = c.seq;
+    cursor->pos = c.pos;
+    return ok;
+}
@@ -1,5 +1,6 @@
 #include "websocket.h"
 #include "http_server.h"
+#include "metrics.h"
 
 #include "esp_console.h"
 #include "esp_http_server.h"
@@ -12,16 +13,25 @@
 
 static const char *const TAG = "websocket";
 
-static int s_clients[WEBSOCKET_MAX_CLIENTS];
+/* A client belongs to the listener (HTTP or HTTPS) it connected through */
+typedef struct
+{
+    httpd_handle_t server;
+    int fd;
+} ws_client_t;
+
+static ws_client_t s_clients[WEBSOCKET_MAX_CLIENTS];
 static size_t s_client_count = 0;
 static SemaphoreHandle_t s_mutex = NULL;
+static metric_t *s_frames_sent = NULL;
+static metric_t *s_send_failures = NULL;
 
-static void add_client(int fd)
+static void add_client(httpd_handle_t server, int fd)
 {
     xSemaphoreTake(s_mutex, portMAX_DELAY);
     if (s_client_count < WEBSOCKET_MAX_CLIENTS)
     {
-        s_clients[s_client_count++] = fd;
+        s_clients[s_client_count++] = (ws_client_t){server, fd};
     }
     xSemaphoreGive(s_mutex);
 }
@@ -31,7 +41,7 @@ static void remove_client(int fd)
     xSemaphoreTake(s_mutex, portMAX_DELAY);
     for (size_t i = 0; i < s_client_count; i++)
     {
-        if (s_clients[i] == fd)
+        if (s_clients[i].fd == fd)
         {
             s_clients[i] = s_clients[s_client_count - 1];
             s_client_count--;
@@ -56,8 +66,7 @@ size_t websocket_client_count(void)
 
 esp_err_t websocket_broadcast(const char *msg, size_t len)
 {
-    httpd_handle_t server = http_server_get_handle();
-    if (!server || !msg)
+    if (!http_server_get_handle() || !msg)
     {
         return ESP_ERR_INVALID_STATE;
     }
@@ -71,14 +80,16 @@ esp_err_t websocket_broadcast(const char *msg, size_t len)
     xSemaphoreTake(s_mutex, portMAX_DELAY);
     for (size_t i = 0; i < s_client_count;)
     {
-        if (httpd_ws_send_frame_async(server, s_clients[i], &frame) != ESP_OK)
+        if (httpd_ws_send_frame_async(s_clients[i].server, s_clients[i].fd, &frame) != ESP_OK)
         {
-            ESP_LOGW(TAG, "Send failed for fd %d, removing", s_clients[i]);
+            ESP_LOGW(TAG, "Send failed for fd %d, removing", s_clients[i].fd);
             s_clients[i] = s_clients[s_client_count - 1];
             s_client_count--;
+            metrics_counter_add(s_send_failures, 1);
         }
         else
         {
+            metrics_counter_add(s_frames_sent, 1);
             i++;
         }
     }
@@ -96,7 +107,7 @@ static esp_err_t ws_handler(httpd_req_t *req)
             return ESP_OK;
         }
         int fd = httpd_req_to_sockfd(req);
-        add_client(fd);
+        add_client(req->handle, fd);
         ESP_LOGI(TAG, "Client connected (fd=%d, total=%u)", fd, (unsigned)websocket_client_count());
         return ESP_OK;
     }
@@ -136,6 +147,12 @@ static esp_err_t ws_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
+static bool sample_clients(int64_t *value)
+{
+    *value = (int64_t)websocket_client_count();
+    return true;
+}
+
 static int cmd_ws(int argc, char **argv)
 {
     (void)argc;
@@ -152,8 +169,13 @@ esp_err_t websocket_init(void)
         return ESP_ERR_NO_MEM;
     }
 
-    httpd_handle_t server = http_server_get_handle();
-    if (!server)
+    metrics_gauge_sampled("cos_ws_clients", "Connected WebSocket clients", sample_clients);
+    s_frames_sent = metrics_counter("cos_ws_frames_sent_total", "WebSocket frames broadcast to clients");
+    s_send_failures = metrics_counter("cos_ws_send_failures_total", "Broadcast sends that dropped a client");
+
+    httpd_handle_t servers[2];
+    size_t n_servers = http_server_get_handles(servers, 2);
+    if (n_servers == 0)
     {
         ESP_LOGE(TAG, "HTTP server not running");
         return ESP_ERR_INVALID_STATE;
@@ -166,7 +188,10 @@ esp_err_t websocket_init(void)
         .user_ctx = NULL,
         .is_websocket = true,
     };
-    httpd_register_uri_handler(server, &ws_uri);
+    for (size_t i = 0; i < n_servers; i++)
+    {
+        httpd_register_uri_handler(servers[i], &ws_uri);
+    }
 
     const esp_console_cmd_t cmd = {
         .command = "ws",
@@ -1,4 +1,5 @@
 #include "wifi.h"
+#include "metrics.h"
 #include "wifi_default_config.h"
 
 #include "esp_check.h"
@@ -19,9 +20,36 @@ static const char *const TAG = "wifi";
 static esp_netif_t *s_sta_netif = NULL;
 static esp_netif_t *s_ap_netif = NULL;
 static EventGroupHandle_t s_event_group = NULL;
+static metric_t *s_disconnects = NULL;
 
 void wifi_register_commands(void);
 
+/* --- Metrics --- */
+
+static bool sample_rssi(int64_t *value)
+{
+    wifi_ap_record_t ap_info;
+    if (!wifi_is_connected() || esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK)
+    {
+        return false;
+    }
+    *value = ap_info.rssi;
+    return true;
+}
+
+static bool sample_connected(int64_t *value)
+{
+    *value = wifi_is_connected() ? 1 : 0;
+    return true;
+}
+
+static void register_metrics(void)
+{
+    metrics_gauge_sampled("cos_wifi_rssi_dbm", "Signal strength of the connected AP", sample_rssi);
+    metrics_gauge_sampled("cos_wifi_connected", "1 while the station has an IP address", sample_connected);
+    s_disconnects = metrics_counter("cos_wifi_disconnects_total", "Station disconnect events");
+}
+
 /* --- Event handler --- */
 
 static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
@@ -39,6 +67,7 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t e
         case WIFI_EVENT_STA_DISCONNECTED:
             ESP_LOGW(TAG, "STA disconnected");
             xEventGroupClearBits(s_event_group, WIFI_CONNECTED_BIT | WIFI_GOT_IP_BIT);
+            metrics_counter_add(s_disconnects, 1);
             break;
         default:
             break;
@@ -101,6 +130,7 @@ esp_err_t wifi_init(void)
     ap_cfg.ap.authmode = strlen(WIFI_AP_DEFAULT_PASSWORD) > 0 ? WIFI_AUTH_WPA2_PSK : WIFI_AUTH_OPEN;
 
     wifi_register_commands();
+    register_metrics();
 
     if (!wifi_has_stored_credentials())
     {
@@ -6,6 +6,8 @@
 #include "http_server.h"
 #include "i2c_bus.h"
 #include "light_sensor.h"
+#include "metrics.h"
+#include "ota.h"
 #include "rgb_led.h"
 #include "shell.h"
 #include "system.h"
@@ -36,6 +38,7 @@ void app_main(void)
     ESP_LOGI(TAG, "COS starting up...");
 
     ESP_ERROR_CHECK(init_nvs());
+    ESP_ERROR_CHECK(metrics_init());
     ESP_ERROR_CHECK(display_init());
     ESP_ERROR_CHECK(calibration_init());
     ESP_ERROR_CHECK(light_sensor_init());
@@ -44,6 +47,7 @@ void app_main(void)
     ESP_ERROR_CHECK(text_console_init());
     ESP_ERROR_CHECK(i2c_bus_init());
     ESP_ERROR_CHECK(filesystem_init());
+    ESP_ERROR_CHECK(ota_init());
     ESP_ERROR_CHECK(wifi_init());
     ESP_ERROR_CHECK(bluetooth_init());
     ESP_ERROR_CHECK(time_sync_init());
@@ -53,5 +57,8 @@ void app_main(void)
     ESP_ERROR_CHECK(shell_init());
     bluetooth_hid_set_keyboard_callback(shell_feed_input);
 
+    /* Everything came up: keep this image (a reset before this point rolls an update back) */
+    ota_mark_valid();
+
     ESP_LOGI(TAG, "COS ready");
 }
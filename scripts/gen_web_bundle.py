@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+"""Generate a C table of gzipped web assets for the http_server component.
+
+Every file below the input directory is gzipped and emitted as a const
+array in flash rodata, together with its URL path, MIME type, ETag and
+length. Entries are sorted by path so the firmware can binary-search them.
+A missing input directory produces an empty table.
+
+Usage: gen_web_bundle.py <asset_dir> <output.c>
+"""
+
+import gzip
+import hashlib
+import os
+import sys
+
+MIME_TYPES = {
+    ".html": "text/html",
+    ".htm": "text/html",
+    ".js": "application/javascript",
+    ".css": "text/css",
+    ".json": "application/json",
+    ".png": "image/png",
+    ".jpg": "image/jpeg",
+    ".jpeg": "image/jpeg",
+    ".gif": "image/gif",
+    ".ico": "image/x-icon",
+    ".svg": "image/svg+xml",
+    ".woff": "font/woff",
+    ".woff2": "font/woff2",
+}
+
+BYTES_PER_LINE = 16
+
+
+def mime_type(path):
+    return MIME_TYPES.get(os.path.splitext(path)[1].lower(), "application/octet-stream")
+
+
+def c_string(text):
+    if any(ord(c) < 0x20 or ord(c) > 0x7E for c in text):
+        raise ValueError(f"unsupported character in asset path: {text!r}")
+    return '"' + text.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def collect_assets(asset_dir):
+    assets = []
+    if not os.path.isdir(asset_dir):
+        return assets
+    for root, dirs, files in os.walk(asset_dir):
+        dirs[:] = [d for d in dirs if not d.startswith(".")]
+        for name in files:
+            if name.startswith("."):
+                continue
+            full = os.path.join(root, name)
+            rel = os.path.relpath(full, asset_dir).replace(os.sep, "/")
+            with open(full, "rb") as f:
+                raw = f.read()
+            # mtime=0 keeps the output byte-identical across rebuilds
+            data = gzip.compress(raw, compresslevel=9, mtime=0)
+            etag = '"' + hashlib.sha256(raw).hexdigest()[:16] + '"'
+            assets.append(("/" + rel, mime_type(rel), etag, data, len(raw)))
+    assets.sort(key=lambda a: a[0].encode("utf-8"))
+    return assets
+
+
+def render(assets):
+    out = [
+        "/* Generated by scripts/gen_web_bundle.py -- do not edit. */",
+        '#include "http_bundle.h"',
+        "",
+        "#include <stdint.h>",
+        "",
+    ]
+    total_raw = 0
+    total_gz = 0
+    for i, (path, _, _, data, raw_len) in enumerate(assets):
+        total_raw += raw_len
+        total_gz += len(data)
+        out.append(f"/* {path}: {raw_len} -> {len(data)} bytes */")
+        out.append(f"static const uint8_t s_asset_{i}[] = {{")
+        for off in range(0, len(data), BYTES_PER_LINE):
+            line = ", ".join(f"0x{b:02x}" for b in data[off : off + BYTES_PER_LINE])
+            out.append(f"    {line},")
+        out.append("};")
+        out.append("")
+
+    out.append(f"const http_bundle_asset_t g_http_bundle_assets[{max(len(assets), 1)}] = {{")
+    for i, (path, mime, etag, data, _) in enumerate(assets):
+        out.append(f"    {{{c_string(path)}, {c_string(mime)}, {c_string(etag)}, s_asset_{i}, {len(data)}}},")
+    if not assets:
+        out.append("    {0},")
+    out.append("};")
+    out.append(f"const size_t g_http_bundle_count = {len(assets)};")
+    out.append("")
+    return "\n".join(out), total_raw, total_gz
+
+
+def main(argv):
+    if len(argv) != 3:
+        print(__doc__.strip().splitlines()[-1], file=sys.stderr)
+        return 2
+
+    asset_dir, output = argv[1], argv[2]
+    assets = collect_assets(asset_dir)
+    source, total_raw, total_gz = render(assets)
+
+    # Only touch the output when it changes, so unchanged assets don't trigger a relink
+    if os.path.exists(output):
+        with open(output, encoding="utf-8") as f:
+            if f.read() == source:
+                return 0
+    os.makedirs(os.path.dirname(os.path.abspath(output)), exist_ok=True)
+    with open(output, "w", encoding="utf-8") as f:
+        f.write(source)
+    print(f"web bundle: {len(assets)} assets, {total_raw} -> {total_gz} bytes")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,148 @@
+/*
+ * Host benchmark for the gzip filter in http_stream.
+ *
+ * Streams three bodies through http_stream with and without http_stream_gzip():
+ * an /api/files listing, console-style log text and incompressible bytes.
+ * Reports compressed size, chunk sends and encoder throughput, and from those
+ * the link speed below which compressing saves time overall:
+ *
+ *   plain: in / link          gzip: in / cpu + out / link
+ *   gzip wins while link < cpu * (1 - out / in)
+ *
+ * The host cpu figure only shows the shape of the trade-off; for the device,
+ * put the encoder rate measured on the ESP32 into the same formula.
+ * Usage: bench_http_gzip [kilobytes] [iterations]
+ */
+#include "http_stream.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static size_t s_bytes;
+static size_t s_sends;
+
+static esp_err_t count_sink(void *ctx, const char *data, size_t len)
+{
+    (void)ctx;
+    (void)data;
+    if (len > 0)
+    {
+        s_bytes += len;
+        s_sends++;
+    }
+    return ESP_OK;
+}
+
+static size_t make_listing(char *buf, size_t max)
+{
+    size_t len = 0;
+    for (unsigned i = 0; len + 96 < max; i++)
+    {
+        len += (size_t)snprintf(buf + len, max - len,
+                                "{\"name\":\"sensor_%05u.csv\",\"size\":%u,\"is_dir\":%s,\"mtime\":%u},", i,
+                                i * 7919 % 100000, i % 10 == 0 ? "true" : "false", 1760000000u + i * 61);
+    }
+    return len;
+}
+
+static size_t make_log(char *buf, size_t max)
+{
+    static const char *const tags[] = {"wifi", "http_server", "vfs", "metrics", "ota"};
+    static const char *const msgs[] = {"Connected, got ip 192.168.1.%u", "GET /api/files 200 in %u us",
+                                       "Mounted /sdcard (%u MB free)", "Sampled %u gauges",
+                                       "Running partition ota_%u"};
+    size_t len = 0;
+    for (unsigned i = 0; len + 128 < max; i++)
+    {
+        len += (size_t)snprintf(buf + len, max - len, "I (%u) %s: ", 1000 + i * 13, tags[i % 5]);
+        len += (size_t)snprintf(buf + len, max - len, msgs[i % 5], i * 2654435761u % 1000);
+        buf[len++] = '\n';
+    }
+    return len;
+}
+
+static size_t make_random(char *buf, size_t max)
+{
+    uint32_t x = 2463534242u;
+    for (size_t i = 0; i < max; i++)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        buf[i] = (char)x;
+    }
+    return max;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Returns seconds per body; writes arrive in 128-byte pieces like JSON output */
+static double stream_body(const char *body, size_t len, bool gzip, int iterations)
+{
+    s_bytes = 0;
+    s_sends = 0;
+    double start = now_s();
+    for (int it = 0; it < iterations; it++)
+    {
+        http_stream_t out;
+        http_stream_init_sink(&out, count_sink, NULL);
+        if (gzip)
+        {
+            http_stream_gzip(&out);
+        }
+        for (size_t off = 0; off < len; off += 128)
+        {
+            http_stream_write(&out, body + off, len - off < 128 ? len - off : 128);
+        }
+        http_stream_finish(&out);
+    }
+    return (now_s() - start) / iterations;
+}
+
+static void run(const char *label, const char *body, size_t len, int iterations)
+{
+    double plain_s = stream_body(body, len, false, iterations);
+    size_t plain_sends = s_sends / (size_t)iterations;
+    double gzip_s = stream_body(body, len, true, iterations);
+    size_t out = s_bytes / (size_t)iterations;
+    size_t gzip_sends = s_sends / (size_t)iterations;
+
+    double cpu = (double)len / (gzip_s - plain_s > 1e-9 ? gzip_s - plain_s : 1e-9);
+    double saved = 1.0 - (double)out / (double)len;
+    printf("%-8s %8zu -> %8zu bytes (%5.1f%%)  sends %4zu -> %4zu  encoder %7.1f MB/s  break-even link %7.1f MB/s\n",
+           label, len, out, 100.0 * (double)out / (double)len, plain_sends, gzip_sends, cpu / 1e6,
+           saved > 0 ? cpu * saved / 1e6 : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+    size_t kb = (argc > 1) ? (size_t)atoi(argv[1]) : 256;
+    int iterations = (argc > 2) ? atoi(argv[2]) : 20;
+    if (kb == 0 || iterations <= 0)
+    {
+        fprintf(stderr, "usage: %s [kilobytes] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    size_t max = kb * 1024;
+    char *body = malloc(max);
+    if (body == NULL)
+    {
+        return 1;
+    }
+
+    printf("Bodies of ~%zu KB, %d iterations, chunk %d bytes\n", kb, iterations, HTTP_STREAM_CHUNK);
+    run("listing", body, make_listing(body, max), iterations);
+    run("log", body, make_log(body, max), iterations);
+    run("random", body, make_random(body, max), iterations);
+
+    free(body);
+    return 0;
+}
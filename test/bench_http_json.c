@@ -0,0 +1,144 @@
+/*
+ * Host benchmark for directory listings built with http_json.
+ *
+ * Renders a synthetic /api/files listing twice: the previous way (snprintf
+ * per entry into a stack buffer, one chunk send per entry) and through the
+ * buffered JSON writer. Reports sends per listing and encoding throughput.
+ * On the device every send is a trip through lwIP, so the send count is the
+ * number that matters; host MB/s only shows the writer is not the bottleneck.
+ * Usage: bench_http_json [entries] [iterations]
+ */
+#include "http_json.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct
+{
+    char name[64];
+    size_t size;
+    bool is_dir;
+} entry_t;
+
+static size_t s_bytes;
+static size_t s_sends;
+
+static esp_err_t count_sink(void *ctx, const char *data, size_t len)
+{
+    (void)ctx;
+    (void)data;
+    s_bytes += len;
+    s_sends++;
+    return ESP_OK;
+}
+
+/* The escaping the handler used before: quotes and backslashes only */
+static size_t legacy_escape(const char *src, char *dst, size_t dst_len)
+{
+    size_t j = 0;
+    for (size_t i = 0; src[i] != '\0' && j < dst_len - 1; i++)
+    {
+        char c = src[i];
+        if (c == '"' || c == '\\')
+        {
+            if (j + 2 >= dst_len)
+            {
+                break;
+            }
+            dst[j++] = '\\';
+        }
+        dst[j++] = c;
+    }
+    dst[j] = '\0';
+    return j;
+}
+
+static void legacy_listing(const entry_t *entries, size_t count)
+{
+    count_sink(NULL, "[", 1);
+    for (size_t i = 0; i < count; i++)
+    {
+        char escaped_name[128];
+        legacy_escape(entries[i].name, escaped_name, sizeof(escaped_name));
+        char item[256];
+        int n = snprintf(item, sizeof(item), "%s{\"name\":\"%s\",\"size\":%u,\"is_dir\":%s}", (i > 0) ? "," : "",
+                         escaped_name, (unsigned)entries[i].size, entries[i].is_dir ? "true" : "false");
+        count_sink(NULL, item, (size_t)n);
+    }
+    count_sink(NULL, "]", 1);
+    count_sink(NULL, NULL, 0);
+}
+
+static void writer_listing(const entry_t *entries, size_t count)
+{
+    http_stream_t out;
+    http_json_t j;
+    http_stream_init_sink(&out, count_sink, NULL);
+    http_json_init(&j, &out);
+    http_json_array_begin(&j);
+    for (size_t i = 0; i < count; i++)
+    {
+        http_json_object_begin(&j);
+        http_json_kv_string(&j, "name", entries[i].name);
+        http_json_kv_uint(&j, "size", entries[i].size);
+        http_json_kv_bool(&j, "is_dir", entries[i].is_dir);
+        http_json_object_end(&j);
+    }
+    http_json_array_end(&j);
+    http_stream_finish(&out);
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void run(const char *label, void (*fn)(const entry_t *, size_t), const entry_t *entries, size_t count,
+                int iterations)
+{
+    s_bytes = 0;
+    s_sends = 0;
+    double start = now_s();
+    for (int i = 0; i < iterations; i++)
+    {
+        fn(entries, count);
+    }
+    double elapsed = now_s() - start;
+    printf("%-8s %8zu bytes/listing  %6zu sends/listing  %8.1f MB/s\n", label, s_bytes / (size_t)iterations,
+           s_sends / (size_t)iterations, (double)s_bytes / elapsed / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+    size_t count = (argc > 1) ? (size_t)atoi(argv[1]) : 5000;
+    int iterations = (argc > 2) ? atoi(argv[2]) : 50;
+    if (count == 0 || iterations <= 0)
+    {
+        fprintf(stderr, "usage: %s [entries] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    entry_t *entries = malloc(count * sizeof(entry_t));
+    if (entries == NULL)
+    {
+        return 1;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        /* Every 16th name needs escaping */
+        snprintf(entries[i].name, sizeof(entries[i].name), (i % 16 == 0) ? "log \"%zu\".txt" : "sensor_%05zu.csv", i);
+        entries[i].size = i * 37;
+        entries[i].is_dir = (i % 10 == 0);
+    }
+
+    printf("Listing of %zu entries, %d iterations, chunk %d bytes\n", count, iterations, HTTP_STREAM_CHUNK);
+    run("legacy", legacy_listing, entries, count, iterations);
+    run("writer", writer_listing, entries, count, iterations);
+
+    free(entries);
+    return 0;
+}
@@ -11,6 +11,11 @@ typedef int http_method_t;
 
 #define HTTP_GET  0
 #define HTTP_POST 1
+#define HTTP_PUT  2
+#define HTTP_HEAD   3
+#define HTTP_PATCH  4
+#define HTTP_DELETE 5
+#define HTTP_ANY    -1
 
 #define HTTPD_RESP_USE_STRLEN -1
 #define HTTPD_SOCK_ERR_TIMEOUT -1
@@ -18,8 +23,19 @@ typedef int http_method_t;
 
 typedef enum
 {
+    HTTPD_400_BAD_REQUEST = 400,
+    HTTPD_401_UNAUTHORIZED = 401,
+    HTTPD_403_FORBIDDEN = 403,
     HTTPD_404_NOT_FOUND = 404,
+    HTTPD_405_METHOD_NOT_ALLOWED = 405,
+    HTTPD_408_REQ_TIMEOUT = 408,
+    HTTPD_411_LENGTH_REQUIRED = 411,
+    HTTPD_414_URI_TOO_LONG = 414,
+    HTTPD_431_REQ_HDR_FIELDS_TOO_LARGE = 431,
     HTTPD_500_INTERNAL_SERVER_ERROR = 500,
+    HTTPD_501_METHOD_NOT_IMPLEMENTED = 501,
+    HTTPD_505_VERSION_NOT_SUPPORTED = 505,
+    HTTPD_ERR_CODE_MAX
 } httpd_err_code_t;
 
 typedef enum
@@ -46,6 +62,7 @@ typedef struct httpd_req
 typedef esp_err_t (*httpd_uri_func_t)(httpd_req_t *r);
 typedef esp_err_t (*httpd_err_handler_func_t)(httpd_req_t *r, httpd_err_code_t err);
 typedef void (*httpd_close_func_t)(httpd_handle_t hd, int sockfd);
+typedef bool (*httpd_uri_match_func_t)(const char *reference_uri, const char *uri_to_match, size_t match_upto);
 
 typedef struct
 {
@@ -63,6 +80,7 @@ typedef struct
     bool lru_purge_enable;
     unsigned stack_size;
     httpd_close_func_t close_fn;
+    httpd_uri_match_func_t uri_match_fn;
 } httpd_config_t;
 
 #define HTTPD_DEFAULT_CONFIG()       \
@@ -72,10 +90,12 @@ typedef struct
         .lru_purge_enable = false,   \
         .stack_size = 4096,          \
         .close_fn = NULL,            \
+        .uri_match_fn = NULL,        \
     }
 
 esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config);
 esp_err_t httpd_stop(httpd_handle_t handle);
+bool httpd_uri_match_wildcard(const char *reference_uri, const char *uri_to_match, size_t match_upto);
 esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri);
 esp_err_t httpd_register_err_handler(httpd_handle_t handle, httpd_err_code_t error, httpd_err_handler_func_t handler);
 esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type);
@@ -88,8 +108,12 @@ esp_err_t httpd_resp_send_err(httpd_req_t *r, httpd_err_code_t error, const char
 esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len);
 esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t val_size);
 esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val, size_t val_size);
+esp_err_t httpd_req_get_cookie_val(httpd_req_t *req, const char *cookie_name, char *val, size_t *val_size);
 int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len);
+int httpd_send(httpd_req_t *r, const char *buf, size_t buf_len);
 int httpd_req_to_sockfd(httpd_req_t *r);
+esp_err_t httpd_req_async_handler_begin(httpd_req_t *r, httpd_req_t **out);
+esp_err_t httpd_req_async_handler_complete(httpd_req_t *r);
 esp_err_t httpd_ws_recv_frame(httpd_req_t *req, httpd_ws_frame_t *frame, size_t max_len);
 esp_err_t httpd_ws_send_frame(httpd_req_t *req, httpd_ws_frame_t *frame);
 esp_err_t httpd_ws_send_frame_async(httpd_handle_t hd, int fd, httpd_ws_frame_t *frame);
@@ -13,3 +13,20 @@ typedef int BaseType_t;
 #define BIT1 (1 << 1)
 
 #define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+
+typedef unsigned int UBaseType_t;
+
+#define portNUM_PROCESSORS 2
+
+/* Host tests are single-threaded: critical sections and interrupt masks are no-ops */
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define portSET_INTERRUPT_MASK_FROM_ISR() 0u
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(state) ((void)(state))
+
+/* Core the caller runs on; set with mock_freertos_set_core_id() */
+int xPortGetCoreID(void);
@@ -6,6 +6,7 @@ typedef void *SemaphoreHandle_t;
 
 SemaphoreHandle_t xSemaphoreCreateBinary(void);
 SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateCounting(unsigned uxMaxCount, unsigned uxInitialCount);
 BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime);
 BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore);
 void vSemaphoreDelete(SemaphoreHandle_t xSemaphore);
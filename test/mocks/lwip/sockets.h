@@ -0,0 +1,8 @@
+#pragma once
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+/* lwIP maps the BSD names onto lwip_* functions; the mock peer is set with mock_httpd_set_peer_ipv4() */
+int lwip_getpeername(int s, struct sockaddr *name, socklen_t *namelen);
+#define getpeername(s, name, namelen) lwip_getpeername(s, name, namelen)
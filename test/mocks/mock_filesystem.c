@@ -146,6 +146,23 @@ esp_err_t vfs_remove(const char *path)
     return ESP_OK;
 }
 
+esp_err_t vfs_hash_file(const char *path, void *buf, size_t buf_len, vfs_hash_t *out)
+{
+    (void)path;
+    (void)buf;
+    (void)buf_len;
+    (void)out;
+    return ESP_ERR_NOT_FOUND;
+}
+
+void vfs_hash_sha256_hex(const vfs_hash_t *hash, char out[2 * VFS_SHA256_LEN + 1])
+{
+    for (size_t i = 0; i < VFS_SHA256_LEN; i++)
+    {
+        snprintf(out + 2 * i, 3, "%02x", hash->sha256[i]);
+    }
+}
+
 bool vfs_exists(const char *path)
 {
     for (int i = 0; i < s_dir_count; i++)
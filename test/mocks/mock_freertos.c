@@ -1,11 +1,24 @@
 #include "mock_freertos.h"
+#include "freertos/semphr.h"
 
 static EventBits_t s_bits = 0;
 static int s_dummy_group = 1;
+static int s_core_id = 0;
 
 void mock_freertos_reset(void)
 {
     s_bits = 0;
+    s_core_id = 0;
+}
+
+void mock_freertos_set_core_id(int core)
+{
+    s_core_id = core;
+}
+
+int xPortGetCoreID(void)
+{
+    return s_core_id;
 }
 
 void mock_freertos_set_bits(EventBits_t bits)
@@ -58,3 +71,35 @@ EventBits_t xEventGroupWaitBits(EventGroupHandle_t xEventGroup, EventBits_t uxBi
     (void)xTicksToWait;
     return s_bits & uxBitsToWaitFor;
 }
+
+/* --- Semaphores: single-threaded host tests only need valid handles --- */
+
+static int s_dummy_semaphore = 1;
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return (SemaphoreHandle_t)&s_dummy_semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return (SemaphoreHandle_t)&s_dummy_semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime)
+{
+    (void)xSemaphore;
+    (void)xBlockTime;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+    (void)xSemaphore;
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore)
+{
+    (void)xSemaphore;
+}
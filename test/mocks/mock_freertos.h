@@ -5,6 +5,9 @@
 /** Reset mock FreeRTOS state (event group bits). */
 void mock_freertos_reset(void);
 
+/** Set the core xPortGetCoreID() reports. */
+void mock_freertos_set_core_id(int core);
+
 /** Directly set event group bits (simulate event handler setting them). */
 void mock_freertos_set_bits(EventBits_t bits);
 
@@ -1,6 +1,8 @@
 #include "mock_httpd.h"
 #include "esp_http_server.h"
+#include "lwip/sockets.h"
 
+#include <arpa/inet.h>
 #include <string.h>
 
 #define MOCK_MAX_HEADERS 8
@@ -12,17 +14,113 @@ static struct
     char field[MOCK_HDR_FIELD_LEN];
     char value[MOCK_HDR_VALUE_LEN];
     bool set;
-} s_headers[MOCK_MAX_HEADERS];
+} s_headers[MOCK_MAX_HEADERS], s_resp_headers[MOCK_MAX_HEADERS];
 
 static int s_dummy_server = 1;
 static char s_last_status[64];
 static char s_last_type[64];
 
+#define MOCK_RESP_MAX (64 * 1024)
+
+static char s_resp[MOCK_RESP_MAX];
+static size_t s_resp_len;
+static int s_resp_sends;
+static bool s_resp_chunked;
+
+static const char *s_body;
+static size_t s_body_len;
+static size_t s_body_pos;
+static size_t s_body_chunk;
+
+#define MOCK_DEFAULT_PEER 0xC0A8010Au
+static uint32_t s_peer = MOCK_DEFAULT_PEER;
+
 void mock_httpd_reset(void)
 {
     memset(s_headers, 0, sizeof(s_headers));
+    memset(s_resp_headers, 0, sizeof(s_resp_headers));
     s_last_status[0] = '\0';
     s_last_type[0] = '\0';
+    s_resp_len = 0;
+    s_resp_sends = 0;
+    s_resp_chunked = false;
+    s_body = NULL;
+    s_body_len = 0;
+    s_body_pos = 0;
+    s_body_chunk = 0;
+    s_peer = MOCK_DEFAULT_PEER;
+}
+
+void mock_httpd_set_peer_ipv4(uint32_t addr)
+{
+    s_peer = addr;
+}
+
+int lwip_getpeername(int s, struct sockaddr *name, socklen_t *namelen)
+{
+    (void)s;
+    struct sockaddr_in sin = {0};
+    sin.sin_family = AF_INET;
+    sin.sin_addr.s_addr = htonl(s_peer);
+    if (*namelen < sizeof(sin))
+    {
+        return -1;
+    }
+    memcpy(name, &sin, sizeof(sin));
+    *namelen = sizeof(sin);
+    return 0;
+}
+
+void mock_httpd_set_body(const void *data, size_t len, size_t max_chunk)
+{
+    s_body = data;
+    s_body_len = len;
+    s_body_pos = 0;
+    s_body_chunk = max_chunk;
+}
+
+static void capture_resp(const char *data, size_t len)
+{
+    if (data == NULL)
+    {
+        return;
+    }
+    if (len > MOCK_RESP_MAX - 1 - s_resp_len)
+    {
+        len = MOCK_RESP_MAX - 1 - s_resp_len;
+    }
+    memcpy(s_resp + s_resp_len, data, len);
+    s_resp_len += len;
+    s_resp[s_resp_len] = '\0';
+}
+
+const char *mock_httpd_response(size_t *len)
+{
+    if (len != NULL)
+    {
+        *len = s_resp_len;
+    }
+    return s_resp;
+}
+
+int mock_httpd_send_count(void)
+{
+    return s_resp_sends;
+}
+
+bool mock_httpd_response_chunked(void)
+{
+    return s_resp_chunked;
+}
+
+const char *mock_httpd_last_status(void)
+{
+    return s_last_status;
+}
+
+const char *mock_httpd_last_type(void)
+{
+    return s_last_type;
 }
 
 void mock_httpd_set_header(const char *field, const char *value)
@@ -85,31 +183,50 @@ esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status)
 esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value)
 {
     (void)r;
-    (void)field;
-    (void)value;
+    for (int i = 0; i < MOCK_MAX_HEADERS; i++)
+    {
+        if (!s_resp_headers[i].set)
+        {
+            strncpy(s_resp_headers[i].field, field, MOCK_HDR_FIELD_LEN - 1);
+            strncpy(s_resp_headers[i].value, value, MOCK_HDR_VALUE_LEN - 1);
+            s_resp_headers[i].set = true;
+            break;
+        }
+    }
     return ESP_OK;
 }
 
+const char *mock_httpd_resp_header(const char *field)
+{
+    for (int i = 0; i < MOCK_MAX_HEADERS; i++)
+    {
+        if (s_resp_headers[i].set && strcmp(s_resp_headers[i].field, field) == 0)
+        {
+            return s_resp_headers[i].value;
+        }
+    }
+    return NULL;
+}
+
 esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, int buf_len)
 {
     (void)r;
-    (void)buf;
-    (void)buf_len;
+    capture_resp(buf, buf_len == HTTPD_RESP_USE_STRLEN ? (buf ? strlen(buf) : 0) : (size_t)buf_len);
+    s_resp_sends++;
     return ESP_OK;
 }
 
 esp_err_t httpd_resp_sendstr_chunk(httpd_req_t *r, const char *chunk)
 {
-    (void)r;
-    (void)chunk;
-    return ESP_OK;
+    return httpd_resp_send_chunk(r, chunk, chunk ? strlen(chunk) : 0);
 }
 
 esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *chunk, size_t len)
 {
     (void)r;
-    (void)chunk;
-    (void)len;
+    capture_resp(chunk, len);
+    s_resp_sends++;
+    s_resp_chunked = true;
     return ESP_OK;
 }
 
@@ -153,12 +270,64 @@ esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *v
     return ESP_ERR_NOT_FOUND;
 }
 
+esp_err_t httpd_req_get_cookie_val(httpd_req_t *req, const char *cookie_name, char *val, size_t *val_size)
+{
+    char cookies[MOCK_HDR_VALUE_LEN];
+    if (httpd_req_get_hdr_value_str(req, "Cookie", cookies, sizeof(cookies)) != ESP_OK)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    size_t name_len = strlen(cookie_name);
+    const char *p = cookies;
+    while (*p != '\0')
+    {
+        while (*p == ' ' || *p == ';')
+        {
+            p++;
+        }
+        size_t len = strcspn(p, ";");
+        if (len > name_len && strncmp(p, cookie_name, name_len) == 0 && p[name_len] == '=')
+        {
+            size_t vlen = len - name_len - 1;
+            if (vlen >= *val_size)
+            {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            memcpy(val, p + name_len + 1, vlen);
+            val[vlen] = '\0';
+            *val_size = vlen + 1;
+            return ESP_OK;
+        }
+        p += len;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
 int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len)
+{
+    (void)r;
+    size_t n = s_body_len - s_body_pos;
+    if (n > buf_len)
+    {
+        n = buf_len;
+    }
+    if (s_body_chunk > 0 && n > s_body_chunk)
+    {
+        n = s_body_chunk;
+    }
+    if (n > 0)
+    {
+        memcpy(buf, s_body + s_body_pos, n);
+        s_body_pos += n;
+    }
+    return (int)n;
+}
+
+int httpd_send(httpd_req_t *r, const char *buf, size_t buf_len)
 {
     (void)r;
     (void)buf;
-    (void)buf_len;
-    return 0;
+    return (int)buf_len;
 }
 
 int httpd_req_to_sockfd(httpd_req_t *r)
@@ -189,8 +358,3 @@ esp_err_t httpd_ws_send_frame_async(httpd_handle_t hd, int fd, httpd_ws_frame_t
     (void)frame;
     return ESP_OK;
 }
-
-uint32_t esp_get_free_heap_size(void)
-{
-    return 200000;
-}
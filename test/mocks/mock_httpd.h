@@ -1,8 +1,32 @@
 #pragma once
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 void mock_httpd_reset(void);
 
 /** Set the value that httpd_req_get_hdr_value_str returns for the next call. */
 void mock_httpd_set_header(const char *field, const char *value);
+
+/** Client address that getpeername() reports for the request socket (host byte order; reset to 192.168.1.10). */
+void mock_httpd_set_peer_ipv4(uint32_t addr);
+
+/** Serve data from httpd_req_recv, at most max_chunk bytes per call (0 = no limit). Not copied. */
+void mock_httpd_set_body(const void *data, size_t len, size_t max_chunk);
+
+/** Response body captured from httpd_resp_send / httpd_resp_send_chunk since the last reset. */
+const char *mock_httpd_response(size_t *len);
+
+/** Number of httpd_resp_send / httpd_resp_send_chunk calls since the last reset (the terminating chunk counts). */
+int mock_httpd_send_count(void);
+
+/** True if the response was sent with chunked encoding. */
+bool mock_httpd_response_chunked(void);
+
+/** Status line and content type set on the response. */
+const char *mock_httpd_last_status(void);
+const char *mock_httpd_last_type(void);
+
+/** Value of a response header set with httpd_resp_set_hdr since the last reset, or NULL. */
+const char *mock_httpd_resp_header(const char *field);
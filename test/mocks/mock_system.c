@@ -2,6 +2,7 @@
 #include "esp_system.h"
 #include "esp_flash.h"
 #include "esp_heap_caps.h"
+#include "esp_random.h"
 
 static uint32_t s_free_heap = 200000;
 static uint32_t s_min_free_heap = 150000;
@@ -57,6 +58,27 @@ bool mock_system_restart_called(void)
     return s_restart_called;
 }
 
+/* --- esp_random.h stubs (deterministic xorshift) --- */
+
+static uint32_t s_random_state = 2463534242u;
+
+uint32_t esp_random(void)
+{
+    s_random_state ^= s_random_state << 13;
+    s_random_state ^= s_random_state >> 17;
+    s_random_state ^= s_random_state << 5;
+    return s_random_state;
+}
+
+void esp_fill_random(void *buf, size_t len)
+{
+    uint8_t *p = buf;
+    for (size_t i = 0; i < len; i++)
+    {
+        p[i] = (uint8_t)esp_random();
+    }
+}
+
 /* --- esp_system.h stubs --- */
 
 const char *esp_get_idf_version(void)
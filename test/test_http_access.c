@@ -0,0 +1,210 @@
+#include "unity.h"
+#include "http_access.h"
+#include "mock_system.h"
+
+#include <stdio.h>
+#include <string.h>
+
+void setUp(void)
+{
+    mock_system_reset();
+    http_access_reset_routes();
+}
+
+void tearDown(void) {}
+
+static void record(http_access_route_t *route, uint32_t duration_us, uint16_t status)
+{
+    const http_access_entry_t e = {.duration_us = duration_us, .status = status};
+    http_access_record(route, &e);
+}
+
+void test_bucket_bounds_double(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(HTTP_ACCESS_BUCKET0_US, http_access_bucket_bound(0));
+    TEST_ASSERT_EQUAL_UINT32(HTTP_ACCESS_BUCKET0_US * 2, http_access_bucket_bound(1));
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)HTTP_ACCESS_BUCKET0_US << (HTTP_ACCESS_BUCKETS - 2),
+                             http_access_bucket_bound(HTTP_ACCESS_BUCKETS - 2));
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, http_access_bucket_bound(HTTP_ACCESS_BUCKETS - 1));
+}
+
+void test_durations_land_in_log_buckets(void)
+{
+    http_access_route_t *r = http_access_route("GET /api/x");
+    record(r, 0, 200);
+    record(r, HTTP_ACCESS_BUCKET0_US - 1, 200);
+    record(r, HTTP_ACCESS_BUCKET0_US, 200);
+    record(r, HTTP_ACCESS_BUCKET0_US * 2 - 1, 200);
+    record(r, HTTP_ACCESS_BUCKET0_US * 2, 200);
+    record(r, UINT32_MAX, 200);
+
+    TEST_ASSERT_EQUAL_UINT32(2, r->buckets[0]);
+    TEST_ASSERT_EQUAL_UINT32(2, r->buckets[1]);
+    TEST_ASSERT_EQUAL_UINT32(1, r->buckets[2]);
+    TEST_ASSERT_EQUAL_UINT32(1, r->buckets[HTTP_ACCESS_BUCKETS - 1]);
+    TEST_ASSERT_EQUAL_UINT32(6, r->count);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, r->max_us);
+}
+
+void test_percentiles_interpolate_within_bucket(void)
+{
+    http_access_route_t *r = http_access_route("GET /api/x");
+    TEST_ASSERT_EQUAL_UINT32(0, http_access_percentile(r, 50));
+
+    for (int i = 0; i < 90; i++)
+    {
+        record(r, 100, 200);
+    }
+    for (int i = 0; i < 10; i++)
+    {
+        record(r, 10000, 200);
+    }
+
+    /* 90 samples in [0, 128): the 50th sits 50/90 of the way up */
+    TEST_ASSERT_EQUAL_UINT32(71, http_access_percentile(r, 50));
+    /* The slow tail is in [8192, 16384), capped at the observed max of 10000 */
+    TEST_ASSERT_EQUAL_UINT32(9096, http_access_percentile(r, 95));
+    TEST_ASSERT_EQUAL_UINT32(9819, http_access_percentile(r, 99));
+    TEST_ASSERT_EQUAL_UINT32(10000, http_access_percentile(r, 100));
+}
+
+void test_status_classes_are_counted(void)
+{
+    http_access_route_t *r = http_access_route("GET /api/x");
+    record(r, 1, 200);
+    record(r, 1, 204);
+    record(r, 1, 304);
+    record(r, 1, 404);
+    record(r, 1, 503);
+    record(r, 1, 0);
+
+    TEST_ASSERT_EQUAL_UINT32(0, r->status[0]);
+    TEST_ASSERT_EQUAL_UINT32(2, r->status[1]);
+    TEST_ASSERT_EQUAL_UINT32(1, r->status[2]);
+    TEST_ASSERT_EQUAL_UINT32(1, r->status[3]);
+    TEST_ASSERT_EQUAL_UINT32(1, r->status[4]);
+    TEST_ASSERT_EQUAL_UINT32(6, r->count);
+}
+
+void test_registry_reuses_names_and_overflows_to_other(void)
+{
+    static char names[HTTP_ACCESS_ROUTES][16];
+    http_access_route_t *first = http_access_route("GET /api/a");
+    TEST_ASSERT_EQUAL_PTR(first, http_access_route("GET /api/a"));
+
+    /* Entry 0 is "other", the first registration took entry 1 */
+    for (int i = 2; i < HTTP_ACCESS_ROUTES; i++)
+    {
+        snprintf(names[i], sizeof(names[i]), "r%d", i);
+        TEST_ASSERT_NOT_EQUAL(0, strcmp("other", http_access_route(names[i])->name));
+    }
+    TEST_ASSERT_EQUAL_STRING("other", http_access_route("one too many")->name);
+
+    http_access_route_t snap;
+    TEST_ASSERT_TRUE(http_access_route_get(0, &snap));
+    TEST_ASSERT_EQUAL_STRING("other", snap.name);
+    TEST_ASSERT_TRUE(http_access_route_get(HTTP_ACCESS_ROUTES - 1, &snap));
+    TEST_ASSERT_FALSE(http_access_route_get(HTTP_ACCESS_ROUTES, &snap));
+}
+
+void test_ring_keeps_newest_oldest_first(void)
+{
+    http_access_route_t *r = http_access_route("GET /api/x");
+    for (uint32_t i = 0; i < HTTP_ACCESS_LOG_SIZE + 5; i++)
+    {
+        record(r, i, 200);
+    }
+
+    static http_access_entry_t out[HTTP_ACCESS_LOG_SIZE];
+    TEST_ASSERT_EQUAL(HTTP_ACCESS_LOG_SIZE, http_access_log_read(out, HTTP_ACCESS_LOG_SIZE));
+    TEST_ASSERT_EQUAL_UINT32(5, out[0].duration_us);
+    TEST_ASSERT_EQUAL_UINT32(HTTP_ACCESS_LOG_SIZE + 4, out[HTTP_ACCESS_LOG_SIZE - 1].duration_us);
+    TEST_ASSERT_EQUAL_STRING("GET /api/x", out[0].route);
+
+    TEST_ASSERT_EQUAL(3, http_access_log_read(out, 3));
+    TEST_ASSERT_EQUAL_UINT32(HTTP_ACCESS_LOG_SIZE + 2, out[0].duration_us);
+    TEST_ASSERT_EQUAL_UINT32(HTTP_ACCESS_LOG_SIZE + 4, out[2].duration_us);
+
+    http_access_reset();
+    TEST_ASSERT_EQUAL(0, http_access_log_read(out, HTTP_ACCESS_LOG_SIZE));
+    TEST_ASSERT_EQUAL_UINT32(0, r->count);
+    TEST_ASSERT_EQUAL_STRING("GET /api/x", r->name);
+}
+
+void test_uri_hash_ignores_query(void)
+{
+    TEST_ASSERT_EQUAL_HEX32(http_access_uri_hash("/api/files"), http_access_uri_hash("/api/files?path=/flash"));
+    TEST_ASSERT_NOT_EQUAL(http_access_uri_hash("/api/files"), http_access_uri_hash("/api/heap"));
+}
+
+void test_request_lifecycle_records_status_bytes_and_time(void)
+{
+    http_access_route_t *r = http_access_route("GET /api/x");
+    httpd_req_t req = {.uri = "/api/x?y=1", .method = HTTP_GET};
+
+    mock_system_set_uptime_us(1000000);
+    http_access_begin(&req, r);
+    http_access_note_status(&req, 404);
+    http_access_note_bytes(&req, 10);
+    http_access_note_bytes(&req, 5);
+    mock_system_set_uptime_us(1002500);
+    http_access_end(&req, false);
+
+    http_access_entry_t e;
+    TEST_ASSERT_EQUAL(1, http_access_log_read(&e, 1));
+    TEST_ASSERT_EQUAL_UINT16(404, e.status);
+    TEST_ASSERT_EQUAL_UINT32(15, e.bytes);
+    TEST_ASSERT_EQUAL_UINT32(2500, e.duration_us);
+    TEST_ASSERT_EQUAL_UINT32(1002, e.end_ms);
+    TEST_ASSERT_EQUAL_HEX32(http_access_uri_hash("/api/x"), e.uri_hash);
+    TEST_ASSERT_EQUAL(HTTP_GET, e.method);
+    TEST_ASSERT_EQUAL_UINT32(1, r->status[3]);
+
+    /* A second end, or one without a begin, records nothing */
+    http_access_end(&req, false);
+    TEST_ASSERT_EQUAL_UINT32(1, r->count);
+}
+
+void test_default_status_and_unmatched_route(void)
+{
+    httpd_req_t req = {.uri = "/nowhere", .method = HTTP_GET};
+    http_access_begin(&req, NULL);
+    http_access_end(&req, false);
+
+    http_access_entry_t e;
+    TEST_ASSERT_EQUAL(1, http_access_log_read(&e, 1));
+    TEST_ASSERT_EQUAL_UINT16(200, e.status);
+    TEST_ASSERT_EQUAL_STRING("other", e.route);
+}
+
+void test_async_request_is_recorded_by_worker(void)
+{
+    http_access_route_t *r = http_access_route("POST /api/slow");
+    httpd_req_t req = {.uri = "/api/slow", .method = HTTP_POST};
+
+    http_access_begin(&req, r);
+    http_access_set_async(&req, true);
+    http_access_end(&req, false);
+    TEST_ASSERT_EQUAL_UINT32(0, r->count);
+
+    http_access_note_status(&req, 201);
+    http_access_end(&req, true);
+    TEST_ASSERT_EQUAL_UINT32(1, r->count);
+    TEST_ASSERT_EQUAL_UINT32(1, r->status[1]);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_bucket_bounds_double);
+    RUN_TEST(test_durations_land_in_log_buckets);
+    RUN_TEST(test_percentiles_interpolate_within_bucket);
+    RUN_TEST(test_status_classes_are_counted);
+    RUN_TEST(test_registry_reuses_names_and_overflows_to_other);
+    RUN_TEST(test_ring_keeps_newest_oldest_first);
+    RUN_TEST(test_uri_hash_ignores_query);
+    RUN_TEST(test_request_lifecycle_records_status_bytes_and_time);
+    RUN_TEST(test_default_status_and_unmatched_route);
+    RUN_TEST(test_async_request_is_recorded_by_worker);
+    return UNITY_END();
+}
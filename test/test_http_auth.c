@@ -2,6 +2,8 @@
 #include "http_server.h"
 #include "mock_httpd.h"
 #include "mock_nvs.h"
+#include "mock_system.h"
+#include "http_auth.h"
 #include "mbedtls/base64.h"
 
 #include <stdio.h>
@@ -23,7 +25,9 @@ void setUp(void)
 {
     mock_httpd_reset();
     mock_nvs_reset();
-    /* Re-init auth with default credentials */
+    mock_system_reset();
+    /* Re-init auth with default credentials; also drops sessions and throttling */
+    http_auth_init();
     http_auth_set_credentials("cos", "cos12345");
 }
 
@@ -121,6 +125,171 @@ void test_invalid_credentials_rejected(void)
     TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_auth_set_credentials("user", ""));
 }
 
+static void set_bearer(const char *token)
+{
+    char hdr[64];
+    snprintf(hdr, sizeof(hdr), "Bearer %s", token);
+    mock_httpd_set_header("Authorization", hdr);
+}
+
+void test_session_token_as_bearer(void)
+{
+    char token[HTTP_AUTH_TOKEN_LEN + 1];
+    TEST_ASSERT_EQUAL(ESP_OK, http_auth_session_create(token, sizeof(token)));
+    TEST_ASSERT_EQUAL(HTTP_AUTH_TOKEN_LEN, strlen(token));
+    set_bearer(token);
+
+    httpd_req_t req = {0};
+    TEST_ASSERT_EQUAL(ESP_OK, http_auth_check(&req));
+}
+
+void test_session_token_as_cookie(void)
+{
+    char token[HTTP_AUTH_TOKEN_LEN + 1];
+    TEST_ASSERT_EQUAL(ESP_OK, http_auth_session_create(token, sizeof(token)));
+    char cookie[96];
+    snprintf(cookie, sizeof(cookie), "theme=dark; " HTTP_AUTH_COOKIE "=%s", token);
+    mock_httpd_set_header("Cookie", cookie);
+
+    httpd_req_t req = {0};
+    TEST_ASSERT_EQUAL(ESP_OK, http_auth_check(&req));
+
+    char got[HTTP_AUTH_TOKEN_LEN + 1];
+    TEST_ASSERT_TRUE(http_auth_request_token(&req, got, sizeof(got)));
+    TEST_ASSERT_EQUAL_STRING(token, got);
+}
+
+void test_forged_and_malformed_tokens_rejected(void)
+{
+    char token[HTTP_AUTH_TOKEN_LEN + 1];
+    TEST_ASSERT_EQUAL(ESP_OK, http_auth_session_create(token, sizeof(token)));
+    TEST_ASSERT_TRUE(http_auth_session_valid(token));
+
+    char forged[HTTP_AUTH_TOKEN_LEN + 1];
+    strcpy(forged, token);
+    forged[HTTP_AUTH_TOKEN_LEN - 1] = forged[HTTP_AUTH_TOKEN_LEN - 1] == '0' ? '1' : '0';
+    TEST_ASSERT_FALSE(http_auth_session_valid(forged));
+
+    forged[HTTP_AUTH_TOKEN_LEN - 1] = '\0';
+    TEST_ASSERT_FALSE(http_auth_session_valid(forged));
+    TEST_ASSERT_FALSE(http_auth_session_valid(""));
+    TEST_ASSERT_FALSE(http_auth_session_valid(NULL));
+    TEST_ASSERT_FALSE(http_auth_session_valid("zzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz"));
+
+    char small[8];
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, http_auth_session_create(small, sizeof(small)));
+}
+
+void test_session_expires(void)
+{
+    char token[HTTP_AUTH_TOKEN_LEN + 1];
+    TEST_ASSERT_EQUAL(ESP_OK, http_auth_session_create(token, sizeof(token)));
+    mock_system_set_uptime_us((int64_t)HTTP_AUTH_SESSION_TTL_S * 1000000 - 1);
+    TEST_ASSERT_TRUE(http_auth_session_valid(token));
+    mock_system_set_uptime_us((int64_t)HTTP_AUTH_SESSION_TTL_S * 1000000);
+    TEST_ASSERT_FALSE(http_auth_session_valid(token));
+}
+
+void test_session_revoke_and_credential_change(void)
+{
+    char a[HTTP_AUTH_TOKEN_LEN + 1];
+    char b[HTTP_AUTH_TOKEN_LEN + 1];
+    TEST_ASSERT_EQUAL(ESP_OK, http_auth_session_create(a, sizeof(a)));
+    TEST_ASSERT_EQUAL(ESP_OK, http_auth_session_create(b, sizeof(b)));
+
+    http_auth_session_revoke(a);
+    TEST_ASSERT_FALSE(http_auth_session_valid(a));
+    TEST_ASSERT_TRUE(http_auth_session_valid(b));
+
+    http_auth_set_credentials("admin", "secret");
+    TEST_ASSERT_FALSE(http_auth_session_valid(b));
+}
+
+void test_full_table_evicts_oldest(void)
+{
+    char tokens[HTTP_AUTH_SESSIONS + 1][HTTP_AUTH_TOKEN_LEN + 1];
+    for (int i = 0; i <= HTTP_AUTH_SESSIONS; i++)
+    {
+        mock_system_set_uptime_us((int64_t)i * 1000000);
+        TEST_ASSERT_EQUAL(ESP_OK, http_auth_session_create(tokens[i], sizeof(tokens[i])));
+    }
+    TEST_ASSERT_FALSE(http_auth_session_valid(tokens[0]));
+    for (int i = 1; i <= HTTP_AUTH_SESSIONS; i++)
+    {
+        TEST_ASSERT_TRUE(http_auth_session_valid(tokens[i]));
+    }
+}
+
+void test_repeated_failures_are_throttled(void)
+{
+    char token[HTTP_AUTH_TOKEN_LEN + 1];
+    TEST_ASSERT_EQUAL(ESP_OK, http_auth_session_create(token, sizeof(token)));
+
+    char bad[256];
+    build_basic_header("cos", "guess", bad, sizeof(bad));
+    httpd_req_t req = {0};
+    for (int i = 0; i < HTTP_AUTH_FAIL_BURST; i++)
+    {
+        mock_httpd_reset();
+        mock_httpd_set_header("Authorization", bad);
+        TEST_ASSERT_EQUAL(ESP_FAIL, http_auth_check(&req));
+        TEST_ASSERT_EQUAL_STRING("401 Unauthorized", mock_httpd_last_status());
+    }
+
+    /* Even the right password is refused while throttled */
+    char good[256];
+    build_basic_header("cos", "cos12345", good, sizeof(good));
+    mock_httpd_reset();
+    mock_httpd_set_header("Authorization", good);
+    TEST_ASSERT_EQUAL(ESP_FAIL, http_auth_check(&req));
+    TEST_ASSERT_EQUAL_STRING("429 Too Many Requests", mock_httpd_last_status());
+    TEST_ASSERT_EQUAL_STRING("2", mock_httpd_resp_header("Retry-After"));
+
+    /* A valid session is not affected */
+    mock_httpd_reset();
+    set_bearer(token);
+    TEST_ASSERT_EQUAL(ESP_OK, http_auth_check(&req));
+
+    /* One interval later a single attempt goes through */
+    mock_system_set_uptime_us((int64_t)HTTP_AUTH_FAIL_INTERVAL_MS * 1000);
+    mock_httpd_reset();
+    mock_httpd_set_header("Authorization", good);
+    TEST_ASSERT_EQUAL(ESP_OK, http_auth_check(&req));
+}
+
+void test_throttling_is_per_client(void)
+{
+    char bad[256];
+    build_basic_header("cos", "guess", bad, sizeof(bad));
+    httpd_req_t req = {0};
+    for (int i = 0; i <= HTTP_AUTH_FAIL_BURST; i++)
+    {
+        mock_httpd_reset();
+        mock_httpd_set_peer_ipv4(0xC0A80163);
+        mock_httpd_set_header("Authorization", bad);
+        TEST_ASSERT_EQUAL(ESP_FAIL, http_auth_check(&req));
+    }
+    TEST_ASSERT_EQUAL_STRING("429 Too Many Requests", mock_httpd_last_status());
+
+    /* Another client still gets in with the right password */
+    char good[256];
+    build_basic_header("cos", "cos12345", good, sizeof(good));
+    mock_httpd_reset();
+    mock_httpd_set_header("Authorization", good);
+    TEST_ASSERT_EQUAL(ESP_OK, http_auth_check(&req));
+}
+
+void test_bare_requests_are_not_counted(void)
+{
+    httpd_req_t req = {0};
+    for (int i = 0; i < HTTP_AUTH_FAIL_BURST * 2; i++)
+    {
+        mock_httpd_reset();
+        TEST_ASSERT_EQUAL(ESP_FAIL, http_auth_check(&req));
+        TEST_ASSERT_EQUAL_STRING("401 Unauthorized", mock_httpd_last_status());
+    }
+}
+
 int main(void)
 {
     UNITY_BEGIN();
@@ -133,5 +302,14 @@ int main(void)
     RUN_TEST(test_credential_update);
     RUN_TEST(test_old_credentials_rejected_after_update);
     RUN_TEST(test_invalid_credentials_rejected);
+    RUN_TEST(test_session_token_as_bearer);
+    RUN_TEST(test_session_token_as_cookie);
+    RUN_TEST(test_forged_and_malformed_tokens_rejected);
+    RUN_TEST(test_session_expires);
+    RUN_TEST(test_session_revoke_and_credential_change);
+    RUN_TEST(test_full_table_evicts_oldest);
+    RUN_TEST(test_repeated_failures_are_throttled);
+    RUN_TEST(test_throttling_is_per_client);
+    RUN_TEST(test_bare_requests_are_not_counted);
     return UNITY_END();
 }
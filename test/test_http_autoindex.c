@@ -0,0 +1,168 @@
+#include "unity.h"
+#include "http_autoindex.h"
+#include "http_server.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static char s_out[4096];
+static size_t s_out_len;
+static http_stream_t s_stream;
+
+static esp_err_t capture_sink(void *ctx, const char *data, size_t len)
+{
+    (void)ctx;
+    memcpy(s_out + s_out_len, data, len);
+    s_out_len += len;
+    s_out[s_out_len] = '\0';
+    return ESP_OK;
+}
+
+void setUp(void)
+{
+    s_out_len = 0;
+    s_out[0] = '\0';
+    http_stream_init_sink(&s_stream, capture_sink, NULL);
+}
+
+void tearDown(void) {}
+
+void test_page_has_title_parent_link_and_closes(void)
+{
+    http_autoindex_begin(&s_stream, "/logs/");
+    TEST_ASSERT_EQUAL(ESP_OK, http_autoindex_end(&s_stream));
+    http_stream_finish(&s_stream);
+
+    TEST_ASSERT_NOT_NULL(strstr(s_out, "<title>Index of /logs/</title>"));
+    TEST_ASSERT_NOT_NULL(strstr(s_out, "<a href=\"../\">../</a>"));
+    TEST_ASSERT_NOT_NULL(strstr(s_out, "</table>\n</body></html>\n"));
+}
+
+void test_root_has_no_parent_link(void)
+{
+    http_autoindex_begin(&s_stream, "/");
+    http_stream_finish(&s_stream);
+    TEST_ASSERT_NULL(strstr(s_out, "../"));
+}
+
+void test_file_row_has_size_and_utc_mtime(void)
+{
+    vfs_dir_entry_t e = {.name = "data.csv", .size = 12345, .is_dir = false, .mtime = 1700000000};
+    http_autoindex_entry(&s_stream, &e);
+    http_stream_finish(&s_stream);
+
+    TEST_ASSERT_EQUAL_STRING("<tr><td><a href=\"data.csv\">data.csv</a></td><td class=\"s\">12345</td>"
+                             "<td>2023-11-14 22:13</td></tr>\n",
+                             s_out);
+}
+
+void test_directory_row_links_with_slash_and_no_size(void)
+{
+    vfs_dir_entry_t e = {.name = "2024", .is_dir = true};
+    http_autoindex_entry(&s_stream, &e);
+    http_stream_finish(&s_stream);
+
+    TEST_ASSERT_EQUAL_STRING("<tr><td><a href=\"2024/\">2024/</a></td><td class=\"s\">-</td><td></td></tr>\n", s_out);
+}
+
+void test_names_are_escaped_and_encoded(void)
+{
+    vfs_dir_entry_t e = {.name = "a <b>&\"c\" d#1.txt"};
+    http_autoindex_entry(&s_stream, &e);
+    http_autoindex_begin(&s_stream, "/x<y>/");
+    http_stream_finish(&s_stream);
+
+    TEST_ASSERT_NOT_NULL(strstr(s_out, "href=\"a%20%3Cb%3E%26%22c%22%20d%231.txt\""));
+    TEST_ASSERT_NOT_NULL(strstr(s_out, ">a &lt;b&gt;&amp;&quot;c&quot; d#1.txt</a>"));
+    TEST_ASSERT_NOT_NULL(strstr(s_out, "Index of /x&lt;y&gt;/"));
+    TEST_ASSERT_NULL(strstr(s_out, "<y>"));
+}
+
+/* What the static handler does with the request for a listed link */
+void test_listed_link_decodes_to_the_name(void)
+{
+    const char *name = "log 01 (a)+\xc3\xbc.csv";
+    vfs_dir_entry_t e = {0};
+    strcpy(e.name, name);
+    http_autoindex_entry(&s_stream, &e);
+    http_stream_finish(&s_stream);
+
+    const char *href = strstr(s_out, "href=\"");
+    TEST_ASSERT_NOT_NULL(href);
+    href += 6;
+    char uri[128];
+    int n = snprintf(uri, sizeof(uri), "/logs/%.*s", (int)(strchr(href, '"') - href), href);
+    TEST_ASSERT_TRUE(n > 0 && (size_t)n < sizeof(uri));
+    TEST_ASSERT_NULL(strchr(uri, ' '));
+
+    char path[128];
+    TEST_ASSERT_EQUAL(ESP_OK, http_path_decode(uri, path, sizeof(path)));
+    TEST_ASSERT_EQUAL_STRING("/logs/log 01 (a)+\xc3\xbc.csv", path);
+}
+
+void test_path_decode_rejects_nul_slash_and_bad_escapes(void)
+{
+    char path[32];
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_path_decode("/a%00b", path, sizeof(path)));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_path_decode("/a%2Fb", path, sizeof(path)));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_path_decode("/a%4", path, sizeof(path)));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_path_decode("/a%zz", path, sizeof(path)));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, http_path_decode("/0123456789012345678901234567890123", path,
+                                                             sizeof(path)));
+    TEST_ASSERT_EQUAL(ESP_OK, http_path_decode("/a%2Eb", path, sizeof(path)));
+    TEST_ASSERT_EQUAL_STRING("/a.b", path);
+}
+
+static uint32_t hash_names(const char *a, const char *b)
+{
+    vfs_dir_entry_t e = {0};
+    strcpy(e.name, a);
+    uint32_t h = http_autoindex_hash(HTTP_AUTOINDEX_HASH_INIT, &e);
+    strcpy(e.name, b);
+    return http_autoindex_hash(h, &e);
+}
+
+void test_etag_follows_names_and_mtime(void)
+{
+    char a[HTTP_ETAG_MAX], b[HTTP_ETAG_MAX], c[HTTP_ETAG_MAX];
+
+    uint32_t h1 = hash_names("ab", "c");
+    uint32_t h2 = hash_names("a", "bc");
+    TEST_ASSERT_NOT_EQUAL(h1, h2);
+
+    http_autoindex_etag(1000, h1, a, sizeof(a));
+    http_autoindex_etag(1000, h2, b, sizeof(b));
+    http_autoindex_etag(1001, h1, c, sizeof(c));
+    TEST_ASSERT_EQUAL_STRING_LEN("W/\"", a, 3);
+    TEST_ASSERT_TRUE(strcmp(a, b) != 0);
+    TEST_ASSERT_TRUE(strcmp(a, c) != 0);
+    TEST_ASSERT_TRUE(strlen(a) < HTTP_ETAG_MAX);
+}
+
+/* A log file growing in place must change the listing's validator */
+void test_etag_follows_entry_size_and_mtime(void)
+{
+    vfs_dir_entry_t e = {.name = "log.csv", .size = 1000, .mtime = 1700000000};
+    uint32_t before = http_autoindex_hash(HTTP_AUTOINDEX_HASH_INIT, &e);
+    e.size = 1100;
+    uint32_t grown = http_autoindex_hash(HTTP_AUTOINDEX_HASH_INIT, &e);
+    e.mtime++;
+    uint32_t touched = http_autoindex_hash(HTTP_AUTOINDEX_HASH_INIT, &e);
+    TEST_ASSERT_NOT_EQUAL(before, grown);
+    TEST_ASSERT_NOT_EQUAL(grown, touched);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_page_has_title_parent_link_and_closes);
+    RUN_TEST(test_root_has_no_parent_link);
+    RUN_TEST(test_file_row_has_size_and_utc_mtime);
+    RUN_TEST(test_directory_row_links_with_slash_and_no_size);
+    RUN_TEST(test_names_are_escaped_and_encoded);
+    RUN_TEST(test_listed_link_decodes_to_the_name);
+    RUN_TEST(test_path_decode_rejects_nul_slash_and_bad_escapes);
+    RUN_TEST(test_etag_follows_names_and_mtime);
+    RUN_TEST(test_etag_follows_entry_size_and_mtime);
+    return UNITY_END();
+}
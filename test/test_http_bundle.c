@@ -0,0 +1,53 @@
+#include "unity.h"
+#include "http_bundle.h"
+
+static const uint8_t s_data[] = {0x1f, 0x8b};
+
+/* Stand-in for the table generated by scripts/gen_web_bundle.py (sorted by path) */
+const http_bundle_asset_t g_http_bundle_assets[] = {
+    {"/app.js", "application/javascript", "\"a\"", s_data, sizeof(s_data)},
+    {"/css/site.css", "text/css", "\"b\"", s_data, sizeof(s_data)},
+    {"/favicon.ico", "image/x-icon", "\"c\"", s_data, sizeof(s_data)},
+    {"/index.html", "text/html", "\"d\"", s_data, sizeof(s_data)},
+    {"/manifest.json", "application/json", "\"e\"", s_data, sizeof(s_data)},
+};
+const size_t g_http_bundle_count = sizeof(g_http_bundle_assets) / sizeof(g_http_bundle_assets[0]);
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_finds_every_asset(void)
+{
+    for (size_t i = 0; i < g_http_bundle_count; i++)
+    {
+        const http_bundle_asset_t *a = http_bundle_find(g_http_bundle_assets[i].path);
+        TEST_ASSERT_TRUE(a == &g_http_bundle_assets[i]);
+    }
+}
+
+void test_returns_precomputed_metadata(void)
+{
+    const http_bundle_asset_t *a = http_bundle_find("/index.html");
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_EQUAL_STRING("text/html", a->mime);
+    TEST_ASSERT_EQUAL_STRING("\"d\"", a->etag);
+    TEST_ASSERT_EQUAL(2, a->len);
+}
+
+void test_missing_paths(void)
+{
+    TEST_ASSERT_TRUE(http_bundle_find("/") == NULL);
+    TEST_ASSERT_TRUE(http_bundle_find("/index.htm") == NULL);
+    TEST_ASSERT_TRUE(http_bundle_find("/zzz") == NULL);
+    TEST_ASSERT_TRUE(http_bundle_find("") == NULL);
+    TEST_ASSERT_TRUE(http_bundle_find(NULL) == NULL);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_finds_every_asset);
+    RUN_TEST(test_returns_precomputed_metadata);
+    RUN_TEST(test_missing_paths);
+    return UNITY_END();
+}
@@ -0,0 +1,144 @@
+#include "unity.h"
+#include "http_server.h"
+
+#include <string.h>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/* 1994-11-06 08:49:37 UTC */
+#define RFC_EXAMPLE_TIME ((time_t)784111777)
+
+void test_etag_format(void)
+{
+    char etag[HTTP_ETAG_MAX];
+    http_etag_format(1234, 0x5f000000, etag, sizeof(etag));
+    TEST_ASSERT_EQUAL_STRING("\"4d2-5f000000\"", etag);
+}
+
+void test_etag_changes_with_size_and_mtime(void)
+{
+    char a[HTTP_ETAG_MAX];
+    char b[HTTP_ETAG_MAX];
+    char c[HTTP_ETAG_MAX];
+    http_etag_format(100, 1000, a, sizeof(a));
+    http_etag_format(101, 1000, b, sizeof(b));
+    http_etag_format(100, 1001, c, sizeof(c));
+    TEST_ASSERT_TRUE(strcmp(a, b) != 0);
+    TEST_ASSERT_TRUE(strcmp(a, c) != 0);
+}
+
+void test_date_format_rfc_example(void)
+{
+    char buf[HTTP_DATE_LEN];
+    TEST_ASSERT_EQUAL(ESP_OK, http_date_format(RFC_EXAMPLE_TIME, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("Sun, 06 Nov 1994 08:49:37 GMT", buf);
+}
+
+void test_date_format_epoch_and_leap_day(void)
+{
+    char buf[HTTP_DATE_LEN];
+    TEST_ASSERT_EQUAL(ESP_OK, http_date_format(0, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("Thu, 01 Jan 1970 00:00:00 GMT", buf);
+
+    /* 2024-02-29 12:00:00 UTC */
+    TEST_ASSERT_EQUAL(ESP_OK, http_date_format((time_t)1709208000, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("Thu, 29 Feb 2024 12:00:00 GMT", buf);
+}
+
+void test_date_format_small_buffer(void)
+{
+    char buf[HTTP_DATE_LEN - 1];
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_date_format(0, buf, sizeof(buf)));
+}
+
+void test_date_parse_round_trip(void)
+{
+    time_t t = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, http_date_parse("Sun, 06 Nov 1994 08:49:37 GMT", &t));
+    TEST_ASSERT_EQUAL(RFC_EXAMPLE_TIME, t);
+
+    char buf[HTTP_DATE_LEN];
+    http_date_format((time_t)1709208000, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL(ESP_OK, http_date_parse(buf, &t));
+    TEST_ASSERT_EQUAL(1709208000, t);
+}
+
+void test_date_parse_rejects_obsolete_and_garbage(void)
+{
+    time_t t = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_date_parse("Sunday, 06-Nov-94 08:49:37 GMT", &t));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_date_parse("Sun Nov  6 08:49:37 1994", &t));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_date_parse("Sun, 06 Foo 1994 08:49:37 GMT", &t));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_date_parse("Sun, 06 Nov 1994 25:49:37 GMT", &t));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_date_parse("", &t));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_date_parse(NULL, &t));
+}
+
+void test_etag_matches_exact_and_list(void)
+{
+    TEST_ASSERT_TRUE(http_etag_matches("\"abc\"", "\"abc\""));
+    TEST_ASSERT_TRUE(http_etag_matches("\"x\", \"abc\"", "\"abc\""));
+    TEST_ASSERT_FALSE(http_etag_matches("\"x\", \"y\"", "\"abc\""));
+    TEST_ASSERT_FALSE(http_etag_matches("\"abcd\"", "\"abc\""));
+}
+
+void test_etag_matches_weak_and_star(void)
+{
+    TEST_ASSERT_TRUE(http_etag_matches("W/\"abc\"", "\"abc\""));
+    TEST_ASSERT_TRUE(http_etag_matches("*", "\"abc\""));
+    TEST_ASSERT_FALSE(http_etag_matches("", "\"abc\""));
+    TEST_ASSERT_FALSE(http_etag_matches(NULL, "\"abc\""));
+}
+
+void test_not_modified_if_none_match_precedence(void)
+{
+    /* A mismatching ETag wins over a satisfied If-Modified-Since */
+    TEST_ASSERT_FALSE(http_is_not_modified("\"old\"", "Sun, 06 Nov 1994 08:49:37 GMT", "\"new\"", 1000));
+    TEST_ASSERT_TRUE(http_is_not_modified("\"new\"", NULL, "\"new\"", 1000));
+}
+
+void test_not_modified_if_modified_since(void)
+{
+    TEST_ASSERT_TRUE(http_is_not_modified(NULL, "Sun, 06 Nov 1994 08:49:37 GMT", "\"e\"", RFC_EXAMPLE_TIME));
+    TEST_ASSERT_TRUE(http_is_not_modified("", "Sun, 06 Nov 1994 08:49:37 GMT", "\"e\"", RFC_EXAMPLE_TIME - 5));
+    TEST_ASSERT_FALSE(http_is_not_modified(NULL, "Sun, 06 Nov 1994 08:49:37 GMT", "\"e\"", RFC_EXAMPLE_TIME + 1));
+    TEST_ASSERT_FALSE(http_is_not_modified(NULL, "not a date", "\"e\"", RFC_EXAMPLE_TIME));
+    TEST_ASSERT_FALSE(http_is_not_modified(NULL, "Sun, 06 Nov 1994 08:49:37 GMT", "\"e\"", 0));
+}
+
+void test_if_range_wednesday_date_is_a_date(void)
+{
+    /* Wed, 21 Oct 2015 07:28:00 GMT */
+    const time_t wed = 1445412480;
+    TEST_ASSERT_TRUE(http_if_range_matches("Wed, 21 Oct 2015 07:28:00 GMT", "\"e\"", wed));
+    TEST_ASSERT_FALSE(http_if_range_matches("Wed, 21 Oct 2015 07:28:00 GMT", "\"e\"", wed + 1));
+}
+
+void test_if_range_etags(void)
+{
+    TEST_ASSERT_TRUE(http_if_range_matches(NULL, "\"e\"", 1000));
+    TEST_ASSERT_TRUE(http_if_range_matches("\"e\"", "\"e\"", 1000));
+    TEST_ASSERT_FALSE(http_if_range_matches("\"f\"", "\"e\"", 1000));
+    /* Weak tags never satisfy If-Range, even if they name the current entity */
+    TEST_ASSERT_FALSE(http_if_range_matches("W/\"e\"", "W/\"e\"", 1000));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_etag_format);
+    RUN_TEST(test_etag_changes_with_size_and_mtime);
+    RUN_TEST(test_date_format_rfc_example);
+    RUN_TEST(test_date_format_epoch_and_leap_day);
+    RUN_TEST(test_date_format_small_buffer);
+    RUN_TEST(test_date_parse_round_trip);
+    RUN_TEST(test_date_parse_rejects_obsolete_and_garbage);
+    RUN_TEST(test_etag_matches_exact_and_list);
+    RUN_TEST(test_etag_matches_weak_and_star);
+    RUN_TEST(test_not_modified_if_none_match_precedence);
+    RUN_TEST(test_not_modified_if_modified_since);
+    RUN_TEST(test_if_range_wednesday_date_is_a_date);
+    RUN_TEST(test_if_range_etags);
+    return UNITY_END();
+}
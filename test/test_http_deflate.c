@@ -0,0 +1,261 @@
+#include "unity.h"
+#include "http_deflate.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/* --- Output capture --- */
+
+static uint8_t *s_out;
+static size_t s_out_len;
+static size_t s_out_cap;
+static size_t s_sink_calls;
+
+static esp_err_t capture_sink(void *ctx, const uint8_t *data, size_t len)
+{
+    (void)ctx;
+    if (s_out_len + len > s_out_cap)
+    {
+        s_out_cap = (s_out_len + len) * 2;
+        s_out = realloc(s_out, s_out_cap);
+    }
+    memcpy(s_out + s_out_len, data, len);
+    s_out_len += len;
+    s_sink_calls++;
+    return ESP_OK;
+}
+
+static esp_err_t failing_sink(void *ctx, const uint8_t *data, size_t len)
+{
+    (void)ctx;
+    (void)data;
+    (void)len;
+    return ESP_FAIL;
+}
+
+/* --- Minimal fixed-Huffman inflater, enough to check the encoder --- */
+
+typedef struct
+{
+    const uint8_t *src;
+    size_t len;
+    size_t pos;
+    unsigned bit;
+} bits_t;
+
+static unsigned get_bit(bits_t *b)
+{
+    TEST_ASSERT_TRUE_MESSAGE(b->pos < b->len, "bitstream overrun");
+    unsigned v = (b->src[b->pos] >> b->bit) & 1;
+    if (++b->bit == 8)
+    {
+        b->bit = 0;
+        b->pos++;
+    }
+    return v;
+}
+
+static unsigned get_bits(bits_t *b, unsigned n)
+{
+    unsigned v = 0;
+    for (unsigned i = 0; i < n; i++)
+    {
+        v |= get_bit(b) << i;
+    }
+    return v;
+}
+
+static unsigned get_litlen(bits_t *b)
+{
+    unsigned code = 0;
+    for (int i = 0; i < 7; i++)
+    {
+        code = (code << 1) | get_bit(b);
+    }
+    if (code <= 0x17)
+    {
+        return 256 + code;
+    }
+    code = (code << 1) | get_bit(b);
+    if (code >= 0x30 && code <= 0xbf)
+    {
+        return code - 0x30;
+    }
+    if (code >= 0xc0 && code <= 0xc7)
+    {
+        return 280 + (code - 0xc0);
+    }
+    code = (code << 1) | get_bit(b);
+    return 144 + (code - 0x190);
+}
+
+static const uint16_t LBASE[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                   31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LEXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                   2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t DBASE[30] = {1,    2,    3,    4,    5,    7,    9,    13,    17,    25,
+                                   33,   49,   65,   97,   129,  193,  257,  385,   513,   769,
+                                   1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t DEXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                   6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+/* Returns the inflated length; the gzip header/trailer are checked too */
+static size_t gunzip(const uint8_t *gz, size_t gz_len, uint8_t *out, size_t out_cap)
+{
+    TEST_ASSERT_TRUE(gz_len >= 18);
+    TEST_ASSERT_EQUAL_HEX8(0x1f, gz[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x8b, gz[1]);
+    TEST_ASSERT_EQUAL(8, gz[2]);
+
+    bits_t b = {.src = gz + 10, .len = gz_len - 18};
+    size_t n = 0;
+    unsigned final = 0;
+    while (!final)
+    {
+        final = get_bit(&b);
+        TEST_ASSERT_EQUAL_MESSAGE(1, get_bits(&b, 2), "expected fixed Huffman block");
+        for (;;)
+        {
+            unsigned sym = get_litlen(&b);
+            if (sym < 256)
+            {
+                TEST_ASSERT_TRUE(n < out_cap);
+                out[n++] = (uint8_t)sym;
+                continue;
+            }
+            if (sym == 256)
+            {
+                break;
+            }
+            sym -= 257;
+            TEST_ASSERT_TRUE(sym < 29);
+            unsigned len = LBASE[sym] + get_bits(&b, LEXTRA[sym]);
+            unsigned dcode = 0;
+            for (int i = 0; i < 5; i++)
+            {
+                dcode = (dcode << 1) | get_bit(&b);
+            }
+            TEST_ASSERT_TRUE(dcode < 30);
+            unsigned dist = DBASE[dcode] + get_bits(&b, DEXTRA[dcode]);
+            TEST_ASSERT_TRUE(dist <= n);
+            TEST_ASSERT_TRUE(n + len <= out_cap);
+            for (unsigned i = 0; i < len; i++, n++)
+            {
+                out[n] = out[n - dist];
+            }
+        }
+    }
+    /* The deflate stream must end exactly where the trailer starts */
+    TEST_ASSERT_EQUAL(b.len, b.pos + (b.bit ? 1 : 0));
+
+    const uint8_t *t = gz + gz_len - 8;
+    uint32_t crc = (uint32_t)t[0] | ((uint32_t)t[1] << 8) | ((uint32_t)t[2] << 16) | ((uint32_t)t[3] << 24);
+    uint32_t isize = (uint32_t)t[4] | ((uint32_t)t[5] << 8) | ((uint32_t)t[6] << 16) | ((uint32_t)t[7] << 24);
+    TEST_ASSERT_EQUAL_HEX32(http_crc32(0, out, n), crc);
+    TEST_ASSERT_EQUAL_UINT32(n, isize);
+    return n;
+}
+
+static void round_trip(const uint8_t *data, size_t len, size_t piece)
+{
+    static http_deflate_t z;
+    free(s_out);
+    s_out = NULL;
+    s_out_len = s_out_cap = s_sink_calls = 0;
+
+    TEST_ASSERT_EQUAL(ESP_OK, http_gzip_init(&z, capture_sink, NULL));
+    for (size_t off = 0; off < len; off += piece)
+    {
+        size_t n = (len - off < piece) ? len - off : piece;
+        TEST_ASSERT_EQUAL(ESP_OK, http_gzip_write(&z, data + off, n));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, http_gzip_finish(&z));
+
+    uint8_t *back = malloc(len + 1);
+    TEST_ASSERT_EQUAL(len, gunzip(s_out, s_out_len, back, len + 1));
+    TEST_ASSERT_EQUAL_MEMORY(data, back, len);
+    free(back);
+}
+
+void test_crc32_known_values(void)
+{
+    TEST_ASSERT_EQUAL_HEX32(0x00000000, http_crc32(0, NULL, 0));
+    TEST_ASSERT_EQUAL_HEX32(0xcbf43926, http_crc32(0, (const uint8_t *)"123456789", 9));
+    /* Incremental use matches one-shot */
+    uint32_t c = http_crc32(0, (const uint8_t *)"1234", 4);
+    TEST_ASSERT_EQUAL_HEX32(0xcbf43926, http_crc32(c, (const uint8_t *)"56789", 5));
+}
+
+void test_empty_input(void)
+{
+    round_trip((const uint8_t *)"", 0, 1);
+    TEST_ASSERT_TRUE(s_out_len <= 24);
+}
+
+void test_short_text(void)
+{
+    const char *text = "Hello, hello, hello! The quick brown fox jumps over the lazy dog.";
+    round_trip((const uint8_t *)text, strlen(text), 1000);
+}
+
+void test_repetitive_input_compresses(void)
+{
+    size_t len = 64 * 1024;
+    uint8_t *data = malloc(len);
+    for (size_t i = 0; i < len; i++)
+    {
+        data[i] = (uint8_t)"<tr><td>row</td></tr>\n"[i % 22];
+    }
+    round_trip(data, len, 1000);
+    TEST_ASSERT_TRUE(s_out_len < len / 10);
+    free(data);
+}
+
+void test_binary_input_across_window_slides(void)
+{
+    size_t len = 100 * 1000;
+    uint8_t *data = malloc(len);
+    uint32_t x = 12345;
+    for (size_t i = 0; i < len; i++)
+    {
+        x = x * 1103515245u + 12345u;
+        /* Mix noise with repeats so matches straddle the window edges */
+        data[i] = (i % 3000 < 1500) ? (uint8_t)(x >> 24) : data[i - 1500];
+    }
+    round_trip(data, len, 777);
+    round_trip(data, len, 1);
+    free(data);
+}
+
+void test_long_runs_use_max_length_matches(void)
+{
+    size_t len = 10000;
+    uint8_t *data = calloc(1, len);
+    round_trip(data, len, 4096);
+    TEST_ASSERT_TRUE(s_out_len < 200);
+    free(data);
+}
+
+void test_sink_error_is_reported(void)
+{
+    static http_deflate_t z;
+    TEST_ASSERT_EQUAL(ESP_FAIL, http_gzip_init(&z, failing_sink, NULL));
+    TEST_ASSERT_EQUAL(ESP_FAIL, http_gzip_write(&z, (const uint8_t *)"abc", 3));
+    TEST_ASSERT_EQUAL(ESP_FAIL, http_gzip_finish(&z));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_crc32_known_values);
+    RUN_TEST(test_empty_input);
+    RUN_TEST(test_short_text);
+    RUN_TEST(test_repetitive_input_compresses);
+    RUN_TEST(test_binary_input_across_window_slides);
+    RUN_TEST(test_long_runs_use_max_length_matches);
+    RUN_TEST(test_sink_error_is_reported);
+    return UNITY_END();
+}
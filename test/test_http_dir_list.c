@@ -0,0 +1,208 @@
+#include "unity.h"
+#include "http_dir_list.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define N_ENTRIES 500
+
+static vfs_dir_entry_t s_entries[N_ENTRIES];
+static http_dir_sort_t s_qsort_order;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static int qsort_compare(const void *a, const void *b)
+{
+    return http_dir_compare(&s_qsort_order, a, b);
+}
+
+/* Pseudo-random names, with colliding sizes and mtimes so ties are exercised */
+static void make_entries(void)
+{
+    uint32_t x = 12345;
+    for (size_t i = 0; i < N_ENTRIES; i++)
+    {
+        x = x * 1103515245u + 12345u;
+        snprintf(s_entries[i].name, sizeof(s_entries[i].name), "log_%05lu.csv", (unsigned long)((x >> 8) % 100000));
+        /* Make names unique, as they are in a directory */
+        s_entries[i].name[0] = (char)('a' + i % 26);
+        s_entries[i].name[1] = (char)('a' + (i / 26) % 26);
+        s_entries[i].size = (x >> 4) % 16;
+        s_entries[i].mtime = (time_t)((x >> 12) % 8);
+        s_entries[i].is_dir = false;
+    }
+}
+
+void test_glob_literals_and_wildcards(void)
+{
+    TEST_ASSERT_TRUE(http_dir_glob_match("*", "anything"));
+    TEST_ASSERT_TRUE(http_dir_glob_match("*", ""));
+    TEST_ASSERT_TRUE(http_dir_glob_match("*.csv", "log.csv"));
+    TEST_ASSERT_FALSE(http_dir_glob_match("*.csv", "log.csv.bak"));
+    TEST_ASSERT_TRUE(http_dir_glob_match("log_????.txt", "log_2024.txt"));
+    TEST_ASSERT_FALSE(http_dir_glob_match("log_????.txt", "log_24.txt"));
+    TEST_ASSERT_TRUE(http_dir_glob_match("a*b*c", "aXXbYYbZZc"));
+    TEST_ASSERT_FALSE(http_dir_glob_match("a*b*c", "aXXbYYbZZ"));
+    TEST_ASSERT_TRUE(http_dir_glob_match("**x", "abx"));
+    TEST_ASSERT_FALSE(http_dir_glob_match("abc", "ab"));
+    TEST_ASSERT_FALSE(http_dir_glob_match("ab", "abc"));
+    TEST_ASSERT_FALSE(http_dir_glob_match("*.CSV", "log.csv"));
+}
+
+void test_glob_classes_and_escapes(void)
+{
+    TEST_ASSERT_TRUE(http_dir_glob_match("data[0-9].bin", "data7.bin"));
+    TEST_ASSERT_FALSE(http_dir_glob_match("data[0-9].bin", "dataX.bin"));
+    TEST_ASSERT_TRUE(http_dir_glob_match("[!.]*", "visible"));
+    TEST_ASSERT_FALSE(http_dir_glob_match("[!.]*", ".hidden"));
+    TEST_ASSERT_TRUE(http_dir_glob_match("[abc]x", "bx"));
+    TEST_ASSERT_TRUE(http_dir_glob_match("[]]", "]"));
+    TEST_ASSERT_TRUE(http_dir_glob_match("\\*", "*"));
+    TEST_ASSERT_FALSE(http_dir_glob_match("\\*", "a"));
+    /* An unterminated class is a literal '[' */
+    TEST_ASSERT_TRUE(http_dir_glob_match("a[b", "a[b"));
+}
+
+void test_glob_pathological_pattern_is_linear(void)
+{
+    char name[201];
+    memset(name, 'a', 200);
+    name[200] = '\0';
+    /* Exponential with naive recursion */
+    TEST_ASSERT_FALSE(http_dir_glob_match("*a*a*a*a*a*a*a*a*a*a*b", name));
+}
+
+void test_sort_parse(void)
+{
+    http_dir_sort_t s;
+    TEST_ASSERT_TRUE(http_dir_sort_parse(NULL, NULL, &s));
+    TEST_ASSERT_EQUAL(HTTP_DIR_SORT_NAME, s.key);
+    TEST_ASSERT_FALSE(s.desc);
+    TEST_ASSERT_TRUE(http_dir_sort_parse("mtime", "desc", &s));
+    TEST_ASSERT_EQUAL(HTTP_DIR_SORT_MTIME, s.key);
+    TEST_ASSERT_TRUE(s.desc);
+    TEST_ASSERT_TRUE(http_dir_sort_parse("size", "", &s));
+    TEST_ASSERT_EQUAL(HTTP_DIR_SORT_SIZE, s.key);
+    TEST_ASSERT_FALSE(http_dir_sort_parse("date", NULL, &s));
+    TEST_ASSERT_FALSE(http_dir_sort_parse("name", "up", &s));
+}
+
+void test_compare_breaks_ties_by_name(void)
+{
+    vfs_dir_entry_t a = {.name = "a", .size = 10};
+    vfs_dir_entry_t b = {.name = "b", .size = 10};
+    vfs_dir_entry_t c = {.name = "c", .size = 5};
+    http_dir_sort_t size_asc = {HTTP_DIR_SORT_SIZE, false};
+    http_dir_sort_t size_desc = {HTTP_DIR_SORT_SIZE, true};
+
+    TEST_ASSERT_TRUE(http_dir_compare(&size_asc, &a, &b) < 0);
+    TEST_ASSERT_TRUE(http_dir_compare(&size_asc, &c, &a) < 0);
+    TEST_ASSERT_TRUE(http_dir_compare(&size_desc, &b, &a) < 0);
+    TEST_ASSERT_TRUE(http_dir_compare(&size_desc, &a, &c) < 0);
+    TEST_ASSERT_EQUAL(0, http_dir_compare(&size_asc, &a, &a));
+}
+
+static void check_topk(http_dir_sort_key_t key, bool desc, size_t cap)
+{
+    http_dir_sort_t sort = {key, desc};
+    static vfs_dir_entry_t sorted[N_ENTRIES];
+    static vfs_dir_entry_t items[N_ENTRIES];
+
+    memcpy(sorted, s_entries, sizeof(sorted));
+    s_qsort_order = sort;
+    qsort(sorted, N_ENTRIES, sizeof(sorted[0]), qsort_compare);
+
+    http_dir_topk_t t;
+    http_dir_topk_init(&t, items, cap, &sort);
+    for (size_t i = 0; i < N_ENTRIES; i++)
+    {
+        http_dir_topk_offer(&t, &s_entries[i]);
+    }
+    http_dir_topk_finish(&t);
+
+    size_t expect = cap < N_ENTRIES ? cap : N_ENTRIES;
+    TEST_ASSERT_EQUAL(expect, t.count);
+    for (size_t i = 0; i < expect; i++)
+    {
+        TEST_ASSERT_EQUAL_STRING(sorted[i].name, items[i].name);
+    }
+}
+
+void test_topk_matches_full_sort(void)
+{
+    make_entries();
+    check_topk(HTTP_DIR_SORT_NAME, false, 10);
+    check_topk(HTTP_DIR_SORT_NAME, true, 1);
+    check_topk(HTTP_DIR_SORT_SIZE, false, 37);
+    check_topk(HTTP_DIR_SORT_SIZE, true, 100);
+    check_topk(HTTP_DIR_SORT_MTIME, false, N_ENTRIES);
+    check_topk(HTTP_DIR_SORT_MTIME, true, N_ENTRIES + 20);
+}
+
+void test_topk_with_zero_capacity_keeps_nothing(void)
+{
+    make_entries();
+    http_dir_sort_t sort = {HTTP_DIR_SORT_NAME, false};
+    http_dir_topk_t t;
+    http_dir_topk_init(&t, NULL, 0, &sort);
+    http_dir_topk_offer(&t, &s_entries[0]);
+    http_dir_topk_finish(&t);
+    TEST_ASSERT_EQUAL(0, t.count);
+}
+
+/* Paging by successive passes after the previous pass's last entry, as the handler does */
+void test_passes_after_floor_walk_the_whole_order(void)
+{
+    make_entries();
+    http_dir_sort_t sort = {HTTP_DIR_SORT_SIZE, true};
+    static vfs_dir_entry_t sorted[N_ENTRIES];
+    memcpy(sorted, s_entries, sizeof(sorted));
+    s_qsort_order = sort;
+    qsort(sorted, N_ENTRIES, sizeof(sorted[0]), qsort_compare);
+
+    vfs_dir_entry_t items[32];
+    vfs_dir_entry_t floor;
+    bool have_floor = false;
+    size_t seen = 0;
+    for (;;)
+    {
+        http_dir_topk_t t;
+        http_dir_topk_init(&t, items, 32, &sort);
+        for (size_t i = 0; i < N_ENTRIES; i++)
+        {
+            if (!have_floor || http_dir_compare(&sort, &s_entries[i], &floor) > 0)
+            {
+                http_dir_topk_offer(&t, &s_entries[i]);
+            }
+        }
+        http_dir_topk_finish(&t);
+        for (size_t i = 0; i < t.count; i++)
+        {
+            TEST_ASSERT_EQUAL_STRING(sorted[seen + i].name, items[i].name);
+        }
+        seen += t.count;
+        if (t.count < 32)
+        {
+            break;
+        }
+        floor = items[t.count - 1];
+        have_floor = true;
+    }
+    TEST_ASSERT_EQUAL(N_ENTRIES, seen);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_glob_literals_and_wildcards);
+    RUN_TEST(test_glob_classes_and_escapes);
+    RUN_TEST(test_glob_pathological_pattern_is_linear);
+    RUN_TEST(test_sort_parse);
+    RUN_TEST(test_compare_breaks_ties_by_name);
+    RUN_TEST(test_topk_matches_full_sort);
+    RUN_TEST(test_topk_with_zero_capacity_keeps_nothing);
+    RUN_TEST(test_passes_after_floor_walk_the_whole_order);
+    return UNITY_END();
+}
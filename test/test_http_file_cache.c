@@ -0,0 +1,154 @@
+#include "unity.h"
+#include "http_file_cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static uint8_t *make_data(size_t size, uint8_t fill)
+{
+    uint8_t *data = malloc(size);
+    memset(data, fill, size);
+    return data;
+}
+
+/* Insert and immediately unpin, as the static handler does after sending */
+static void put_released(const char *path, size_t size, time_t mtime)
+{
+    const http_file_cache_entry_t *e = http_file_cache_put(path, size, mtime, make_data(size, 0xAB));
+    TEST_ASSERT_NOT_NULL(e);
+    http_file_cache_release(e);
+}
+
+void setUp(void)
+{
+    http_file_cache_init();
+    http_file_cache_flush();
+}
+
+void tearDown(void) {}
+
+void test_miss_then_hit(void)
+{
+    http_file_cache_stats_t before;
+    http_file_cache_get_stats(&before);
+
+    TEST_ASSERT_TRUE(http_file_cache_acquire("/littlefs/public/index.html", 100, 5) == NULL);
+    put_released("/littlefs/public/index.html", 100, 5);
+
+    const http_file_cache_entry_t *e = http_file_cache_acquire("/littlefs/public/index.html", 100, 5);
+    TEST_ASSERT_NOT_NULL(e);
+    TEST_ASSERT_EQUAL(100, e->size);
+    TEST_ASSERT_EQUAL_UINT8(0xAB, e->data[99]);
+    http_file_cache_release(e);
+
+    http_file_cache_stats_t after;
+    http_file_cache_get_stats(&after);
+    TEST_ASSERT_EQUAL(before.misses + 1, after.misses);
+    TEST_ASSERT_EQUAL(before.hits + 1, after.hits);
+}
+
+void test_stale_mtime_or_size_invalidates(void)
+{
+    put_released("/littlefs/a.css", 50, 10);
+    TEST_ASSERT_TRUE(http_file_cache_acquire("/littlefs/a.css", 50, 11) == NULL);
+    /* The stale entry was dropped, so even the old validators now miss */
+    TEST_ASSERT_TRUE(http_file_cache_acquire("/littlefs/a.css", 50, 10) == NULL);
+
+    put_released("/littlefs/a.css", 50, 10);
+    TEST_ASSERT_TRUE(http_file_cache_acquire("/littlefs/a.css", 51, 10) == NULL);
+
+    http_file_cache_stats_t stats;
+    http_file_cache_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.entries);
+    TEST_ASSERT_EQUAL(0, stats.bytes);
+}
+
+void test_rejects_oversized_file(void)
+{
+    uint8_t *data = make_data(HTTP_FILE_CACHE_MAX_FILE + 1, 0);
+    TEST_ASSERT_TRUE(http_file_cache_put("/littlefs/big.bin", HTTP_FILE_CACHE_MAX_FILE + 1, 1, data) == NULL);
+    free(data);
+}
+
+void test_byte_bound_evicts_least_recently_used(void)
+{
+    const size_t size = HTTP_FILE_CACHE_MAX_FILE;
+    const size_t fit = HTTP_FILE_CACHE_MAX_BYTES / size;
+    char path[32];
+
+    for (size_t i = 0; i < fit; i++)
+    {
+        snprintf(path, sizeof(path), "/littlefs/f%u", (unsigned)i);
+        put_released(path, size, 1);
+    }
+
+    /* Touch f0 so f1 becomes the least recently used */
+    const http_file_cache_entry_t *e = http_file_cache_acquire("/littlefs/f0", size, 1);
+    TEST_ASSERT_NOT_NULL(e);
+    http_file_cache_release(e);
+
+    http_file_cache_stats_t before;
+    http_file_cache_get_stats(&before);
+    put_released("/littlefs/new", size, 1);
+
+    http_file_cache_stats_t after;
+    http_file_cache_get_stats(&after);
+    TEST_ASSERT_EQUAL(before.evictions + 1, after.evictions);
+    TEST_ASSERT_TRUE(after.bytes <= HTTP_FILE_CACHE_MAX_BYTES);
+
+    TEST_ASSERT_TRUE(http_file_cache_acquire("/littlefs/f1", size, 1) == NULL);
+    e = http_file_cache_acquire("/littlefs/f0", size, 1);
+    TEST_ASSERT_NOT_NULL(e);
+    http_file_cache_release(e);
+}
+
+void test_pinned_entries_survive_flush_until_released(void)
+{
+    const http_file_cache_entry_t *pinned = http_file_cache_put("/littlefs/p", 10, 1, make_data(10, 0x11));
+    TEST_ASSERT_NOT_NULL(pinned);
+
+    http_file_cache_flush();
+    TEST_ASSERT_EQUAL_UINT8(0x11, pinned->data[0]);
+    TEST_ASSERT_TRUE(http_file_cache_acquire("/littlefs/p", 10, 1) == NULL);
+
+    http_file_cache_release(pinned);
+    http_file_cache_stats_t stats;
+    http_file_cache_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.entries);
+}
+
+void test_all_pinned_put_fails(void)
+{
+    const size_t size = HTTP_FILE_CACHE_MAX_FILE;
+    const size_t fit = HTTP_FILE_CACHE_MAX_BYTES / size;
+    const http_file_cache_entry_t *pins[HTTP_FILE_CACHE_SLOTS];
+    char path[32];
+
+    for (size_t i = 0; i < fit; i++)
+    {
+        snprintf(path, sizeof(path), "/littlefs/pin%u", (unsigned)i);
+        pins[i] = http_file_cache_put(path, size, 1, make_data(size, 0));
+        TEST_ASSERT_NOT_NULL(pins[i]);
+    }
+
+    uint8_t *data = make_data(size, 0);
+    TEST_ASSERT_TRUE(http_file_cache_put("/littlefs/extra", size, 1, data) == NULL);
+    free(data);
+
+    for (size_t i = 0; i < fit; i++)
+    {
+        http_file_cache_release(pins[i]);
+    }
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_miss_then_hit);
+    RUN_TEST(test_stale_mtime_or_size_invalidates);
+    RUN_TEST(test_rejects_oversized_file);
+    RUN_TEST(test_byte_bound_evicts_least_recently_used);
+    RUN_TEST(test_pinned_entries_survive_flush_until_released);
+    RUN_TEST(test_all_pinned_put_fails);
+    return UNITY_END();
+}
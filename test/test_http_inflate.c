@@ -0,0 +1,225 @@
+#include "unity.h"
+#include "http_deflate.h"
+#include "http_inflate.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/* --- Chunked source and capturing sink --- */
+
+typedef struct
+{
+    const uint8_t *data;
+    size_t len;
+    size_t pos;
+    size_t piece;
+} source_t;
+
+static esp_err_t piece_source(void *ctx, const uint8_t **data, size_t *len)
+{
+    source_t *s = ctx;
+    size_t n = s->len - s->pos;
+    if (n > s->piece)
+    {
+        n = s->piece;
+    }
+    *data = s->data + s->pos;
+    *len = n;
+    s->pos += n;
+    return ESP_OK;
+}
+
+static uint8_t *s_out;
+static size_t s_out_len;
+static size_t s_out_cap;
+
+static esp_err_t capture_sink(void *ctx, const uint8_t *data, size_t len)
+{
+    (void)ctx;
+    if (s_out_len + len > s_out_cap)
+    {
+        s_out_cap = (s_out_len + len) * 2;
+        s_out = realloc(s_out, s_out_cap);
+    }
+    memcpy(s_out + s_out_len, data, len);
+    s_out_len += len;
+    return ESP_OK;
+}
+
+static esp_err_t failing_sink(void *ctx, const uint8_t *data, size_t len)
+{
+    (void)ctx;
+    (void)data;
+    (void)len;
+    return ESP_FAIL;
+}
+
+static http_inflate_t s_z;
+
+static esp_err_t gunzip(const uint8_t *gz, size_t len, size_t piece)
+{
+    s_out_len = 0;
+    source_t src = {.data = gz, .len = len, .piece = piece};
+    return http_gunzip(&s_z, piece_source, capture_sink, &src);
+}
+
+/* --- Encoded with Python's gzip module (level 9, FNAME set): dynamic Huffman blocks --- */
+
+static const uint8_t PAGE_GZ[] = {
+    0x1f, 0x8b, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x02, 0xff, 0x69, 0x6e, 0x64, 0x65, 0x78, 0x2e,
+    0x68, 0x74, 0x6d, 0x6c, 0x00, 0x8d, 0xd4, 0x4d, 0x0a, 0xc2, 0x30, 0x10, 0x86, 0xe1, 0x7d, 0x4f,
+    0x11, 0x4f, 0x10, 0x67, 0xc6, 0x5f, 0x18, 0x72, 0x02, 0x2f, 0x51, 0x9b, 0xd1, 0x16, 0xaa, 0x09,
+    0x98, 0x4d, 0x6f, 0x2f, 0x58, 0xdd, 0x3a, 0xdf, 0x26, 0x04, 0xf2, 0xae, 0x1e, 0xc2, 0xa7, 0x9b,
+    0x5c, 0x86, 0xb6, 0x54, 0x0b, 0x63, 0x7b, 0xcc, 0x49, 0xbf, 0xa7, 0xf5, 0x39, 0x69, 0x9b, 0xda,
+    0x6c, 0x69, 0x28, 0x2f, 0x8d, 0xeb, 0x55, 0xe3, 0xfa, 0x70, 0x2d, 0x79, 0x49, 0x5a, 0xd3, 0x65,
+    0x7a, 0x5a, 0xd8, 0x86, 0x72, 0x0b, 0x6d, 0xb4, 0x90, 0xad, 0xce, 0x65, 0xb1, 0x1c, 0x6a, 0x7f,
+    0x37, 0x8d, 0x35, 0x75, 0xbf, 0x84, 0xfc, 0x84, 0xfd, 0x44, 0xfc, 0x64, 0xe7, 0x27, 0x7b, 0x3f,
+    0x39, 0xf8, 0xc9, 0xd1, 0x4f, 0x4e, 0x7e, 0x72, 0x06, 0xe8, 0x10, 0x5e, 0xc0, 0x97, 0x00, 0x60,
+    0x02, 0x84, 0x09, 0x20, 0x26, 0xc0, 0x98, 0x00, 0x64, 0x02, 0x94, 0x09, 0x60, 0x26, 0xc0, 0x99,
+    0x01, 0x67, 0x46, 0xfe, 0x31, 0xe0, 0xcc, 0x80, 0x33, 0x03, 0xce, 0x0c, 0x38, 0x33, 0xe0, 0xcc,
+    0x80, 0x33, 0x03, 0xce, 0x0c, 0x38, 0x0b, 0xe0, 0x2c, 0x80, 0xb3, 0x20, 0x83, 0x01, 0x38, 0x0b,
+    0xe0, 0x2c, 0x80, 0xb3, 0x00, 0xce, 0x02, 0x38, 0x0b, 0xe0, 0x2c, 0xff, 0x9c, 0xe3, 0x3a, 0xce,
+    0xf1, 0x33, 0xe4, 0xdd, 0x1b, 0x91, 0xe2, 0x1e, 0x94, 0xdf, 0x05, 0x00, 0x00,
+};
+
+static size_t build_page(char *buf, size_t cap)
+{
+    size_t len = (size_t)snprintf(buf, cap, "<!doctype html><html><head><title>cos</title></head><body>");
+    for (int i = 0; i < 40; i++)
+    {
+        len += (size_t)snprintf(buf + len, cap - len, "<p>Line %d of the deployed page</p>\n", i);
+    }
+    len += (size_t)snprintf(buf + len, cap - len, "</body></html>\n");
+    return len;
+}
+
+void test_dynamic_huffman_stream_with_file_name(void)
+{
+    char page[2048];
+    size_t len = build_page(page, sizeof(page));
+
+    TEST_ASSERT_EQUAL(ESP_OK, gunzip(PAGE_GZ, sizeof(PAGE_GZ), sizeof(PAGE_GZ)));
+    TEST_ASSERT_EQUAL(len, s_out_len);
+    TEST_ASSERT_EQUAL_MEMORY(page, s_out, len);
+
+    /* Byte-at-a-time input decodes the same */
+    TEST_ASSERT_EQUAL(ESP_OK, gunzip(PAGE_GZ, sizeof(PAGE_GZ), 1));
+    TEST_ASSERT_EQUAL_MEMORY(page, s_out, len);
+}
+
+static esp_err_t append_sink(void *ctx, const uint8_t *data, size_t len)
+{
+    uint8_t **cursor = ctx;
+    memcpy(*cursor, data, len);
+    *cursor += len;
+    return ESP_OK;
+}
+
+void test_round_trip_through_encoder_wraps_window(void)
+{
+    size_t len = 3 * HTTP_INFLATE_WINDOW + 123;
+    uint8_t *data = malloc(len);
+    uint32_t x = 99;
+    for (size_t i = 0; i < len; i++)
+    {
+        x = x * 1103515245u + 12345u;
+        data[i] = (i % 2000 < 700) ? (uint8_t)(x >> 24) : data[i - 700];
+    }
+
+    static http_deflate_t enc;
+    uint8_t *gz = malloc(2 * len);
+    uint8_t *cursor = gz;
+    TEST_ASSERT_EQUAL(ESP_OK, http_gzip_init(&enc, append_sink, &cursor));
+    TEST_ASSERT_EQUAL(ESP_OK, http_gzip_write(&enc, data, len));
+    TEST_ASSERT_EQUAL(ESP_OK, http_gzip_finish(&enc));
+
+    TEST_ASSERT_EQUAL(ESP_OK, gunzip(gz, (size_t)(cursor - gz), 333));
+    TEST_ASSERT_EQUAL(len, s_out_len);
+    TEST_ASSERT_EQUAL_MEMORY(data, s_out, len);
+    free(gz);
+    free(data);
+}
+
+static size_t stored_member(uint8_t *out, const char *text)
+{
+    static const uint8_t header[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 3};
+    size_t len = strlen(text);
+    uint32_t crc = http_crc32(0, (const uint8_t *)text, len);
+    size_t n = 0;
+    memcpy(out, header, sizeof(header));
+    n += sizeof(header);
+    out[n++] = 0x01; /* BFINAL, stored */
+    out[n++] = (uint8_t)len;
+    out[n++] = (uint8_t)(len >> 8);
+    out[n++] = (uint8_t)~len;
+    out[n++] = (uint8_t)(~len >> 8);
+    memcpy(out + n, text, len);
+    n += len;
+    for (int i = 0; i < 4; i++)
+    {
+        out[n++] = (uint8_t)(crc >> (8 * i));
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        out[n++] = (uint8_t)(len >> (8 * i));
+    }
+    return n;
+}
+
+void test_stored_block(void)
+{
+    uint8_t gz[128];
+    size_t n = stored_member(gz, "stored, not compressed");
+    TEST_ASSERT_EQUAL(ESP_OK, gunzip(gz, n, 5));
+    TEST_ASSERT_EQUAL(22, s_out_len);
+    TEST_ASSERT_EQUAL_MEMORY("stored, not compressed", s_out, 22);
+}
+
+void test_corrupt_trailer_is_detected(void)
+{
+    uint8_t gz[128];
+    size_t n = stored_member(gz, "checksum me");
+    gz[n - 8] ^= 0x01;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_CRC, gunzip(gz, n, n));
+}
+
+void test_truncated_stream(void)
+{
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, gunzip(PAGE_GZ, sizeof(PAGE_GZ) / 2, 64));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, gunzip(PAGE_GZ, sizeof(PAGE_GZ) - 1, 64));
+}
+
+void test_malformed_input(void)
+{
+    const uint8_t not_gzip[] = "ustar archive, not gzip";
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_RESPONSE, gunzip(not_gzip, sizeof(not_gzip), 8));
+
+    /* Block type 3 is reserved */
+    uint8_t gz[128];
+    size_t n = stored_member(gz, "x");
+    gz[10] = 0x07;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_RESPONSE, gunzip(gz, n, n));
+}
+
+void test_sink_error_stops_decoding(void)
+{
+    source_t src = {.data = PAGE_GZ, .len = sizeof(PAGE_GZ), .piece = 16};
+    TEST_ASSERT_EQUAL(ESP_FAIL, http_gunzip(&s_z, piece_source, failing_sink, &src));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_dynamic_huffman_stream_with_file_name);
+    RUN_TEST(test_round_trip_through_encoder_wraps_window);
+    RUN_TEST(test_stored_block);
+    RUN_TEST(test_corrupt_trailer_is_detected);
+    RUN_TEST(test_truncated_stream);
+    RUN_TEST(test_malformed_input);
+    RUN_TEST(test_sink_error_stops_decoding);
+    return UNITY_END();
+}
@@ -0,0 +1,391 @@
+#include "unity.h"
+#include "http_inflate.h"
+#include "http_json.h"
+#include "mock_httpd.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* --- Capturing sink --- */
+
+static char s_out[8192];
+static size_t s_out_len;
+static size_t s_chunks[16];
+static int s_chunk_count;
+static bool s_ended;
+
+static esp_err_t capture_sink(void *ctx, const char *data, size_t len)
+{
+    (void)ctx;
+    if (len == 0)
+    {
+        s_ended = true;
+        return ESP_OK;
+    }
+    memcpy(s_out + s_out_len, data, len);
+    s_out_len += len;
+    s_out[s_out_len] = '\0';
+    if (s_chunk_count < 16)
+    {
+        s_chunks[s_chunk_count] = len;
+    }
+    s_chunk_count++;
+    return ESP_OK;
+}
+
+static esp_err_t failing_sink(void *ctx, const char *data, size_t len)
+{
+    (void)ctx;
+    (void)data;
+    (void)len;
+    return ESP_FAIL;
+}
+
+static http_stream_t s_stream;
+static http_json_t s_json;
+
+void setUp(void)
+{
+    s_out_len = 0;
+    s_out[0] = '\0';
+    s_chunk_count = 0;
+    s_ended = false;
+    http_stream_init_sink(&s_stream, capture_sink, NULL);
+    http_json_init(&s_json, &s_stream);
+    mock_httpd_reset();
+}
+
+void tearDown(void) {}
+
+/* --- JSON writer --- */
+
+void test_object_with_members(void)
+{
+    http_json_object_begin(&s_json);
+    http_json_kv_string(&s_json, "name", "a.txt");
+    http_json_kv_uint(&s_json, "size", 4294967296ULL);
+    http_json_kv_int(&s_json, "delta", -5);
+    http_json_kv_bool(&s_json, "is_dir", false);
+    http_json_key(&s_json, "none");
+    http_json_null(&s_json);
+    http_json_object_end(&s_json);
+    TEST_ASSERT_EQUAL(ESP_OK, http_stream_finish(&s_stream));
+
+    TEST_ASSERT_EQUAL_STRING("{\"name\":\"a.txt\",\"size\":4294967296,\"delta\":-5,\"is_dir\":false,\"none\":null}", s_out);
+    TEST_ASSERT_TRUE(s_ended);
+}
+
+void test_nested_containers_get_commas_right(void)
+{
+    http_json_object_begin(&s_json);
+    http_json_key(&s_json, "files");
+    http_json_array_begin(&s_json);
+    for (int i = 0; i < 3; i++)
+    {
+        http_json_object_begin(&s_json);
+        http_json_kv_uint(&s_json, "i", (uint64_t)i);
+        http_json_key(&s_json, "tags");
+        http_json_array_begin(&s_json);
+        http_json_array_end(&s_json);
+        http_json_object_end(&s_json);
+    }
+    http_json_array_end(&s_json);
+    http_json_kv_uint(&s_json, "skipped", 0);
+    http_json_object_end(&s_json);
+    http_stream_finish(&s_stream);
+
+    TEST_ASSERT_EQUAL_STRING("{\"files\":[{\"i\":0,\"tags\":[]},{\"i\":1,\"tags\":[]},{\"i\":2,\"tags\":[]}],\"skipped\":0}",
+                             s_out);
+}
+
+void test_array_of_scalars(void)
+{
+    http_json_array_begin(&s_json);
+    http_json_string(&s_json, "x");
+    http_json_bool(&s_json, true);
+    http_json_string(&s_json, NULL);
+    http_json_int(&s_json, 7);
+    http_json_array_end(&s_json);
+    http_stream_finish(&s_stream);
+    TEST_ASSERT_EQUAL_STRING("[\"x\",true,null,7]", s_out);
+}
+
+void test_escaping(void)
+{
+    http_json_string(&s_json, "q\"b\\s/\b\f\n\r\t\x01\x1f\x7f end");
+    http_stream_finish(&s_stream);
+    TEST_ASSERT_EQUAL_STRING("\"q\\\"b\\\\s/\\b\\f\\n\\r\\t\\u0001\\u001f\x7f end\"", s_out);
+}
+
+void test_utf8_passes_through(void)
+{
+    http_json_string(&s_json, "gr\xc3\xbc\xc3\x9f \xe2\x82\xac");
+    http_stream_finish(&s_stream);
+    TEST_ASSERT_EQUAL_STRING("\"gr\xc3\xbc\xc3\x9f \xe2\x82\xac\"", s_out);
+}
+
+void test_keys_are_escaped(void)
+{
+    http_json_object_begin(&s_json);
+    http_json_kv_string(&s_json, "a\"b", "");
+    http_json_object_end(&s_json);
+    http_stream_finish(&s_stream);
+    TEST_ASSERT_EQUAL_STRING("{\"a\\\"b\":\"\"}", s_out);
+}
+
+void test_nesting_too_deep_is_an_error(void)
+{
+    for (int i = 0; i < HTTP_JSON_MAX_DEPTH; i++)
+    {
+        http_json_array_begin(&s_json);
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, http_stream_finish(&s_stream));
+}
+
+/* --- Stream buffering --- */
+
+void test_small_writes_are_sent_in_full_chunks(void)
+{
+    char line[100];
+    memset(line, 'x', sizeof(line));
+    for (int i = 0; i < 40; i++)
+    {
+        http_stream_write(&s_stream, line, sizeof(line));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, http_stream_finish(&s_stream));
+
+    TEST_ASSERT_EQUAL(3, s_chunk_count);
+    TEST_ASSERT_EQUAL(HTTP_STREAM_CHUNK, s_chunks[0]);
+    TEST_ASSERT_EQUAL(HTTP_STREAM_CHUNK, s_chunks[1]);
+    TEST_ASSERT_EQUAL(4000 - 2 * HTTP_STREAM_CHUNK, s_chunks[2]);
+    TEST_ASSERT_EQUAL(4000, s_out_len);
+}
+
+void test_large_write_bypasses_empty_buffer(void)
+{
+    static char big[3 * HTTP_STREAM_CHUNK + 10];
+    memset(big, 'y', sizeof(big));
+    http_stream_write(&s_stream, "ab", 2);
+    http_stream_write(&s_stream, big, sizeof(big));
+    http_stream_finish(&s_stream);
+
+    /* Top up the partial chunk, then the rest goes out in one piece */
+    TEST_ASSERT_EQUAL(2, s_chunk_count);
+    TEST_ASSERT_EQUAL(HTTP_STREAM_CHUNK, s_chunks[0]);
+    TEST_ASSERT_EQUAL(sizeof(big) + 2 - HTTP_STREAM_CHUNK, s_chunks[1]);
+}
+
+void test_sink_errors_are_sticky(void)
+{
+    static char big[2 * HTTP_STREAM_CHUNK];
+    http_stream_init_sink(&s_stream, failing_sink, NULL);
+    TEST_ASSERT_EQUAL(ESP_FAIL, http_stream_write(&s_stream, big, sizeof(big)));
+    TEST_ASSERT_EQUAL(ESP_FAIL, http_stream_puts(&s_stream, "more"));
+    TEST_ASSERT_EQUAL(ESP_FAIL, http_stream_finish(&s_stream));
+}
+
+void test_short_response_uses_content_length(void)
+{
+    httpd_req_t req = {0};
+    http_stream_t out;
+    http_stream_init(&out, &req);
+    http_stream_printf(&out, "{\"n\":%d}", 42);
+    TEST_ASSERT_EQUAL(ESP_OK, http_stream_finish(&out));
+
+    TEST_ASSERT_EQUAL(1, mock_httpd_send_count());
+    TEST_ASSERT_FALSE(mock_httpd_response_chunked());
+    TEST_ASSERT_EQUAL_STRING("{\"n\":42}", mock_httpd_response(NULL));
+}
+
+void test_long_response_is_chunked(void)
+{
+    httpd_req_t req = {0};
+    http_stream_t out;
+    http_stream_init(&out, &req);
+    for (int i = 0; i < 500; i++)
+    {
+        http_stream_puts(&out, "0123456789");
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, http_stream_finish(&out));
+
+    size_t len;
+    mock_httpd_response(&len);
+    TEST_ASSERT_EQUAL(5000, len);
+    TEST_ASSERT_TRUE(mock_httpd_response_chunked());
+    /* Three full chunks, the remainder and the terminator */
+    TEST_ASSERT_EQUAL(5, mock_httpd_send_count());
+}
+
+/* --- gzip filter --- */
+
+typedef struct
+{
+    const uint8_t *in;
+    size_t in_len;
+    char *out;
+    size_t out_len;
+    size_t out_max;
+} gunzip_ctx_t;
+
+static esp_err_t gunzip_source(void *ctx, const uint8_t **data, size_t *len)
+{
+    gunzip_ctx_t *c = ctx;
+    *data = c->in;
+    *len = c->in_len;
+    c->in_len = 0;
+    return ESP_OK;
+}
+
+static esp_err_t gunzip_sink(void *ctx, const uint8_t *data, size_t len)
+{
+    gunzip_ctx_t *c = ctx;
+    if (c->out_len + len > c->out_max)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(c->out + c->out_len, data, len);
+    c->out_len += len;
+    return ESP_OK;
+}
+
+/* A listing as /api/files sends it: repetitive keys, varying names and sizes */
+static size_t make_listing(char *buf, size_t max)
+{
+    size_t len = 0;
+    for (int i = 0; len + 80 < max; i++)
+    {
+        len += (size_t)snprintf(buf + len, max - len, "{\"name\":\"log_%04d.txt\",\"size\":%d,\"is_dir\":false},", i,
+                                i * 37 % 9000);
+    }
+    return len;
+}
+
+void test_gzip_round_trips_in_full_chunks(void)
+{
+    static char input[16384];
+    static char decoded[sizeof(input)];
+    static http_inflate_t z;
+    size_t input_len = make_listing(input, sizeof(input));
+
+    http_stream_gzip(&s_stream);
+    for (size_t off = 0; off < input_len; off += 100)
+    {
+        size_t n = input_len - off < 100 ? input_len - off : 100;
+        TEST_ASSERT_EQUAL(ESP_OK, http_stream_write(&s_stream, input + off, n));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, http_stream_finish(&s_stream));
+    TEST_ASSERT_TRUE(s_ended);
+    TEST_ASSERT_TRUE(s_out_len < input_len / 3);
+    for (int i = 0; i < s_chunk_count - 1 && i < 16; i++)
+    {
+        TEST_ASSERT_EQUAL(HTTP_STREAM_CHUNK, s_chunks[i]);
+    }
+
+    gunzip_ctx_t c = {(const uint8_t *)s_out, s_out_len, decoded, 0, sizeof(decoded)};
+    TEST_ASSERT_EQUAL(ESP_OK, http_gunzip(&z, gunzip_source, gunzip_sink, &c));
+    TEST_ASSERT_EQUAL(input_len, c.out_len);
+    TEST_ASSERT_EQUAL_MEMORY(input, decoded, input_len);
+}
+
+void test_gzip_skips_body_within_one_chunk(void)
+{
+    http_stream_gzip(&s_stream);
+    http_stream_puts(&s_stream, "{\"status\":\"ok\"}");
+    TEST_ASSERT_EQUAL(ESP_OK, http_stream_finish(&s_stream));
+    TEST_ASSERT_EQUAL_STRING("{\"status\":\"ok\"}", s_out);
+    TEST_ASSERT_EQUAL(1, s_chunk_count);
+}
+
+void test_gzip_response_sets_content_encoding(void)
+{
+    static char input[8192];
+    size_t input_len = make_listing(input, sizeof(input));
+    httpd_req_t req = {0};
+    mock_httpd_set_header("Accept-Encoding", "gzip, deflate, br");
+    http_stream_t out;
+    http_stream_init(&out, &req);
+    http_stream_gzip(&out);
+    http_stream_write(&out, input, input_len);
+    TEST_ASSERT_EQUAL(ESP_OK, http_stream_finish(&out));
+
+    size_t len;
+    const char *body = mock_httpd_response(&len);
+    TEST_ASSERT_TRUE(mock_httpd_response_chunked());
+    TEST_ASSERT_EQUAL_STRING("gzip", mock_httpd_resp_header("Content-Encoding"));
+    TEST_ASSERT_EQUAL_STRING("Accept-Encoding", mock_httpd_resp_header("Vary"));
+    TEST_ASSERT_TRUE(len < input_len);
+    TEST_ASSERT_EQUAL_HEX8(0x1f, (uint8_t)body[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x8b, (uint8_t)body[1]);
+}
+
+void test_gzip_response_needs_accept_encoding(void)
+{
+    static char input[4096];
+    memset(input, 'z', sizeof(input));
+    httpd_req_t req = {0};
+    mock_httpd_set_header("Accept-Encoding", "identity");
+    http_stream_t out;
+    http_stream_init(&out, &req);
+    http_stream_gzip(&out);
+    http_stream_write(&out, input, sizeof(input));
+    TEST_ASSERT_EQUAL(ESP_OK, http_stream_finish(&out));
+
+    size_t len;
+    mock_httpd_response(&len);
+    TEST_ASSERT_EQUAL(sizeof(input), len);
+    TEST_ASSERT_NULL(mock_httpd_resp_header("Content-Encoding"));
+}
+
+void test_accepts_gzip_honours_q_values(void)
+{
+    httpd_req_t req = {0};
+    TEST_ASSERT_FALSE(http_stream_accepts_gzip(&req));
+    mock_httpd_set_header("Accept-Encoding", "deflate, GZIP");
+    TEST_ASSERT_TRUE(http_stream_accepts_gzip(&req));
+    mock_httpd_reset();
+    mock_httpd_set_header("Accept-Encoding", "br;q=1.0, gzip;q=0");
+    TEST_ASSERT_FALSE(http_stream_accepts_gzip(&req));
+    mock_httpd_reset();
+    mock_httpd_set_header("Accept-Encoding", "gzip;q=0.5");
+    TEST_ASSERT_TRUE(http_stream_accepts_gzip(&req));
+    mock_httpd_reset();
+    mock_httpd_set_header("Accept-Encoding", "x-gzip2, *");
+    TEST_ASSERT_TRUE(http_stream_accepts_gzip(&req));
+    mock_httpd_reset();
+    mock_httpd_set_header("Accept-Encoding", "identity");
+    TEST_ASSERT_FALSE(http_stream_accepts_gzip(&req));
+}
+
+void test_send_error(void)
+{
+    httpd_req_t req = {0};
+    TEST_ASSERT_EQUAL(ESP_OK, http_json_send_error(&req, "400 Bad Request", "Bad \"path\""));
+    TEST_ASSERT_EQUAL_STRING("400 Bad Request", mock_httpd_last_status());
+    TEST_ASSERT_EQUAL_STRING("application/json", mock_httpd_last_type());
+    TEST_ASSERT_EQUAL_STRING("{\"error\":\"Bad \\\"path\\\"\"}", mock_httpd_response(NULL));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_object_with_members);
+    RUN_TEST(test_nested_containers_get_commas_right);
+    RUN_TEST(test_array_of_scalars);
+    RUN_TEST(test_escaping);
+    RUN_TEST(test_utf8_passes_through);
+    RUN_TEST(test_keys_are_escaped);
+    RUN_TEST(test_nesting_too_deep_is_an_error);
+    RUN_TEST(test_small_writes_are_sent_in_full_chunks);
+    RUN_TEST(test_large_write_bypasses_empty_buffer);
+    RUN_TEST(test_sink_errors_are_sticky);
+    RUN_TEST(test_short_response_uses_content_length);
+    RUN_TEST(test_long_response_is_chunked);
+    RUN_TEST(test_gzip_round_trips_in_full_chunks);
+    RUN_TEST(test_gzip_skips_body_within_one_chunk);
+    RUN_TEST(test_gzip_response_sets_content_encoding);
+    RUN_TEST(test_gzip_response_needs_accept_encoding);
+    RUN_TEST(test_accepts_gzip_honours_q_values);
+    RUN_TEST(test_send_error);
+    return UNITY_END();
+}
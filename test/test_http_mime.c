@@ -27,6 +27,14 @@ void test_json(void)
     TEST_ASSERT_EQUAL_STRING("application/json", http_mime_type("data.json"));
 }
 
+void test_text(void)
+{
+    TEST_ASSERT_EQUAL_STRING("text/plain", http_mime_type("notes.txt"));
+    TEST_ASSERT_EQUAL_STRING("text/plain", http_mime_type("/flash/logs/boot.log"));
+    TEST_ASSERT_EQUAL_STRING("text/csv", http_mime_type("samples.csv"));
+    TEST_ASSERT_EQUAL_STRING("application/xml", http_mime_type("feed.xml"));
+}
+
 void test_png(void)
 {
     TEST_ASSERT_EQUAL_STRING("image/png", http_mime_type("logo.png"));
@@ -83,6 +91,19 @@ void test_multiple_dots(void)
     TEST_ASSERT_EQUAL_STRING("text/html", http_mime_type("page.old.html"));
 }
 
+void test_compressible(void)
+{
+    TEST_ASSERT_TRUE(http_mime_is_compressible(http_mime_type("index.html")));
+    TEST_ASSERT_TRUE(http_mime_is_compressible(http_mime_type("app.js")));
+    TEST_ASSERT_TRUE(http_mime_is_compressible(http_mime_type("data.json")));
+    TEST_ASSERT_TRUE(http_mime_is_compressible(http_mime_type("boot.log")));
+    TEST_ASSERT_TRUE(http_mime_is_compressible(http_mime_type("icon.svg")));
+    TEST_ASSERT_FALSE(http_mime_is_compressible(http_mime_type("logo.png")));
+    TEST_ASSERT_FALSE(http_mime_is_compressible(http_mime_type("font.woff2")));
+    TEST_ASSERT_FALSE(http_mime_is_compressible(http_mime_type("firmware.bin")));
+    TEST_ASSERT_FALSE(http_mime_is_compressible(NULL));
+}
+
 int main(void)
 {
     UNITY_BEGIN();
@@ -90,6 +111,7 @@ int main(void)
     RUN_TEST(test_js);
     RUN_TEST(test_css);
     RUN_TEST(test_json);
+    RUN_TEST(test_text);
     RUN_TEST(test_png);
     RUN_TEST(test_jpeg);
     RUN_TEST(test_gif);
@@ -100,5 +122,6 @@ int main(void)
     RUN_TEST(test_no_extension);
     RUN_TEST(test_empty_and_null);
     RUN_TEST(test_multiple_dots);
+    RUN_TEST(test_compressible);
     return UNITY_END();
 }
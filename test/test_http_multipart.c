@@ -0,0 +1,281 @@
+#include "unity.h"
+#include "http_multipart.h"
+#include "mock_httpd.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BOUNDARY "----cosTestBoundary42"
+
+typedef struct
+{
+    uint8_t *data;
+    size_t len;
+    size_t cap;
+    int chunks;
+    int first_count;
+    int final_count;
+    char field_name[64];
+    char file_name[128];
+    char last_field[64];
+    char last_value[512];
+    int fields;
+    int abort_after;
+} capture_t;
+
+static capture_t s_cap;
+static uint8_t *s_body;
+static size_t s_body_len;
+
+void setUp(void)
+{
+    mock_httpd_reset();
+    free(s_cap.data);
+    memset(&s_cap, 0, sizeof(s_cap));
+    s_cap.abort_after = -1;
+    free(s_body);
+    s_body = NULL;
+    s_body_len = 0;
+}
+
+void tearDown(void) {}
+
+static void on_field(const char *name, const char *value, void *ctx)
+{
+    capture_t *c = ctx;
+    strncpy(c->last_field, name, sizeof(c->last_field) - 1);
+    strncpy(c->last_value, value, sizeof(c->last_value) - 1);
+    c->fields++;
+}
+
+static bool on_file(const char *field_name, const char *file_name, const uint8_t *data, size_t len, bool is_first,
+                    bool is_final, void *ctx)
+{
+    capture_t *c = ctx;
+    if (c->abort_after >= 0 && c->chunks >= c->abort_after)
+    {
+        return false;
+    }
+    if (c->len + len > c->cap)
+    {
+        c->cap = (c->len + len) * 2 + 16;
+        c->data = realloc(c->data, c->cap);
+    }
+    memcpy(c->data + c->len, data, len);
+    c->len += len;
+    c->chunks++;
+    c->first_count += is_first ? 1 : 0;
+    c->final_count += is_final ? 1 : 0;
+    strncpy(c->field_name, field_name, sizeof(c->field_name) - 1);
+    strncpy(c->file_name, file_name, sizeof(c->file_name) - 1);
+    return true;
+}
+
+static void append(const void *data, size_t len)
+{
+    s_body = realloc(s_body, s_body_len + len);
+    memcpy(s_body + s_body_len, data, len);
+    s_body_len += len;
+}
+
+static void append_str(const char *s)
+{
+    append(s, strlen(s));
+}
+
+static void build_file_body(const uint8_t *payload, size_t len)
+{
+    append_str("--" BOUNDARY "\r\n"
+               "Content-Disposition: form-data; name=\"path\"\r\n\r\n"
+               "/flash/data/out.bin\r\n"
+               "--" BOUNDARY "\r\n"
+               "Content-Disposition: form-data; name=\"file\"; filename=\"out.bin\"\r\n"
+               "Content-Type: application/octet-stream\r\n\r\n");
+    append(payload, len);
+    append_str("\r\n--" BOUNDARY "--\r\n");
+}
+
+static esp_err_t run(size_t chunk)
+{
+    mock_httpd_set_header("Content-Type", "multipart/form-data; boundary=" BOUNDARY);
+    mock_httpd_set_body(s_body, s_body_len, chunk);
+    httpd_req_t req = {.uri = "/api/upload", .content_len = s_body_len};
+    return http_multipart_parse(&req, on_field, on_file, &s_cap);
+}
+
+static uint8_t *binary_payload(size_t len)
+{
+    uint8_t *p = malloc(len);
+    for (size_t i = 0; i < len; i++)
+    {
+        p[i] = (uint8_t)((i * 131u) ^ (i >> 7));
+    }
+    return p;
+}
+
+void test_field_and_file(void)
+{
+    const uint8_t payload[] = "hello world";
+    build_file_body(payload, sizeof(payload) - 1);
+
+    TEST_ASSERT_EQUAL(ESP_OK, run(0));
+    TEST_ASSERT_EQUAL(1, s_cap.fields);
+    TEST_ASSERT_EQUAL_STRING("path", s_cap.last_field);
+    TEST_ASSERT_EQUAL_STRING("/flash/data/out.bin", s_cap.last_value);
+    TEST_ASSERT_EQUAL_STRING("file", s_cap.field_name);
+    TEST_ASSERT_EQUAL_STRING("out.bin", s_cap.file_name);
+    TEST_ASSERT_EQUAL(11, s_cap.len);
+    TEST_ASSERT_EQUAL_MEMORY(payload, s_cap.data, 11);
+    TEST_ASSERT_EQUAL(1, s_cap.first_count);
+    TEST_ASSERT_EQUAL(1, s_cap.final_count);
+}
+
+void test_binary_with_nul_bytes(void)
+{
+    const uint8_t payload[] = {0x00, 0x01, 0x00, '\r', '\n', '-', '-', 0x00, 0xff, 0x00};
+    build_file_body(payload, sizeof(payload));
+
+    TEST_ASSERT_EQUAL(ESP_OK, run(0));
+    TEST_ASSERT_EQUAL(sizeof(payload), s_cap.len);
+    TEST_ASSERT_EQUAL_MEMORY(payload, s_cap.data, sizeof(payload));
+}
+
+void test_boundary_split_across_every_recv(void)
+{
+    uint8_t *payload = binary_payload(3000);
+    build_file_body(payload, 3000);
+
+    const size_t chunks[] = {1, 2, 3, 7, 13, 64, 1000};
+    for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++)
+    {
+        free(s_cap.data);
+        memset(&s_cap, 0, sizeof(s_cap));
+        s_cap.abort_after = -1;
+
+        TEST_ASSERT_EQUAL(ESP_OK, run(chunks[i]));
+        TEST_ASSERT_EQUAL(3000, s_cap.len);
+        TEST_ASSERT_EQUAL_MEMORY(payload, s_cap.data, 3000);
+        TEST_ASSERT_EQUAL(1, s_cap.first_count);
+        TEST_ASSERT_EQUAL(1, s_cap.final_count);
+        TEST_ASSERT_EQUAL_STRING("/flash/data/out.bin", s_cap.last_value);
+    }
+    free(payload);
+}
+
+void test_payload_with_partial_boundary_prefixes(void)
+{
+    char payload[256];
+    snprintf(payload, sizeof(payload), "a\r\n--%.10sb\r\n-\r\n--%.20s!\r\n--", BOUNDARY, BOUNDARY);
+    build_file_body((const uint8_t *)payload, strlen(payload));
+
+    TEST_ASSERT_EQUAL(ESP_OK, run(5));
+    TEST_ASSERT_EQUAL(strlen(payload), s_cap.len);
+    TEST_ASSERT_EQUAL_MEMORY(payload, s_cap.data, strlen(payload));
+}
+
+void test_large_file_exceeds_old_accumulator(void)
+{
+    const size_t len = 256 * 1024;
+    uint8_t *payload = binary_payload(len);
+    build_file_body(payload, len);
+
+    TEST_ASSERT_EQUAL(ESP_OK, run(1436));
+    TEST_ASSERT_EQUAL(len, s_cap.len);
+    TEST_ASSERT_EQUAL_MEMORY(payload, s_cap.data, len);
+    TEST_ASSERT_EQUAL(1, s_cap.first_count);
+    TEST_ASSERT_EQUAL(1, s_cap.final_count);
+    free(payload);
+}
+
+void test_empty_file(void)
+{
+    build_file_body(NULL, 0);
+
+    TEST_ASSERT_EQUAL(ESP_OK, run(0));
+    TEST_ASSERT_EQUAL(0, s_cap.len);
+    TEST_ASSERT_EQUAL(1, s_cap.first_count);
+    TEST_ASSERT_EQUAL(1, s_cap.final_count);
+}
+
+void test_preamble_is_ignored(void)
+{
+    append_str("This is a preamble.\r\n");
+    build_file_body((const uint8_t *)"xyz", 3);
+
+    TEST_ASSERT_EQUAL(ESP_OK, run(4));
+    TEST_ASSERT_EQUAL(3, s_cap.len);
+    TEST_ASSERT_EQUAL_MEMORY("xyz", s_cap.data, 3);
+}
+
+void test_quoted_boundary(void)
+{
+    build_file_body((const uint8_t *)"q", 1);
+    mock_httpd_set_header("Content-Type", "multipart/form-data; boundary=\"" BOUNDARY "\"");
+    mock_httpd_set_body(s_body, s_body_len, 0);
+    httpd_req_t req = {.content_len = s_body_len};
+
+    TEST_ASSERT_EQUAL(ESP_OK, http_multipart_parse(&req, on_field, on_file, &s_cap));
+    TEST_ASSERT_EQUAL(1, s_cap.len);
+}
+
+void test_missing_boundary(void)
+{
+    build_file_body((const uint8_t *)"q", 1);
+    mock_httpd_set_header("Content-Type", "multipart/form-data");
+    mock_httpd_set_body(s_body, s_body_len, 0);
+    httpd_req_t req = {.content_len = s_body_len};
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_multipart_parse(&req, on_field, on_file, &s_cap));
+}
+
+void test_callback_abort(void)
+{
+    uint8_t *payload = binary_payload(20000);
+    build_file_body(payload, 20000);
+    s_cap.abort_after = 1;
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, run(0));
+    free(payload);
+}
+
+void test_truncated_body_flushes_final_chunk(void)
+{
+    append_str("--" BOUNDARY "\r\n"
+               "Content-Disposition: form-data; name=\"file\"; filename=\"t.txt\"\r\n\r\n"
+               "truncated");
+
+    TEST_ASSERT_EQUAL(ESP_OK, run(0));
+    TEST_ASSERT_EQUAL(9, s_cap.len);
+    TEST_ASSERT_EQUAL(1, s_cap.final_count);
+}
+
+void test_oversized_part_header(void)
+{
+    append_str("--" BOUNDARY "\r\nContent-Disposition: form-data; name=\"f\"; filename=\"");
+    for (int i = 0; i < 2000; i++)
+    {
+        append_str("x");
+    }
+    append_str("\"\r\n\r\ndata\r\n--" BOUNDARY "--\r\n");
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, run(0));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_field_and_file);
+    RUN_TEST(test_binary_with_nul_bytes);
+    RUN_TEST(test_boundary_split_across_every_recv);
+    RUN_TEST(test_payload_with_partial_boundary_prefixes);
+    RUN_TEST(test_large_file_exceeds_old_accumulator);
+    RUN_TEST(test_empty_file);
+    RUN_TEST(test_preamble_is_ignored);
+    RUN_TEST(test_quoted_boundary);
+    RUN_TEST(test_missing_boundary);
+    RUN_TEST(test_callback_abort);
+    RUN_TEST(test_truncated_body_flushes_final_chunk);
+    RUN_TEST(test_oversized_part_header);
+    return UNITY_END();
+}
@@ -0,0 +1,106 @@
+#include "unity.h"
+#include "http_server.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_closed_range(void)
+{
+    size_t start = 0;
+    size_t end = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, http_range_parse("bytes=0-99", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(0, start);
+    TEST_ASSERT_EQUAL(99, end);
+
+    TEST_ASSERT_EQUAL(ESP_OK, http_range_parse("bytes=500-500", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(500, start);
+    TEST_ASSERT_EQUAL(500, end);
+}
+
+void test_open_ended_range(void)
+{
+    size_t start = 0;
+    size_t end = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, http_range_parse("bytes=900-", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(900, start);
+    TEST_ASSERT_EQUAL(999, end);
+}
+
+void test_suffix_range(void)
+{
+    size_t start = 0;
+    size_t end = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, http_range_parse("bytes=-100", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(900, start);
+    TEST_ASSERT_EQUAL(999, end);
+
+    /* Suffix longer than the resource selects the whole resource */
+    TEST_ASSERT_EQUAL(ESP_OK, http_range_parse("bytes=-5000", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(0, start);
+    TEST_ASSERT_EQUAL(999, end);
+}
+
+void test_end_clamped_to_size(void)
+{
+    size_t start = 0;
+    size_t end = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, http_range_parse("bytes=10-5000", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(10, start);
+    TEST_ASSERT_EQUAL(999, end);
+}
+
+void test_whitespace_tolerated(void)
+{
+    size_t start = 0;
+    size_t end = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, http_range_parse(" bytes= 1-2 ", 10, &start, &end));
+    TEST_ASSERT_EQUAL(1, start);
+    TEST_ASSERT_EQUAL(2, end);
+}
+
+void test_unsatisfiable(void)
+{
+    size_t start = 0;
+    size_t end = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, http_range_parse("bytes=1000-", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, http_range_parse("bytes=2000-3000", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, http_range_parse("bytes=-0", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, http_range_parse("bytes=0-", 0, &start, &end));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, http_range_parse("bytes=-10", 0, &start, &end));
+}
+
+void test_malformed_is_ignored(void)
+{
+    size_t start = 0;
+    size_t end = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, http_range_parse(NULL, 1000, &start, &end));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, http_range_parse("", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, http_range_parse("items=0-10", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, http_range_parse("bytes=", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, http_range_parse("bytes=-", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, http_range_parse("bytes=abc-10", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, http_range_parse("bytes=10-5", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, http_range_parse("bytes=10", 1000, &start, &end));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, http_range_parse("bytes=99999999999999999999999-", 1000, &start, &end));
+}
+
+void test_multi_range_is_ignored(void)
+{
+    size_t start = 0;
+    size_t end = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, http_range_parse("bytes=0-1,5-6", 1000, &start, &end));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_closed_range);
+    RUN_TEST(test_open_ended_range);
+    RUN_TEST(test_suffix_range);
+    RUN_TEST(test_end_clamped_to_size);
+    RUN_TEST(test_whitespace_tolerated);
+    RUN_TEST(test_unsatisfiable);
+    RUN_TEST(test_malformed_is_ignored);
+    RUN_TEST(test_multi_range_is_ignored);
+    return UNITY_END();
+}
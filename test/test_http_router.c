@@ -0,0 +1,281 @@
+#include "unity.h"
+#include "http_router.h"
+#include "mock_httpd.h"
+
+#include <string.h>
+
+/* --- Stubs for the auth and async layers --- */
+
+static bool s_auth_ok;
+static int s_auth_calls;
+static bool s_defer;
+static httpd_uri_func_t s_deferred;
+
+esp_err_t http_auth_check(httpd_req_t *req)
+{
+    (void)req;
+    s_auth_calls++;
+    return s_auth_ok ? ESP_OK : ESP_FAIL;
+}
+
+bool http_async_defer(httpd_req_t *req, httpd_uri_func_t handler)
+{
+    (void)req;
+    if (s_defer)
+    {
+        s_deferred = handler;
+    }
+    return s_defer;
+}
+
+/* --- Handlers --- */
+
+static int s_calls_a;
+static int s_calls_b;
+
+static esp_err_t handler_a(httpd_req_t *req)
+{
+    (void)req;
+    s_calls_a++;
+    return ESP_OK;
+}
+
+static esp_err_t handler_b(httpd_req_t *req)
+{
+    (void)req;
+    s_calls_b++;
+    return ESP_OK;
+}
+
+static esp_err_t add(const char *path, uint32_t methods, uint32_t flags, httpd_uri_func_t handler)
+{
+    const http_route_t route = {path, methods, flags, handler};
+    return http_server_register_route(&route);
+}
+
+#define GET HTTP_ROUTE_METHOD(HTTP_GET)
+#define POST HTTP_ROUTE_METHOD(HTTP_POST)
+
+void setUp(void)
+{
+    http_router_reset();
+    mock_httpd_reset();
+    s_auth_ok = true;
+    s_auth_calls = 0;
+    s_defer = false;
+    s_deferred = NULL;
+    s_calls_a = 0;
+    s_calls_b = 0;
+}
+
+void tearDown(void) {}
+
+void test_literal_routes_match_exactly(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/files", GET, 0, handler_a));
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/heap", GET, 0, handler_b));
+
+    http_router_match_t m;
+    TEST_ASSERT_EQUAL(ESP_OK, http_router_match("/api/heap", HTTP_GET, &m));
+    TEST_ASSERT_EQUAL_PTR(handler_b, m.route->handler);
+    TEST_ASSERT_EQUAL(ESP_OK, http_router_match("/api/files?path=/flash", HTTP_GET, &m));
+    TEST_ASSERT_EQUAL_PTR(handler_a, m.route->handler);
+    TEST_ASSERT_EQUAL(ESP_OK, http_router_match("/api/files/", HTTP_GET, &m));
+    TEST_ASSERT_EQUAL(0, m.param_count);
+
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, http_router_match("/api/file", HTTP_GET, &m));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, http_router_match("/api/files/x", HTTP_GET, &m));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, http_router_match("/api", HTTP_GET, &m));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, http_router_match("/api//heap", HTTP_GET, &m));
+}
+
+void test_parameters_are_captured(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/uploads/{id}", POST, 0, handler_a));
+
+    http_router_match_t m;
+    TEST_ASSERT_EQUAL(ESP_OK, http_router_match("/api/uploads/abc123?x=1", HTTP_POST, &m));
+    TEST_ASSERT_EQUAL(1, m.param_count);
+    TEST_ASSERT_EQUAL_STRING("id", m.params[0].name);
+    TEST_ASSERT_EQUAL(6, m.params[0].len);
+    TEST_ASSERT_EQUAL_MEMORY("abc123", m.params[0].value, 6);
+
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, http_router_match("/api/uploads", HTTP_POST, &m));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, http_router_match("/api/uploads/a/b", HTTP_POST, &m));
+}
+
+void test_literal_beats_parameter(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/uploads/{id}", GET, 0, handler_a));
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/uploads/stats", GET, 0, handler_b));
+
+    http_router_match_t m;
+    TEST_ASSERT_EQUAL(ESP_OK, http_router_match("/api/uploads/stats", HTTP_GET, &m));
+    TEST_ASSERT_EQUAL_PTR(handler_b, m.route->handler);
+    TEST_ASSERT_EQUAL(0, m.param_count);
+    TEST_ASSERT_EQUAL(ESP_OK, http_router_match("/api/uploads/other", HTTP_GET, &m));
+    TEST_ASSERT_EQUAL_PTR(handler_a, m.route->handler);
+}
+
+void test_dead_end_literal_backtracks_to_parameter(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/a/b/c", GET, 0, handler_a));
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/a/{x}/d", GET, 0, handler_b));
+
+    http_router_match_t m;
+    TEST_ASSERT_EQUAL(ESP_OK, http_router_match("/api/a/b/d", HTTP_GET, &m));
+    TEST_ASSERT_EQUAL_PTR(handler_b, m.route->handler);
+    TEST_ASSERT_EQUAL(1, m.param_count);
+    TEST_ASSERT_EQUAL_MEMORY("b", m.params[0].value, 1);
+}
+
+void test_catch_all_takes_the_rest(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/files", GET, 0, handler_a));
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/files/{path...}", GET, 0, handler_b));
+
+    http_router_match_t m;
+    TEST_ASSERT_EQUAL(ESP_OK, http_router_match("/api/files/flash/dir/a.txt?download=1", HTTP_GET, &m));
+    TEST_ASSERT_EQUAL_PTR(handler_b, m.route->handler);
+    TEST_ASSERT_EQUAL_STRING("path", m.params[0].name);
+    TEST_ASSERT_EQUAL(15, m.params[0].len);
+    TEST_ASSERT_EQUAL_MEMORY("flash/dir/a.txt", m.params[0].value, 15);
+
+    TEST_ASSERT_EQUAL(ESP_OK, http_router_match("/api/files", HTTP_GET, &m));
+    TEST_ASSERT_EQUAL_PTR(handler_a, m.route->handler);
+}
+
+void test_wrong_method_reports_allowed_methods(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/archive", GET, 0, handler_a));
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/archive", POST, 0, handler_b));
+
+    http_router_match_t m;
+    TEST_ASSERT_EQUAL(ESP_OK, http_router_match("/api/archive", HTTP_POST, &m));
+    TEST_ASSERT_EQUAL_PTR(handler_b, m.route->handler);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, http_router_match("/api/archive", HTTP_DELETE, &m));
+    TEST_ASSERT_NULL(m.route);
+    TEST_ASSERT_EQUAL_HEX32(GET | POST, m.allowed);
+
+    char allow[32];
+    TEST_ASSERT_EQUAL(9, http_router_allow_header(m.allowed, allow, sizeof(allow)));
+    TEST_ASSERT_EQUAL_STRING("GET, POST", allow);
+}
+
+void test_bad_patterns_are_rejected(void)
+{
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, add("/files", GET, 0, handler_a));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, add("/api/files", 0, 0, handler_a));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, add("/api/files", GET, 0, NULL));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, add("/api//files", GET, 0, handler_a));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, add("/api/files/", GET, 0, handler_a));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, add("/api/{}", GET, 0, handler_a));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, add("/api/x{id}", GET, 0, handler_a));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, add("/api/{rest...}/more", GET, 0, handler_a));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, add("/api/{a}/{b}/{c}/{d}/{e}", GET, 0, handler_a));
+}
+
+void test_conflicts_are_rejected(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/uploads/{id}", GET | POST, 0, handler_a));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, add("/api/uploads/{id}", POST, 0, handler_b));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, add("/api/uploads/{name}", HTTP_ROUTE_METHOD(HTTP_PUT), 0, handler_b));
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/uploads/{id}", HTTP_ROUTE_METHOD(HTTP_PUT), 0, handler_b));
+}
+
+void test_route_param_is_percent_decoded(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/files/{path...}", GET, 0, handler_a));
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/uploads/{id}", GET, 0, handler_a));
+
+    httpd_req_t req = {.uri = "/api/files/flash/My%20Docs/a%2Bb.txt", .method = HTTP_GET};
+    char buf[32];
+    TEST_ASSERT_EQUAL(ESP_OK, http_server_route_param(&req, "path", buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("flash/My Docs/a+b.txt", buf);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, http_server_route_param(&req, "id", buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, http_server_route_param(&req, "path", buf, 8));
+
+    req.uri = "/api/uploads/a%2";
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_server_route_param(&req, "id", buf, sizeof(buf)));
+    req.uri = "/api/uploads/a%00b";
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_server_route_param(&req, "id", buf, sizeof(buf)));
+    req.uri = "/api/uploads/a%zzb";
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_server_route_param(&req, "id", buf, sizeof(buf)));
+}
+
+void test_dispatch_unknown_path_is_404(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/heap", GET, 0, handler_a));
+
+    httpd_req_t req = {.uri = "/api/nope", .method = HTTP_GET};
+    TEST_ASSERT_EQUAL(ESP_OK, http_router_handler(&req));
+    TEST_ASSERT_EQUAL_STRING("404 Not Found", mock_httpd_last_status());
+    TEST_ASSERT_EQUAL(0, s_calls_a);
+}
+
+void test_dispatch_wrong_method_is_405_with_allow(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/heap", GET | HTTP_ROUTE_METHOD(HTTP_HEAD), 0, handler_a));
+
+    httpd_req_t req = {.uri = "/api/heap", .method = HTTP_DELETE};
+    TEST_ASSERT_EQUAL(ESP_OK, http_router_handler(&req));
+    TEST_ASSERT_EQUAL_STRING("405 Method Not Allowed", mock_httpd_last_status());
+    TEST_ASSERT_EQUAL_STRING("GET, HEAD", mock_httpd_resp_header("Allow"));
+    TEST_ASSERT_EQUAL(0, s_calls_a);
+}
+
+void test_dispatch_checks_auth_only_when_required(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/open", GET, 0, handler_a));
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/closed", GET, HTTP_ROUTE_AUTH, handler_b));
+    s_auth_ok = false;
+
+    httpd_req_t req = {.uri = "/api/open", .method = HTTP_GET};
+    TEST_ASSERT_EQUAL(ESP_OK, http_router_handler(&req));
+    TEST_ASSERT_EQUAL(1, s_calls_a);
+    TEST_ASSERT_EQUAL(0, s_auth_calls);
+
+    req.uri = "/api/closed";
+    TEST_ASSERT_EQUAL(ESP_OK, http_router_handler(&req));
+    TEST_ASSERT_EQUAL(0, s_calls_b);
+    TEST_ASSERT_EQUAL(1, s_auth_calls);
+
+    s_auth_ok = true;
+    TEST_ASSERT_EQUAL(ESP_OK, http_router_handler(&req));
+    TEST_ASSERT_EQUAL(1, s_calls_b);
+}
+
+void test_dispatch_defers_async_routes(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, add("/api/slow", POST, HTTP_ROUTE_ASYNC, handler_a));
+    s_defer = true;
+
+    httpd_req_t req = {.uri = "/api/slow", .method = HTTP_POST};
+    TEST_ASSERT_EQUAL(ESP_OK, http_router_handler(&req));
+    TEST_ASSERT_EQUAL(0, s_calls_a);
+    TEST_ASSERT_EQUAL_PTR(handler_a, s_deferred);
+
+    /* Worker side: defer declines and the handler runs inline */
+    s_defer = false;
+    TEST_ASSERT_EQUAL(ESP_OK, http_router_handler(&req));
+    TEST_ASSERT_EQUAL(1, s_calls_a);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_literal_routes_match_exactly);
+    RUN_TEST(test_parameters_are_captured);
+    RUN_TEST(test_literal_beats_parameter);
+    RUN_TEST(test_dead_end_literal_backtracks_to_parameter);
+    RUN_TEST(test_catch_all_takes_the_rest);
+    RUN_TEST(test_wrong_method_reports_allowed_methods);
+    RUN_TEST(test_bad_patterns_are_rejected);
+    RUN_TEST(test_conflicts_are_rejected);
+    RUN_TEST(test_route_param_is_percent_decoded);
+    RUN_TEST(test_dispatch_unknown_path_is_404);
+    RUN_TEST(test_dispatch_wrong_method_is_405_with_allow);
+    RUN_TEST(test_dispatch_checks_auth_only_when_required);
+    RUN_TEST(test_dispatch_defers_async_routes);
+    return UNITY_END();
+}
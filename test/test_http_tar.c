@@ -0,0 +1,326 @@
+#include "unity.h"
+#include "http_tar.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static unsigned long octal_field(const uint8_t *p, size_t len)
+{
+    char tmp[16] = {0};
+    memcpy(tmp, p, len);
+    return strtoul(tmp, NULL, 8);
+}
+
+static unsigned header_sum(const uint8_t *block)
+{
+    unsigned sum = 0;
+    for (int i = 0; i < HTTP_TAR_BLOCK; i++)
+    {
+        sum += (i >= 148 && i < 156) ? ' ' : block[i];
+    }
+    return sum;
+}
+
+void test_regular_file_header(void)
+{
+    uint8_t b[HTTP_TAR_BLOCK];
+    TEST_ASSERT_EQUAL(ESP_OK, http_tar_header(b, "data/log.txt", 1234, 1700000000, false));
+
+    TEST_ASSERT_EQUAL_STRING("data/log.txt", (const char *)b);
+    TEST_ASSERT_EQUAL_STRING("0000644", (const char *)b + 100);
+    TEST_ASSERT_EQUAL(1234, octal_field(b + 124, 12));
+    TEST_ASSERT_EQUAL(1700000000UL, octal_field(b + 136, 12));
+    TEST_ASSERT_EQUAL('0', b[156]);
+    TEST_ASSERT_EQUAL_MEMORY("ustar\0" "00", b + 257, 8);
+    TEST_ASSERT_EQUAL(header_sum(b), octal_field(b + 148, 7));
+    TEST_ASSERT_EQUAL(' ', b[155]);
+}
+
+void test_directory_header(void)
+{
+    uint8_t b[HTTP_TAR_BLOCK];
+    TEST_ASSERT_EQUAL(ESP_OK, http_tar_header(b, "data/www", 999, 0, true));
+
+    TEST_ASSERT_EQUAL_STRING("data/www/", (const char *)b);
+    TEST_ASSERT_EQUAL('5', b[156]);
+    TEST_ASSERT_EQUAL(0, octal_field(b + 124, 12));
+    TEST_ASSERT_EQUAL_STRING("0000755", (const char *)b + 100);
+}
+
+void test_name_of_exactly_100_bytes_fits_without_prefix(void)
+{
+    char name[101];
+    memset(name, 'n', 100);
+    name[100] = '\0';
+    uint8_t b[HTTP_TAR_BLOCK];
+    TEST_ASSERT_EQUAL(ESP_OK, http_tar_header(b, name, 1, 0, false));
+    TEST_ASSERT_EQUAL_MEMORY(name, b, 100);
+    TEST_ASSERT_EQUAL(0, b[345]);
+}
+
+void test_long_name_uses_prefix(void)
+{
+    char name[201];
+    memset(name, 'a', 200);
+    name[200] = '\0';
+    name[150] = '/';
+    uint8_t b[HTTP_TAR_BLOCK];
+    TEST_ASSERT_EQUAL(ESP_OK, http_tar_header(b, name, 1, 0, false));
+
+    TEST_ASSERT_EQUAL_MEMORY(name, b + 345, 150);
+    TEST_ASSERT_EQUAL(0, b[345 + 150]);
+    TEST_ASSERT_EQUAL_MEMORY(name + 151, b, 49);
+    TEST_ASSERT_EQUAL(0, b[49]);
+}
+
+void test_unsplittable_name_is_rejected(void)
+{
+    char name[160];
+    memset(name, 'x', 159);
+    name[159] = '\0';
+    uint8_t b[HTTP_TAR_BLOCK];
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, http_tar_header(b, name, 1, 0, false));
+}
+
+void test_invalid_args(void)
+{
+    uint8_t b[HTTP_TAR_BLOCK];
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_tar_header(b, "", 0, 0, false));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_tar_header(b, NULL, 0, 0, false));
+}
+
+void test_padding(void)
+{
+    TEST_ASSERT_EQUAL(0, http_tar_padding(0));
+    TEST_ASSERT_EQUAL(511, http_tar_padding(1));
+    TEST_ASSERT_EQUAL(0, http_tar_padding(512));
+    TEST_ASSERT_EQUAL(512 - 188, http_tar_padding(700));
+}
+
+/* --- Streaming reader --- */
+
+typedef struct
+{
+    char names[8][HTTP_TAR_NAME_MAX];
+    http_tar_type_t types[8];
+    uint64_t sizes[8];
+    int entries;
+    int ends;
+    uint8_t data[4096];
+    size_t data_len;
+    const char *skip;
+} capture_t;
+
+static esp_err_t cap_entry(void *ctx, const http_tar_entry_t *e)
+{
+    capture_t *c = ctx;
+    strcpy(c->names[c->entries], e->name);
+    c->types[c->entries] = e->type;
+    c->sizes[c->entries] = e->size;
+    c->entries++;
+    if (e->type == HTTP_TAR_TYPE_OTHER || (c->skip && strcmp(c->skip, e->name) == 0))
+    {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t cap_data(void *ctx, const uint8_t *data, size_t len)
+{
+    capture_t *c = ctx;
+    memcpy(c->data + c->data_len, data, len);
+    c->data_len += len;
+    return ESP_OK;
+}
+
+static esp_err_t cap_end(void *ctx)
+{
+    capture_t *c = ctx;
+    c->ends++;
+    return ESP_OK;
+}
+
+static uint8_t s_archive[16 * HTTP_TAR_BLOCK];
+static size_t s_archive_len;
+
+static void put_block(const uint8_t *block)
+{
+    memcpy(s_archive + s_archive_len, block, HTTP_TAR_BLOCK);
+    s_archive_len += HTTP_TAR_BLOCK;
+}
+
+static void put_entry(const char *name, const char *data, bool is_dir)
+{
+    uint8_t b[HTTP_TAR_BLOCK];
+    size_t len = data ? strlen(data) : 0;
+    TEST_ASSERT_EQUAL(ESP_OK, http_tar_header(b, name, len, 0, is_dir));
+    put_block(b);
+    memset(s_archive + s_archive_len, 0, len + http_tar_padding(len));
+    memcpy(s_archive + s_archive_len, data ? data : "", len);
+    s_archive_len += len + http_tar_padding(len);
+}
+
+/* Change the type flag of the last header written and fix up its checksum */
+static void retype_block(uint8_t *b, char type)
+{
+    b[156] = (uint8_t)type;
+    char chk[8];
+    snprintf(chk, sizeof(chk), "%06o", header_sum(b));
+    memcpy(b + 148, chk, 7);
+}
+
+static esp_err_t feed(capture_t *c, size_t piece, http_tar_reader_t *r)
+{
+    const http_tar_callbacks_t cb = {.on_entry = cap_entry, .on_data = cap_data, .on_end = cap_end, .ctx = c};
+    http_tar_reader_init(r, &cb);
+    for (size_t off = 0; off < s_archive_len; off += piece)
+    {
+        size_t n = (s_archive_len - off < piece) ? s_archive_len - off : piece;
+        esp_err_t err = http_tar_reader_write(r, s_archive + off, n);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+    }
+    return http_tar_reader_finish(r);
+}
+
+static void build_site(void)
+{
+    s_archive_len = 0;
+    put_entry("./site", NULL, true);
+    char big[701];
+    memset(big, 'b', 700);
+    big[700] = '\0';
+    put_entry("site/index.html", big, false);
+    put_entry("site/empty", NULL, false);
+    put_entry("site/a.txt", "hello", false);
+    memset(s_archive + s_archive_len, 0, 2 * HTTP_TAR_BLOCK);
+    s_archive_len += 2 * HTTP_TAR_BLOCK;
+}
+
+void test_reader_reads_entries_in_any_piece_size(void)
+{
+    static const size_t pieces[] = {1, 7, 512, 1000, sizeof(s_archive)};
+    build_site();
+    for (size_t i = 0; i < sizeof(pieces) / sizeof(pieces[0]); i++)
+    {
+        capture_t c = {0};
+        http_tar_reader_t r;
+        TEST_ASSERT_EQUAL(ESP_OK, feed(&c, pieces[i], &r));
+        TEST_ASSERT_EQUAL(4, c.entries);
+        TEST_ASSERT_EQUAL_STRING("site", c.names[0]);
+        TEST_ASSERT_EQUAL(HTTP_TAR_TYPE_DIR, c.types[0]);
+        TEST_ASSERT_EQUAL_STRING("site/index.html", c.names[1]);
+        TEST_ASSERT_EQUAL(700, c.sizes[1]);
+        TEST_ASSERT_EQUAL(HTTP_TAR_TYPE_FILE, c.types[2]);
+        TEST_ASSERT_EQUAL(4, c.ends);
+        TEST_ASSERT_EQUAL(705, c.data_len);
+        TEST_ASSERT_EQUAL_MEMORY("hello", c.data + 700, 5);
+    }
+}
+
+void test_reader_skips_declined_entries(void)
+{
+    build_site();
+    capture_t c = {.skip = "site/index.html"};
+    http_tar_reader_t r;
+    TEST_ASSERT_EQUAL(ESP_OK, feed(&c, 100, &r));
+    TEST_ASSERT_EQUAL(4, c.entries);
+    TEST_ASSERT_EQUAL(3, c.ends);
+    TEST_ASSERT_EQUAL(5, c.data_len);
+}
+
+void test_reader_applies_gnu_long_name(void)
+{
+    char name[200];
+    memset(name, 'L', sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+
+    s_archive_len = 0;
+    put_entry("././@LongLink", name, false);
+    retype_block(s_archive, 'L');
+    put_entry("truncated", "x", false);
+    put_entry("next", "y", false);
+
+    capture_t c = {0};
+    http_tar_reader_t r;
+    TEST_ASSERT_EQUAL(ESP_OK, feed(&c, 64, &r));
+    TEST_ASSERT_EQUAL(2, c.entries);
+    TEST_ASSERT_EQUAL_STRING(name, c.names[0]);
+    TEST_ASSERT_EQUAL_STRING("next", c.names[1]);
+}
+
+void test_reader_applies_pax_path(void)
+{
+    s_archive_len = 0;
+    put_entry("PaxHeaders/x", "20 mtime=1700000000\n27 path=./deep/pax-name.js\n", false);
+    retype_block(s_archive, 'x');
+    put_entry("short", "z", false);
+
+    capture_t c = {0};
+    http_tar_reader_t r;
+    TEST_ASSERT_EQUAL(ESP_OK, feed(&c, 512, &r));
+    TEST_ASSERT_EQUAL(1, c.entries);
+    TEST_ASSERT_EQUAL_STRING("deep/pax-name.js", c.names[0]);
+}
+
+void test_reader_reports_links_as_other(void)
+{
+    s_archive_len = 0;
+    put_entry("link", NULL, false);
+    retype_block(s_archive, '2');
+
+    capture_t c = {0};
+    http_tar_reader_t r;
+    TEST_ASSERT_EQUAL(ESP_OK, feed(&c, 512, &r));
+    TEST_ASSERT_EQUAL(HTTP_TAR_TYPE_OTHER, c.types[0]);
+    TEST_ASSERT_EQUAL(0, c.ends);
+}
+
+void test_reader_rejects_bad_checksum(void)
+{
+    build_site();
+    s_archive[HTTP_TAR_BLOCK + 3] ^= 0x20;
+    capture_t c = {0};
+    http_tar_reader_t r;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_CRC, feed(&c, 4096, &r));
+}
+
+void test_reader_detects_truncation(void)
+{
+    build_site();
+    s_archive_len = HTTP_TAR_BLOCK + 300; /* stops inside index.html */
+    capture_t c = {0};
+    http_tar_reader_t r;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, feed(&c, 512, &r));
+
+    /* Ending on an entry boundary without the zero blocks is accepted */
+    build_site();
+    s_archive_len -= 2 * HTTP_TAR_BLOCK;
+    TEST_ASSERT_EQUAL(ESP_OK, feed(&c, 512, &r));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_regular_file_header);
+    RUN_TEST(test_directory_header);
+    RUN_TEST(test_name_of_exactly_100_bytes_fits_without_prefix);
+    RUN_TEST(test_long_name_uses_prefix);
+    RUN_TEST(test_unsplittable_name_is_rejected);
+    RUN_TEST(test_invalid_args);
+    RUN_TEST(test_padding);
+    RUN_TEST(test_reader_reads_entries_in_any_piece_size);
+    RUN_TEST(test_reader_skips_declined_entries);
+    RUN_TEST(test_reader_applies_gnu_long_name);
+    RUN_TEST(test_reader_applies_pax_path);
+    RUN_TEST(test_reader_reports_links_as_other);
+    RUN_TEST(test_reader_rejects_bad_checksum);
+    RUN_TEST(test_reader_detects_truncation);
+    return UNITY_END();
+}
@@ -0,0 +1,107 @@
+#include "unity.h"
+#include "http_upload_session.h"
+
+#include <string.h>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_meta_round_trip(void)
+{
+    http_upload_meta_t in = {.path = "/sdcard/fw/image.bin", .length = 5000000000ULL, .created = 1760000000};
+    char buf[256];
+    TEST_ASSERT_GREATER_THAN(0, http_upload_meta_format(&in, buf, sizeof(buf)));
+
+    http_upload_meta_t out;
+    TEST_ASSERT_EQUAL(ESP_OK, http_upload_meta_parse(buf, &out));
+    TEST_ASSERT_EQUAL_STRING(in.path, out.path);
+    TEST_ASSERT_TRUE(in.length == out.length);
+    TEST_ASSERT_TRUE(in.created == out.created);
+}
+
+void test_meta_format_rejects_small_buffer(void)
+{
+    http_upload_meta_t in = {.path = "/flash/a.bin", .length = 1, .created = 1};
+    char buf[16];
+    TEST_ASSERT_EQUAL(-1, http_upload_meta_format(&in, buf, sizeof(buf)));
+}
+
+void test_meta_format_rejects_newline_in_path(void)
+{
+    http_upload_meta_t in = {.path = "/flash/a\nlength=1", .length = 1, .created = 1};
+    char buf[256];
+    TEST_ASSERT_EQUAL(-1, http_upload_meta_format(&in, buf, sizeof(buf)));
+}
+
+void test_meta_parse_rejects_bad_magic(void)
+{
+    http_upload_meta_t out;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_upload_meta_parse("path=/flash/a\nlength=1\ncreated=1\n", &out));
+}
+
+void test_meta_parse_requires_all_fields(void)
+{
+    http_upload_meta_t out;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, http_upload_meta_parse("cos-upload 1\npath=/flash/a\nlength=1\n", &out));
+}
+
+void test_meta_parse_rejects_bad_numbers(void)
+{
+    http_upload_meta_t out;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG,
+                      http_upload_meta_parse("cos-upload 1\npath=/flash/a\nlength=-5\ncreated=1\n", &out));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG,
+                      http_upload_meta_parse("cos-upload 1\npath=/flash/a\nlength=12x\ncreated=1\n", &out));
+}
+
+void test_meta_parse_ignores_unknown_keys(void)
+{
+    http_upload_meta_t out;
+    TEST_ASSERT_EQUAL(ESP_OK,
+                      http_upload_meta_parse("cos-upload 1\nfuture=1\npath=/flash/a\nlength=7\ncreated=9", &out));
+    TEST_ASSERT_EQUAL_STRING("/flash/a", out.path);
+    TEST_ASSERT_TRUE(out.length == 7);
+}
+
+void test_id_validation(void)
+{
+    TEST_ASSERT_TRUE(http_upload_id_valid("0123456789abcdef"));
+    TEST_ASSERT_FALSE(http_upload_id_valid("0123456789ABCDEF"));
+    TEST_ASSERT_FALSE(http_upload_id_valid("0123456789abcde"));
+    TEST_ASSERT_FALSE(http_upload_id_valid("0123456789abcdef0"));
+    TEST_ASSERT_FALSE(http_upload_id_valid("../../etc/passwd"));
+    TEST_ASSERT_FALSE(http_upload_id_valid(""));
+    TEST_ASSERT_FALSE(http_upload_id_valid(NULL));
+}
+
+void test_expiry(void)
+{
+    const int64_t t0 = 1760000000;
+    TEST_ASSERT_FALSE(http_upload_session_expired(t0, t0 + 100, 3600));
+    TEST_ASSERT_FALSE(http_upload_session_expired(t0, t0 + 3600, 3600));
+    TEST_ASSERT_TRUE(http_upload_session_expired(t0, t0 + 3601, 3600));
+}
+
+void test_expiry_waits_for_valid_clock(void)
+{
+    const int64_t t0 = 1760000000;
+    /* Created before SNTP sync, or evaluated before it */
+    TEST_ASSERT_FALSE(http_upload_session_expired(5, t0, 3600));
+    TEST_ASSERT_FALSE(http_upload_session_expired(t0, 50000, 3600));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_meta_round_trip);
+    RUN_TEST(test_meta_format_rejects_small_buffer);
+    RUN_TEST(test_meta_format_rejects_newline_in_path);
+    RUN_TEST(test_meta_parse_rejects_bad_magic);
+    RUN_TEST(test_meta_parse_requires_all_fields);
+    RUN_TEST(test_meta_parse_rejects_bad_numbers);
+    RUN_TEST(test_meta_parse_ignores_unknown_keys);
+    RUN_TEST(test_id_validation);
+    RUN_TEST(test_expiry);
+    RUN_TEST(test_expiry_waits_for_valid_clock);
+    return UNITY_END();
+}
@@ -0,0 +1,151 @@
+#include "unity.h"
+#include "log_ring.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static log_ring_t s_ring;
+
+void setUp(void)
+{
+    log_ring_init(&s_ring);
+}
+
+void tearDown(void) {}
+
+static void write_str(const char *s)
+{
+    log_ring_write(&s_ring, s, strlen(s));
+}
+
+static const char *next_line(log_ring_cursor_t *c, uint32_t *dropped)
+{
+    static char line[LOG_RING_LINE_MAX + 1];
+    size_t len = 0;
+    if (!log_ring_next(&s_ring, c, line, sizeof(line), &len, dropped))
+    {
+        return NULL;
+    }
+    TEST_ASSERT_EQUAL(strlen(line), len);
+    return line;
+}
+
+void test_lines_are_split_and_cr_removed(void)
+{
+    write_str("I (1) one\r\nI (2) t");
+    write_str("wo\n\npartial");
+
+    log_ring_cursor_t c;
+    log_ring_seek(&s_ring, 0, &c);
+    TEST_ASSERT_EQUAL_STRING("I (1) one", next_line(&c, NULL));
+    TEST_ASSERT_EQUAL_STRING("I (2) two", next_line(&c, NULL));
+    TEST_ASSERT_EQUAL_STRING("", next_line(&c, NULL));
+    TEST_ASSERT_NULL(next_line(&c, NULL));
+    TEST_ASSERT_EQUAL_UINT32(3, c.seq);
+
+    write_str(" line\n");
+    TEST_ASSERT_EQUAL_STRING("partial line", next_line(&c, NULL));
+}
+
+void test_seek_replays_last_lines_and_clamps(void)
+{
+    write_str("a\nb\nc\nd\n");
+
+    log_ring_cursor_t c;
+    log_ring_seek(&s_ring, s_ring.seq_head - 2, &c);
+    TEST_ASSERT_EQUAL_STRING("c", next_line(&c, NULL));
+    TEST_ASSERT_EQUAL_STRING("d", next_line(&c, NULL));
+
+    /* Past the newest line: only future lines */
+    log_ring_seek(&s_ring, 100, &c);
+    TEST_ASSERT_EQUAL_UINT32(4, c.seq);
+    TEST_ASSERT_NULL(next_line(&c, NULL));
+    write_str("e\n");
+    TEST_ASSERT_EQUAL_STRING("e", next_line(&c, NULL));
+}
+
+void test_full_ring_drops_oldest_and_reports_to_reader(void)
+{
+    log_ring_cursor_t c;
+    log_ring_seek(&s_ring, 0, &c);
+
+    /* 16-byte records: "line 0000000000\n" */
+    char buf[32];
+    const uint32_t total = LOG_RING_SIZE / 16 + 10;
+    for (uint32_t i = 0; i < total; i++)
+    {
+        snprintf(buf, sizeof(buf), "line %010lu\n", (unsigned long)i);
+        write_str(buf);
+    }
+    TEST_ASSERT_EQUAL_UINT32(total, s_ring.seq_head);
+    TEST_ASSERT_EQUAL_UINT32(10, s_ring.seq_tail);
+    TEST_ASSERT_TRUE(s_ring.head - s_ring.tail <= LOG_RING_SIZE);
+
+    uint32_t dropped = 0;
+    TEST_ASSERT_EQUAL_STRING("line 0000000010", next_line(&c, &dropped));
+    TEST_ASSERT_EQUAL_UINT32(10, dropped);
+
+    /* A cursor positioned before the tail is clamped too */
+    log_ring_seek(&s_ring, 0, &c);
+    TEST_ASSERT_EQUAL_UINT32(10, c.seq);
+}
+
+void test_reader_keeping_up_sees_every_line_across_wraps(void)
+{
+    log_ring_cursor_t c;
+    log_ring_seek(&s_ring, 0, &c);
+
+    char buf[48];
+    uint32_t dropped = 0;
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        snprintf(buf, sizeof(buf), "msg %lu %.*s\n", (unsigned long)i, (int)(i % 23), "xxxxxxxxxxxxxxxxxxxxxxx");
+        write_str(buf);
+        buf[strlen(buf) - 1] = '\0';
+        TEST_ASSERT_EQUAL_STRING(buf, next_line(&c, &dropped));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, dropped);
+    TEST_ASSERT_NULL(next_line(&c, &dropped));
+}
+
+void test_long_lines_are_split(void)
+{
+    char big[LOG_RING_LINE_MAX + 11];
+    memset(big, 'x', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+    write_str(big);
+    write_str("\n");
+
+    log_ring_cursor_t c;
+    log_ring_seek(&s_ring, 0, &c);
+    TEST_ASSERT_EQUAL(LOG_RING_LINE_MAX, strlen(next_line(&c, NULL)));
+    TEST_ASSERT_EQUAL(10, strlen(next_line(&c, NULL)));
+}
+
+void test_read_truncates_to_caller_buffer(void)
+{
+    write_str("0123456789\nnext\n");
+
+    log_ring_cursor_t c;
+    log_ring_seek(&s_ring, 0, &c);
+    char small[5];
+    size_t len = 0;
+    TEST_ASSERT_TRUE(log_ring_next(&s_ring, &c, small, sizeof(small), &len, NULL));
+    TEST_ASSERT_EQUAL_STRING("0123", small);
+    TEST_ASSERT_EQUAL(4, len);
+    /* The rest of the long line is skipped, not returned as another line */
+    TEST_ASSERT_TRUE(log_ring_next(&s_ring, &c, small, sizeof(small), &len, NULL));
+    TEST_ASSERT_EQUAL_STRING("next", small);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_lines_are_split_and_cr_removed);
+    RUN_TEST(test_seek_replays_last_lines_and_clamps);
+    RUN_TEST(test_full_ring_drops_oldest_and_reports_to_reader);
+    RUN_TEST(test_reader_keeping_up_sees_every_line_across_wraps);
+    RUN_TEST(test_long_lines_are_split);
+    RUN_TEST(test_read_truncates_to_caller_buffer);
+    return UNITY_END();
+}
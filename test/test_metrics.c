@@ -0,0 +1,208 @@
+#include "unity.h"
+#include "metrics.h"
+#include "mock_freertos.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static char s_out[2048];
+static size_t s_out_len;
+
+static esp_err_t capture(void *ctx, const char *data, size_t len)
+{
+    (void)ctx;
+    TEST_ASSERT_TRUE(s_out_len + len < sizeof(s_out));
+    memcpy(s_out + s_out_len, data, len);
+    s_out_len += len;
+    s_out[s_out_len] = '\0';
+    return ESP_OK;
+}
+
+static esp_err_t fail_after_first(void *ctx, const char *data, size_t len)
+{
+    int *calls = ctx;
+    (void)data;
+    (void)len;
+    return (*calls)++ == 0 ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+static const char *export_all(const char *prefix)
+{
+    s_out_len = 0;
+    s_out[0] = '\0';
+    TEST_ASSERT_EQUAL(ESP_OK, metrics_export(prefix, capture, NULL));
+    return s_out;
+}
+
+static bool sample_rssi(int64_t *value)
+{
+    *value = -61;
+    return true;
+}
+
+static bool sample_none(int64_t *value)
+{
+    (void)value;
+    return false;
+}
+
+void setUp(void)
+{
+    mock_freertos_reset();
+    metrics_reset();
+}
+
+void tearDown(void) {}
+
+void test_counter_sums_per_core_slots(void)
+{
+    metric_t *c = metrics_counter("cos_test_total", "Test counter");
+    TEST_ASSERT_NOT_NULL(c);
+
+    metrics_counter_add(c, 3);
+    mock_freertos_set_core_id(1);
+    metrics_counter_add(c, 4);
+    metrics_counter_add(c, 0xFFFFFFFFu);
+
+    TEST_ASSERT_EQUAL_UINT64(7ull + 0xFFFFFFFFull, metrics_counter_value(c));
+}
+
+void test_registration_is_idempotent_and_typed(void)
+{
+    metric_t *c = metrics_counter("cos_test_total", "Test counter");
+    TEST_ASSERT_EQUAL_PTR(c, metrics_counter("cos_test_total", "Test counter"));
+    TEST_ASSERT_NULL(metrics_gauge("cos_test_total", "Same name, other type"));
+    TEST_ASSERT_NULL(metrics_counter("", "Empty name"));
+}
+
+void test_null_handles_are_ignored(void)
+{
+    metrics_counter_add(NULL, 1);
+    metrics_gauge_set(NULL, 1);
+    metrics_histogram_observe(NULL, 1);
+    TEST_ASSERT_EQUAL_UINT64(0, metrics_counter_value(NULL));
+}
+
+void test_registry_full_returns_null(void)
+{
+    static char names[METRICS_MAX + 1][24];
+    for (int i = 0; i < METRICS_MAX; i++)
+    {
+        snprintf(names[i], sizeof(names[i]), "cos_m%d", i);
+        TEST_ASSERT_NOT_NULL(metrics_gauge(names[i], ""));
+    }
+    snprintf(names[METRICS_MAX], sizeof(names[METRICS_MAX]), "cos_m%d", METRICS_MAX);
+    TEST_ASSERT_NULL(metrics_gauge(names[METRICS_MAX], ""));
+}
+
+void test_export_counter_and_gauges(void)
+{
+    metrics_counter_add(metrics_counter("cos_frames_total", "Frames drawn"), 12);
+    metrics_gauge_set(metrics_gauge("cos_clients", "Connected clients"), 2);
+    metrics_gauge_sampled("cos_rssi_dbm", "Signal", sample_rssi);
+    metrics_gauge_sampled("cos_absent", "Never sampled", sample_none);
+
+    TEST_ASSERT_EQUAL_STRING("# HELP cos_frames_total Frames drawn\n"
+                             "# TYPE cos_frames_total counter\n"
+                             "cos_frames_total 12\n"
+                             "# HELP cos_clients Connected clients\n"
+                             "# TYPE cos_clients gauge\n"
+                             "cos_clients 2\n"
+                             "# HELP cos_rssi_dbm Signal\n"
+                             "# TYPE cos_rssi_dbm gauge\n"
+                             "cos_rssi_dbm -61\n"
+                             "# HELP cos_absent Never sampled\n"
+                             "# TYPE cos_absent gauge\n",
+                             export_all(NULL));
+}
+
+void test_labelled_metrics_share_one_family(void)
+{
+    metric_t *ok = metrics_counter("cos_req_total{code=\"2xx\"}", "Requests");
+    metrics_counter("cos_other_total", "Unrelated");
+    metric_t *err = metrics_counter("cos_req_total{code=\"5xx\"}", "Requests");
+    metrics_counter_add(ok, 5);
+    metrics_counter_add(err, 1);
+
+    TEST_ASSERT_EQUAL_STRING("# HELP cos_req_total Requests\n"
+                             "# TYPE cos_req_total counter\n"
+                             "cos_req_total{code=\"2xx\"} 5\n"
+                             "cos_req_total{code=\"5xx\"} 1\n",
+                             export_all("cos_req"));
+}
+
+void test_histogram_buckets_are_cumulative(void)
+{
+    static const uint32_t bounds[] = {10, 100, 1000};
+    metric_t *h = metrics_histogram("cos_lat_us", "Latency", bounds, 3);
+    TEST_ASSERT_NOT_NULL(h);
+
+    metrics_histogram_observe(h, 5);
+    metrics_histogram_observe(h, 10);
+    mock_freertos_set_core_id(1);
+    metrics_histogram_observe(h, 50);
+    metrics_histogram_observe(h, 5000);
+
+    TEST_ASSERT_EQUAL_STRING("# HELP cos_lat_us Latency\n"
+                             "# TYPE cos_lat_us histogram\n"
+                             "cos_lat_us_bucket{le=\"10\"} 2\n"
+                             "cos_lat_us_bucket{le=\"100\"} 3\n"
+                             "cos_lat_us_bucket{le=\"1000\"} 3\n"
+                             "cos_lat_us_bucket{le=\"+Inf\"} 4\n"
+                             "cos_lat_us_sum 5065\n"
+                             "cos_lat_us_count 4\n",
+                             export_all(NULL));
+}
+
+void test_histogram_keeps_its_labels(void)
+{
+    static const uint32_t bounds[] = {1};
+    metrics_histogram_observe(metrics_histogram("cos_h{k=\"v\"}", "H", bounds, 1), 2);
+
+    TEST_ASSERT_EQUAL_STRING("# HELP cos_h H\n"
+                             "# TYPE cos_h histogram\n"
+                             "cos_h_bucket{k=\"v\",le=\"1\"} 0\n"
+                             "cos_h_bucket{k=\"v\",le=\"+Inf\"} 1\n"
+                             "cos_h_sum{k=\"v\"} 2\n"
+                             "cos_h_count{k=\"v\"} 1\n",
+                             export_all(NULL));
+}
+
+void test_histogram_limits(void)
+{
+    static const uint32_t bounds[METRICS_HIST_BUCKETS + 1] = {0};
+    TEST_ASSERT_NULL(metrics_histogram("cos_too_many", "", bounds, METRICS_HIST_BUCKETS + 1));
+
+    static char names[METRICS_MAX_HISTOGRAMS + 1][16];
+    for (int i = 0; i <= METRICS_MAX_HISTOGRAMS; i++)
+    {
+        snprintf(names[i], sizeof(names[i]), "cos_h%d", i);
+        metric_t *h = metrics_histogram(names[i], "", bounds, 1);
+        TEST_ASSERT_TRUE(i < METRICS_MAX_HISTOGRAMS ? h != NULL : h == NULL);
+    }
+}
+
+void test_export_stops_at_first_write_error(void)
+{
+    metrics_counter("cos_a_total", "A");
+    metrics_counter("cos_b_total", "B");
+    int calls = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, metrics_export(NULL, fail_after_first, &calls));
+    TEST_ASSERT_EQUAL(2, calls);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_counter_sums_per_core_slots);
+    RUN_TEST(test_registration_is_idempotent_and_typed);
+    RUN_TEST(test_null_handles_are_ignored);
+    RUN_TEST(test_registry_full_returns_null);
+    RUN_TEST(test_export_counter_and_gauges);
+    RUN_TEST(test_labelled_metrics_share_one_family);
+    RUN_TEST(test_histogram_buckets_are_cumulative);
+    RUN_TEST(test_histogram_keeps_its_labels);
+    RUN_TEST(test_histogram_limits);
+    RUN_TEST(test_export_stops_at_first_write_error);
+    return UNITY_END();
+}
@@ -255,6 +255,27 @@ static void test_cmd_hexdump_no_arg(void)
     TEST_ASSERT_EQUAL(1, ret);
 }
 
+static void test_cmd_sha256_no_arg(void)
+{
+    char *argv[] = {"sha256"};
+    int ret = mock_console_run_cmd("sha256", 1, argv);
+    TEST_ASSERT_EQUAL(1, ret);
+}
+
+static void test_cmd_sha256_missing_file(void)
+{
+    char *argv[] = {"sha256", "nofile.bin"};
+    int ret = mock_console_run_cmd("sha256", 2, argv);
+    TEST_ASSERT_EQUAL(1, ret);
+}
+
+static void test_cmd_sha256_directory(void)
+{
+    char *argv[] = {"sha256", "/flash"};
+    int ret = mock_console_run_cmd("sha256", 2, argv);
+    TEST_ASSERT_EQUAL(1, ret);
+}
+
 static void test_cmd_sd_no_arg(void)
 {
     char *argv[] = {"sd"};
@@ -362,6 +383,9 @@ int main(void)
     RUN_TEST(test_cmd_touch);
     RUN_TEST(test_cmd_touch_no_arg);
     RUN_TEST(test_cmd_hexdump_no_arg);
+    RUN_TEST(test_cmd_sha256_no_arg);
+    RUN_TEST(test_cmd_sha256_missing_file);
+    RUN_TEST(test_cmd_sha256_directory);
 
     /* sd commands */
     RUN_TEST(test_cmd_sd_no_arg);
@@ -14,6 +14,13 @@ const char *shell_get_prompt(void)
     return s_mock_prompt;
 }
 
+/* Mock shell_run_command (defined in shell.c, not linked here) */
+esp_err_t shell_run_command(const char *cmdline, int *ret, uint32_t wait_ms)
+{
+    (void)wait_ms;
+    return esp_console_run(cmdline, ret);
+}
+
 static void reset_state(void)
 {
     s_line_pos = 0;